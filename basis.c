@@ -0,0 +1,350 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "basis.h"
+#include "instrument.h"
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+struct prepared_basis {
+  int n;
+  int k;
+  //column j (n numbers) holds R above row j and the Householder vector of
+  //   step j from row j down
+  long double *qr;
+  //2 / v^T v for each Householder vector v
+  long double *beta;
+  //the diagonal of R
+  long double *rdiag;
+  size_t bytes;
+};
+
+
+struct prepared_basis *basis_prepare(const struct vector * const basis[],
+                                     const int k) {
+  INSTRUMENT_SCOPE(basis_prepare);
+  assert(basis);
+  for (int j = 0; j < k; j++) {
+    assert(basis[j]);
+  }
+  if (k < 1) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. k must be greater than 0.");
+    return NULL;
+  }
+  const int n = vector_dim(basis[0]);
+  INSTRUMENT_DIMS(n, k);
+  for (int j = 0; j < k; j++) {
+    if ((vector_dim(basis[j]) != n) || (n < 1)) {
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "Invalid input. All vectors must have the same positive "
+                    "dimension.");
+      return NULL;
+    }
+  }
+  if (k > n) {
+    linalg_report(LINALG_ERR_NOT_BASIS, __func__,
+                  "Invalid input. %d vectors in R[%d] are not linearly "
+                  "independent.", k, n);
+    return NULL;
+  }
+  struct prepared_basis *B = malloc(sizeof(struct prepared_basis));
+  B->n = n;
+  B->k = k;
+  B->bytes = sizeof(struct prepared_basis) +
+             ((size_t) k * n + 2 * k) * sizeof(long double);
+  B->qr = malloc((size_t) (k * n + 2 * k) * sizeof(long double));
+  INSTRUMENT_ALLOC(B->bytes);
+  B->beta = B->qr + (size_t) k * n;
+  B->rdiag = B->beta + k;
+  for (int j = 0; j < k; j++) {
+    memcpy(B->qr + (size_t) j * n, vector_cdata(basis[j]),
+           n * sizeof(long double));
+  }
+  for (int j = 0; j < k; j++) {
+    long double *v = B->qr + (size_t) j * n;
+    const long double *b = vector_cdata(basis[j]);
+    long double size = 0;
+    long double rest = 0;
+    for (int i = 0; i < n; i++) {
+      size += b[i] * b[i];
+    }
+    for (int i = j; i < n; i++) {
+      rest += v[i] * v[i];
+    }
+    size = sqrtl(size);
+    rest = sqrtl(rest);
+    if (!(rest > PRECISION * size)) {
+      linalg_report(LINALG_ERR_NOT_BASIS, __func__,
+                    "Invalid input. Vector %d is in the span of the vectors "
+                    "before it.", j + 1);
+      basis_destroy(B);
+      return NULL;
+    }
+    //v = x - alpha e_j reflects x to alpha e_j
+    const long double alpha = v[j] < 0 ? rest : -rest;
+    v[j] -= alpha;
+    long double vv = 0;
+    for (int i = j; i < n; i++) {
+      vv += v[i] * v[i];
+    }
+    B->beta[j] = 2 / vv;
+    B->rdiag[j] = alpha;
+    for (int c = j + 1; c < k; c++) {
+      long double *a = B->qr + (size_t) c * n;
+      long double s = 0;
+      for (int i = j; i < n; i++) {
+        s += v[i] * a[i];
+      }
+      s *= B->beta[j];
+      for (int i = j; i < n; i++) {
+        a[i] -= s * v[i];
+      }
+    }
+    INSTRUMENT_FLOPS(4LL * (n - j) * (k - j));
+  }
+  return B;
+}
+
+void basis_size(const struct prepared_basis * const B, int * const n,
+                int * const k) {
+  assert(B);
+  assert(n);
+  assert(k);
+  *n = B->n;
+  *k = B->k;
+}
+
+//reflect(B, x) replaces the n long doubles of x by Q^T x, whose first k
+//   entries are the coordinates of the projection of x in the columns of Q,
+//   and the rest those of the part of x outside the span.
+//requires: B, x are not NULL
+//effects: modifies x
+static void reflect(const struct prepared_basis * const B,
+                    long double * const x) {
+  const int n = B->n;
+  for (int j = 0; j < B->k; j++) {
+    const long double *v = B->qr + (size_t) j * n;
+    long double s = 0;
+    for (int i = j; i < n; i++) {
+      s += v[i] * x[i];
+    }
+    s *= B->beta[j];
+    for (int i = j; i < n; i++) {
+      x[i] -= s * v[i];
+    }
+  }
+  INSTRUMENT_FLOPS(4LL * n * B->k);
+}
+
+//spanned(B, y, size) returns true if y = Q^T x (see reflect) belongs to an x
+//   in the span of B, where size is the norm of x.
+//requires: B, y are not NULL
+static bool spanned(const struct prepared_basis * const B,
+                    const long double * const y, const long double size) {
+  long double rest = 0;
+  for (int i = B->k; i < B->n; i++) {
+    rest += y[i] * y[i];
+  }
+  return sqrtl(rest) <= PRECISION * size;
+}
+
+//solve_r(B, y, c) solves Rc = y for the k coordinates c.
+//requires: B, y, c are not NULL
+//effects: modifies c
+static void solve_r(const struct prepared_basis * const B,
+                    const long double * const y, long double * const c) {
+  const int n = B->n;
+  for (int j = B->k - 1; j >= 0; j--) {
+    long double sum = y[j];
+    for (int t = j + 1; t < B->k; t++) {
+      sum -= B->qr[(size_t) t * n + j] * c[t];
+    }
+    c[j] = sum / B->rdiag[j];
+  }
+  INSTRUMENT_FLOPS((long long) B->k * B->k);
+}
+
+//query(B, v1, function) returns a heap-allocated copy of Q^T v1, or reports
+//   on behalf of function that v1 does not fit B and returns NULL.
+//requires: B, v1 are not NULL
+//effects: may print output
+//         may allocate heap memory
+static long double *query(const struct prepared_basis * const B,
+                          const struct vector * const v1,
+                          const char * const function) {
+  if (vector_dim(v1) != B->n) {
+    linalg_report(LINALG_ERR_DIMENSION, function,
+                  "Invalid input. v1 must be in R[%d].", B->n);
+    return NULL;
+  }
+  long double *y = malloc(B->n * sizeof(long double));
+  INSTRUMENT_ALLOC(B->n * sizeof(long double));
+  memcpy(y, vector_cdata(v1), B->n * sizeof(long double));
+  reflect(B, y);
+  return y;
+}
+
+//query_end(y, n) frees the result of query, which holds n long doubles.
+//effects: frees heap memory
+static void query_end(long double * const y, const int n) {
+  (void) n;
+  INSTRUMENT_FREE(n * sizeof(long double));
+  free(y);
+}
+
+//norm(v1) returns the length of v1.
+//requires: v1 is not NULL
+static long double norm(const struct vector * const v1) {
+  const long double *x = vector_cdata(v1);
+  long double sum = 0;
+  for (int i = 0; i < vector_dim(v1); i++) {
+    sum += x[i] * x[i];
+  }
+  return sqrtl(sum);
+}
+
+bool basis_in_span(const struct prepared_basis * const B,
+                   const struct vector * const v1) {
+  INSTRUMENT_SCOPE(basis_in_span);
+  assert(B);
+  assert(v1);
+  INSTRUMENT_DIMS(B->n, B->k);
+  long double *y = query(B, v1, __func__);
+  if (!y) {
+    return false;
+  }
+  const bool result = spanned(B, y, norm(v1));
+  query_end(y, B->n);
+  return result;
+}
+
+struct vector *basis_coord(const struct prepared_basis * const B,
+                           const struct vector * const v1) {
+  INSTRUMENT_SCOPE(basis_coord);
+  assert(B);
+  assert(v1);
+  INSTRUMENT_DIMS(B->n, B->k);
+  long double *y = query(B, v1, __func__);
+  if (!y) {
+    return NULL;
+  }
+  struct vector *coords = NULL;
+  if (!spanned(B, y, norm(v1))) {
+    linalg_report(LINALG_ERR_INVALID, __func__,
+                  "Invalid input. Vector is not in span.");
+  } else {
+    coords = vector_create_zero(B->k);
+    solve_r(B, y, vector_data(coords));
+  }
+  query_end(y, B->n);
+  return coords;
+}
+
+struct vector *basis_project(const struct prepared_basis * const B,
+                             const struct vector * const v1) {
+  INSTRUMENT_SCOPE(basis_project);
+  assert(B);
+  assert(v1);
+  INSTRUMENT_DIMS(B->n, B->k);
+  long double *y = query(B, v1, __func__);
+  if (!y) {
+    return NULL;
+  }
+  const int n = B->n;
+  struct vector *projection = vector_create_zero(n);
+  long double *x = vector_data(projection);
+  memcpy(x, y, B->k * sizeof(long double));
+  //Q applies the reflections in reverse order
+  for (int j = B->k - 1; j >= 0; j--) {
+    const long double *v = B->qr + (size_t) j * n;
+    long double s = 0;
+    for (int i = j; i < n; i++) {
+      s += v[i] * x[i];
+    }
+    s *= B->beta[j];
+    for (int i = j; i < n; i++) {
+      x[i] -= s * v[i];
+    }
+  }
+  INSTRUMENT_FLOPS(4LL * n * B->k);
+  query_end(y, B->n);
+  return projection;
+}
+
+struct matrix *basis_coord_batch(const struct prepared_basis * const B,
+                                 const struct matrix * const V,
+                                 bool * const in_span) {
+  INSTRUMENT_SCOPE(basis_coord_batch);
+  assert(B);
+  assert(V);
+  int m, s = 0;
+  matrix_size(V, &m, &s);
+  INSTRUMENT_DIMS(m, s);
+  const int n = B->n;
+  const int k = B->k;
+  if (m != n) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. V must have %d rows.", n);
+    return NULL;
+  }
+  //the queries by columns, the squared norm of each, then room for the
+  //   coordinates of one
+  const size_t bytes = ((size_t) n * s + s + k) * sizeof(long double);
+  long double *X = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  long double *size = X + (size_t) n * s;
+  long double *coeff = size + s;
+  memset(size, 0, s * sizeof(long double));
+  for (int i = 0; i < n; i++) {
+    const long double *row = matrix_row_cdata(V, i + 1);
+    for (int c = 0; c < s; c++) {
+      X[(size_t) c * n + i] = row[c];
+      size[c] += row[c] * row[c];
+    }
+  }
+  //each reflection is applied to every query while it is in cache
+  for (int j = 0; j < k; j++) {
+    const long double *v = B->qr + (size_t) j * n;
+    for (int c = 0; c < s; c++) {
+      long double *x = X + (size_t) c * n;
+      long double t = 0;
+      for (int i = j; i < n; i++) {
+        t += v[i] * x[i];
+      }
+      t *= B->beta[j];
+      for (int i = j; i < n; i++) {
+        x[i] -= t * v[i];
+      }
+    }
+  }
+  INSTRUMENT_FLOPS(4LL * n * k * s);
+  struct matrix *coords = matrix_create_zero(k, s);
+  for (int c = 0; c < s; c++) {
+    const long double *y = X + (size_t) c * n;
+    if (in_span) {
+      in_span[c] = spanned(B, y, sqrtl(size[c]));
+    }
+    solve_r(B, y, coeff);
+    for (int j = 0; j < k; j++) {
+      matrix_row_data(coords, j + 1)[c] = coeff[j];
+    }
+  }
+  INSTRUMENT_FREE(bytes);
+  free(X);
+  return coords;
+}
+
+void basis_destroy(struct prepared_basis * const B) {
+  if (B) {
+    INSTRUMENT_FREE(B->bytes);
+    free(B->qr);
+    free(B);
+  }
+}
@@ -0,0 +1,87 @@
+#ifndef LINALG_BASIS_H
+#define LINALG_BASIS_H
+
+#include <stdbool.h>
+
+//A prepared basis is a QR factorization of the k vectors of a basis of a
+//   subspace of R[n], found once by Householder reflections. Every query
+//   afterwards (is v in the span, what are the B-coordinates of v, what is
+//   the projection of v onto the span) costs O(nk), while in_span and
+//   B_coord in vector_space.h reduce a new matrix each time. A vector is in
+//   the span when the part of it outside the span has at most PRECISION
+//   times its norm.
+struct prepared_basis;
+struct vector;
+struct matrix;
+
+//basis_prepare(basis, k) factors the first k vectors of basis and returns
+//   them as a prepared basis through a heap-allocated pointer that the
+//   caller must free with basis_destroy(). If k is not positive, the vectors
+//   do not have the same positive dimension, or they are not linearly
+//   independent (a vector has at most PRECISION times its norm outside the
+//   span of those before it), it outputs an error message and returns NULL.
+//requires: basis is not NULL, there are at least k pointers in basis
+//          first k pointers in basis are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct prepared_basis *basis_prepare(const struct vector * const basis[],
+                                     const int k);
+
+//basis_size(B, n, k) stores the dimension of the vectors of B in *n and
+//   their number in *k.
+//requires: B, n, k are not NULL
+//effects: modifies *n and *k
+void basis_size(const struct prepared_basis * const B, int * const n,
+                int * const k);
+
+//basis_in_span(B, v1) returns true if v1 is in the span of B. If v1 does
+//   not have the dimension of B, it outputs an error message and returns
+//   false.
+//requires: B, v1 are not NULL
+//effects: may print output
+bool basis_in_span(const struct prepared_basis * const B,
+                   const struct vector * const v1);
+
+//basis_coord(B, v1) returns the B-coordinates of v1 through a
+//   heap-allocated vector that the caller must free with vector_destroy().
+//   If v1 does not have the dimension of B or is not in its span, it outputs
+//   an error message and returns NULL.
+//requires: B, v1 are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct vector *basis_coord(const struct prepared_basis * const B,
+                           const struct vector * const v1);
+
+//basis_project(B, v1) returns the orthogonal projection of v1 onto the span
+//   of B through a heap-allocated vector that the caller must free with
+//   vector_destroy(). If v1 does not have the dimension of B, it outputs an
+//   error message and returns NULL.
+//requires: B, v1 are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct vector *basis_project(const struct prepared_basis * const B,
+                             const struct vector * const v1);
+
+//basis_coord_batch(B, V, in_span) treats each column of V as a query and
+//   returns the k x s matrix (for s columns) whose columns are their
+//   B-coordinates, through a heap-allocated pointer that the caller must
+//   free with matrix_destroy(). All columns are solved together. A column
+//   that is not in the span gets the coordinates of its projection, and if
+//   in_span is not NULL, in_span[j - 1] is set to whether column j is in the
+//   span. If V does not have n rows, it outputs an error message and returns
+//   NULL.
+//requires: B, V are not NULL
+//          in_span is NULL or has room for as many bools as V has columns
+//effects: may modify in_span
+//         may print output
+//         may allocate heap memory
+struct matrix *basis_coord_batch(const struct prepared_basis * const B,
+                                 const struct matrix * const V,
+                                 bool * const in_span);
+
+//basis_destroy(B) frees all heap memory allocated to B. Passing NULL does
+//   nothing.
+//effects: frees heap memory
+void basis_destroy(struct prepared_basis * const B);
+
+#endif
@@ -0,0 +1,483 @@
+/*/////////////////////////////////////////////////////////////////////////////
+
+                     Linear Algebra I Toolbox Benchmarks
+
+/////////////////////////////////////////////////////////////////////////////*/
+//This program times the public operations of the toolbox over a sweep of
+//   sizes and prints the results as JSON on stdout, one record per operation
+//   and size:
+//     op             name of the function being timed
+//     n              problem size (vector length, or matrix/basis dimension)
+//     iterations     number of timed calls
+//     ns_per_op      average wall time per call in nanoseconds
+//     gflops         nominal flop count per call divided by the time per call
+//     allocs_per_op  heap allocations (malloc/calloc/realloc) per call
+//     bytes_per_op   heap bytes requested per call
+//   Flop counts are nominal: they are the counts of the textbook O(n^3)
+//   algorithm for each problem (for example 2n^3/3 for a determinant), so
+//   GFLOP/s goes up as the implementation gets faster, whatever algorithm it
+//   uses.
+//Usage: benchmark [--quick] [op ...]
+//   --quick runs only the smallest size of every operation, and naming one or
+//   more operations restricts the run to them.
+//The allocation counters need the allocator to be wrapped at link time (see
+//   the benchmark target in the Makefile).
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "vector_core.h"
+#include "vector_operations.h"
+#include "matrix_core.h"
+#include "matrix_operations.h"
+#include "matrix_expr.h"
+#include "inv_and_det.h"
+#include "vector_space.h"
+#include "eigen_and_diag.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+//Allocation counting
+
+static long long alloc_count = 0;
+static long long alloc_bytes = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+  alloc_count++;
+  alloc_bytes += size;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  alloc_count++;
+  alloc_bytes += count * size;
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  alloc_count++;
+  alloc_bytes += size;
+  return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+  __real_free(ptr);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//Inputs
+
+//all inputs come from a fixed-seed generator so runs are comparable
+static unsigned long long rng_state = 88172645463325252ULL;
+
+//random_entry() returns a pseudo-random long double in [-1, 1).
+//effects: modifies rng_state
+static long double random_entry(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (long double) (rng_state >> 11) / (1ULL << 52) - 1;
+}
+
+//random_vector(n) returns a heap-allocated vector with n random entries.
+//effects: allocates heap memory
+static struct vector *random_vector(const int n) {
+  struct vector *v = vector_create();
+  for (int i = 0; i < n; i++) {
+    vector_add_elem(v, random_entry());
+  }
+  return v;
+}
+
+//random_matrix(n, symmetric) returns a heap-allocated, diagonally dominant
+//   (hence invertible) n x n matrix with random entries. If symmetric is true,
+//   the matrix is also symmetric, so its eigenvalues are real.
+//effects: allocates heap memory
+static struct matrix *random_matrix(const int n, const bool symmetric) {
+  long double *entries = malloc(n * n * sizeof(long double));
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      if (symmetric && j < i) {
+        entries[i * n + j] = entries[j * n + i];
+      } else {
+        entries[i * n + j] = random_entry();
+      }
+    }
+    entries[i * n + i] += n;
+  }
+  struct matrix *A = quick_matrix_input(entries, n, n);
+  free(entries);
+  return A;
+}
+
+//A struct bench_input holds everything one benchmark case needs.
+struct bench_input {
+  int n;
+  struct vector *v1;
+  struct vector *v2;
+  struct matrix *A;
+  struct matrix *B;
+  struct vector **basis1;
+  struct vector **basis2;
+  struct vector **list;
+  int list_len;
+};
+
+//input_create(n) returns a heap-allocated set of random inputs of size n.
+//   basis1 and basis2 hold the columns of B and A, so both are bases of R[n];
+//   list holds the columns of B with the sum of the previous two inserted
+//   after every second column, so find_basis has vectors to reject.
+//effects: allocates heap memory
+static struct bench_input *input_create(const int n) {
+  struct bench_input *in = malloc(sizeof(struct bench_input));
+  in->n = n;
+  in->v1 = random_vector(n);
+  in->v2 = random_vector(n);
+  in->A = random_matrix(n, true);
+  in->B = random_matrix(n, false);
+  in->basis1 = malloc(n * sizeof(struct vector *));
+  in->basis2 = malloc(n * sizeof(struct vector *));
+  in->list = malloc((n + n / 2) * sizeof(struct vector *));
+  in->list_len = 0;
+  for (int i = 1; i <= n; i++) {
+    in->basis1[i - 1] = matrix_dupe_col(in->B, i);
+    in->basis2[i - 1] = matrix_dupe_col(in->A, i);
+    in->list[in->list_len] = matrix_dupe_col(in->B, i);
+    in->list_len++;
+    if (i % 2 == 0) {
+      in->list[in->list_len] = vector_add(in->list[in->list_len - 1],
+                                          in->list[in->list_len - 2]);
+      in->list_len++;
+    }
+  }
+  return in;
+}
+
+//input_destroy(in) frees all heap memory allocated to in.
+//effects: frees heap memory
+static void input_destroy(struct bench_input * const in) {
+  vector_destroy(in->v1);
+  vector_destroy(in->v2);
+  matrix_destroy(in->A);
+  matrix_destroy(in->B);
+  for (int i = 0; i < in->n; i++) {
+    vector_destroy(in->basis1[i]);
+    vector_destroy(in->basis2[i]);
+  }
+  for (int i = 0; i < in->list_len; i++) {
+    vector_destroy(in->list[i]);
+  }
+  free(in->basis1);
+  free(in->basis2);
+  free(in->list);
+  free(in);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//Operations
+
+//each run_* function performs one call of the operation being timed and
+//   frees whatever it returned. Operations whose results are cached with the
+//   matrix (see matrix_cache.h) invalidate the input first so every call does
+//   the full work; the *_cached cases time the repeated query instead.
+
+static void run_vector_dot(const struct bench_input * const in) {
+  vector_dot(in->v1, in->v2);
+}
+
+static void run_matrix_mult_matrix(const struct bench_input * const in) {
+  matrix_destroy(matrix_mult_matrix(in->A, in->B));
+}
+
+static void run_matrix_add_scaled(const struct bench_input * const in) {
+  struct matrix *scaled = matrix_mult_scalar(in->B, 2);
+  matrix_destroy(matrix_add(in->A, scaled));
+  matrix_destroy(scaled);
+}
+
+static void run_matrix_expr_add_scaled(const struct bench_input * const in) {
+  struct matrix_expr *E = matrix_expr_create();
+  const struct expr_node *x = expr_add(E, expr_matrix(E, in->A),
+                                       expr_scale(E, expr_matrix(E, in->B),
+                                                  2));
+  matrix_destroy(matrix_expr_eval(E, x));
+  matrix_expr_destroy(E);
+}
+
+static void run_matrix_triple_product(const struct bench_input * const in) {
+  struct matrix *AB = matrix_mult_matrix(in->A, in->B);
+  matrix_destroy(matrix_mult_matrix(AB, in->A));
+  matrix_destroy(AB);
+}
+
+static void run_matrix_expr_triple_product(
+    const struct bench_input * const in) {
+  struct matrix_expr *E = matrix_expr_create();
+  const struct expr_node *a = expr_matrix(E, in->A);
+  const struct expr_node *x =
+    expr_mult(E, expr_mult(E, a, expr_matrix(E, in->B)), a);
+  matrix_destroy(matrix_expr_eval(E, x));
+  matrix_expr_destroy(E);
+}
+
+static void run_RREF(const struct bench_input * const in) {
+  matrix_invalidate(in->B);
+  matrix_destroy(RREF(in->B));
+}
+
+static void run_matrix_rank(const struct bench_input * const in) {
+  matrix_invalidate(in->B);
+  matrix_rank(in->B);
+}
+
+static void run_matrix_det(const struct bench_input * const in) {
+  matrix_invalidate(in->B);
+  matrix_det(in->B);
+}
+
+static void run_matrix_inverse(const struct bench_input * const in) {
+  matrix_invalidate(in->B);
+  matrix_destroy(matrix_inverse(in->B));
+}
+
+static void run_matrix_det_cached(const struct bench_input * const in) {
+  matrix_det(in->B);
+}
+
+static void run_matrix_inverse_cached(const struct bench_input * const in) {
+  matrix_destroy(matrix_inverse(in->B));
+}
+
+static void run_find_basis(const struct bench_input * const in) {
+  matrix_destroy(find_basis((const struct vector * const *) in->list,
+                            in->list_len));
+}
+
+static void run_change_of_coord_matrix(const struct bench_input * const in) {
+  matrix_destroy(
+    change_of_coord_matrix((const struct vector * const *) in->basis1,
+                           (const struct vector * const *) in->basis2, in->n));
+}
+
+static void run_eigenvalue_2x2(const struct bench_input * const in) {
+  long double lambda1, lambda2 = 0;
+  eigenvalue_2x2(in->A, &lambda1, &lambda2);
+}
+
+static void run_eigenvalue_3x3(const struct bench_input * const in) {
+  long double lambda1, lambda2, lambda3 = 0;
+  eigenvalue_3x3(in->A, &lambda1, &lambda2, &lambda3);
+}
+
+static void run_eigenvectors_2x2(const struct bench_input * const in) {
+  struct vector *v1 = NULL;
+  struct vector *v2 = NULL;
+  eigenvectors_2x2(in->A, &v1, &v2);
+  vector_destroy(v1);
+  vector_destroy(v2);
+}
+
+static void run_eigenvectors_3x3(const struct bench_input * const in) {
+  struct vector *v1 = NULL;
+  struct vector *v2 = NULL;
+  struct vector *v3 = NULL;
+  eigenvectors_3x3(in->A, &v1, &v2, &v3);
+  vector_destroy(v1);
+  vector_destroy(v2);
+  vector_destroy(v3);
+}
+
+static void run_diagonalize_2x2(const struct bench_input * const in) {
+  struct matrix *P = NULL;
+  struct matrix *D = NULL;
+  struct matrix *P_inv = NULL;
+  diagonalize_2x2(in->A, &P, &D, &P_inv);
+  matrix_destroy(P);
+  matrix_destroy(D);
+  matrix_destroy(P_inv);
+}
+
+static void run_diagonalize_3x3(const struct bench_input * const in) {
+  struct matrix *P = NULL;
+  struct matrix *D = NULL;
+  struct matrix *P_inv = NULL;
+  diagonalize_3x3(in->A, &P, &D, &P_inv);
+  matrix_destroy(P);
+  matrix_destroy(D);
+  matrix_destroy(P_inv);
+}
+
+//nominal flop counts (see the top of the file)
+
+static double flops_dot(const int n) {
+  return 2.0 * n;
+}
+
+static double flops_mult(const int n) {
+  return 2.0 * n * n * n;
+}
+
+static double flops_add_scaled(const int n) {
+  return 2.0 * n * n;
+}
+
+static double flops_triple_product(const int n) {
+  return 4.0 * n * n * n;
+}
+
+static double flops_elimination(const int n) {
+  return 2.0 * n * n * n / 3;
+}
+
+static double flops_inverse(const int n) {
+  return 2.0 * n * n * n;
+}
+
+static double flops_small(const int n) {
+  return 30.0 * n * n * n;
+}
+
+//A struct bench_case describes one operation and the sizes it is run at. A
+//   size of 0 ends the list.
+struct bench_case {
+  const char *name;
+  void (*run)(const struct bench_input * const in);
+  double (*flops)(const int n);
+  int sizes[8];
+};
+
+static const struct bench_case CASES[] = {
+  {"vector_dot", run_vector_dot, flops_dot, {16, 256, 4096, 65536, 0}},
+  {"matrix_mult_matrix", run_matrix_mult_matrix, flops_mult,
+   {4, 16, 64, 128, 0}},
+  {"matrix_add_scaled", run_matrix_add_scaled, flops_add_scaled,
+   {16, 64, 256, 0}},
+  {"matrix_expr_add_scaled", run_matrix_expr_add_scaled, flops_add_scaled,
+   {16, 64, 256, 0}},
+  {"matrix_triple_product", run_matrix_triple_product, flops_triple_product,
+   {4, 16, 64, 0}},
+  {"matrix_expr_triple_product", run_matrix_expr_triple_product,
+   flops_triple_product, {4, 16, 64, 0}},
+  {"RREF", run_RREF, flops_elimination, {4, 16, 64, 128, 0}},
+  {"matrix_rank", run_matrix_rank, flops_elimination, {4, 16, 64, 128, 0}},
+  {"matrix_det", run_matrix_det, flops_elimination,
+   {3, 5, 7, 64, 128, 256, 0}},
+  {"matrix_inverse", run_matrix_inverse, flops_inverse,
+   {3, 5, 7, 64, 128, 256, 0}},
+  {"matrix_det_cached", run_matrix_det_cached, flops_elimination,
+   {3, 16, 64, 0}},
+  {"matrix_inverse_cached", run_matrix_inverse_cached, flops_inverse,
+   {3, 16, 64, 0}},
+  {"find_basis", run_find_basis, flops_elimination, {4, 8, 16, 32, 0}},
+  {"change_of_coord_matrix", run_change_of_coord_matrix, flops_elimination,
+   {2, 4, 8, 16, 0}},
+  {"eigenvalue_2x2", run_eigenvalue_2x2, flops_small, {2, 0}},
+  {"eigenvalue_3x3", run_eigenvalue_3x3, flops_small, {3, 0}},
+  {"eigenvectors_2x2", run_eigenvectors_2x2, flops_small, {2, 0}},
+  {"eigenvectors_3x3", run_eigenvectors_3x3, flops_small, {3, 0}},
+  {"diagonalize_2x2", run_diagonalize_2x2, flops_small, {2, 0}},
+  {"diagonalize_3x3", run_diagonalize_3x3, flops_small, {3, 0}},
+};
+
+static const int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//Driver
+
+//every measurement runs for at least this long, and at least MIN_ITERATIONS
+//   calls
+static const double MIN_SECONDS = 0.2;
+static const long long MIN_ITERATIONS = 3;
+
+//now_seconds() returns a monotonic time stamp in seconds.
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//bench_one(c, n, first) times c at size n and prints its JSON record,
+//   preceded by a comma unless first is true.
+//effects: prints output
+static void bench_one(const struct bench_case * const c, const int n,
+                      const bool first) {
+  struct bench_input *in = input_create(n);
+  //one untimed call so lazily built state does not count against the first
+  //   measurement
+  c->run(in);
+  long long iterations = 0;
+  const long long count_before = alloc_count;
+  const long long bytes_before = alloc_bytes;
+  const double start = now_seconds();
+  double elapsed = 0;
+  while (iterations < MIN_ITERATIONS || elapsed < MIN_SECONDS) {
+    c->run(in);
+    iterations++;
+    elapsed = now_seconds() - start;
+  }
+  const double allocs = (double) (alloc_count - count_before) / iterations;
+  const double bytes = (double) (alloc_bytes - bytes_before) / iterations;
+  const double seconds_per_op = elapsed / iterations;
+  input_destroy(in);
+  printf("%s\n    {\"op\": \"%s\", \"n\": %d, \"iterations\": %lld, ",
+         first ? "" : ",", c->name, n, iterations);
+  printf("\"ns_per_op\": %.1f, \"gflops\": %.6f, ", seconds_per_op * 1e9,
+         c->flops(n) / seconds_per_op * 1e-9);
+  printf("\"allocs_per_op\": %.1f, \"bytes_per_op\": %.1f}", allocs, bytes);
+  fflush(stdout);
+}
+
+//selected(name, argc, argv) returns true if the operation name should run
+//   given the command line arguments.
+static bool selected(const char * const name, const int argc,
+                     char * const argv[]) {
+  bool any_named = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      continue;
+    }
+    any_named = true;
+    if (strcmp(argv[i], name) == 0) {
+      return true;
+    }
+  }
+  return !any_named;
+}
+
+int main(int argc, char *argv[]) {
+  bool quick = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      quick = true;
+    }
+  }
+  printf("{\n  \"benchmark\": \"linalg\",\n  \"results\": [");
+  bool first = true;
+  for (int i = 0; i < CASE_COUNT; i++) {
+    if (!selected(CASES[i].name, argc, argv)) {
+      continue;
+    }
+    for (int j = 0; CASES[i].sizes[j] > 0; j++) {
+      bench_one(&CASES[i], CASES[i].sizes[j], first);
+      first = false;
+      if (quick) {
+        break;
+      }
+    }
+  }
+  printf("\n  ]\n}\n");
+  return 0;
+}
@@ -0,0 +1,675 @@
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "disk.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+static const char MAGIC[8] = {'L', 'I', 'N', 'A', 'L', 'G', 'D', 'M'};
+
+//bytes before the first entry
+static const off_t HEADER = 16;
+
+//widest tile, beyond which a tile no longer fits in cache
+static const int MAX_TILE = 512;
+
+struct disk_matrix {
+  int fd;
+  int m;
+  int n;
+};
+
+
+//where(D, i, j) returns the position in the file of D of the entry in row i
+//   and column j, counted from 0.
+//requires: D is not NULL
+static off_t where(const struct disk_matrix * const D, const int i,
+                   const int j) {
+  return HEADER + ((off_t) i * D->n + j) * (off_t) sizeof(long double);
+}
+
+//move(fd, buffer, bytes, offset, write) writes the bytes of buffer to fd at
+//   offset if write is true, and reads them from there otherwise. It returns
+//   true if all bytes were moved.
+//requires: buffer is not NULL
+//effects: modifies buffer or the file of fd
+static bool move(const int fd, void * const buffer, size_t bytes,
+                 off_t offset, const bool write) {
+  char *next = buffer;
+  while (bytes > 0) {
+    const ssize_t done = write ? pwrite(fd, next, bytes, offset)
+                               : pread(fd, next, bytes, offset);
+    if ((done < 0) && (errno == EINTR)) {
+      continue;
+    }
+    if (done <= 0) {
+      return false;
+    }
+    next += done;
+    bytes -= done;
+    offset += done;
+  }
+  return true;
+}
+
+
+//A struct tile is a transfer of the rows x cols block of D whose top left
+//   entry is in row row and column col (counted from 0) to or from buffer,
+//   whose rows follow each other. It may run on a thread of its own.
+struct tile {
+  const struct disk_matrix *D;
+  long double *buffer;
+  int row;
+  int col;
+  int rows;
+  int cols;
+  bool write;
+  bool ok;
+  bool started;
+  pthread_t thread;
+};
+
+//transfer(tile) moves the block of tile a row at a time.
+//requires: tile is a struct tile pointer
+//effects: modifies the buffer or the file of tile
+static void *transfer(void *tile) {
+  struct tile * const t = tile;
+  t->ok = true;
+  for (int r = 0; (r < t->rows) && t->ok; r++) {
+    t->ok = move(t->D->fd, t->buffer + (size_t) r * t->cols,
+                 t->cols * sizeof(long double),
+                 where(t->D, t->row + r, t->col), t->write);
+  }
+  return NULL;
+}
+
+//tile_set(t, D, buffer, row, col, rows, cols, write) describes a transfer.
+//requires: t, D, buffer are not NULL, t is not running
+//effects: modifies *t
+static void tile_set(struct tile * const t, const struct disk_matrix * const D,
+                     long double * const buffer, const int row, const int col,
+                     const int rows, const int cols, const bool write) {
+  t->D = D;
+  t->buffer = buffer;
+  t->row = row;
+  t->col = col;
+  t->rows = rows;
+  t->cols = cols;
+  t->write = write;
+}
+
+//tile_start(t) starts the transfer of t on a thread of its own, or runs it
+//   on the calling thread if no thread can be started.
+//requires: t is not NULL and not running
+//effects: modifies *t
+static void tile_start(struct tile * const t) {
+  t->started = pthread_create(&t->thread, NULL, transfer, t) == 0;
+  if (!t->started) {
+    transfer(t);
+  }
+}
+
+//tile_finish(t) waits for the transfer of t and returns true if it
+//   succeeded (or t was never started).
+//requires: t is not NULL
+//effects: modifies *t
+static bool tile_finish(struct tile * const t) {
+  if (t->started) {
+    pthread_join(t->thread, NULL);
+    t->started = false;
+  }
+  return t->ok;
+}
+
+//tile_idle(t) marks t as not running.
+//requires: t is not NULL
+//effects: modifies *t
+static void tile_idle(struct tile * const t) {
+  t->started = false;
+  t->ok = true;
+}
+
+//accumulate(c, a, a_stride, b, rows, inner, cols, alpha) adds alpha a b to
+//   c, where a is rows x inner with rows a_stride apart, b is inner x cols
+//   and c is rows x cols, both by rows.
+//requires: a, b, c are not NULL
+//effects: modifies c
+static void accumulate(long double * const c, const long double * const a,
+                       const int a_stride, const long double * const b,
+                       const int rows, const int inner, const int cols,
+                       const long double alpha) {
+  for (int i = 0; i < rows; i++) {
+    long double *ci = c + (size_t) i * cols;
+    for (int k = 0; k < inner; k++) {
+      const long double aik = alpha * a[(size_t) i * a_stride + k];
+      const long double *bk = b + (size_t) k * cols;
+      for (int j = 0; j < cols; j++) {
+        ci[j] += aik * bk[j];
+      }
+    }
+  }
+}
+
+
+//disk_open(path, flags, function) opens path with flags, or reports on
+//   behalf of function and returns -1.
+//requires: path, function are not NULL
+//effects: may print output
+static int disk_open(const char * const path, const int flags,
+                     const char * const function) {
+  const int fd = open(path, flags, 0644);
+  if (fd < 0) {
+    linalg_report(LINALG_ERR_IO, function, "Could not open %s: %s.", path,
+                  strerror(errno));
+  }
+  return fd;
+}
+
+//make(path, m, n, function) is disk_matrix_create on behalf of function.
+//requires: path, function are not NULL
+//effects: may print output
+//         may allocate heap memory
+//         writes the file path
+static struct disk_matrix *make(const char * const path, const int m,
+                                const int n, const char * const function) {
+  if ((m < 1) || (n < 1)) {
+    linalg_report(LINALG_ERR_EMPTY, function,
+                  "Invalid input. m and n must be greater than 0.");
+    return NULL;
+  }
+  const int fd = disk_open(path, O_RDWR | O_CREAT | O_TRUNC, function);
+  if (fd < 0) {
+    return NULL;
+  }
+  char header[16];
+  const int32_t size[2] = {m, n};
+  memcpy(header, MAGIC, sizeof(MAGIC));
+  memcpy(header + sizeof(MAGIC), size, sizeof(size));
+  struct disk_matrix *D = malloc(sizeof(struct disk_matrix));
+  D->fd = fd;
+  D->m = m;
+  D->n = n;
+  if (!move(fd, header, sizeof(header), 0, true) ||
+      (ftruncate(fd, where(D, m, 0)) != 0)) {
+    linalg_report(LINALG_ERR_IO, function, "Could not write %s: %s.", path,
+                  strerror(errno));
+    disk_matrix_destroy(D);
+    return NULL;
+  }
+  return D;
+}
+
+struct disk_matrix *disk_matrix_create(const char * const path, const int m,
+                                       const int n) {
+  assert(path);
+  return make(path, m, n, __func__);
+}
+
+struct disk_matrix *disk_matrix_open(const char * const path) {
+  assert(path);
+  const int fd = disk_open(path, O_RDWR, __func__);
+  if (fd < 0) {
+    return NULL;
+  }
+  char header[16];
+  int32_t size[2] = {0, 0};
+  struct stat file;
+  const bool read = move(fd, header, sizeof(header), 0, false);
+  if (read) {
+    memcpy(size, header + sizeof(MAGIC), sizeof(size));
+  }
+  if (!read || (memcmp(header, MAGIC, sizeof(MAGIC)) != 0) ||
+      (size[0] < 1) || (size[1] < 1) || (fstat(fd, &file) != 0) ||
+      (file.st_size < HEADER + (off_t) size[0] * size[1] *
+                               (off_t) sizeof(long double))) {
+    linalg_report(LINALG_ERR_IO, __func__,
+                  "%s does not hold a matrix.", path);
+    close(fd);
+    return NULL;
+  }
+  struct disk_matrix *D = malloc(sizeof(struct disk_matrix));
+  D->fd = fd;
+  D->m = size[0];
+  D->n = size[1];
+  return D;
+}
+
+struct disk_matrix *disk_matrix_store(const char * const path,
+                                      const struct matrix * const A) {
+  assert(path);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  struct disk_matrix *D = make(path, m, n, __func__);
+  if (!D) {
+    return NULL;
+  }
+  for (int i = 0; i < m; i++) {
+    if (!move(D->fd, (void *) matrix_row_cdata(A, i + 1),
+              n * sizeof(long double), where(D, i, 0), true)) {
+      linalg_report(LINALG_ERR_IO, __func__, "Could not write %s: %s.",
+                    path, strerror(errno));
+      disk_matrix_destroy(D);
+      return NULL;
+    }
+  }
+  return D;
+}
+
+struct matrix *disk_matrix_load(const struct disk_matrix * const D) {
+  assert(D);
+  struct matrix *A = matrix_create_zero(D->m, D->n);
+  for (int i = 0; i < D->m; i++) {
+    if (!move(D->fd, matrix_row_data(A, i + 1), D->n * sizeof(long double),
+              where(D, i, 0), false)) {
+      linalg_report(LINALG_ERR_IO, __func__, "Could not read row %d.", i + 1);
+      matrix_destroy(A);
+      return NULL;
+    }
+  }
+  return A;
+}
+
+void disk_matrix_size(const struct disk_matrix * const D, int * const m,
+                      int * const n) {
+  assert(D);
+  assert(m);
+  assert(n);
+  *m = D->m;
+  *n = D->n;
+}
+
+
+//A product tile of C is found from tiles of A and B in steps: step s adds
+//   tile (i, k) of A times tile (k, j) of B to tile (i, j) of C, where k runs
+//   fastest, then j, then i.
+struct product {
+  const struct disk_matrix *A;
+  const struct disk_matrix *B;
+  int width;
+  //number of tiles along m, n and p
+  int across;
+  int down;
+  int inner;
+};
+
+//product_load(P, s, a, b, tile_a, tile_b) sets tile_a and tile_b to read the
+//   tiles of step s into a and b.
+//requires: P, a, b, tile_a, tile_b are not NULL
+//effects: modifies *tile_a and *tile_b
+static void product_load(const struct product * const P, const long long s,
+                         long double * const a, long double * const b,
+                         struct tile * const tile_a,
+                         struct tile * const tile_b) {
+  const int w = P->width;
+  const int k = s % P->inner;
+  const int j = s / P->inner % P->across;
+  const int i = s / P->inner / P->across;
+  const int rows = P->A->m - i * w < w ? P->A->m - i * w : w;
+  const int inner = P->A->n - k * w < w ? P->A->n - k * w : w;
+  const int cols = P->B->n - j * w < w ? P->B->n - j * w : w;
+  tile_set(tile_a, P->A, a, i * w, k * w, rows, inner, false);
+  tile_set(tile_b, P->B, b, k * w, j * w, inner, cols, false);
+}
+
+enum linalg_status disk_matrix_mult(const struct disk_matrix * const A,
+                                    const struct disk_matrix * const B,
+                                    struct disk_matrix * const C,
+                                    const size_t budget) {
+  INSTRUMENT_SCOPE(disk_matrix_mult);
+  assert(A);
+  assert(B);
+  assert(C);
+  assert((C != A) && (C != B));
+  INSTRUMENT_DIMS(A->m, B->n);
+  if ((A->n != B->m) || (C->m != A->m) || (C->n != B->n)) {
+    return linalg_report(LINALG_ERR_DIMENSION, __func__,
+                         "Invalid input. A is %d x %d, so B must be %d x n "
+                         "and C %d x n.", A->m, A->n, A->n, A->m);
+  }
+  //two tiles of A, two of B (one in use, one being read) and two of C (one
+  //   being summed, one being written)
+  int w = (int) sqrtl(budget / (6.0L * sizeof(long double)));
+  w = w < MAX_TILE ? w : MAX_TILE;
+  if (w < 1) {
+    return linalg_report(LINALG_ERR_INVALID, __func__,
+                         "Invalid input. The budget must be at least %d "
+                         "bytes.", (int) (6 * sizeof(long double)));
+  }
+  struct product P = {A, B, w, (B->n + w - 1) / w, (A->m + w - 1) / w,
+                      (A->n + w - 1) / w};
+  const size_t bytes = (size_t) 6 * w * w * sizeof(long double);
+  long double *buffer = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  long double *a[2] = {buffer, buffer + (size_t) w * w};
+  long double *b[2] = {a[1] + (size_t) w * w, a[1] + (size_t) 2 * w * w};
+  long double *c[2] = {b[1] + (size_t) w * w, b[1] + (size_t) 2 * w * w};
+  struct tile in[2][2];
+  struct tile out[2];
+  for (int t = 0; t < 2; t++) {
+    tile_idle(&in[t][0]);
+    tile_idle(&in[t][1]);
+    tile_idle(&out[t]);
+  }
+  const long long steps = (long long) P.down * P.across * P.inner;
+  product_load(&P, 0, a[0], b[0], &in[0][0], &in[0][1]);
+  tile_start(&in[0][0]);
+  tile_start(&in[0][1]);
+  bool ok = true;
+  int sum = 0;
+  for (long long s = 0; (s < steps) && ok; s++) {
+    const int now = s & 1;
+    ok = tile_finish(&in[now][0]) && tile_finish(&in[now][1]);
+    if (!ok) {
+      break;
+    }
+    //the next tiles are read while these are multiplied
+    if (s + 1 < steps) {
+      product_load(&P, s + 1, a[!now], b[!now], &in[!now][0], &in[!now][1]);
+      tile_start(&in[!now][0]);
+      tile_start(&in[!now][1]);
+    }
+    const struct tile *ta = &in[now][0];
+    const struct tile *tb = &in[now][1];
+    if (s % P.inner == 0) {
+      ok = tile_finish(&out[sum]);
+      memset(c[sum], 0, (size_t) ta->rows * tb->cols * sizeof(long double));
+    }
+    accumulate(c[sum], a[now], ta->cols, b[now], ta->rows, ta->cols,
+               tb->cols, 1);
+    INSTRUMENT_FLOPS(2LL * ta->rows * ta->cols * tb->cols);
+    if (s % P.inner == P.inner - 1) {
+      tile_set(&out[sum], C, c[sum], ta->row, tb->col, ta->rows, tb->cols,
+               true);
+      tile_start(&out[sum]);
+      sum = !sum;
+    }
+  }
+  for (int t = 0; t < 2; t++) {
+    tile_finish(&in[t][0]);
+    tile_finish(&in[t][1]);
+    ok = tile_finish(&out[t]) && ok;
+  }
+  INSTRUMENT_FREE(bytes);
+  free(buffer);
+  if (!ok) {
+    return linalg_report(LINALG_ERR_IO, __func__,
+                         "Could not read or write a tile.");
+  }
+  return LINALG_OK;
+}
+
+
+//panel_factor(panel, rows, w, pivot) factors the rows x w panel (by rows)
+//   in place with partial pivoting, and stores in pivot[j] the row swapped
+//   with row j at step j.
+//requires: panel, pivot are not NULL, pivot has room for w ints
+//effects: modifies panel and pivot
+static void panel_factor(long double * const panel, const int rows,
+                         const int w, int * const pivot) {
+  for (int j = 0; j < w; j++) {
+    int best = j;
+    for (int i = j + 1; i < rows; i++) {
+      if (fabsl(panel[(size_t) i * w + j]) >
+          fabsl(panel[(size_t) best * w + j])) {
+        best = i;
+      }
+    }
+    pivot[j] = best;
+    if (best != j) {
+      for (int c = 0; c < w; c++) {
+        const long double temp = panel[(size_t) j * w + c];
+        panel[(size_t) j * w + c] = panel[(size_t) best * w + c];
+        panel[(size_t) best * w + c] = temp;
+      }
+    }
+    const long double p = panel[(size_t) j * w + j];
+    if (p == 0) {
+      continue;
+    }
+    for (int i = j + 1; i < rows; i++) {
+      long double *row = panel + (size_t) i * w;
+      row[j] /= p;
+      for (int c = j + 1; c < w; c++) {
+        row[c] -= row[j] * panel[(size_t) j * w + c];
+      }
+    }
+  }
+}
+
+enum linalg_status disk_matrix_lu(struct disk_matrix * const A,
+                                  int perm[], const size_t budget) {
+  INSTRUMENT_SCOPE(disk_matrix_lu);
+  assert(A);
+  assert(perm);
+  const int n = A->n;
+  INSTRUMENT_DIMS(A->m, n);
+  if (A->m != n) {
+    return linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                         "Invalid input. A must be square.");
+  }
+  //a panel of n x w, the w x w tile of U beside the diagonal block, three
+  //   tiles below it (one being updated, one read, one written) and two rows
+  const long double units = (long double) budget / sizeof(long double);
+  const long double n2 = (long double) n * n;
+  const long double root = n2 - 16.0L * (2.0L * n - units);
+  int w = root > 0 ? (int) fminl((sqrtl(root) - n) / 8, MAX_TILE) : 0;
+  w = w < MAX_TILE ? w : MAX_TILE;
+  w = w < n ? w : n;
+  while ((w > 0) &&
+         ((long double) n * w + 4.0L * w * w + 2.0L * n > units)) {
+    w--;
+  }
+  if (w < 1) {
+    return linalg_report(LINALG_ERR_INVALID, __func__,
+                         "Invalid input. The budget must be at least %lld "
+                         "bytes.",
+                         (long long) (3 * n + 4) *
+                         (long long) sizeof(long double));
+  }
+  const size_t bytes = ((size_t) n * w + (size_t) 4 * w * w + 2 * n) *
+                       sizeof(long double) + w * sizeof(int);
+  long double *panel = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  long double *u = panel + (size_t) n * w;
+  long double *t[3] = {u + (size_t) w * w, u + (size_t) 2 * w * w,
+                       u + (size_t) 3 * w * w};
+  long double *row = t[2] + (size_t) w * w;
+  int *pivot = (int *) (row + 2 * n);
+  struct tile tiles[3];
+  for (int s = 0; s < 3; s++) {
+    tile_idle(&tiles[s]);
+  }
+  for (int i = 0; i < n; i++) {
+    perm[i] = i + 1;
+  }
+  bool ok = true;
+  for (int k = 0; (k < n) && ok; k += w) {
+    const int kw = n - k < w ? n - k : w;
+    const int rows = n - k;
+    struct tile sync;
+    tile_set(&sync, A, panel, k, k, rows, kw, false);
+    transfer(&sync);
+    ok = sync.ok;
+    if (!ok) {
+      break;
+    }
+    panel_factor(panel, rows, kw, pivot);
+    INSTRUMENT_FLOPS(2LL * rows * kw * kw);
+    sync.write = true;
+    transfer(&sync);
+    ok = sync.ok;
+    //the swaps of the panel are applied to the columns beside it
+    for (int j = 0; (j < kw) && ok; j++) {
+      const int r1 = k + j;
+      const int r2 = k + pivot[j];
+      if (r1 == r2) {
+        continue;
+      }
+      const int temp = perm[r1];
+      perm[r1] = perm[r2];
+      perm[r2] = temp;
+      ok = move(A->fd, row, n * sizeof(long double), where(A, r1, 0), false) &&
+           move(A->fd, row + n, n * sizeof(long double), where(A, r2, 0),
+                false);
+      for (int c = 0; (c < n) && ok; c++) {
+        if ((c < k) || (c >= k + kw)) {
+          const long double swap = row[c];
+          row[c] = row[n + c];
+          row[n + c] = swap;
+        }
+      }
+      ok = ok &&
+           move(A->fd, row, n * sizeof(long double), where(A, r1, 0), true) &&
+           move(A->fd, row + n, n * sizeof(long double), where(A, r2, 0),
+                true);
+    }
+    if (!ok || (k + kw == n)) {
+      continue;
+    }
+    //the rest is updated by tiles (i, j) below and right of the panel, i
+    //   running fastest; tile s + 1 is read while tile s is updated and
+    //   tile s - 1 written
+    const int first = k + kw;
+    const int down = (n - first + w - 1) / w;
+    const int across = (n - first + w - 1) / w;
+    const long long steps = (long long) down * across;
+    tile_set(&tiles[0], A, t[0], first, first, n - first < w ? n - first : w,
+             n - first < w ? n - first : w, false);
+    tile_start(&tiles[0]);
+    for (long long s = 0; (s < steps) && ok; s++) {
+      const int now = s % 3;
+      const int next = (s + 1) % 3;
+      const int i = s % down;
+      const int j = s / down;
+      const int c0 = first + j * w;
+      const int cw = n - c0 < w ? n - c0 : w;
+      ok = tile_finish(&tiles[now]);
+      if (!ok) {
+        break;
+      }
+      if (s + 1 < steps) {
+        const int r1 = first + (int) ((s + 1) % down) * w;
+        const int c1 = first + (int) ((s + 1) / down) * w;
+        ok = tile_finish(&tiles[next]);
+        tile_set(&tiles[next], A, t[next], r1, c1, n - r1 < w ? n - r1 : w,
+                 n - c1 < w ? n - c1 : w, false);
+        tile_start(&tiles[next]);
+      }
+      if (i == 0) {
+        //U12 = L11^-1 A12 for the columns of this tile
+        tile_set(&sync, A, u, k, c0, kw, cw, false);
+        transfer(&sync);
+        for (int r = 1; (r < kw) && sync.ok; r++) {
+          accumulate(u + (size_t) r * cw, panel + (size_t) r * kw, kw, u, 1,
+                     r, cw, -1);
+        }
+        sync.write = true;
+        if (sync.ok) {
+          transfer(&sync);
+        }
+        ok = ok && sync.ok;
+        INSTRUMENT_FLOPS((long long) kw * kw * cw);
+      }
+      struct tile * const current = &tiles[now];
+      //A22 = A22 - L21 U12
+      accumulate(t[now], panel + (size_t) (current->row - k) * kw, kw, u,
+                 current->rows, kw, cw, -1);
+      INSTRUMENT_FLOPS(2LL * current->rows * kw * cw);
+      current->write = true;
+      tile_start(current);
+    }
+    for (int s = 0; s < 3; s++) {
+      ok = tile_finish(&tiles[s]) && ok;
+      tile_idle(&tiles[s]);
+    }
+  }
+  for (int s = 0; s < 3; s++) {
+    tile_finish(&tiles[s]);
+  }
+  INSTRUMENT_FREE(bytes);
+  free(panel);
+  if (!ok) {
+    return linalg_report(LINALG_ERR_IO, __func__,
+                         "Could not read or write a tile.");
+  }
+  return LINALG_OK;
+}
+
+struct vector *disk_matrix_lu_solve(const struct disk_matrix * const LU,
+                                    const int perm[],
+                                    const struct vector * const b) {
+  INSTRUMENT_SCOPE(disk_matrix_lu_solve);
+  assert(LU);
+  assert(perm);
+  assert(b);
+  const int n = LU->n;
+  INSTRUMENT_DIMS(n, n);
+  if (vector_dim(b) != n) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. b must be in R[%d].", n);
+    return NULL;
+  }
+  const long double *rhs = vector_cdata(b);
+  struct vector *x = vector_create_zero(n);
+  long double *y = vector_data(x);
+  long double *row = malloc(n * sizeof(long double));
+  INSTRUMENT_ALLOC(n * sizeof(long double));
+  bool ok = true;
+  //L y = P b reads the part of each row left of the diagonal
+  for (int i = 0; (i < n) && ok; i++) {
+    ok = move(LU->fd, row, i * sizeof(long double), where(LU, i, 0), false);
+    long double sum = rhs[perm[i] - 1];
+    for (int j = 0; j < i; j++) {
+      sum -= row[j] * y[j];
+    }
+    y[i] = sum;
+  }
+  //U x = y reads the rest, from the last row up
+  bool singular = false;
+  for (int i = n - 1; (i >= 0) && ok && !singular; i--) {
+    ok = move(LU->fd, row + i, (n - i) * sizeof(long double),
+              where(LU, i, i), false);
+    long double sum = y[i];
+    for (int j = i + 1; j < n; j++) {
+      sum -= row[j] * y[j];
+    }
+    singular = row[i] == 0;
+    y[i] = singular ? 0 : sum / row[i];
+  }
+  INSTRUMENT_FLOPS(2LL * n * n);
+  INSTRUMENT_FREE(n * sizeof(long double));
+  free(row);
+  if (!ok || singular) {
+    vector_destroy(x);
+    if (!ok) {
+      linalg_report(LINALG_ERR_IO, __func__, "Could not read a row.");
+    } else {
+      linalg_report(LINALG_ERR_SINGULAR, __func__,
+                    "Invalid input. Matrix is not invertible.");
+    }
+    return NULL;
+  }
+  return x;
+}
+
+void disk_matrix_destroy(struct disk_matrix * const D) {
+  if (D) {
+    close(D->fd);
+    free(D);
+  }
+}
@@ -0,0 +1,122 @@
+#ifndef LINALG_DISK_H
+#define LINALG_DISK_H
+
+#include <stddef.h>
+#include "status.h"
+
+//A struct disk_matrix is an m x n matrix kept in a file instead of in
+//   memory: a 16 byte header ("LINALGDM", then m and n as 32 bit integers)
+//   followed by the entries as long doubles, row after row. The file is only
+//   readable on machines with the same long double format. The functions
+//   below read and write such a matrix one tile at a time, and never hold
+//   more than the memory budget they are given. While one tile is being
+//   computed on, a second thread reads the next tile and writes back the
+//   previous one, so I/O overlaps computation and throughput stays close to
+//   that of matrix_mult_matrix as long as the disk delivers about 16 bytes
+//   per tile width of floating point operations.
+
+struct disk_matrix;
+struct matrix;
+struct vector;
+
+//disk_matrix_create(path, m, n) creates (or replaces) the file path with an
+//   m x n zero matrix and returns it open through a heap-allocated pointer
+//   that the caller must free with disk_matrix_destroy(). If m or n is not
+//   positive or the file cannot be written, it outputs an error message and
+//   returns NULL.
+//requires: path is not NULL
+//effects: may print output
+//         may allocate heap memory
+//         writes the file path
+struct disk_matrix *disk_matrix_create(const char * const path, const int m,
+                                       const int n);
+
+//disk_matrix_open(path) opens the matrix stored in the file path for
+//   reading and writing and returns it through a heap-allocated pointer that
+//   the caller must free with disk_matrix_destroy(). If the file cannot be
+//   opened or does not hold a matrix, it outputs an error message and
+//   returns NULL.
+//requires: path is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct disk_matrix *disk_matrix_open(const char * const path);
+
+//disk_matrix_store(path, A) is like disk_matrix_create, but the file holds
+//   the entries of A. If A is empty, it outputs an error message and returns
+//   NULL.
+//requires: path, A are not NULL
+//effects: may print output
+//         may allocate heap memory
+//         writes the file path
+struct disk_matrix *disk_matrix_store(const char * const path,
+                                      const struct matrix * const A);
+
+//disk_matrix_load(D) returns the matrix stored in D through a heap-allocated
+//   pointer that the caller must free with matrix_destroy(). If the file
+//   cannot be read, it outputs an error message and returns NULL.
+//requires: D is not NULL, the matrix fits in memory
+//effects: may print output
+//         may allocate heap memory
+struct matrix *disk_matrix_load(const struct disk_matrix * const D);
+
+//disk_matrix_size(D, m, n) stores the number of rows of D in *m and of
+//   columns in *n.
+//requires: D, m, n are not NULL
+//effects: modifies *m and *n
+void disk_matrix_size(const struct disk_matrix * const D, int * const m,
+                      int * const n);
+
+//disk_matrix_mult(A, B, C, budget) stores the product AB in C, reading A and
+//   B in square tiles whose width is chosen so that six of them fit in
+//   budget bytes. It returns LINALG_OK, or reports LINALG_ERR_DIMENSION if A
+//   is m x p, B is not p x n or C is not m x n, LINALG_ERR_INVALID if budget
+//   cannot hold six 1 x 1 tiles, or LINALG_ERR_IO if a file cannot be read or
+//   written, in which case C is left partly written.
+//requires: A, B, C are not NULL, C is not A or B and not in the same file
+//effects: may print output
+//         allocates and frees heap memory
+//         writes the file of C
+enum linalg_status disk_matrix_mult(const struct disk_matrix * const A,
+                                    const struct disk_matrix * const B,
+                                    struct disk_matrix * const C,
+                                    const size_t budget);
+
+//disk_matrix_lu(A, perm, budget) replaces the n x n matrix A by its LU
+//   factorization with partial pivoting, PA = LU, by a right-looking blocked
+//   algorithm: the entries below the diagonal are those of L (whose diagonal
+//   is 1) and the rest those of U, and row i of PA is row perm[i - 1] of A.
+//   Each step factors a panel of all the rows below it in memory and then
+//   updates the rest of A tile by tile. The width w of the panels and tiles
+//   is the largest (up to 512) for which a panel of n x w, four w x w tiles
+//   and two rows fit in budget bytes. A singular A is factored too, with a 0
+//   on the diagonal of U. It returns LINALG_OK, or reports
+//   LINALG_ERR_NOT_SQUARE if A is not square, LINALG_ERR_INVALID if budget
+//   cannot hold a panel of width 1, or LINALG_ERR_IO if the file cannot be
+//   read or written, in which case A is left partly factored.
+//requires: A, perm are not NULL, perm has room for n ints
+//effects: modifies perm
+//         may print output
+//         allocates and frees heap memory
+//         writes the file of A
+enum linalg_status disk_matrix_lu(struct disk_matrix * const A,
+                                  int perm[], const size_t budget);
+
+//disk_matrix_lu_solve(LU, perm, b) returns the solution x of Ax = b, where LU
+//   and perm hold the factorization of A found by disk_matrix_lu, through a
+//   heap-allocated vector that the caller must free with vector_destroy().
+//   It reads LU twice, a row at a time. If b is not in R[n], U has a 0 on
+//   its diagonal or the file cannot be read, it outputs an error message and
+//   returns NULL.
+//requires: LU, perm, b are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct vector *disk_matrix_lu_solve(const struct disk_matrix * const LU,
+                                    const int perm[],
+                                    const struct vector * const b);
+
+//disk_matrix_destroy(D) closes the file of D, which is kept, and frees all
+//   heap memory allocated to D. Passing NULL does nothing.
+//effects: frees heap memory
+void disk_matrix_destroy(struct disk_matrix * const D);
+
+#endif
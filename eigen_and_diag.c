@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <math.h>
 #include "eigen_and_diag.h"
@@ -7,6 +8,9 @@
 #include "matrix_core.h"
 #include "vector_core.h"
 #include "inv_and_det.h"
+#include "structure.h"
+#include "instrument.h"
+#include "status.h"
 #include "settings.h"
 
 
@@ -14,19 +18,23 @@
 
 struct matrix *B_matrix(const struct vector * const B[], 
                         const struct matrix * const L) {
+  INSTRUMENT_SCOPE(B_matrix);
   assert(L);
   int m, n = -1;
   matrix_size(L, &m, &n);
+  INSTRUMENT_DIMS(m, n);
   for (int i = 0; i < n; i++) {
     assert(B[i]);
     if (vector_dim(B[i]) != n) {
-      printf("Invalid input. Height of vectors in B must be the same as the");
-      printf("matrix L.\n");
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "Invalid input. Height of vectors in B must be the same "
+                    "as the matrix L.");
       return NULL;
     }
   }
   if ((m != n) || (m < 1)) {
-    printf("Invalid input. [L] must be an n x n matrix where n > 0.\n");
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. [L] must be an n x n matrix where n > 0.");
     return NULL;
   } else {
     struct matrix *temp1 = matrix_create();
@@ -34,37 +42,57 @@ struct matrix *B_matrix(const struct vector * const B[],
       matrix_add_col(temp1, B[i]);
     }
     struct matrix *temp1_inv = matrix_inverse(temp1);
-    struct matrix *temp2 = matrix_mult_matrix(L, temp1);
-    struct matrix *Bmatrix = matrix_mult_matrix(temp1_inv, temp2);
+    if (!temp1_inv) {
+      matrix_destroy(temp1);
+      return NULL;
+    }
+    //[B]^-1 [L] [B], with the second product written over the first
+    struct matrix *Bmatrix = matrix_mult_matrix(temp1_inv, L);
+    Bmatrix = matrix_mult_matrix_consume(Bmatrix, temp1);
     matrix_destroy(temp1);
     matrix_destroy(temp1_inv);
-    matrix_destroy(temp2);
     return Bmatrix;
   }
   return NULL;
 }
 
 
-void eigenvalue_2x2(const struct matrix * const A, long double * const lambda1,
-                    long double * const lambda2) {
+//roots_2x2(A, lambda1, lambda2, function) is eigenvalue_2x2, reporting
+//   errors as function.
+//requires: A, lambda1, lambda2, function are not NULL
+//effects: modifies *lambda1 and *lambda2
+//         may print message
+static void roots_2x2(const struct matrix * const A,
+                      long double * const lambda1, long double * const lambda2,
+                      const char * const function) {
   assert(A);
   int m, n = 0;
   matrix_size(A, &m, &n);
   if (m != 2 || n != 2) {
-    printf("Invalid input. The matrix is not 2 x 2.\n");
+    linalg_report(LINALG_ERR_DIMENSION, function,
+                  "Invalid input. The matrix is not 2 x 2.");
     *lambda1 = INT_MIN;
     *lambda2 = INT_MIN;
     return;
   } else {
-    const long double a = matrix_elem(A, 1, 1);
-    const long double b = matrix_elem(A, 1, 2);
-    const long double c = matrix_elem(A, 2, 1);
-    const long double d = matrix_elem(A, 2, 2);
+    const long double a = matrix_elem_unchecked(A, 1, 1);
+    const long double b = matrix_elem_unchecked(A, 1, 2);
+    const long double c = matrix_elem_unchecked(A, 2, 1);
+    const long double d = matrix_elem_unchecked(A, 2, 2);
+    if (matrix_structure(A) &
+        (MATRIX_UPPER_TRIANGULAR | MATRIX_LOWER_TRIANGULAR)) {
+      //the eigenvalues of a triangular matrix are its diagonal entries
+      *lambda1 = a > d ? a : d;
+      *lambda2 = a > d ? d : a;
+      return;
+    }
     const long double power1 = -a - d;
     const long double constant = a * d - b * c;
+    INSTRUMENT_FLOPS(12);
     if ((power1 * power1 - 4 * constant) < 0) {
-      printf("The matrix has non-real eigenvalues.\n");
-      printf("The function currently supports only real eigenvalues.\n");
+      linalg_report(LINALG_ERR_NOT_REAL, function,
+                    "The matrix has non-real eigenvalues. The function "
+                    "currently supports only real eigenvalues.");
       *lambda1 = INT_MIN;
       *lambda2 = INT_MIN;
       return;
@@ -79,6 +107,14 @@ void eigenvalue_2x2(const struct matrix * const A, long double * const lambda1,
   }
 }
 
+void eigenvalue_2x2(const struct matrix * const A, long double * const lambda1,
+                    long double * const lambda2) {
+  INSTRUMENT_SCOPE(eigenvalue_2x2);
+  assert(A);
+  INSTRUMENT_MATRIX_DIMS(A);
+  roots_2x2(A, lambda1, lambda2, __func__);
+}
+
 //cubic_roots(a, b, c, x0, x1, x2) takes in three long doubles as the 2nd 
 //   degree, 1st degree and constant coefficients of a degree 3 polynomial, 
 //   where the 3rd degree coefficient is 1. Then it updates *x0, *x1 and *x2
@@ -148,38 +184,60 @@ static int cubic_roots(long double a, long double b, long double c,
 }
 
 
-void eigenvalue_3x3(const struct matrix * const A, long double * const lambda1,
-                    long double * const lambda2, long double * const lambda3) {
+//roots_3x3(A, lambda1, lambda2, lambda3, function) is eigenvalue_3x3,
+//   reporting errors as function.
+//requires: A, lambda1, lambda2, lambda3, function are not NULL
+//effects: modifies *lambda1, *lambda2 and *lambda3
+//         may print message
+static void roots_3x3(const struct matrix * const A,
+                      long double * const lambda1, long double * const lambda2,
+                      long double * const lambda3,
+                      const char * const function) {
   assert(A);
   int m, n = 0;
   matrix_size(A, &m, &n);
   if (m != 3 || n != 3) {
-    printf("Invalid input. The matrix is not 3 x 3.\n");
+    linalg_report(LINALG_ERR_DIMENSION, function,
+                  "Invalid input. The matrix is not 3 x 3.");
     *lambda1 = INT_MIN;
     *lambda2 = INT_MIN;
     *lambda3 = INT_MIN;
     return;
   } else {
-    const long double a = matrix_elem(A, 1, 1);
-    const long double b = matrix_elem(A, 1, 2);
-    const long double c = matrix_elem(A, 1, 3);
-    const long double d = matrix_elem(A, 2, 1);
-    const long double e = matrix_elem(A, 2, 2);
-    const long double f = matrix_elem(A, 2, 3);
-    const long double g = matrix_elem(A, 3, 1);
-    const long double h = matrix_elem(A, 3, 2);
-    const long double i = matrix_elem(A, 3, 3);
+    const long double a = matrix_elem_unchecked(A, 1, 1);
+    const long double b = matrix_elem_unchecked(A, 1, 2);
+    const long double c = matrix_elem_unchecked(A, 1, 3);
+    const long double d = matrix_elem_unchecked(A, 2, 1);
+    const long double e = matrix_elem_unchecked(A, 2, 2);
+    const long double f = matrix_elem_unchecked(A, 2, 3);
+    const long double g = matrix_elem_unchecked(A, 3, 1);
+    const long double h = matrix_elem_unchecked(A, 3, 2);
+    const long double i = matrix_elem_unchecked(A, 3, 3);
+    if (matrix_structure(A) &
+        (MATRIX_UPPER_TRIANGULAR | MATRIX_LOWER_TRIANGULAR)) {
+      //the eigenvalues of a triangular matrix are its diagonal entries, in
+      //   the same ascending order cubic_roots uses
+      const long double low = a < e ? a : e;
+      const long double high = a < e ? e : a;
+      *lambda1 = i < low ? i : low;
+      *lambda2 = i < low ? low : (i > high ? high : i);
+      *lambda3 = i > high ? i : high;
+      return;
+    }
     const long double power2 = a + e + i;
     const long double power1 = -(a * e) - (a * i) + (c * g) + (b * d) - (e * i)
       + (h * f);
     const long double constant = (a * e * i) - (a * f * h) - (b * d * i) +
       (b * f * g ) - (c * e * g ) + (c * d * h);
+    //characteristic polynomial plus the closed form cubic solution
+    INSTRUMENT_FLOPS(60);
     long double eigenvalue1, eigenvalue2, eigenvalue3 = INT_MIN;
     int root_number = cubic_roots(-power2, -power1, -constant, &eigenvalue1,
                                   &eigenvalue2, &eigenvalue3);
     if (root_number != 3) {
-      printf("The matrix has non-real eigenvalues.\n");
-      printf("The function currently supports only real eigenvalues.\n");
+      linalg_report(LINALG_ERR_NOT_REAL, function,
+                    "The matrix has non-real eigenvalues. The function "
+                    "currently supports only real eigenvalues.");
       *lambda1 = INT_MIN;
       *lambda2 = INT_MIN;
       *lambda3 = INT_MIN;
@@ -192,32 +250,46 @@ void eigenvalue_3x3(const struct matrix * const A, long double * const lambda1,
   }
 }
 
+void eigenvalue_3x3(const struct matrix * const A, long double * const lambda1,
+                    long double * const lambda2, long double * const lambda3) {
+  INSTRUMENT_SCOPE(eigenvalue_3x3);
+  assert(A);
+  INSTRUMENT_MATRIX_DIMS(A);
+  roots_3x3(A, lambda1, lambda2, lambda3, __func__);
+}
 
-int eigenvectors_2x2(const struct matrix * const A, struct vector ** const v1,
-                     struct vector ** const v2) {
+
+//vectors_2x2(A, v1, v2, function) is eigenvectors_2x2, reporting errors as
+//   function.
+//requires: A, v1, v2, function are not NULL
+//effects: may modify *v1 and *v2
+//         may print message
+//         may allocate heap memory
+static int vectors_2x2(const struct matrix * const A,
+                       struct vector ** const v1, struct vector ** const v2,
+                       const char * const function) {
   long double lambda1, lambda2 = 0;
-  eigenvalue_2x2(A, &lambda1, &lambda2);
+  roots_2x2(A, &lambda1, &lambda2, function);
   if (lambda1 == INT_MIN && lambda2 == INT_MIN) {
     return 0;
   } else {
     long double entries[] = 
-    {matrix_elem(A, 1, 1) - lambda1, matrix_elem(A, 1, 2),
-     matrix_elem(A, 2, 1), matrix_elem(A, 2, 2) - lambda1};           
+    {matrix_elem_unchecked(A, 1, 1) - lambda1, matrix_elem_unchecked(A, 1, 2),
+     matrix_elem_unchecked(A, 2, 1), matrix_elem_unchecked(A, 2, 2) - lambda1};           
     struct matrix *temp = quick_matrix_input(entries, 2, 2);
-    struct matrix *rref = RREF(temp);
-    matrix_destroy(temp);
-    if ((-PRECISION < matrix_elem(rref, 1, 1)) &&
-        (matrix_elem(rref, 1, 1) < PRECISION) &&
-        (-PRECISION < matrix_elem(rref, 1, 2)) &&
-        (matrix_elem(rref, 1, 2) < PRECISION)) {
+    struct matrix *rref = RREF_consume(temp);
+    if ((-PRECISION < matrix_elem_unchecked(rref, 1, 1)) &&
+        (matrix_elem_unchecked(rref, 1, 1) < PRECISION) &&
+        (-PRECISION < matrix_elem_unchecked(rref, 1, 2)) &&
+        (matrix_elem_unchecked(rref, 1, 2) < PRECISION)) {
       matrix_destroy(rref);
       long double v_1[] = {1, 0};
       long double v_2[] = {0, 1};
       *v1 = quick_vector_input(v_1, 2);
       *v2 = quick_vector_input(v_2, 2);
       return 2;
-    } else if ((-PRECISION < matrix_elem(rref, 1, 1)) &&
-               (matrix_elem(rref, 1, 1) < PRECISION)) {
+    } else if ((-PRECISION < matrix_elem_unchecked(rref, 1, 1)) &&
+               (matrix_elem_unchecked(rref, 1, 1) < PRECISION)) {
       //algebraic of 2, geometric of 1
       matrix_destroy(rref);
       long double v_1[] = {1, 0};
@@ -225,17 +297,16 @@ int eigenvectors_2x2(const struct matrix * const A, struct vector ** const v1,
       return 1;
     } else {
       long double v_1[] = 
-      {-matrix_elem(rref, 1, 2) / matrix_elem(rref, 1, 1), 1};
+      {-matrix_elem_unchecked(rref, 1, 2) / matrix_elem_unchecked(rref, 1, 1), 1};
       *v1 = quick_vector_input(v_1, 2);
       matrix_destroy(rref);
       long double entries[] = 
-      {matrix_elem(A, 1, 1) - lambda2, matrix_elem(A, 1, 2),
-       matrix_elem(A, 2, 1), matrix_elem(A, 2, 2) - lambda2};
+      {matrix_elem_unchecked(A, 1, 1) - lambda2, matrix_elem_unchecked(A, 1, 2),
+       matrix_elem_unchecked(A, 2, 1), matrix_elem_unchecked(A, 2, 2) - lambda2};
       struct matrix *temp = quick_matrix_input(entries, 2, 2);
-      struct matrix *rref = RREF(temp);
-      matrix_destroy(temp);
+      struct matrix *rref = RREF_consume(temp);
       long double v_2[] = 
-      {-matrix_elem(rref, 1, 2) / matrix_elem(rref, 1, 1), 1};
+      {-matrix_elem_unchecked(rref, 1, 2) / matrix_elem_unchecked(rref, 1, 1), 1};
       *v2 = quick_vector_input(v_2, 2);
       matrix_destroy(rref);
       return 2;
@@ -243,20 +314,35 @@ int eigenvectors_2x2(const struct matrix * const A, struct vector ** const v1,
   }
 }
 
-int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
-                     struct vector ** const v2, struct vector ** const v3) {
+int eigenvectors_2x2(const struct matrix * const A, struct vector ** const v1,
+                     struct vector ** const v2) {
+  INSTRUMENT_SCOPE(eigenvectors_2x2);
+  INSTRUMENT_DIMS(2, 2);
+  return vectors_2x2(A, v1, v2, __func__);
+}
+
+//vectors_3x3(A, v1, v2, v3, function) is eigenvectors_3x3, reporting
+//   errors as function.
+//requires: A, v1, v2, v3, function are not NULL
+//effects: may modify *v1, *v2 and *v3
+//         may print message
+//         may allocate heap memory
+static int vectors_3x3(const struct matrix * const A,
+                       struct vector ** const v1, struct vector ** const v2,
+                       struct vector ** const v3,
+                       const char * const function) {
   long double lambda1, lambda2, lambda3 = 0;
-  eigenvalue_3x3(A, &lambda1, &lambda2, &lambda3);
+  roots_3x3(A, &lambda1, &lambda2, &lambda3, function);
   if (!(lambda1 == INT_MIN && lambda2 == INT_MIN && lambda3 == INT_MIN)) {
-    const long double a = matrix_elem(A, 1, 1);
-    const long double b = matrix_elem(A, 1, 2);
-    const long double c = matrix_elem(A, 1, 3);
-    const long double d = matrix_elem(A, 2, 1);
-    const long double e = matrix_elem(A, 2, 2);
-    const long double f = matrix_elem(A, 2, 3);
-    const long double g = matrix_elem(A, 3, 1);
-    const long double h = matrix_elem(A, 3, 2);
-    const long double i = matrix_elem(A, 3, 3);
+    const long double a = matrix_elem_unchecked(A, 1, 1);
+    const long double b = matrix_elem_unchecked(A, 1, 2);
+    const long double c = matrix_elem_unchecked(A, 1, 3);
+    const long double d = matrix_elem_unchecked(A, 2, 1);
+    const long double e = matrix_elem_unchecked(A, 2, 2);
+    const long double f = matrix_elem_unchecked(A, 2, 3);
+    const long double g = matrix_elem_unchecked(A, 3, 1);
+    const long double h = matrix_elem_unchecked(A, 3, 2);
+    const long double i = matrix_elem_unchecked(A, 3, 3);
     long double a1, b1, c1, e1, f1 = 0;
     //making sure any lambda with multiplicity of 2 stay in the front:
     if (lambda1 == lambda3) {
@@ -275,14 +361,13 @@ int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
     long double entries[] = {a - lambda1, b, c, d, e - lambda1, f, g, h,
                              i - lambda1};
     struct matrix *temp = quick_matrix_input(entries, 3, 3);
-    struct matrix *rref = RREF(temp);
+    struct matrix *rref = RREF_consume(temp);
     int rref_rank = matrix_rank(rref);
-    a1 = matrix_elem(rref, 1, 1);
-    b1 = matrix_elem(rref, 1, 2);
-    c1 = matrix_elem(rref, 1, 3);
-    e1 = matrix_elem(rref, 2, 2);
-    f1 = matrix_elem(rref, 2, 3);
-    matrix_destroy(temp);
+    a1 = matrix_elem_unchecked(rref, 1, 1);
+    b1 = matrix_elem_unchecked(rref, 1, 2);
+    c1 = matrix_elem_unchecked(rref, 1, 3);
+    e1 = matrix_elem_unchecked(rref, 2, 2);
+    f1 = matrix_elem_unchecked(rref, 2, 3);
     matrix_destroy(rref);
     if (rref_rank == 0) {// 3 identical eigenvalues
       long double v_1[] = {1, 0, 0};
@@ -339,14 +424,13 @@ int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
     long double entries2[] = {a - lambda3, b, c, d, e - lambda3, f, g, h,
                               i - lambda3};
     temp = quick_matrix_input(entries2, 3, 3);
-    rref = RREF(temp);
-    a1 = matrix_elem(rref, 1, 1);
-    b1 = matrix_elem(rref, 1, 2);
-    c1 = matrix_elem(rref, 1, 3);
-    e1 = matrix_elem(rref, 2, 2);
-    f1 = matrix_elem(rref, 2, 3);
+    rref = RREF_consume(temp);
+    a1 = matrix_elem_unchecked(rref, 1, 1);
+    b1 = matrix_elem_unchecked(rref, 1, 2);
+    c1 = matrix_elem_unchecked(rref, 1, 3);
+    e1 = matrix_elem_unchecked(rref, 2, 2);
+    f1 = matrix_elem_unchecked(rref, 2, 3);
     matrix_destroy(rref);
-    matrix_destroy(temp);
     //rref must have rank 2, since alg/geom multiplicity of lambda3 must be 1
     if (a1 > PRECISION || a1 < -PRECISION) {
       if (e1 > PRECISION || e1 < -PRECISION) {
@@ -366,14 +450,13 @@ int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
     long double entries3[] = {a - lambda2, b, c, d, e - lambda2, f, g, h,
                               i - lambda2};
     temp = quick_matrix_input(entries3, 3, 3);
-    rref = RREF(temp);
-    a1 = matrix_elem(rref, 1, 1);
-    b1 = matrix_elem(rref, 1, 2);
-    c1 = matrix_elem(rref, 1, 3);
-    e1 = matrix_elem(rref, 2, 2);
-    f1 = matrix_elem(rref, 2, 3);
+    rref = RREF_consume(temp);
+    a1 = matrix_elem_unchecked(rref, 1, 1);
+    b1 = matrix_elem_unchecked(rref, 1, 2);
+    c1 = matrix_elem_unchecked(rref, 1, 3);
+    e1 = matrix_elem_unchecked(rref, 2, 2);
+    f1 = matrix_elem_unchecked(rref, 2, 3);
     matrix_destroy(rref);
-    matrix_destroy(temp);
     if (a1 > PRECISION || a1 < -PRECISION) {
       if (e1 > PRECISION || e1 < -PRECISION) {
         long double v_2[] = {-c1 / a1, -f1 / e1, 1};
@@ -391,16 +474,75 @@ int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
   return 0;
 }
 
+int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
+                     struct vector ** const v2, struct vector ** const v3) {
+  INSTRUMENT_SCOPE(eigenvectors_3x3);
+  INSTRUMENT_DIMS(3, 3);
+  return vectors_3x3(A, v1, v2, v3, __func__);
+}
+
+
+//diagonal_diagonalize(A, n, P, D, P_inv) diagonalizes the n x n matrix A,
+//   n = 2 or 3, without finding eigenvectors if it is already diagonal. D
+//   holds the eigenvalues in the order eigenvalue_2x2 or eigenvalue_3x3
+//   returns them, as in the general case, and P is the permutation matrix
+//   whose column k is e_i for the diagonal entry A[ii] in position k of D,
+//   with P_inv its transpose. It returns true in that case, and false
+//   without modifying anything otherwise.
+//requires: A, P, D, P_inv are not NULL
+//effects: may modify *P, *D and *P_inv
+//         may allocate heap memory
+static bool diagonal_diagonalize(const struct matrix * const A, const int n,
+                                 struct matrix ** const P,
+                                 struct matrix ** const D,
+                                 struct matrix ** const P_inv) {
+  int m, width = 0;
+  matrix_size(A, &m, &width);
+  if ((m != n) || !(matrix_structure(A) & MATRIX_DIAGONAL)) {
+    return false;
+  }
+  //the eigenvalues of a triangular matrix are its diagonal entries, exactly
+  long double lambda[3] = {0, 0, 0};
+  if (n == 2) {
+    eigenvalue_2x2(A, &lambda[0], &lambda[1]);
+  } else {
+    eigenvalue_3x3(A, &lambda[0], &lambda[1], &lambda[2]);
+  }
+  *P = matrix_create_zero(n, n);
+  *D = matrix_create_zero(n, n);
+  *P_inv = matrix_create_zero(n, n);
+  bool used[3] = {false, false, false};
+  for (int k = 1; k <= n; k++) {
+    //the first diagonal entry not placed yet that is the kth eigenvalue
+    int i = 1;
+    while ((i < n) &&
+           (used[i - 1] || (matrix_row_cdata(A, i)[i - 1] != lambda[k - 1]))) {
+      i++;
+    }
+    used[i - 1] = true;
+    matrix_row_data(*D, k)[k - 1] = lambda[k - 1];
+    matrix_row_data(*P, i)[k - 1] = 1;
+    matrix_row_data(*P_inv, k)[i - 1] = 1;
+  }
+  return true;
+}
+
 
 void diagonalize_2x2(const struct matrix * const A, struct matrix ** const P,
                      struct matrix ** const D, struct matrix ** const P_inv) {
+  INSTRUMENT_SCOPE(diagonalize_2x2);
+  INSTRUMENT_DIMS(2, 2);
+  if (diagonal_diagonalize(A, 2, P, D, P_inv)) {
+    return;
+  }
   struct vector *v1, *v2 = NULL;
-  int eigenvector_num = eigenvectors_2x2(A, &v1, &v2);
+  int eigenvector_num = vectors_2x2(A, &v1, &v2, __func__);
   if (eigenvector_num == 1) {
-    printf("The matrix is not diagonalizable.\n");
+    linalg_report(LINALG_ERR_NOT_DIAGONALIZABLE, __func__,
+                  "The matrix is not diagonalizable.");
   } else if (eigenvector_num == 2) {
     long double lambda1, lambda2 = 0;
-    eigenvalue_2x2(A, &lambda1, &lambda2);
+    roots_2x2(A, &lambda1, &lambda2, __func__);
     struct matrix *p = matrix_create();
     matrix_add_col(p, v1);
     matrix_add_col(p, v2);
@@ -419,13 +561,19 @@ void diagonalize_2x2(const struct matrix * const A, struct matrix ** const P,
 
 void diagonalize_3x3(const struct matrix * const A, struct matrix ** const P,
                      struct matrix ** const D, struct matrix ** const P_inv) {
+  INSTRUMENT_SCOPE(diagonalize_3x3);
+  INSTRUMENT_DIMS(3, 3);
+  if (diagonal_diagonalize(A, 3, P, D, P_inv)) {
+    return;
+  }
   struct vector *v1, *v2, *v3 = NULL;
-  int eigenvector_num = eigenvectors_3x3(A, &v1, &v2, &v3);
+  int eigenvector_num = vectors_3x3(A, &v1, &v2, &v3, __func__);
   if ((eigenvector_num == 1) || (eigenvector_num == 2)) {
-    printf("The matrix is not diagonalizable.\n");
+    linalg_report(LINALG_ERR_NOT_DIAGONALIZABLE, __func__,
+                  "The matrix is not diagonalizable.");
   } else if (eigenvector_num == 3) {
     long double lambda1, lambda2, lambda3 = 0;
-    eigenvalue_3x3(A, &lambda1, &lambda2, &lambda3);
+    roots_3x3(A, &lambda1, &lambda2, &lambda3, __func__);
     struct matrix *p = matrix_create();
     matrix_add_col(p, v1);
     matrix_add_col(p, v2);
@@ -59,7 +59,10 @@ int eigenvectors_3x3(const struct matrix * const A, struct vector ** const v1,
 //diagonalize_2x2(A, P, D, P_inv) takes in four struct matrix pointers where A
 //   is a 2 x 2 matrix. If possible, it modifies P, D and P_inv such that P 
 //   diagonalizes A, or (P_inv)(D)(P) = A. Otherwise it outputs an error
-//   message and leave P, D and P_inv unchanged.
+//   message and leave P, D and P_inv unchanged. Perturbing A by E moves
+//   each eigenvalue by up to about matrix_cond_1(P) times |E|_1 (the
+//   Bauer-Fike theorem, with the condition number estimated as in
+//   inv_and_det.h), so a large estimate flags a D to distrust.
 //requires: A is not NULL;
 //          *A is a 2 x 2 matrix.
 //effects: may modify *P, *D and *P_inv
@@ -71,7 +74,10 @@ void diagonalize_2x2(const struct matrix * const A, struct matrix ** const P,
 //diagonalize_3x3(A, P, D, P_inv) takes in four struct matrix pointers where A
 //   is a 3 x 3 matrix. If possible, it modifies P, D and P_inv such that P 
 //   diagonalizes A, or (P_inv)(D)(P) = A. Otherwise it outputs an error
-//   message and leave P, D and P_inv unchanged.
+//   message and leave P, D and P_inv unchanged. Perturbing A by E moves
+//   each eigenvalue by up to about matrix_cond_1(P) times |E|_1 (the
+//   Bauer-Fike theorem, with the condition number estimated as in
+//   inv_and_det.h), so a large estimate flags a D to distrust.
 //requires: A is not NULL;
 //          *A is a 3 x 3 matrix.
 //effects: may modify *P, *D and *P_inv
@@ -0,0 +1,1036 @@
+#include <assert.h>
+#include <complex.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "eigs.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+const struct eigs_options EIGS_DEFAULTS = {1e-10L, 1000, 0, 1,
+                                           EIGS_LARGEST_MAGNITUDE};
+
+//dot(x, y, n) returns the dot product of the n long doubles of x and y.
+//requires: x, y are not NULL
+static long double dot(const long double * const x, const long double * const y,
+                       const int n) {
+  long double sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  INSTRUMENT_FLOPS(2LL * n);
+  return sum;
+}
+
+//axpy(y, a, x, n) adds a times x to y, which hold n long doubles.
+//requires: x, y are not NULL
+//effects: modifies y
+static void axpy(long double * const y, const long double a,
+                 const long double * const x, const int n) {
+  for (int i = 0; i < n; i++) {
+    y[i] += a * x[i];
+  }
+  INSTRUMENT_FLOPS(2LL * n);
+}
+
+//random_fill(state, x, n) fills x with n pseudo-random numbers in [-1, 1)
+//   from the xorshift generator *state, so every run starts alike.
+//requires: state, x are not NULL, *state is not 0
+//effects: modifies *state and x
+static void random_fill(uint64_t * const state, long double * const x,
+                        const int n) {
+  uint64_t s = *state;
+  for (int i = 0; i < n; i++) {
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    x[i] = (s >> 11) * 0x1p-52L - 1;
+  }
+  *state = s;
+}
+
+//orthonormalize(V, count, n, x, state) makes x a unit vector orthogonal to
+//   the count orthonormal vectors of n long doubles stored one after the
+//   other in V, by two passes of Gram-Schmidt. If almost all of x lies in
+//   their span, x is replaced by a pseudo-random vector first.
+//requires: V, x, state are not NULL, count < n
+//effects: modifies x and *state
+static void orthonormalize(const long double * const V, const int count,
+                           const int n, long double * const x,
+                           uint64_t * const state) {
+  assert(count < n);
+  for (;;) {
+    const long double before = sqrtl(dot(x, x, n));
+    for (int pass = 0; pass < 2; pass++) {
+      for (int j = 0; j < count; j++) {
+        const long double *v = V + (size_t) j * n;
+        axpy(x, -dot(v, x, n), v, n);
+      }
+    }
+    const long double after = sqrtl(dot(x, x, n));
+    if ((after > 0) && (after > 1e-8L * before)) {
+      for (int i = 0; i < n; i++) {
+        x[i] /= after;
+      }
+      return;
+    }
+    random_fill(state, x, n);
+  }
+}
+
+//A struct solve holds the state of Lanczos or Arnoldi. The basis V and its
+//   image W = AV have m vectors of n long doubles each, one after the other;
+//   G holds the g vectors the next block of the basis is made from. H = V^T W
+//   is m x m and stored by columns (its entries between the first fresh
+//   vectors are carried over from the last restart), and so are the
+//   coefficients (Zr + i Zi)
+//   in the basis of the Ritz vector of each Ritz value re + i im. order
+//   lists the Ritz values from most to least wanted: the first kw of them
+//   are the k wanted ones and the partner of a complex pair among them, and
+//   the first r are kept on a restart.
+struct solve {
+  const struct linop *A;
+  struct eigs_options options;
+  struct eigs_stats stats;
+  int n;
+  int k;
+  int m;
+  int b;
+  int g;
+  int fresh;
+  int kw;
+  int r;
+  bool symmetric;
+  uint64_t state;
+  long double *V;
+  long double *W;
+  long double *G;
+  long double *x;
+  long double *y;
+  long double *H;
+  long double *Zr;
+  long double *Zi;
+  long double *re;
+  long double *im;
+  long double *scratch;
+  long double complex *M;
+  long double complex *c;
+  int *order;
+  int *pivot;
+  void *work;
+  size_t bytes;
+};
+
+//apply(S, x, y) stores Ax in y, where A is the operator of S.
+//requires: S, x, y are not NULL, x and y do not overlap
+//effects: modifies y and S->stats
+static void apply(struct solve * const S, const long double * const x,
+                  long double * const y) {
+  S->A->apply(S->A->data, x, y);
+  S->stats.applications++;
+}
+
+//expand(S, count) extends the count orthonormal vectors of S->V to S->m:
+//   each step orthonormalizes the vectors of S->G against the basis, appends
+//   them, and makes their images the next S->G.
+//requires: S is not NULL, 0 < count, S->g > 0
+//effects: modifies *S
+static void expand(struct solve * const S, int count) {
+  const int n = S->n;
+  while (count < S->m) {
+    const int step = S->g < S->m - count ? S->g : S->m - count;
+    for (int t = 0; t < step; t++) {
+      long double *v = S->V + (size_t) (count + t) * n;
+      memcpy(v, S->G + (size_t) t * n, n * sizeof(long double));
+      orthonormalize(S->V, count + t, n, v, &S->state);
+    }
+    for (int t = 0; t < step; t++) {
+      const size_t at = (size_t) (count + t) * n;
+      apply(S, S->V + at, S->W + at);
+      memcpy(S->G + (size_t) t * n, S->W + at, n * sizeof(long double));
+    }
+    count += step;
+    S->g = step;
+  }
+}
+
+//symmetric_eigen(T, m, lambda, Z) finds the eigenvalues of the symmetric
+//   m x m matrix T (stored by columns) by cyclic Jacobi rotations, stores
+//   them in lambda and a unit eigenvector for each in the same column of Z.
+//requires: T, lambda, Z are not NULL, m >= 1
+//effects: modifies T, lambda and Z
+static void symmetric_eigen(long double * const T, const int m,
+                            long double * const lambda, long double * const Z) {
+  for (int j = 0; j < m; j++) {
+    for (int i = 0; i < m; i++) {
+      Z[i + j * m] = i == j;
+    }
+  }
+  long double total = 0;
+  for (int i = 0; i < m * m; i++) {
+    total += T[i] * T[i];
+  }
+  for (int sweep = 0; sweep < 64; sweep++) {
+    long double off = 0;
+    for (int q = 1; q < m; q++) {
+      for (int p = 0; p < q; p++) {
+        off += T[p + q * m] * T[p + q * m];
+      }
+    }
+    if (off <= LDBL_EPSILON * LDBL_EPSILON * total) {
+      break;
+    }
+    for (int q = 1; q < m; q++) {
+      for (int p = 0; p < q; p++) {
+        const long double tpq = T[p + q * m];
+        if (tpq == 0) {
+          continue;
+        }
+        //the rotation in the (p, q) plane that zeroes T[p][q]
+        const long double theta = (T[q + q * m] - T[p + p * m]) / (2 * tpq);
+        const long double t = (theta < 0 ? -1 : 1) /
+                              (fabsl(theta) + sqrtl(theta * theta + 1));
+        const long double cs = 1 / sqrtl(t * t + 1);
+        const long double sn = t * cs;
+        for (int i = 0; i < m; i++) {
+          const long double a = T[i + p * m];
+          const long double b = T[i + q * m];
+          T[i + p * m] = cs * a - sn * b;
+          T[i + q * m] = sn * a + cs * b;
+        }
+        for (int j = 0; j < m; j++) {
+          const long double a = T[p + j * m];
+          const long double b = T[q + j * m];
+          T[p + j * m] = cs * a - sn * b;
+          T[q + j * m] = sn * a + cs * b;
+        }
+        for (int i = 0; i < m; i++) {
+          const long double a = Z[i + p * m];
+          const long double b = Z[i + q * m];
+          Z[i + p * m] = cs * a - sn * b;
+          Z[i + q * m] = sn * a + cs * b;
+        }
+        INSTRUMENT_FLOPS(18LL * m);
+      }
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    lambda[i] = T[i + i * m];
+  }
+}
+
+//general_eigen(a, m, re, im) finds the eigenvalues re + i im of the m x m
+//   matrix stored by rows in a, numbered from 1 ((m + 1) x (m + 1) entries),
+//   by reduction to upper Hessenberg form with stabilized elimination and
+//   the Francis double shift QR algorithm. The two values of a complex pair
+//   are stored next to each other. It returns false if the QR algorithm
+//   does not converge.
+//requires: a, re, im are not NULL, m >= 1
+//effects: modifies a, re and im
+static bool general_eigen(long double * const a, const int m,
+                          long double * const re, long double * const im) {
+#define A_(i, j) a[(i) * (m + 1) + (j)]
+  INSTRUMENT_FLOPS(10LL * m * m * m);
+  for (int p = 2; p < m; p++) {
+    long double x = 0;
+    int i = p;
+    for (int j = p; j <= m; j++) {
+      if (fabsl(A_(j, p - 1)) > fabsl(x)) {
+        x = A_(j, p - 1);
+        i = j;
+      }
+    }
+    if (i != p) {
+      for (int j = p - 1; j <= m; j++) {
+        const long double t = A_(i, j);
+        A_(i, j) = A_(p, j);
+        A_(p, j) = t;
+      }
+      for (int j = 1; j <= m; j++) {
+        const long double t = A_(j, i);
+        A_(j, i) = A_(j, p);
+        A_(j, p) = t;
+      }
+    }
+    if (x != 0) {
+      for (i = p + 1; i <= m; i++) {
+        long double y = A_(i, p - 1);
+        if (y != 0) {
+          y /= x;
+          A_(i, p - 1) = 0;
+          for (int j = p; j <= m; j++) {
+            A_(i, j) -= y * A_(p, j);
+          }
+          for (int j = 1; j <= m; j++) {
+            A_(j, p) += y * A_(j, i);
+          }
+        }
+      }
+    }
+  }
+  long double norm = 0;
+  for (int i = 1; i <= m; i++) {
+    for (int j = i > 1 ? i - 1 : 1; j <= m; j++) {
+      norm += fabsl(A_(i, j));
+    }
+  }
+  int nn = m;
+  long double t = 0;
+  long double p = 0, q = 0, r = 0, s = 0, w = 0, x = 0, y = 0, z = 0;
+  while (nn >= 1) {
+    int its = 0;
+    int l;
+    do {
+      //look for a negligible subdiagonal entry to split the matrix at
+      for (l = nn; l >= 2; l--) {
+        s = fabsl(A_(l - 1, l - 1)) + fabsl(A_(l, l));
+        if (s == 0) {
+          s = norm;
+        }
+        if (fabsl(A_(l, l - 1)) + s == s) {
+          A_(l, l - 1) = 0;
+          break;
+        }
+      }
+      x = A_(nn, nn);
+      if (l == nn) {
+        re[nn - 1] = x + t;
+        im[nn - 1] = 0;
+        nn--;
+      } else {
+        y = A_(nn - 1, nn - 1);
+        w = A_(nn, nn - 1) * A_(nn - 1, nn);
+        if (l == nn - 1) {
+          p = (y - x) / 2;
+          q = p * p + w;
+          z = sqrtl(fabsl(q));
+          x += t;
+          if (q >= 0) {
+            z = p + (p >= 0 ? z : -z);
+            re[nn - 2] = re[nn - 1] = x + z;
+            if (z != 0) {
+              re[nn - 1] = x - w / z;
+            }
+            im[nn - 2] = im[nn - 1] = 0;
+          } else {
+            re[nn - 2] = re[nn - 1] = x + p;
+            im[nn - 2] = z;
+            im[nn - 1] = -z;
+          }
+          nn -= 2;
+        } else {
+          if (its == 60) {
+            return false;
+          }
+          if ((its == 10) || (its == 20)) {
+            //exceptional shift
+            t += x;
+            for (int i = 1; i <= nn; i++) {
+              A_(i, i) -= x;
+            }
+            s = fabsl(A_(nn, nn - 1)) + fabsl(A_(nn - 1, nn - 2));
+            y = x = 0.75L * s;
+            w = -0.4375L * s * s;
+          }
+          its++;
+          int k;
+          for (k = nn - 2; k >= l; k--) {
+            z = A_(k, k);
+            r = x - z;
+            s = y - z;
+            p = (r * s - w) / A_(k + 1, k) + A_(k, k + 1);
+            q = A_(k + 1, k + 1) - z - r - s;
+            r = A_(k + 2, k + 1);
+            s = fabsl(p) + fabsl(q) + fabsl(r);
+            p /= s;
+            q /= s;
+            r /= s;
+            if (k == l) {
+              break;
+            }
+            const long double u = fabsl(A_(k, k - 1)) * (fabsl(q) + fabsl(r));
+            const long double v = fabsl(p) * (fabsl(A_(k - 1, k - 1)) +
+                                              fabsl(z) +
+                                              fabsl(A_(k + 1, k + 1)));
+            if (u + v == v) {
+              break;
+            }
+          }
+          const int first = k;
+          for (int i = first + 2; i <= nn; i++) {
+            A_(i, i - 2) = 0;
+            if (i != first + 2) {
+              A_(i, i - 3) = 0;
+            }
+          }
+          //chase the bulge down the subdiagonal
+          for (k = first; k <= nn - 1; k++) {
+            if (k != first) {
+              p = A_(k, k - 1);
+              q = A_(k + 1, k - 1);
+              r = 0;
+              if (k != nn - 1) {
+                r = A_(k + 2, k - 1);
+              }
+              x = fabsl(p) + fabsl(q) + fabsl(r);
+              if (x != 0) {
+                p /= x;
+                q /= x;
+                r /= x;
+              }
+            }
+            s = sqrtl(p * p + q * q + r * r);
+            s = p >= 0 ? s : -s;
+            if (s != 0) {
+              if (k == first) {
+                if (l != first) {
+                  A_(k, k - 1) = -A_(k, k - 1);
+                }
+              } else {
+                A_(k, k - 1) = -s * x;
+              }
+              p += s;
+              x = p / s;
+              y = q / s;
+              z = r / s;
+              q /= p;
+              r /= p;
+              for (int j = k; j <= nn; j++) {
+                p = A_(k, j) + q * A_(k + 1, j);
+                if (k != nn - 1) {
+                  p += r * A_(k + 2, j);
+                  A_(k + 2, j) -= p * z;
+                }
+                A_(k + 1, j) -= p * y;
+                A_(k, j) -= p * x;
+              }
+              const int last = nn < k + 3 ? nn : k + 3;
+              for (int i = l; i <= last; i++) {
+                p = x * A_(i, k) + y * A_(i, k + 1);
+                if (k != nn - 1) {
+                  p += z * A_(i, k + 2);
+                  A_(i, k + 2) -= p * r;
+                }
+                A_(i, k + 1) -= p * q;
+                A_(i, k) -= p;
+              }
+            }
+          }
+        }
+      }
+    } while ((nn >= 1) && (l < nn - 1));
+  }
+  return true;
+#undef A_
+}
+
+//ritz_coefficients(S, index) stores in column index of S->Zr and S->Zi a
+//   unit eigenvector of S->H for the Ritz value index, found by inverse
+//   iteration with a shift next to it.
+//requires: S is not NULL, 0 <= index < S->m
+//effects: modifies *S
+static void ritz_coefficients(struct solve * const S, const int index) {
+  const int m = S->m;
+  long double norm = 0;
+  for (int i = 0; i < m * m; i++) {
+    norm = fmaxl(norm, fabsl(S->H[i]));
+  }
+  const long double delta = 64 * LDBL_EPSILON * (norm > 0 ? norm : 1);
+  const long double complex shift = S->re[index] + delta + S->im[index] * I;
+  long double complex *M = S->M;
+  for (int j = 0; j < m; j++) {
+    for (int i = 0; i < m; i++) {
+      M[i + j * m] = S->H[i + j * m] - (i == j ? shift : 0);
+    }
+  }
+  //LU factors of H - shift I with partial pivoting
+  for (int j = 0; j < m; j++) {
+    int best = j;
+    for (int i = j + 1; i < m; i++) {
+      if (cabsl(M[i + j * m]) > cabsl(M[best + j * m])) {
+        best = i;
+      }
+    }
+    S->pivot[j] = best;
+    if (best != j) {
+      for (int t = 0; t < m; t++) {
+        const long double complex swap = M[j + t * m];
+        M[j + t * m] = M[best + t * m];
+        M[best + t * m] = swap;
+      }
+    }
+    if (M[j + j * m] == 0) {
+      M[j + j * m] = delta;
+    }
+    for (int i = j + 1; i < m; i++) {
+      M[i + j * m] /= M[j + j * m];
+      for (int t = j + 1; t < m; t++) {
+        M[i + t * m] -= M[i + j * m] * M[j + t * m];
+      }
+    }
+  }
+  INSTRUMENT_FLOPS(8LL * m * m * m);
+  long double complex *z = S->c;
+  for (int i = 0; i < m; i++) {
+    z[i] = 1;
+  }
+  for (int step = 0; step < 3; step++) {
+    for (int j = 0; j < m; j++) {
+      const long double complex swap = z[j];
+      z[j] = z[S->pivot[j]];
+      z[S->pivot[j]] = swap;
+    }
+    for (int i = 1; i < m; i++) {
+      for (int j = 0; j < i; j++) {
+        z[i] -= M[i + j * m] * z[j];
+      }
+    }
+    for (int i = m - 1; i >= 0; i--) {
+      for (int j = i + 1; j < m; j++) {
+        z[i] -= M[i + j * m] * z[j];
+      }
+      z[i] /= M[i + i * m];
+    }
+    long double size = 0;
+    for (int i = 0; i < m; i++) {
+      size += creall(z[i]) * creall(z[i]) + cimagl(z[i]) * cimagl(z[i]);
+    }
+    size = sqrtl(size);
+    for (int i = 0; i < m; i++) {
+      z[i] /= size;
+    }
+  }
+  INSTRUMENT_FLOPS(24LL * m * m);
+  for (int i = 0; i < m; i++) {
+    S->Zr[i + index * m] = creall(z[i]);
+    S->Zi[i + index * m] = S->im[index] == 0 ? 0 : cimagl(z[i]);
+  }
+}
+
+//key(S, index) is how much the Ritz value index of S is wanted.
+//requires: S is not NULL, 0 <= index < S->m
+static long double key(const struct solve * const S, const int index) {
+  return S->options.target == EIGS_LARGEST_REAL ? S->re[index] :
+         hypotl(S->re[index], S->im[index]);
+}
+
+//pairs_end(S, count) returns the smallest number >= count of leading Ritz
+//   values of S (in order) that does not split a complex pair.
+//requires: S is not NULL, 0 <= count <= S->m
+static int pairs_end(const struct solve * const S, const int count) {
+  int p = 0;
+  while (p < count) {
+    p += S->im[S->order[p]] != 0 ? 2 : 1;
+  }
+  return p;
+}
+
+//rayleigh_ritz(S) finds the Ritz pairs of the operator on the span of the
+//   basis of S, orders them, picks S->kw and S->r and finds the coefficients
+//   of the first S->r. It returns false if the Ritz values cannot be found.
+//requires: S is not NULL, the basis of S is full
+//effects: modifies *S
+static bool rayleigh_ritz(struct solve * const S) {
+  const int n = S->n;
+  const int m = S->m;
+  for (int j = 0; j < m; j++) {
+    for (int i = j < S->fresh ? S->fresh : 0; i < m; i++) {
+      S->H[i + j * m] = dot(S->V + (size_t) i * n, S->W + (size_t) j * n, n);
+    }
+  }
+  if (S->symmetric) {
+    for (int j = 0; j < m; j++) {
+      for (int i = 0; i < m; i++) {
+        S->scratch[i + j * m] = (S->H[i + j * m] + S->H[j + i * m]) / 2;
+      }
+      S->im[j] = 0;
+    }
+    symmetric_eigen(S->scratch, m, S->re, S->Zr);
+  } else {
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j < m; j++) {
+        S->scratch[(i + 1) * (m + 1) + j + 1] = S->H[i + j * m];
+      }
+    }
+    if (!general_eigen(S->scratch, m, S->re, S->im)) {
+      return false;
+    }
+  }
+  //a stable insertion sort keeps each complex pair together
+  for (int p = 0; p < m; p++) {
+    int q = p;
+    while ((q > 0) && (key(S, S->order[q - 1]) < key(S, p))) {
+      S->order[q] = S->order[q - 1];
+      q--;
+    }
+    S->order[q] = p;
+  }
+  S->kw = pairs_end(S, S->k < m ? S->k : m);
+  S->kw = S->kw < m ? S->kw : m;
+  int r = S->kw + (m - S->kw) / 2;
+  r = r < m - 1 ? r : m - 1;
+  r = r > S->kw ? r : S->kw;
+  if (pairs_end(S, r) > r) {
+    r = r - 1 >= S->kw ? r - 1 : r + 1;
+  }
+  S->r = r < m ? r : m;
+  if (!S->symmetric) {
+    for (int p = 0; p < S->r; p++) {
+      const int index = S->order[p];
+      ritz_coefficients(S, index);
+      if (S->im[index] != 0) {
+        const int partner = S->order[p + 1];
+        for (int i = 0; i < m; i++) {
+          S->Zr[i + partner * m] = S->Zr[i + index * m];
+          S->Zi[i + partner * m] = -S->Zi[i + index * m];
+        }
+        p++;
+      }
+    }
+  }
+  return true;
+}
+
+//combine(S, B, z, out) stores the combination of the basis vectors (or
+//   their images) B with the coefficients z in out.
+//requires: S, B, z, out are not NULL
+//effects: modifies out
+static void combine(const struct solve * const S, const long double * const B,
+                    const long double * const z, long double * const out) {
+  memset(out, 0, S->n * sizeof(long double));
+  for (int j = 0; j < S->m; j++) {
+    if (z[j] != 0) {
+      axpy(out, z[j], B + (size_t) j * S->n, S->n);
+    }
+  }
+}
+
+//check(S) stores in S->stats the largest residual of the wanted Ritz pairs
+//   relative to the largest wanted |lambda| and whether it is small enough.
+//requires: S is not NULL, rayleigh_ritz(S) succeeded
+//effects: modifies S->stats, S->x and S->y
+static void check(struct solve * const S) {
+  const int n = S->n;
+  const int m = S->m;
+  long double scale = 0;
+  for (int p = 0; p < S->kw; p++) {
+    const int index = S->order[p];
+    scale = fmaxl(scale, hypotl(S->re[index], S->im[index]));
+  }
+  scale = scale > 0 ? scale : 1;
+  long double worst = 0;
+  long double *xr = S->x;
+  long double *xi = S->x + n;
+  long double *yr = S->y;
+  long double *yi = S->y + n;
+  for (int p = 0; p < S->kw; p++) {
+    const int index = S->order[p];
+    const long double lr = S->re[index];
+    const long double li = S->im[index];
+    combine(S, S->V, S->Zr + (size_t) index * m, xr);
+    combine(S, S->W, S->Zr + (size_t) index * m, yr);
+    long double sum = 0;
+    if (li == 0) {
+      for (int i = 0; i < n; i++) {
+        const long double d = yr[i] - lr * xr[i];
+        sum += d * d;
+      }
+    } else {
+      combine(S, S->V, S->Zi + (size_t) index * m, xi);
+      combine(S, S->W, S->Zi + (size_t) index * m, yi);
+      for (int i = 0; i < n; i++) {
+        const long double dr = yr[i] - (lr * xr[i] - li * xi[i]);
+        const long double di = yi[i] - (lr * xi[i] + li * xr[i]);
+        sum += dr * dr + di * di;
+      }
+      //the partner has the same residual
+      p++;
+    }
+    INSTRUMENT_FLOPS(8LL * n);
+    worst = fmaxl(worst, sqrtl(sum) / scale);
+  }
+  S->stats.residual = worst;
+  S->stats.converged = worst <= S->options.tolerance;
+}
+
+//restart(S) shrinks the basis of S to an orthonormal basis of the span of
+//   the first S->r Ritz vectors (the real and imaginary parts of a complex
+//   one), and makes the next block out of the images of the last basis
+//   vectors, orthogonalized against the whole old basis. It returns the new
+//   number of basis vectors, and updates H to match them.
+//requires: S is not NULL, rayleigh_ritz(S) succeeded
+//effects: modifies *S
+static int restart(struct solve * const S) {
+  const int n = S->n;
+  const int m = S->m;
+  S->g = S->b < m ? S->b : m;
+  for (int t = 0; t < S->g; t++) {
+    long double *gen = S->G + (size_t) t * n;
+    memcpy(gen, S->W + (size_t) (m - S->g + t) * n, n * sizeof(long double));
+    for (int pass = 0; pass < 2; pass++) {
+      for (int j = 0; j < m; j++) {
+        const long double *v = S->V + (size_t) j * n;
+        axpy(gen, -dot(v, gen, n), v, n);
+      }
+    }
+  }
+  //the new coefficients, orthonormalized by columns in C
+  long double *C = S->scratch;
+  int count = 0;
+  for (int p = 0; p < S->r; p++) {
+    const int index = S->order[p];
+    const int parts = S->im[index] != 0 ? 2 : 1;
+    for (int part = 0; part < parts; part++) {
+      long double *c = C + (size_t) count * m;
+      memcpy(c, (part ? S->Zi : S->Zr) + (size_t) index * m,
+             m * sizeof(long double));
+      const long double before = sqrtl(dot(c, c, m));
+      for (int pass = 0; pass < 2; pass++) {
+        for (int j = 0; j < count; j++) {
+          const long double *d = C + (size_t) j * m;
+          axpy(c, -dot(d, c, m), d, m);
+        }
+      }
+      const long double after = sqrtl(dot(c, c, m));
+      if ((after > 0) && (after > 1e-8L * before)) {
+        for (int i = 0; i < m; i++) {
+          c[i] /= after;
+        }
+        count++;
+      }
+    }
+    p += parts - 1;
+  }
+  //V = VC and W = WC, a tile of rows at a time
+  long double *tile = S->x;
+  const int height = 4 * n / m < 64 ? 4 * n / m : 64;
+  for (int pass = 0; pass < 2; pass++) {
+    long double *B = pass ? S->W : S->V;
+    for (int i0 = 0; i0 < n; i0 += height) {
+      const int rows = n - i0 < height ? n - i0 : height;
+      for (int j = 0; j < m; j++) {
+        const long double *column = B + (size_t) j * n + i0;
+        for (int i = 0; i < rows; i++) {
+          tile[i * m + j] = column[i];
+        }
+      }
+      for (int t = 0; t < count; t++) {
+        const long double *c = C + (size_t) t * m;
+        long double *out = B + (size_t) t * n + i0;
+        for (int i = 0; i < rows; i++) {
+          const long double *row = tile + i * m;
+          long double sum = 0;
+          for (int j = 0; j < m; j++) {
+            sum += row[j] * c[j];
+          }
+          out[i] = sum;
+        }
+      }
+    }
+  }
+  //H = C^T H C, through HC in Zr
+  long double *HC = S->Zr;
+  for (int t = 0; t < count; t++) {
+    for (int i = 0; i < m; i++) {
+      long double sum = 0;
+      for (int j = 0; j < m; j++) {
+        sum += S->H[i + j * m] * C[j + t * m];
+      }
+      HC[i + t * m] = sum;
+    }
+  }
+  for (int b = 0; b < count; b++) {
+    for (int a = 0; a < count; a++) {
+      S->H[a + b * m] = dot(C + (size_t) a * m, HC + (size_t) b * m, m);
+    }
+  }
+  S->fresh = count;
+  INSTRUMENT_FLOPS(4LL * n * m * count + 2LL * m * m * count);
+  return count;
+}
+
+//eigenvectors(S) returns the n x k matrix whose columns are the first k
+//   Ritz vectors of S, each with its largest entry positive.
+//requires: S is not NULL, rayleigh_ritz(S) succeeded
+//          the first k Ritz values are real
+//effects: allocates heap memory
+static struct matrix *eigenvectors(struct solve * const S) {
+  const int n = S->n;
+  struct matrix *X = matrix_create_zero(n, S->k);
+  for (int p = 0; p < S->k; p++) {
+    long double *x = S->x;
+    combine(S, S->V, S->Zr + (size_t) S->order[p] * S->m, x);
+    long double size = 0;
+    long double largest = 0;
+    for (int i = 0; i < n; i++) {
+      size += x[i] * x[i];
+      largest = fabsl(x[i]) > fabsl(largest) ? x[i] : largest;
+    }
+    size = largest < 0 ? -sqrtl(size) : sqrtl(size);
+    for (int i = 0; i < n; i++) {
+      matrix_row_data(X, i + 1)[p] = x[i] / size;
+    }
+  }
+  return X;
+}
+
+//krylov_schur(A, k, start, values, vectors, options, stats, symmetric,
+//   function) runs Lanczos (if symmetric) or Arnoldi on behalf of function.
+//requires: A, values are not NULL, values has room for k numbers
+//effects: may modify values, *vectors and *stats
+//         may print output
+//         may allocate heap memory
+static enum linalg_status krylov_schur(const struct linop * const A,
+                                       const int k,
+                                       const struct matrix * const start,
+                                       long double values[],
+                                       struct matrix ** const vectors,
+                                       const struct eigs_options * const options,
+                                       struct eigs_stats * const stats,
+                                       const bool symmetric,
+                                       const char * const function) {
+  assert(A);
+  assert(values);
+  struct solve S;
+  S.A = A;
+  S.options = options ? *options : EIGS_DEFAULTS;
+  S.stats.converged = false;
+  S.stats.iterations = 0;
+  S.stats.applications = 0;
+  S.stats.residual = 0;
+  S.symmetric = symmetric;
+  S.fresh = 0;
+  S.state = 0x9E3779B97F4A7C15ULL;
+  S.n = A->n;
+  S.k = k;
+  if (vectors) {
+    *vectors = NULL;
+  }
+  if (stats) {
+    *stats = S.stats;
+  }
+  const int n = S.n;
+  int rows = 0;
+  int columns = 0;
+  if (start) {
+    matrix_size(start, &rows, &columns);
+  }
+  if ((n < 1) || (start && (rows != n))) {
+    return linalg_report(LINALG_ERR_DIMENSION, function,
+                         "Invalid input. The operator and the start vectors "
+                         "must have the same dimension.");
+  } else if ((k < 1) || (k > n) || (S.options.block < 1) ||
+             ((S.options.subspace != 0) && (S.options.subspace < k + 2))) {
+    return linalg_report(LINALG_ERR_INVALID, function,
+                         "Invalid input. k must be between 1 and %d, the "
+                         "block at least 1 and the subspace 0 or at least "
+                         "k + 2.", n);
+  }
+  int m = S.options.subspace;
+  if (m == 0) {
+    m = 2 * k + 1 > 20 ? 2 * k + 1 : 20;
+  }
+  S.m = m = m < n ? m : n;
+  S.b = S.options.block < m - 1 ? S.options.block : (m > 1 ? m - 1 : 1);
+  //complex numbers first, then long doubles, then ints, so each is aligned
+  const size_t complexes = (size_t) m * m + m;
+  const size_t numbers = (size_t) (2 * m + S.b + 4) * n + 3 * (size_t) m * m +
+                         (size_t) (m + 1) * (m + 1) + 2 * (size_t) m;
+  S.bytes = complexes * sizeof(long double complex) +
+            numbers * sizeof(long double) + 2 * (size_t) m * sizeof(int);
+  S.work = malloc(S.bytes);
+  INSTRUMENT_ALLOC(S.bytes);
+  S.M = S.work;
+  S.c = S.M + (size_t) m * m;
+  S.V = (long double *) (S.c + m);
+  S.W = S.V + (size_t) m * n;
+  S.G = S.W + (size_t) m * n;
+  S.x = S.G + (size_t) S.b * n;
+  S.y = S.x + 2 * (size_t) n;
+  S.H = S.y + 2 * (size_t) n;
+  S.Zr = S.H + (size_t) m * m;
+  S.Zi = S.Zr + (size_t) m * m;
+  S.scratch = S.Zi + (size_t) m * m;
+  S.re = S.scratch + (size_t) (m + 1) * (m + 1);
+  S.im = S.re + m;
+  S.order = (int *) (S.im + m);
+  S.pivot = S.order + m;
+  //the start vectors (with pseudo-random ones to fill the first block)
+  const int given = columns < m - 1 ? columns : m - 1;
+  int count = given > S.b ? given : S.b;
+  count = count < m ? count : m;
+  for (int j = 0; j < count; j++) {
+    long double *v = S.V + (size_t) j * n;
+    if (j < given) {
+      for (int i = 0; i < n; i++) {
+        v[i] = matrix_row_cdata(start, i + 1)[j];
+      }
+    } else {
+      random_fill(&S.state, v, n);
+    }
+    orthonormalize(S.V, j, n, v, &S.state);
+    apply(&S, v, S.W + (size_t) j * n);
+  }
+  S.g = S.b < count ? S.b : count;
+  memcpy(S.G, S.W + (size_t) (count - S.g) * n,
+         (size_t) S.g * n * sizeof(long double));
+  expand(&S, count);
+  bool found = true;
+  for (;;) {
+    found = rayleigh_ritz(&S);
+    S.stats.iterations++;
+    if (!found) {
+      S.stats.converged = false;
+      break;
+    }
+    check(&S);
+    if (S.stats.converged || (S.stats.iterations >= S.options.max_iterations)) {
+      break;
+    }
+    expand(&S, restart(&S));
+  }
+  enum linalg_status status = LINALG_OK;
+  bool real = true;
+  for (int p = 0; found && (p < k); p++) {
+    real = real && (S.im[S.order[p]] == 0);
+  }
+  if (!found) {
+    status = linalg_report(LINALG_ERR_NO_CONVERGENCE, function,
+                           "The QR algorithm failed on the Ritz values.");
+  } else if (!real) {
+    status = linalg_report(LINALG_ERR_NOT_REAL, function,
+                           "A wanted eigenvalue is not real.");
+  } else {
+    for (int p = 0; p < k; p++) {
+      values[p] = S.re[S.order[p]];
+    }
+    if (vectors) {
+      *vectors = eigenvectors(&S);
+    }
+    if (!S.stats.converged) {
+      status = linalg_report(LINALG_ERR_NO_CONVERGENCE, function,
+                             "The residual is %Lg after %d iterations.",
+                             S.stats.residual, S.stats.iterations);
+    }
+  }
+  INSTRUMENT_FREE(S.bytes);
+  free(S.work);
+  if (stats) {
+    *stats = S.stats;
+  }
+  return status;
+}
+
+enum linalg_status eigs_power(const struct linop * const A,
+                              const struct vector * const start,
+                              long double * const lambda,
+                              struct vector ** const vector,
+                              const struct eigs_options * const options,
+                              struct eigs_stats * const stats) {
+  INSTRUMENT_SCOPE(eigs_power);
+  assert(A);
+  assert(lambda);
+  const struct eigs_options opt = options ? *options : EIGS_DEFAULTS;
+  struct eigs_stats st = {false, 0, 0, 0};
+  const int n = A->n;
+  INSTRUMENT_DIMS(n, n);
+  if (vector) {
+    *vector = NULL;
+  }
+  if ((n < 1) || (start && (vector_dim(start) != n))) {
+    if (stats) {
+      *stats = st;
+    }
+    return linalg_report(LINALG_ERR_DIMENSION, __func__,
+                         "Invalid input. The operator and the start vector "
+                         "must have the same dimension.");
+  }
+  struct vector *result = vector_create_zero(n);
+  long double *x = vector_data(result);
+  const size_t bytes = n * sizeof(long double);
+  long double *y = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  if (start) {
+    memcpy(x, vector_cdata(start), bytes);
+  }
+  long double size = sqrtl(dot(x, x, n));
+  if (size == 0) {
+    random_fill(&state, x, n);
+    size = sqrtl(dot(x, x, n));
+  }
+  for (int i = 0; i < n; i++) {
+    x[i] /= size;
+  }
+  long double theta = 0;
+  while (st.iterations < opt.max_iterations) {
+    A->apply(A->data, x, y);
+    st.applications++;
+    st.iterations++;
+    theta = dot(x, y, n);
+    long double sum = 0;
+    for (int i = 0; i < n; i++) {
+      const long double d = y[i] - theta * x[i];
+      sum += d * d;
+    }
+    INSTRUMENT_FLOPS(3LL * n);
+    const long double res = sqrtl(sum);
+    st.residual = res == 0 ? 0 : res / fabsl(theta);
+    if (st.residual <= opt.tolerance) {
+      st.converged = true;
+      break;
+    }
+    size = sqrtl(dot(y, y, n));
+    for (int i = 0; i < n; i++) {
+      x[i] = y[i] / size;
+    }
+  }
+  INSTRUMENT_FREE(bytes);
+  free(y);
+  *lambda = theta;
+  if (vector) {
+    *vector = result;
+  } else {
+    vector_destroy(result);
+  }
+  if (stats) {
+    *stats = st;
+  }
+  if (!st.converged) {
+    return linalg_report(LINALG_ERR_NO_CONVERGENCE, __func__,
+                         "The residual is %Lg after %d iterations.",
+                         st.residual, st.iterations);
+  }
+  return LINALG_OK;
+}
+
+enum linalg_status eigs_lanczos(const struct linop * const A, const int k,
+                                const struct matrix * const start,
+                                long double values[],
+                                struct matrix ** const vectors,
+                                const struct eigs_options * const options,
+                                struct eigs_stats * const stats) {
+  INSTRUMENT_SCOPE(eigs_lanczos);
+  INSTRUMENT_DIMS(A->n, k);
+  return krylov_schur(A, k, start, values, vectors, options, stats, true,
+                      __func__);
+}
+
+enum linalg_status eigs_arnoldi(const struct linop * const A, const int k,
+                                const struct matrix * const start,
+                                long double values[],
+                                struct matrix ** const vectors,
+                                const struct eigs_options * const options,
+                                struct eigs_stats * const stats) {
+  INSTRUMENT_SCOPE(eigs_arnoldi);
+  INSTRUMENT_DIMS(A->n, k);
+  return krylov_schur(A, k, start, values, vectors, options, stats, false,
+                      __func__);
+}
@@ -0,0 +1,125 @@
+#ifndef LINALG_EIGS_H
+#define LINALG_EIGS_H
+
+#include <stdbool.h>
+#include "krylov.h"
+#include "status.h"
+
+//eigen_and_diag.h finds every eigenvalue of a 2 x 2 or 3 x 3 matrix. The
+//   functions in this file find only the few eigenvalues of largest size of
+//   a large operator, a struct linop from krylov.h (so a struct matrix, a
+//   sparse matrix or any function that computes Ax):
+//     eigs_power    power iteration, for the dominant eigenpair
+//     eigs_lanczos  block Lanczos, for k eigenpairs of a symmetric operator
+//     eigs_arnoldi  restarted Arnoldi, for k eigenpairs of any operator
+//   Lanczos and Arnoldi extend an orthonormal basis of options->subspace
+//   vectors block by block, with the operator applied to options->block
+//   vectors per step, and take the Ritz pairs of the operator on its span.
+//   Until the k wanted pairs have converged, they restart from the span of
+//   the best Ritz vectors, which is what implicit restarting with the other
+//   Ritz values as shifts keeps (a Krylov-Schur restart). A restart cycle
+//   therefore costs about subspace / 2 applications plus O(n subspace^2)
+//   work to keep the basis orthonormal. Eigenvectors returned by an earlier
+//   call may be passed as the start of the next one.
+
+struct vector;
+struct matrix;
+
+//An enum eigs_target says which eigenvalues are wanted: those of largest
+//   absolute value, or those with the largest (real part, for a complex
+//   eigenvalue) value.
+enum eigs_target {
+  EIGS_LARGEST_MAGNITUDE,
+  EIGS_LARGEST_REAL
+};
+
+//A struct eigs_options controls a computation. It stops when, for each
+//   wanted pair (lambda, x) with x a unit vector, the norm of Ax - lambda x
+//   is at most tolerance times the largest wanted |lambda|, or after
+//   max_iterations iterations (restart cycles for Lanczos and Arnoldi).
+//   subspace is the size of the basis (0 picks max(2k + 1, 20)), and block
+//   the number of vectors the operator is applied to at a time. target is
+//   ignored by eigs_power.
+struct eigs_options {
+  long double tolerance;
+  int max_iterations;
+  int subspace;
+  int block;
+  enum eigs_target target;
+};
+
+//EIGS_DEFAULTS is used when no options are given: a tolerance of 1e-10, at
+//   most 1000 iterations, an automatic subspace, a block of one vector and
+//   the eigenvalues of largest magnitude.
+extern const struct eigs_options EIGS_DEFAULTS;
+
+//A struct eigs_stats describes a finished computation. residual is the
+//   largest relative residual of the wanted pairs in the last iteration.
+struct eigs_stats {
+  bool converged;
+  int iterations;
+  int applications;
+  long double residual;
+};
+
+//eigs_power(A, start, lambda, vector, options, stats) finds the eigenvalue
+//   of A of largest magnitude by power iteration from start (or from a
+//   fixed pseudo-random vector if start is NULL or zero) and stores it in
+//   *lambda. If vector is not NULL, *vector is set to a heap-allocated unit
+//   eigenvector that the caller must free with vector_destroy(). It returns
+//   LINALG_OK if the iteration converged, which needs the largest
+//   magnitude to belong to a single real eigenvalue; otherwise it stores the
+//   last estimates and reports LINALG_ERR_NO_CONVERGENCE. If start does not
+//   fit A, it reports LINALG_ERR_DIMENSION and sets *vector to NULL.
+//   options may be NULL (see EIGS_DEFAULTS), as may stats.
+//requires: A, lambda are not NULL
+//effects: modifies *lambda, *vector and *stats
+//         may print output
+//         allocates heap memory
+enum linalg_status eigs_power(const struct linop * const A,
+                              const struct vector * const start,
+                              long double * const lambda,
+                              struct vector ** const vector,
+                              const struct eigs_options * const options,
+                              struct eigs_stats * const stats);
+
+//eigs_lanczos(A, k, start, values, vectors, options, stats) finds the k
+//   eigenvalues of the symmetric operator A selected by options->target and
+//   stores them in values, in that order. If vectors is not NULL, *vectors
+//   is set to a heap-allocated n x k matrix whose columns are the matching
+//   unit eigenvectors, which the caller must free with matrix_destroy().
+//   The columns of start, if it is not NULL, begin the basis: pass the
+//   vectors of an earlier call to warm start. It returns LINALG_OK if every
+//   wanted pair converged; otherwise it stores the last estimates and
+//   reports LINALG_ERR_NO_CONVERGENCE. If k is not between 1 and n, or the
+//   options are invalid (subspace below k + 2 or block below 1), it reports
+//   LINALG_ERR_INVALID, and if start does not have n rows,
+//   LINALG_ERR_DIMENSION; then *vectors is set to NULL.
+//requires: A, values are not NULL, values has room for k numbers
+//          A is symmetric
+//effects: modifies values, *vectors and *stats
+//         may print output
+//         allocates heap memory
+enum linalg_status eigs_lanczos(const struct linop * const A, const int k,
+                                const struct matrix * const start,
+                                long double values[],
+                                struct matrix ** const vectors,
+                                const struct eigs_options * const options,
+                                struct eigs_stats * const stats);
+
+//eigs_arnoldi(A, k, start, values, vectors, options, stats) is like
+//   eigs_lanczos, but A may be any operator. If a wanted eigenvalue is not
+//   real, it reports LINALG_ERR_NOT_REAL, leaves values unchanged and sets
+//   *vectors to NULL.
+//requires: A, values are not NULL, values has room for k numbers
+//effects: may modify values, *vectors and *stats
+//         may print output
+//         may allocate heap memory
+enum linalg_status eigs_arnoldi(const struct linop * const A, const int k,
+                                const struct matrix * const start,
+                                long double values[],
+                                struct matrix ** const vectors,
+                                const struct eigs_options * const options,
+                                struct eigs_stats * const stats);
+
+#endif
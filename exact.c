@@ -0,0 +1,737 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix_core.h"
+#include "matrix_cache.h"
+#include "exact.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+//A struct bigint is an arbitrary-precision integer. Its magnitude is held in
+//   the first len of its cap 32-bit limbs, least significant first, with no
+//   leading zero limbs, so zero has len 0 and is never negative.
+struct bigint {
+  bool negative;
+  int len;
+  int cap;
+  uint32_t limb[];
+};
+
+//big_create(cap) returns a heap-allocated zero-filled bigint with len = cap
+//   limbs, which the caller must free with big_destroy().
+//requires: cap >= 0
+//effects: allocates heap memory
+static struct bigint *big_create(const int cap) {
+  const size_t bytes = sizeof(struct bigint) + cap * sizeof(uint32_t);
+  struct bigint *b = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  b->negative = false;
+  b->len = cap;
+  b->cap = cap;
+  memset(b->limb, 0, cap * sizeof(uint32_t));
+  return b;
+}
+
+//big_destroy(b) frees b if it is not NULL.
+//effects: frees heap memory
+static void big_destroy(struct bigint * const b) {
+  if (b) {
+    INSTRUMENT_FREE(sizeof(struct bigint) + b->cap * sizeof(uint32_t));
+    free(b);
+  }
+}
+
+//big_trim(b) drops the leading zero limbs of b.
+//requires: b is not NULL
+//effects: modifies *b
+static void big_trim(struct bigint * const b) {
+  while ((b->len > 0) && (b->limb[b->len - 1] == 0)) {
+    b->len--;
+  }
+  if (b->len == 0) {
+    b->negative = false;
+  }
+}
+
+//big_from_int128(x) returns x as a heap-allocated bigint.
+//effects: allocates heap memory
+static struct bigint *big_from_int128(const __int128 x) {
+  struct bigint *b = big_create(4);
+  unsigned __int128 u = x < 0 ? -(unsigned __int128) x : (unsigned __int128) x;
+  for (int i = 0; i < 4; i++) {
+    b->limb[i] = (uint32_t) u;
+    u >>= 32;
+  }
+  b->negative = x < 0;
+  big_trim(b);
+  return b;
+}
+
+//big_to_int64(b, x) stores b in *x and returns true if it fits in 64 bits.
+//   Otherwise it returns false.
+//requires: b, x are not NULL
+//effects: may modify *x
+static bool big_to_int64(const struct bigint * const b, int64_t * const x) {
+  if (b->len > 2) {
+    return false;
+  }
+  uint64_t u = 0;
+  for (int i = b->len - 1; i >= 0; i--) {
+    u = (u << 32) | b->limb[i];
+  }
+  if (!b->negative && (u <= INT64_MAX)) {
+    *x = u;
+    return true;
+  } else if (b->negative && (u - 1 <= INT64_MAX)) {
+    *x = -(int64_t) (u - 1) - 1;
+    return true;
+  }
+  return false;
+}
+
+//big_bit(b, i) returns bit i of the magnitude of b.
+//requires: b is not NULL, 0 <= i < 32 * b->len
+static unsigned big_bit(const struct bigint * const b, const int i) {
+  return (b->limb[i / 32] >> (i % 32)) & 1;
+}
+
+//big_to_ld(b) returns b rounded to the nearest long double (ties to even).
+//requires: b is not NULL
+static long double big_to_ld(const struct bigint * const b) {
+  if (b->len == 0) {
+    return 0;
+  }
+  const int bits = 32 * b->len - __builtin_clz(b->limb[b->len - 1]);
+  const int mantissa = LDBL_MANT_DIG < 64 ? LDBL_MANT_DIG : 64;
+  uint64_t top = 0;
+  int low = bits > mantissa ? bits - mantissa : 0;
+  for (int i = bits - 1; i >= low; i--) {
+    top = (top << 1) | big_bit(b, i);
+  }
+  if (low > 0) {
+    bool sticky = false;
+    for (int i = 0; i < low - 1 && !sticky; i++) {
+      sticky = big_bit(b, i);
+    }
+    if (big_bit(b, low - 1) && (sticky || (top & 1))) {
+      //rounding up may carry out of the mantissa
+      if (top == UINT64_MAX >> (64 - mantissa)) {
+        top = (uint64_t) 1 << (mantissa - 1);
+        low++;
+      } else {
+        top++;
+      }
+    }
+  }
+  const long double x = ldexpl(top, low);
+  return b->negative ? -x : x;
+}
+
+//mag_cmp(a, b) returns -1, 0 or 1 as the magnitude of a is below, equal to or
+//   above that of b.
+//requires: a, b are not NULL
+static int mag_cmp(const struct bigint * const a, const struct bigint * const b) {
+  if (a->len != b->len) {
+    return a->len < b->len ? -1 : 1;
+  }
+  for (int i = a->len - 1; i >= 0; i--) {
+    if (a->limb[i] != b->limb[i]) {
+      return a->limb[i] < b->limb[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+//mag_add(a, b) returns |a| + |b| as a heap-allocated bigint.
+//requires: a, b are not NULL
+//effects: allocates heap memory
+static struct bigint *mag_add(const struct bigint * const a,
+                              const struct bigint * const b) {
+  const int len = (a->len > b->len ? a->len : b->len) + 1;
+  struct bigint *r = big_create(len);
+  uint64_t carry = 0;
+  for (int i = 0; i < len; i++) {
+    carry += (i < a->len ? a->limb[i] : 0);
+    carry += (i < b->len ? b->limb[i] : 0);
+    r->limb[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+  big_trim(r);
+  return r;
+}
+
+//mag_sub(a, b) returns |a| - |b| as a heap-allocated bigint.
+//requires: a, b are not NULL, |a| >= |b|
+//effects: allocates heap memory
+static struct bigint *mag_sub(const struct bigint * const a,
+                              const struct bigint * const b) {
+  struct bigint *r = big_create(a->len);
+  int64_t borrow = 0;
+  for (int i = 0; i < a->len; i++) {
+    int64_t t = (int64_t) a->limb[i] - (i < b->len ? b->limb[i] : 0) - borrow;
+    borrow = t < 0;
+    r->limb[i] = (uint32_t) (t + (borrow << 32));
+  }
+  assert(borrow == 0);
+  big_trim(r);
+  return r;
+}
+
+//big_sub(a, b) returns a - b as a heap-allocated bigint.
+//requires: a, b are not NULL
+//effects: allocates heap memory
+static struct bigint *big_sub(const struct bigint * const a,
+                              const struct bigint * const b) {
+  struct bigint *r = NULL;
+  if (a->negative != b->negative) {
+    r = mag_add(a, b);
+    r->negative = a->negative;
+  } else if (mag_cmp(a, b) >= 0) {
+    r = mag_sub(a, b);
+    r->negative = a->negative;
+  } else {
+    r = mag_sub(b, a);
+    r->negative = !a->negative;
+  }
+  big_trim(r);
+  return r;
+}
+
+//big_mul(a, b) returns ab as a heap-allocated bigint.
+//requires: a, b are not NULL
+//effects: allocates heap memory
+static struct bigint *big_mul(const struct bigint * const a,
+                              const struct bigint * const b) {
+  struct bigint *r = big_create(a->len + b->len);
+  for (int i = 0; i < a->len; i++) {
+    uint64_t carry = 0;
+    for (int j = 0; j < b->len; j++) {
+      carry += (uint64_t) a->limb[i] * b->limb[j] + r->limb[i + j];
+      r->limb[i + j] = (uint32_t) carry;
+      carry >>= 32;
+    }
+    r->limb[i + b->len] = (uint32_t) carry;
+  }
+  r->negative = a->negative != b->negative;
+  big_trim(r);
+  return r;
+}
+
+//big_div(u, v) returns u / v, rounded towards zero, as a heap-allocated
+//   bigint (Knuth's algorithm D on 32-bit limbs).
+//requires: u, v are not NULL, v is not zero
+//effects: allocates heap memory
+static struct bigint *big_div(const struct bigint * const u,
+                              const struct bigint * const v) {
+  const int m = u->len;
+  const int n = v->len;
+  assert(n > 0);
+  if (m < n) {
+    return big_create(0);
+  }
+  struct bigint *q = big_create(m - n + 1);
+  if (n == 1) {
+    uint64_t rem = 0;
+    for (int j = m - 1; j >= 0; j--) {
+      rem = (rem << 32) | u->limb[j];
+      q->limb[j] = (uint32_t) (rem / v->limb[0]);
+      rem %= v->limb[0];
+    }
+  } else {
+    //normalize so that the top limb of the divisor has its high bit set
+    const int s = __builtin_clz(v->limb[n - 1]);
+    const size_t bytes = (m + 1 + n) * sizeof(uint32_t);
+    uint32_t *un = malloc(bytes);
+    INSTRUMENT_ALLOC(bytes);
+    uint32_t *vn = un + m + 1;
+    for (int i = n - 1; i > 0; i--) {
+      vn[i] = (v->limb[i] << s) | (uint32_t) ((uint64_t) v->limb[i - 1] >> (32 - s));
+    }
+    vn[0] = v->limb[0] << s;
+    un[m] = (uint32_t) ((uint64_t) u->limb[m - 1] >> (32 - s));
+    for (int i = m - 1; i > 0; i--) {
+      un[i] = (u->limb[i] << s) | (uint32_t) ((uint64_t) u->limb[i - 1] >> (32 - s));
+    }
+    un[0] = u->limb[0] << s;
+    for (int j = m - n; j >= 0; j--) {
+      const uint64_t top = ((uint64_t) un[j + n] << 32) | un[j + n - 1];
+      uint64_t qhat = top / vn[n - 1];
+      uint64_t rhat = top % vn[n - 1];
+      while ((qhat >> 32) ||
+             (qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2]))) {
+        qhat--;
+        rhat += vn[n - 1];
+        if (rhat >> 32) {
+          break;
+        }
+      }
+      //multiply and subtract, adding back if qhat was one too large
+      int64_t k = 0;
+      int64_t t = 0;
+      for (int i = 0; i < n; i++) {
+        const uint64_t p = qhat * vn[i];
+        t = un[i + j] - k - (int64_t) (p & 0xFFFFFFFF);
+        un[i + j] = (uint32_t) t;
+        k = (int64_t) (p >> 32) - (t >> 32);
+      }
+      t = un[j + n] - k;
+      un[j + n] = (uint32_t) t;
+      q->limb[j] = (uint32_t) qhat;
+      if (t < 0) {
+        q->limb[j]--;
+        uint64_t carry = 0;
+        for (int i = 0; i < n; i++) {
+          carry += (uint64_t) un[i + j] + vn[i];
+          un[i + j] = (uint32_t) carry;
+          carry >>= 32;
+        }
+        un[j + n] += (uint32_t) carry;
+      }
+    }
+    INSTRUMENT_FREE(bytes);
+    free(un);
+  }
+  q->negative = u->negative != v->negative;
+  big_trim(q);
+  return q;
+}
+
+//big_format(b, out, size) writes b to out as a null-terminated decimal
+//   string and returns true if it fits in size characters. Otherwise it
+//   returns false.
+//requires: b, out are not NULL, size > 0
+//effects: may modify out
+//         allocates and frees heap memory
+static bool big_format(const struct bigint * const b, char * const out,
+                       const int size) {
+  //each 32-bit limb holds fewer than 10 decimal digits
+  const int max = 10 * b->len + 2;
+  const size_t bytes = max + b->len * sizeof(uint32_t);
+  uint32_t *mag = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  char *digits = (char *) (mag + b->len);
+  memcpy(mag, b->limb, b->len * sizeof(uint32_t));
+  int len = b->len;
+  int count = 0;
+  //peel off nine digits at a time, least significant first
+  do {
+    uint64_t rem = 0;
+    for (int i = len - 1; i >= 0; i--) {
+      rem = (rem << 32) | mag[i];
+      mag[i] = (uint32_t) (rem / 1000000000);
+      rem %= 1000000000;
+    }
+    while ((len > 0) && (mag[len - 1] == 0)) {
+      len--;
+    }
+    for (int i = 0; i < 9 && (len > 0 || rem > 0 || i == 0); i++) {
+      digits[count++] = '0' + rem % 10;
+      rem /= 10;
+    }
+  } while (len > 0);
+  if (b->negative) {
+    digits[count++] = '-';
+  }
+  const bool fits = count < size;
+  if (fits) {
+    for (int i = 0; i < count; i++) {
+      out[i] = digits[count - 1 - i];
+    }
+    out[count] = '\0';
+  }
+  INSTRUMENT_FREE(bytes);
+  free(mag);
+  return fits;
+}
+
+
+//An exact_int is an exact integer: small while the value fits in 64 bits, in
+//   which case big is NULL, and big otherwise.
+struct exact_int {
+  int64_t small;
+  struct bigint *big;
+};
+
+//as_big(x) returns x as a bigint; if x is small, the bigint is
+//   heap-allocated and *allocated is set to true.
+//requires: x, allocated are not NULL
+//effects: may allocate heap memory
+//         may modify *allocated
+static struct bigint *as_big(const struct exact_int * const x,
+                             bool * const allocated) {
+  if (x->big) {
+    return x->big;
+  }
+  *allocated = true;
+  return big_from_int128(x->small);
+}
+
+//exact_is_zero(x) returns true if x is zero.
+//requires: x is not NULL
+static bool exact_is_zero(const struct exact_int * const x) {
+  return !x->big && (x->small == 0);
+}
+
+//exact_to_ld(x) returns x rounded to the nearest long double.
+//requires: x is not NULL
+static long double exact_to_ld(const struct exact_int * const x) {
+  return x->big ? big_to_ld(x->big) : (long double) x->small;
+}
+
+//exact_update(x, p, y, z, d) replaces x by (px - yz) / d, which must be an
+//   integer; this is the step of Bareiss' elimination.
+//requires: x, p, y, z, d are not NULL, d is not zero
+//effects: modifies *x
+//         may allocate and free heap memory
+static void exact_update(struct exact_int * const x,
+                         const struct exact_int * const p,
+                         const struct exact_int * const y,
+                         const struct exact_int * const z,
+                         const struct exact_int * const d) {
+  if (!x->big && !p->big && !y->big && !z->big && !d->big) {
+    //each product is below 2^126 in magnitude, so the difference fits
+    const __int128 t = (__int128) p->small * x->small -
+                       (__int128) y->small * z->small;
+    assert(t % d->small == 0);
+    const __int128 q = t / d->small;
+    if ((q >= INT64_MIN) && (q <= INT64_MAX)) {
+      x->small = (int64_t) q;
+    } else {
+      x->big = big_from_int128(q);
+    }
+    return;
+  }
+  bool own[5] = {false, false, false, false, false};
+  struct bigint *bx = as_big(x, &own[0]);
+  struct bigint *bp = as_big(p, &own[1]);
+  struct bigint *by = as_big(y, &own[2]);
+  struct bigint *bz = as_big(z, &own[3]);
+  struct bigint *bd = as_big(d, &own[4]);
+  struct bigint *px = big_mul(bp, bx);
+  struct bigint *yz = big_mul(by, bz);
+  struct bigint *t = big_sub(px, yz);
+  struct bigint *q = big_div(t, bd);
+  big_destroy(px);
+  big_destroy(yz);
+  big_destroy(t);
+  big_destroy(x->big);
+  x->big = NULL;
+  struct bigint *operands[5] = {bx, bp, by, bz, bd};
+  for (int i = 1; i < 5; i++) {
+    if (own[i]) {
+      big_destroy(operands[i]);
+    }
+  }
+  if (own[0]) {
+    big_destroy(bx);
+  }
+  if (big_to_int64(q, &x->small)) {
+    big_destroy(q);
+  } else {
+    x->big = q;
+  }
+}
+
+//exact_copy(x, y) makes x an independent copy of y.
+//requires: x, y are not NULL
+//effects: modifies *x
+//         may allocate and free heap memory
+static void exact_copy(struct exact_int * const x,
+                       const struct exact_int * const y) {
+  big_destroy(x->big);
+  x->big = NULL;
+  x->small = y->small;
+  if (y->big) {
+    x->big = big_create(y->big->len);
+    x->big->negative = y->big->negative;
+    memcpy(x->big->limb, y->big->limb, y->big->len * sizeof(uint32_t));
+  }
+}
+
+
+//A struct bareiss holds an m x n integer matrix (row-major) during
+//   elimination, with its rank, the sign of the row permutation applied to it
+//   and its last pivot, which divides every entry of the next step.
+struct bareiss {
+  int m;
+  int n;
+  struct exact_int *entry;
+  int rank;
+  int sign;
+  struct exact_int pivot;
+};
+
+//bareiss_create(A) returns the entries of the integer matrix A through a
+//   heap-allocated pointer that the caller must free with bareiss_destroy().
+//requires: A is not NULL, A is integral
+//effects: allocates heap memory
+static struct bareiss *bareiss_create(const struct matrix * const A) {
+  struct bareiss *X = malloc(sizeof(struct bareiss));
+  matrix_size(A, &X->m, &X->n);
+  const size_t bytes = (size_t) X->m * X->n * sizeof(struct exact_int);
+  X->entry = malloc(bytes);
+  INSTRUMENT_ALLOC(sizeof(struct bareiss) + bytes);
+  for (int i = 0; i < X->m; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    for (int j = 0; j < X->n; j++) {
+      X->entry[i * X->n + j].small = (int64_t) row[j];
+      X->entry[i * X->n + j].big = NULL;
+    }
+  }
+  X->rank = 0;
+  X->sign = 1;
+  X->pivot.small = 1;
+  X->pivot.big = NULL;
+  return X;
+}
+
+//bareiss_destroy(X) frees X.
+//requires: X is not NULL
+//effects: frees heap memory
+static void bareiss_destroy(struct bareiss * const X) {
+  for (int i = 0; i < X->m * X->n; i++) {
+    big_destroy(X->entry[i].big);
+  }
+  big_destroy(X->pivot.big);
+  INSTRUMENT_FREE(sizeof(struct bareiss) +
+                  (size_t) X->m * X->n * sizeof(struct exact_int));
+  free(X->entry);
+  free(X);
+}
+
+//bareiss_eliminate(X, jordan) runs Bareiss' elimination on X, taking the
+//   first nonzero entry of each column as its pivot. Only the rows below each
+//   pivot are eliminated unless jordan is true, in which case the rows above
+//   are as well, so every pivot column ends up zero apart from its pivot.
+//   Either way all pivots equal the last one, the determinant of the leading
+//   rank x rank block of the row permuted matrix.
+//requires: X is not NULL
+//effects: modifies *X
+//         may allocate and free heap memory
+static void bareiss_eliminate(struct bareiss * const X, const bool jordan) {
+  const int m = X->m;
+  const int n = X->n;
+  struct exact_int *e = X->entry;
+  const struct exact_int zero = {0, NULL};
+  int r = 0;
+  for (int c = 0; (c < n) && (r < m); c++) {
+    int p = r;
+    while ((p < m) && exact_is_zero(&e[p * n + c])) {
+      p++;
+    }
+    if (p == m) {
+      continue;
+    }
+    if (p != r) {
+      for (int j = 0; j < n; j++) {
+        const struct exact_int t = e[p * n + j];
+        e[p * n + j] = e[r * n + j];
+        e[r * n + j] = t;
+      }
+      X->sign = -X->sign;
+    }
+    const struct exact_int *pivot = &e[r * n + c];
+    for (int i = jordan ? 0 : r + 1; i < m; i++) {
+      if (i == r) {
+        continue;
+      }
+      const struct exact_int *y = &e[i * n + c];
+      //the entries of row r left of c are zero, so earlier columns of the
+      //   rows above are only rescaled
+      for (int j = (i < r) ? 0 : c + 1; j < n; j++) {
+        if (j != c) {
+          exact_update(&e[i * n + j], pivot, y, j < c ? &zero : &e[r * n + j],
+                       &X->pivot);
+        }
+      }
+      big_destroy(e[i * n + c].big);
+      e[i * n + c] = zero;
+    }
+    INSTRUMENT_FLOPS(3LL * ((jordan ? m : m - r) - 1) * (jordan ? n : n - c));
+    exact_copy(&X->pivot, pivot);
+    r++;
+  }
+  X->rank = r;
+}
+
+//integral_input(A, function) returns LINALG_OK if A is a non-empty integral
+//   matrix. Otherwise it reports the error on behalf of function and returns
+//   its status.
+//requires: A is not NULL
+//effects: may print output
+static enum linalg_status integral_input(const struct matrix * const A,
+                                         const char * const function) {
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  if ((m == 0) || (n == 0)) {
+    return linalg_report(LINALG_ERR_EMPTY, function,
+                         "The input matrix must not be empty.");
+  } else if (!matrix_is_integral(A)) {
+    return linalg_report(LINALG_ERR_INVALID, function,
+                         "Every entry must be an integer below 2^63 in "
+                         "magnitude.");
+  }
+  return LINALG_OK;
+}
+
+bool matrix_is_integral(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_is_integral);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!(cache->valid & CACHE_INTEGRAL)) {
+    bool integral = true;
+    for (int i = 1; i <= m && integral; i++) {
+      const long double *row = matrix_row_cdata(A, i);
+      for (int j = 0; j < n && integral; j++) {
+        integral = (row[j] == truncl(row[j])) && (fabsl(row[j]) < 0x1p63L);
+      }
+    }
+    cache->integral = integral;
+    cache->valid |= CACHE_INTEGRAL;
+  }
+  return cache->integral;
+}
+
+//exact_det(A) returns the determinant of the integral square matrix A after
+//   Bareiss' elimination, through a heap-allocated pointer that the caller
+//   must free with bareiss_destroy(); the determinant is its pivot field
+//   times its sign, or zero if its rank is below its size.
+//requires: A is not NULL, A is square, non-empty and integral
+//effects: allocates heap memory
+static struct bareiss *exact_det(const struct matrix * const A) {
+  struct bareiss *X = bareiss_create(A);
+  bareiss_eliminate(X, false);
+  if (X->rank < X->n) {
+    big_destroy(X->pivot.big);
+    X->pivot.big = NULL;
+    X->pivot.small = 0;
+  } else if (X->sign < 0) {
+    if (X->pivot.big) {
+      X->pivot.big->negative = !X->pivot.big->negative;
+    } else if (X->pivot.small == INT64_MIN) {
+      X->pivot.big = big_from_int128(-(__int128) INT64_MIN);
+    } else {
+      X->pivot.small = -X->pivot.small;
+    }
+  }
+  return X;
+}
+
+//square_integral_input(A, function) is like integral_input, but A must also
+//   be square.
+//requires: A is not NULL
+//effects: may print output
+static enum linalg_status square_integral_input(const struct matrix * const A,
+                                                const char * const function) {
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  if ((m != n) || (m < 1)) {
+    return linalg_report(LINALG_ERR_NOT_SQUARE, function,
+                         "Invalid input. Matrix must be n x n where n is "
+                         "positive.");
+  }
+  return integral_input(A, function);
+}
+
+enum linalg_status matrix_det_exact(const struct matrix * const A,
+                                    long double * const det) {
+  INSTRUMENT_SCOPE(matrix_det_exact);
+  assert(A);
+  assert(det);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  const enum linalg_status status = square_integral_input(A, __func__);
+  if (status != LINALG_OK) {
+    return status;
+  }
+  struct bareiss *X = exact_det(A);
+  *det = exact_to_ld(&X->pivot);
+  bareiss_destroy(X);
+  return LINALG_OK;
+}
+
+enum linalg_status matrix_det_exact_string(const struct matrix * const A,
+                                           char * const out, const int size) {
+  INSTRUMENT_SCOPE(matrix_det_exact);
+  assert(A);
+  assert(out);
+  assert(size > 0);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  enum linalg_status status = square_integral_input(A, __func__);
+  if (status != LINALG_OK) {
+    return status;
+  }
+  struct bareiss *X = exact_det(A);
+  bool allocated = false;
+  struct bigint *det = as_big(&X->pivot, &allocated);
+  if (!big_format(det, out, size)) {
+    status = linalg_report(LINALG_ERR_INVALID, __func__,
+                           "The buffer is too small for the determinant.");
+  }
+  if (allocated) {
+    big_destroy(det);
+  }
+  bareiss_destroy(X);
+  return status;
+}
+
+enum linalg_status matrix_rank_exact(const struct matrix * const A,
+                                     int * const rank) {
+  INSTRUMENT_SCOPE(matrix_rank_exact);
+  assert(A);
+  assert(rank);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  const enum linalg_status status = integral_input(A, __func__);
+  if (status != LINALG_OK) {
+    return status;
+  }
+  struct bareiss *X = bareiss_create(A);
+  bareiss_eliminate(X, false);
+  *rank = X->rank;
+  bareiss_destroy(X);
+  return LINALG_OK;
+}
+
+struct matrix *RREF_exact(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(RREF_exact);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if (integral_input(A, __func__) != LINALG_OK) {
+    return NULL;
+  }
+  struct bareiss *X = bareiss_create(A);
+  bareiss_eliminate(X, true);
+  //each pivot row divided by the common pivot is the row of the RREF
+  struct matrix *result = matrix_create_zero(m, n);
+  const long double d = exact_to_ld(&X->pivot);
+  for (int i = 0; i < X->rank; i++) {
+    long double *row = matrix_row_data(result, i + 1);
+    for (int j = 0; j < n; j++) {
+      const struct exact_int *x = &X->entry[i * n + j];
+      if (!x->big && !X->pivot.big && (x->small == X->pivot.small)) {
+        row[j] = 1;
+      } else if (!exact_is_zero(x)) {
+        row[j] = exact_to_ld(x) / d;
+      }
+    }
+  }
+  INSTRUMENT_FLOPS((long long) X->rank * n);
+  bareiss_destroy(X);
+  return result;
+}
@@ -0,0 +1,71 @@
+#ifndef LINALG_EXACT_H
+#define LINALG_EXACT_H
+
+#include <stdbool.h>
+#include "status.h"
+
+//Matrices with integer entries can be reduced without any rounding. The
+//   functions in this file use Bareiss' fraction-free elimination, in which
+//   every intermediate value is itself a determinant of a submatrix and
+//   every division is exact, so the determinant, rank and RREF of an n x n
+//   integer matrix take O(n^3) exact operations and never need PRECISION.
+//   Values are kept in 64-bit integers while they fit and move to
+//   arbitrary-precision integers when they do not, so the results are exact
+//   whatever the size of the entries; only the final conversion to long
+//   double rounds.
+//An entry counts as an integer if it is a whole number whose magnitude is
+//   below 2^63.
+
+struct matrix;
+
+//matrix_is_integral(A) returns true if every entry of A is an integer (see
+//   above). The answer is kept with A until A is modified.
+//requires: A is not NULL
+//effects: may allocate heap memory
+bool matrix_is_integral(const struct matrix * const A);
+
+//matrix_det_exact(A, det) stores the exact determinant of the integer
+//   matrix A, rounded to the nearest long double, in *det and returns
+//   LINALG_OK if possible. Otherwise (A is not square, is empty or has an
+//   entry that is not an integer) it reports the error (see status.h),
+//   leaves *det unchanged and returns its status.
+//requires: A, det are not NULL
+//effects: may modify *det
+//         may print output
+//         may allocate heap memory
+enum linalg_status matrix_det_exact(const struct matrix * const A,
+                                    long double * const det);
+
+//matrix_det_exact_string(A, out, size) is like matrix_det_exact, but writes
+//   every digit of the determinant to out as a null-terminated decimal
+//   string. If the digits do not fit in size characters, it reports
+//   LINALG_ERR_INVALID and leaves out unchanged.
+//requires: A, out are not NULL, size > 0
+//effects: may modify out
+//         may print output
+//         may allocate heap memory
+enum linalg_status matrix_det_exact_string(const struct matrix * const A,
+                                           char * const out, const int size);
+
+//matrix_rank_exact(A, rank) stores the exact rank of the integer matrix A in
+//   *rank and returns LINALG_OK if possible. Otherwise it reports the error,
+//   leaves *rank unchanged and returns its status.
+//requires: A, rank are not NULL
+//effects: may modify *rank
+//         may print output
+//         may allocate heap memory
+enum linalg_status matrix_rank_exact(const struct matrix * const A,
+                                     int * const rank);
+
+//RREF_exact(A) returns the RREF of the integer matrix A through a
+//   heap-allocated matrix pointer that the caller must free with
+//   matrix_destroy(). The RREF is found exactly: every leading entry is
+//   exactly 1, every zero is exactly 0, and each other entry is a fraction
+//   that is only rounded when it is stored. If A is empty or not integral,
+//   it outputs an error message and returns NULL.
+//requires: A is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct matrix *RREF_exact(const struct matrix * const A);
+
+#endif
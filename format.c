@@ -0,0 +1,215 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "format.h"
+#include "instrument.h"
+#include "settings.h"
+
+//See header file for documentation
+
+struct text_buffer {
+  char *data;
+  int length;
+  int capacity;
+  bool growable;
+};
+
+//two-digit lookup table used to convert integers two digits at a time
+static const char DIGIT_PAIRS[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536"
+  "37383940414243444546474849505152535455565758596061626364656667686970717273"
+  "7475767778798081828384858687888990919293949596979899";
+
+static const unsigned long long POWERS_OF_TEN[] = 
+  {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+   100000000ULL, 1000000000ULL};
+
+
+struct text_buffer *text_buffer_create() {
+  struct text_buffer *tb = malloc(sizeof(struct text_buffer));
+  tb->capacity = 256;
+  tb->data = malloc(tb->capacity);
+  INSTRUMENT_ALLOC(sizeof(struct text_buffer) + tb->capacity);
+  tb->data[0] = '\0';
+  tb->length = 0;
+  tb->growable = true;
+  return tb;
+}
+
+struct text_buffer *text_buffer_wrap(char * const buf, const int size) {
+  assert(size >= 0);
+  assert(buf || size == 0);
+  struct text_buffer *tb = malloc(sizeof(struct text_buffer));
+  INSTRUMENT_ALLOC(sizeof(struct text_buffer));
+  tb->data = buf;
+  tb->capacity = size;
+  tb->length = 0;
+  tb->growable = false;
+  if (size > 0) {
+    buf[0] = '\0';
+  }
+  return tb;
+}
+
+//reserve(tb, n) makes sure a growable *tb has room for n more chars plus the
+//   terminating NUL.
+//effects: may modify *tb
+static void reserve(struct text_buffer * const tb, const int n) {
+  if (tb->growable && tb->length + n + 1 > tb->capacity) {
+    INSTRUMENT_FREE(tb->capacity);
+    while (tb->length + n + 1 > tb->capacity) {
+      tb->capacity *= 2;
+    }
+    tb->data = realloc(tb->data, tb->capacity);
+    INSTRUMENT_ALLOC(tb->capacity);
+  }
+}
+
+void text_buffer_append(struct text_buffer * const tb, const char * const s,
+                        const int n) {
+  assert(tb);
+  assert(s);
+  reserve(tb, n);
+  if (tb->length + n < tb->capacity) {
+    memcpy(tb->data + tb->length, s, n);
+  } else if (tb->length + 1 < tb->capacity) {
+    memcpy(tb->data + tb->length, s, tb->capacity - 1 - tb->length);
+  }
+  tb->length += n;
+}
+
+void text_buffer_append_char(struct text_buffer * const tb, const char c) {
+  assert(tb);
+  reserve(tb, 1);
+  if (tb->length + 1 < tb->capacity) {
+    tb->data[tb->length] = c;
+  }
+  tb->length++;
+}
+
+//integer_path(x, decimals) returns true if x, scaled by 10^decimals, is
+//   below 2^63, so that the scaled value still holds its halves and
+//   format_fixed can round and convert it without snprintf.
+//requires: 0 <= decimals <= 9
+static bool integer_path(const long double x, const int decimals) {
+  return isfinite(x) && (fabsl(x) * POWERS_OF_TEN[decimals] < 9.2e18L);
+}
+
+void text_buffer_append_number(struct text_buffer * const tb,
+                               const long double x) {
+  assert(tb);
+  long double value = x;
+  if ((-PRECISION < x) && (PRECISION > x)) {
+    value = 0;
+  }
+  if (integer_path(value, PRINT_DECIMALS)) {
+    char temp[PRINT_WIDTH + 64];
+    text_buffer_append(tb, temp,
+                       format_fixed(value, PRINT_WIDTH, PRINT_DECIMALS, temp));
+  } else {
+    //a huge value can need more than a hundred digits
+    const int n = snprintf(NULL, 0, "%*.*Lf", PRINT_WIDTH, PRINT_DECIMALS,
+                           value);
+    char *temp = malloc(n + 1);
+    snprintf(temp, n + 1, "%*.*Lf", PRINT_WIDTH, PRINT_DECIMALS, value);
+    text_buffer_append(tb, temp, n);
+    free(temp);
+  }
+}
+
+int text_buffer_length(const struct text_buffer * const tb) {
+  assert(tb);
+  return tb->length;
+}
+
+const char *text_buffer_data(struct text_buffer * const tb) {
+  assert(tb);
+  if (tb->capacity == 0) {
+    return "";
+  } else if (tb->length < tb->capacity) {
+    tb->data[tb->length] = '\0';
+  } else {
+    tb->data[tb->capacity - 1] = '\0';
+  }
+  return tb->data;
+}
+
+void text_buffer_write(struct text_buffer * const tb, FILE * const out) {
+  assert(tb);
+  assert(out);
+  const int stored = tb->length < tb->capacity ? tb->length : 
+    (tb->capacity > 0 ? tb->capacity - 1 : 0);
+  fwrite(tb->data, 1, stored, out);
+}
+
+void text_buffer_destroy(struct text_buffer * const tb) {
+  if (!tb) {
+    return;
+  } else {
+    if (tb->growable) {
+      INSTRUMENT_FREE(tb->capacity);
+      free(tb->data);
+    }
+    INSTRUMENT_FREE(sizeof(struct text_buffer));
+    free(tb);
+  }
+}
+
+
+int format_fixed(const long double x, const int width, const int decimals,
+                 char * const out) {
+  assert(out);
+  assert(0 <= decimals && decimals <= 9);
+  if (!integer_path(x, decimals)) {
+    //too large (or not a number) for the integer path; snprintf returns the
+    //   length x needs, not the length it stored
+    const int n = snprintf(out, 64, "%*.*Lf", width, decimals, x);
+    return n < 64 ? n : 63;
+  }
+  //x 10^decimals is rounded to the nearest integer like printf rounds the
+  //   exact value: a product that lands on a half is decided by its rounding
+  //   error, which fmal finds exactly, and true halves go to the even integer
+  const long double scaled = fabsl(x) * POWERS_OF_TEN[decimals];
+  long double nearest = nearbyintl(scaled);
+  if (fabsl(scaled - nearest) == 0.5L) {
+    const long double error = fmal(fabsl(x), POWERS_OF_TEN[decimals], -scaled);
+    if (error != 0) {
+      nearest = error > 0 ? ceill(scaled) : floorl(scaled);
+    }
+  }
+  unsigned long long q = (unsigned long long) nearest;
+  //digits are produced backwards into the tail of a scratch buffer
+  char digits[32];
+  int pos = 32;
+  int frac_left = decimals;
+  while (frac_left >= 2) {
+    const int pair = q % 100;
+    q /= 100;
+    digits[--pos] = DIGIT_PAIRS[2 * pair + 1];
+    digits[--pos] = DIGIT_PAIRS[2 * pair];
+    frac_left -= 2;
+  }
+  if (frac_left == 1) {
+    digits[--pos] = '0' + q % 10;
+    q /= 10;
+  }
+  if (decimals > 0) {
+    digits[--pos] = '.';
+  }
+  do {
+    digits[--pos] = '0' + q % 10;
+    q /= 10;
+  } while (q > 0);
+  if (signbit(x)) {
+    digits[--pos] = '-';
+  }
+  const int len = 32 - pos;
+  const int pad = width > len ? width - len : 0;
+  memset(out, ' ', pad);
+  memcpy(out + pad, digits + pos, len);
+  out[pad + len] = '\0';
+  return pad + len;
+}
@@ -0,0 +1,79 @@
+#ifndef LINALG_FORMAT_H
+#define LINALG_FORMAT_H
+
+#include <stdio.h>
+
+//A struct text_buffer accumulates formatted text so that it can be handed to
+//   the caller (or to a FILE *) in one piece instead of one printf per entry.
+struct text_buffer;
+
+//text_buffer_create() returns a heap-allocated, growable text buffer that the
+//   caller must free using text_buffer_destroy().
+//effects: allocates heap memory
+struct text_buffer *text_buffer_create();
+
+//text_buffer_wrap(buf, size) returns a heap-allocated text buffer that writes
+//   into the caller-supplied array buf of size chars. Text that does not fit
+//   is dropped but still counted, so text_buffer_length() reports the size
+//   that would have been needed (like snprintf). The caller must free the
+//   pointer using text_buffer_destroy(); buf itself is not freed.
+//requires: buf is not NULL if size > 0
+//          size >= 0
+//effects: allocates heap memory
+struct text_buffer *text_buffer_wrap(char * const buf, const int size);
+
+//text_buffer_append(tb, s, n) appends the first n chars of s to *tb.
+//requires: tb and s are not NULL
+//effects: modifies *tb
+void text_buffer_append(struct text_buffer * const tb, const char * const s,
+                        const int n);
+
+//text_buffer_append_char(tb, c) appends c to *tb.
+//requires: tb is not NULL
+//effects: modifies *tb
+void text_buffer_append_char(struct text_buffer * const tb, const char c);
+
+//text_buffer_append_number(tb, x) appends x right-aligned in a field of
+//   PRINT_WIDTH characters with PRINT_DECIMALS digits after the decimal
+//   point (the same text printf("%*.*Lf") produces, see format_fixed).
+//   Values within PRECISION of zero are written as zero.
+//requires: tb is not NULL
+//effects: modifies *tb
+void text_buffer_append_number(struct text_buffer * const tb,
+                               const long double x);
+
+//text_buffer_length(tb) returns the number of chars appended to *tb so far,
+//   including any that did not fit in a wrapped buffer.
+//requires: tb is not NULL
+int text_buffer_length(const struct text_buffer * const tb);
+
+//text_buffer_data(tb) returns the NUL-terminated text stored in *tb. The 
+//   pointer is valid until the next append or text_buffer_destroy().
+//requires: tb is not NULL
+const char *text_buffer_data(struct text_buffer * const tb);
+
+//text_buffer_write(tb, out) writes the stored text of *tb to out with a single
+//   fwrite call.
+//requires: tb and out are not NULL
+//effects: prints output
+void text_buffer_write(struct text_buffer * const tb, FILE * const out);
+
+//text_buffer_destroy(tb) frees heap memory allocated to tb if it is not NULL.
+//effects: may free heap memory
+void text_buffer_destroy(struct text_buffer * const tb);
+
+//format_fixed(x, width, decimals, out) writes x into out as printf would with
+//   "%*.*Lf", using a fast integer conversion for values below 2^63 once
+//   scaled by 10^decimals. Like glibc's printf, it rounds the exact binary
+//   value of x, with exact ties going to the even digit. It returns
+//   the number of chars written (not counting the terminating NUL). out must
+//   have room for at least width + 1 chars, or 64 chars if that is more. A
+//   value that needs more than 63 chars is cut to the first 63
+//   (text_buffer_append_number prints it whole).
+//requires: out is not NULL
+//          0 <= decimals <= 9
+//effects: modifies out
+int format_fixed(const long double x, const int width, const int decimals,
+                 char * const out);
+
+#endif
@@ -0,0 +1,302 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "gram.h"
+#include "instrument.h"
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+//rows gathered for one symmetric rank-k update
+static const int CHUNK = 64;
+
+struct gram {
+  int n;
+  bool rhs;
+  long long count;
+  //A^T A by rows, of which only the upper triangle is kept
+  long double *g;
+  //A^T b
+  long double *atb;
+  long double btb;
+  size_t bytes;
+};
+
+
+struct gram *gram_create(const int n, const bool rhs) {
+  if (n < 1) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. n must be greater than 0.");
+    return NULL;
+  }
+  struct gram *G = malloc(sizeof(struct gram));
+  G->n = n;
+  G->rhs = rhs;
+  G->count = 0;
+  G->btb = 0;
+  G->bytes = sizeof(struct gram) +
+             ((size_t) n * n + n) * sizeof(long double);
+  G->g = calloc((size_t) n * n + n, sizeof(long double));
+  G->atb = G->g + (size_t) n * n;
+  INSTRUMENT_ALLOC(G->bytes);
+  return G;
+}
+
+enum linalg_status gram_add_row(struct gram * const G,
+                                const struct vector * const row,
+                                const long double b) {
+  INSTRUMENT_SCOPE(gram_add_row);
+  assert(G);
+  assert(row);
+  const int n = G->n;
+  INSTRUMENT_DIMS(1, n);
+  if (vector_dim(row) != n) {
+    return linalg_report(LINALG_ERR_DIMENSION, __func__,
+                         "Invalid input. row must be in R[%d].", n);
+  }
+  const long double *x = vector_cdata(row);
+  for (int i = 0; i < n; i++) {
+    if (x[i] == 0) {
+      continue;
+    }
+    long double *gi = G->g + (size_t) i * n;
+    for (int j = i; j < n; j++) {
+      gi[j] += x[i] * x[j];
+    }
+  }
+  if (G->rhs) {
+    for (int i = 0; i < n; i++) {
+      G->atb[i] += x[i] * b;
+    }
+    G->btb += b * b;
+  }
+  G->count++;
+  INSTRUMENT_FLOPS((long long) n * (n + 1));
+  return LINALG_OK;
+}
+
+enum linalg_status gram_add_rows(struct gram * const G,
+                                 const struct matrix * const rows,
+                                 const struct vector * const b) {
+  INSTRUMENT_SCOPE(gram_add_rows);
+  assert(G);
+  assert(rows);
+  const int n = G->n;
+  int m, cols = 0;
+  matrix_size(rows, &m, &cols);
+  INSTRUMENT_DIMS(m, cols);
+  if ((cols != n) && (m > 0)) {
+    return linalg_report(LINALG_ERR_DIMENSION, __func__,
+                         "Invalid input. rows must have %d columns.", n);
+  }
+  if (G->rhs != (b != NULL)) {
+    return linalg_report(LINALG_ERR_INVALID, __func__,
+                         "Invalid input. b must be given exactly when the "
+                         "accumulator has a right-hand side.");
+  }
+  if (b && (vector_dim(b) != m)) {
+    return linalg_report(LINALG_ERR_DIMENSION, __func__,
+                         "Invalid input. b must be in R[%d].", m);
+  }
+  if (m == 0) {
+    return LINALG_OK;
+  }
+  //up to CHUNK rows are stored by columns, so every entry of the update is
+  //   a dot product of two contiguous columns
+  const int width = m < CHUNK ? m : CHUNK;
+  long double *X = malloc((size_t) n * width * sizeof(long double));
+  const long double *y = b ? vector_cdata(b) : NULL;
+  for (int start = 0; start < m; start += width) {
+    const int k = m - start < width ? m - start : width;
+    for (int t = 0; t < k; t++) {
+      const long double *row = matrix_row_cdata(rows, start + t + 1);
+      for (int i = 0; i < n; i++) {
+        X[(size_t) i * k + t] = row[i];
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      const long double *xi = X + (size_t) i * k;
+      long double *gi = G->g + (size_t) i * n;
+      for (int j = i; j < n; j++) {
+        const long double *xj = X + (size_t) j * k;
+        long double sum = 0;
+        for (int t = 0; t < k; t++) {
+          sum += xi[t] * xj[t];
+        }
+        gi[j] += sum;
+      }
+      if (y) {
+        long double sum = 0;
+        for (int t = 0; t < k; t++) {
+          sum += xi[t] * y[start + t];
+        }
+        G->atb[i] += sum;
+      }
+    }
+    if (y) {
+      for (int t = 0; t < k; t++) {
+        G->btb += y[start + t] * y[start + t];
+      }
+    }
+  }
+  free(X);
+  G->count += m;
+  INSTRUMENT_FLOPS((long long) m * n * (n + 1 + (y ? 2 : 0)));
+  return LINALG_OK;
+}
+
+enum linalg_status gram_merge(struct gram * const G,
+                              const struct gram * const other) {
+  INSTRUMENT_SCOPE(gram_merge);
+  assert(G);
+  assert(other);
+  const int n = G->n;
+  INSTRUMENT_DIMS(n, n);
+  if ((other->n != n) || (other->rhs != G->rhs)) {
+    return linalg_report(LINALG_ERR_DIMENSION, __func__,
+                         "Invalid input. Both accumulators must have rows in "
+                         "R[%d] and the same right-hand sides.", n);
+  }
+  for (int i = 0; i < n; i++) {
+    for (int j = i; j < n; j++) {
+      G->g[(size_t) i * n + j] += other->g[(size_t) i * n + j];
+    }
+    G->atb[i] += other->atb[i];
+  }
+  G->btb += other->btb;
+  G->count += other->count;
+  INSTRUMENT_FLOPS((long long) n * (n + 1) / 2);
+  return LINALG_OK;
+}
+
+long long gram_count(const struct gram * const G) {
+  assert(G);
+  return G->count;
+}
+
+struct matrix *gram_matrix(const struct gram * const G) {
+  assert(G);
+  const int n = G->n;
+  struct matrix *AtA = matrix_create_zero(n, n);
+  for (int i = 0; i < n; i++) {
+    long double *row = matrix_row_data(AtA, i + 1);
+    for (int j = 0; j < n; j++) {
+      row[j] = i <= j ? G->g[(size_t) i * n + j] : G->g[(size_t) j * n + i];
+    }
+  }
+  return AtA;
+}
+
+struct vector *gram_rhs(const struct gram * const G) {
+  assert(G);
+  if (!G->rhs) {
+    linalg_report(LINALG_ERR_INVALID, __func__,
+                  "Invalid input. The accumulator has no right-hand side.");
+    return NULL;
+  }
+  struct vector *atb = vector_create_zero(G->n);
+  memcpy(vector_data(atb), G->atb, G->n * sizeof(long double));
+  return atb;
+}
+
+struct vector *gram_solve(const struct gram * const G,
+                          const long double ridge,
+                          long double * const residual) {
+  INSTRUMENT_SCOPE(gram_solve);
+  assert(G);
+  const int n = G->n;
+  INSTRUMENT_DIMS(n, n);
+  if (!G->rhs) {
+    linalg_report(LINALG_ERR_INVALID, __func__,
+                  "Invalid input. The accumulator has no right-hand side.");
+    return NULL;
+  }
+  if (ridge < 0) {
+    linalg_report(LINALG_ERR_INVALID, __func__,
+                  "Invalid input. ridge must not be negative.");
+    return NULL;
+  }
+  //A^T A + ridge I = U^T U, with U over the upper triangle of a copy
+  const size_t bytes = (size_t) n * n * sizeof(long double);
+  long double *U = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  memcpy(U, G->g, bytes);
+  long double largest = 0;
+  for (int j = 0; j < n; j++) {
+    U[(size_t) j * n + j] += ridge;
+    largest = fmaxl(largest, U[(size_t) j * n + j]);
+  }
+  bool definite = largest > 0;
+  for (int j = 0; (j < n) && definite; j++) {
+    long double d = U[(size_t) j * n + j];
+    for (int k = 0; k < j; k++) {
+      d -= U[(size_t) k * n + j] * U[(size_t) k * n + j];
+    }
+    if (!(d > PRECISION * largest)) {
+      definite = false;
+      break;
+    }
+    const long double pivot = sqrtl(d);
+    U[(size_t) j * n + j] = pivot;
+    for (int i = j + 1; i < n; i++) {
+      long double sum = U[(size_t) j * n + i];
+      for (int k = 0; k < j; k++) {
+        sum -= U[(size_t) k * n + j] * U[(size_t) k * n + i];
+      }
+      U[(size_t) j * n + i] = sum / pivot;
+    }
+  }
+  INSTRUMENT_FLOPS((long long) n * n * n / 3);
+  struct vector *x = NULL;
+  if (!definite) {
+    linalg_report(LINALG_ERR_SINGULAR, __func__,
+                  "Invalid input. A^T A is not positive definite, so A does "
+                  "not have full column rank.");
+  } else {
+    x = vector_create_zero(n);
+    long double *y = vector_data(x);
+    //U^T y = A^T b, then U x = y
+    for (int i = 0; i < n; i++) {
+      long double sum = G->atb[i];
+      for (int k = 0; k < i; k++) {
+        sum -= U[(size_t) k * n + i] * y[k];
+      }
+      y[i] = sum / U[(size_t) i * n + i];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      long double sum = y[i];
+      for (int k = i + 1; k < n; k++) {
+        sum -= U[(size_t) i * n + k] * y[k];
+      }
+      y[i] = sum / U[(size_t) i * n + i];
+    }
+    INSTRUMENT_FLOPS(2LL * n * n);
+    if (residual) {
+      //|Ax - b|^2 = b^T b - 2 x^T A^T b + x^T A^T A x, and
+      //   A^T A x = A^T b - ridge x; the difference cancels to rounding
+      //   error, which may be negative, when the residual is below about
+      //   sqrt(LDBL_EPSILON) |b|
+      long double sum = G->btb;
+      for (int i = 0; i < n; i++) {
+        sum -= y[i] * G->atb[i] + ridge * y[i] * y[i];
+      }
+      *residual = sum > 0 ? sqrtl(sum) : 0;
+    }
+  }
+  INSTRUMENT_FREE(bytes);
+  free(U);
+  return x;
+}
+
+void gram_destroy(struct gram * const G) {
+  if (G) {
+    INSTRUMENT_FREE(G->bytes);
+    free(G->g);
+    free(G);
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef LINALG_GRAM_H
+#define LINALG_GRAM_H
+
+#include <stdbool.h>
+#include "status.h"
+
+//A struct gram accumulates the Gram matrix A^T A of a matrix A with n
+//   columns, and optionally A^T b and b^T b for a right-hand side b, while
+//   the rows of A (and the entries of b) arrive one at a time or in blocks.
+//   A itself is never stored. Each row adds its outer product to the upper
+//   triangle only, and a block of k rows adds all k at once as a symmetric
+//   rank-k update, so ingesting m rows costs about m n^2 multiply-adds in
+//   total and the accumulator needs O(n^2) memory. Accumulators fed on
+//   different threads can be merged. The result is ready for a solver: the
+//   least-squares solution of Ax = b comes from one Cholesky factorization
+//   of A^T A, and gram_matrix gives A^T A for other uses.
+
+struct gram;
+struct matrix;
+struct vector;
+
+//gram_create(n, rhs) returns an empty accumulator for rows in R[n], which
+//   also accumulates A^T b and b^T b if rhs is true, through a heap-allocated
+//   pointer that the caller must free with gram_destroy(). If n is not
+//   positive, it outputs an error message and returns NULL.
+//effects: may print output
+//         may allocate heap memory
+struct gram *gram_create(const int n, const bool rhs);
+
+//gram_add_row(G, row, b) adds row (a row of A) to G, with b as its entry of
+//   the right-hand side if G has one (b is ignored otherwise). It returns
+//   LINALG_OK, or reports LINALG_ERR_DIMENSION if row is not in R[n].
+//requires: G, row are not NULL
+//effects: modifies G
+//         may print output
+enum linalg_status gram_add_row(struct gram * const G,
+                                const struct vector * const row,
+                                const long double b);
+
+//gram_add_rows(G, rows, b) adds each row of the matrix rows to G, with the
+//   entries of b as their right-hand sides. b must be NULL if G has no
+//   right-hand side. It returns LINALG_OK, or reports LINALG_ERR_DIMENSION if
+//   rows does not have n columns or b does not have one entry per row, and
+//   LINALG_ERR_INVALID if b is NULL but G has a right-hand side or the other
+//   way around.
+//requires: G, rows are not NULL
+//effects: modifies G
+//         may print output
+enum linalg_status gram_add_rows(struct gram * const G,
+                                 const struct matrix * const rows,
+                                 const struct vector * const b);
+
+//gram_merge(G, other) adds the rows accumulated in other to G, as if they
+//   had been added to G. It returns LINALG_OK, or reports
+//   LINALG_ERR_DIMENSION if the two have different n or only one has a
+//   right-hand side.
+//requires: G, other are not NULL
+//effects: modifies G
+//         may print output
+enum linalg_status gram_merge(struct gram * const G,
+                              const struct gram * const other);
+
+//gram_count(G) returns how many rows G has accumulated.
+//requires: G is not NULL
+long long gram_count(const struct gram * const G);
+
+//gram_matrix(G) returns the n x n matrix A^T A through a heap-allocated
+//   pointer that the caller must free with matrix_destroy().
+//requires: G is not NULL
+//effects: allocates heap memory
+struct matrix *gram_matrix(const struct gram * const G);
+
+//gram_rhs(G) returns A^T b through a heap-allocated vector that the caller
+//   must free with vector_destroy(). If G has no right-hand side, it outputs
+//   an error message and returns NULL.
+//requires: G is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct vector *gram_rhs(const struct gram * const G);
+
+//gram_solve(G, ridge, residual) returns the x that minimizes |Ax - b|^2 +
+//   ridge |x|^2 (the least-squares solution when ridge is 0) through a
+//   heap-allocated vector that the caller must free with vector_destroy(),
+//   found from the Cholesky factorization of A^T A + ridge I in O(n^3) time.
+//   If residual is not NULL, it stores |Ax - b| in *residual. The rows are
+//   not kept, so its square comes from the accumulated sums as
+//   b^T b - x^T A^T b - ridge |x|^2, which cancels when the fit is close:
+//   the residual is accurate only to about sqrt(LDBL_EPSILON) |b| (about
+//   3e-10 |b|), and a smaller one may be reported as 0. If G has no
+//   right-hand side or ridge is negative, it outputs an error message and
+//   returns NULL; if A^T A + ridge I is not positive definite (a pivot is at
+//   most PRECISION times the largest diagonal entry, so A does not have full
+//   column rank), it reports LINALG_ERR_SINGULAR and returns NULL.
+//requires: G is not NULL
+//effects: may modify *residual
+//         may print output
+//         may allocate heap memory
+struct vector *gram_solve(const struct gram * const G,
+                          const long double ridge,
+                          long double * const residual);
+
+//gram_destroy(G) frees all heap memory allocated to G. Passing NULL does
+//   nothing.
+//effects: frees heap memory
+void gram_destroy(struct gram * const G);
+
+#endif
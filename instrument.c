@@ -0,0 +1,159 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "instrument.h"
+#include "trace.h"
+
+//See header file for documentation
+
+#define INSTRUMENT_NAME_ENTRY(name) #name,
+static const char * const OP_NAMES[] = {
+  INSTRUMENT_OPS(INSTRUMENT_NAME_ENTRY)
+};
+#undef INSTRUMENT_NAME_ENTRY
+
+//totals per operation; every field is updated with atomic adds
+static struct instrument_counters totals[INSTR_COUNT];
+
+
+const char *instrument_op_name(const int op) {
+  if (op < 0 || op >= INSTR_COUNT) {
+    return NULL;
+  }
+  return OP_NAMES[op];
+}
+
+int instrument_snapshot(struct instrument_counters * const out, const int max) {
+  assert(out);
+  assert(max >= 0);
+  const int count = max < INSTR_COUNT ? max : INSTR_COUNT;
+  for (int i = 0; i < count; i++) {
+    out[i].name = OP_NAMES[i];
+    out[i].calls = __atomic_load_n(&totals[i].calls, __ATOMIC_RELAXED);
+    out[i].flops = __atomic_load_n(&totals[i].flops, __ATOMIC_RELAXED);
+    out[i].bytes_allocated =
+      __atomic_load_n(&totals[i].bytes_allocated, __ATOMIC_RELAXED);
+    out[i].bytes_freed =
+      __atomic_load_n(&totals[i].bytes_freed, __ATOMIC_RELAXED);
+    out[i].nanoseconds =
+      __atomic_load_n(&totals[i].nanoseconds, __ATOMIC_RELAXED);
+  }
+  return count;
+}
+
+void instrument_reset(void) {
+  for (int i = 0; i < INSTR_COUNT; i++) {
+    __atomic_store_n(&totals[i].calls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&totals[i].flops, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&totals[i].bytes_allocated, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&totals[i].bytes_freed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&totals[i].nanoseconds, 0, __ATOMIC_RELAXED);
+  }
+}
+
+
+#ifdef LINALG_INSTRUMENT
+
+bool instrument_enabled(void) {
+  return true;
+}
+
+#else
+
+bool instrument_enabled(void) {
+  return false;
+}
+
+#endif
+
+
+#if defined(LINALG_INSTRUMENT) || defined(LINALG_TRACE)
+
+//innermost active frame of this thread
+static __thread struct instrument_frame *current = NULL;
+
+//number of active frames of each operation on this thread, used to charge
+//   recursive calls only once
+static __thread int active[INSTR_COUNT];
+
+//now_ns() returns a monotonic time stamp in nanoseconds.
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void instrument_enter(struct instrument_frame * const frame, const int op,
+                      const bool timed) {
+  frame->op = op;
+  frame->timed = timed;
+  frame->start = timed ? now_ns() : 0;
+  frame->flops = 0;
+  frame->bytes_allocated = 0;
+  frame->bytes_freed = 0;
+  frame->rows = -1;
+  frame->cols = -1;
+  frame->parent = current;
+  current = frame;
+  active[op]++;
+#ifdef LINALG_INSTRUMENT
+  __atomic_fetch_add(&totals[op].calls, 1, __ATOMIC_RELAXED);
+#endif
+#ifdef LINALG_TRACE
+  if (timed) {
+    trace_begin(op);
+  }
+#endif
+}
+
+void instrument_leave(struct instrument_frame * const frame) {
+  const int op = frame->op;
+  active[op]--;
+  current = frame->parent;
+#ifdef LINALG_TRACE
+  if (frame->timed) {
+    trace_end(op, frame->rows, frame->cols);
+  }
+#endif
+#ifdef LINALG_INSTRUMENT
+  if (active[op] == 0) {
+    struct instrument_counters * const t = &totals[op];
+    if (frame->timed) {
+      __atomic_fetch_add(&t->nanoseconds, now_ns() - frame->start,
+                         __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&t->flops, frame->flops, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&t->bytes_allocated, frame->bytes_allocated,
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&t->bytes_freed, frame->bytes_freed, __ATOMIC_RELAXED);
+  }
+#endif
+  if (current) {
+    current->flops += frame->flops;
+    current->bytes_allocated += frame->bytes_allocated;
+    current->bytes_freed += frame->bytes_freed;
+  }
+}
+
+void instrument_flops(const long long n) {
+  if (current) {
+    current->flops += n;
+  }
+}
+
+void instrument_alloc(const long long bytes) {
+  if (current) {
+    current->bytes_allocated += bytes;
+  }
+}
+
+void instrument_free(const long long bytes) {
+  if (current) {
+    current->bytes_freed += bytes;
+  }
+}
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef LINALG_INSTRUMENT_H
+#define LINALG_INSTRUMENT_H
+
+#include <stdbool.h>
+
+//The toolbox can count, for each public function in matrix_core.h,
+//   matrix_operations.h, inv_and_det.h, lu.h, structure.h, exact.h,
+//   modular.h, sketch.h, basis.h, orthonormal.h and eigen_and_diag.h, for
+//   matrix_expr_eval, for the solvers in krylov.h and eigs.h, for the
+//   sparse matrix and ILU(0) constructors in sparse.h, for the passes over
+//   the rows in tsqr.h, for the out-of-core kernels in disk.h, for the
+//   updates and solver of gram.h and for refine_solve, how often it is
+//   called, how many floating point operations it performs, how many heap
+//   bytes it allocates and frees, and how much wall time it takes.
+//Instrumentation is compiled in only when LINALG_INSTRUMENT is defined (for
+//   example with "make INSTRUMENT=1"). Otherwise the hooks below expand to
+//   nothing and the snapshot reports zeros.
+//Counts are inclusive: an operation is charged for everything the operations
+//   it calls do. A nested call of an operation that is already active on the
+//   thread is counted as a call, but its time, flops and bytes are only
+//   charged once, to the outermost call. The status returning variants
+//   (matrix_rank_checked, matrix_det_checked) are charged to the operation
+//   they implement, and matrix_det_exact_string to matrix_det_exact. Cheap
+//   accessors (matrix_size, matrix_elem) are counted but not timed, and the
+//   unchecked accessors (matrix_elem_unchecked, matrix_row_data,
+//   matrix_row_cdata) are not instrumented at all.
+//Counters are shared between threads and updated atomically.
+//The same hooks feed the span tracer in trace.h when LINALG_TRACE is
+//   defined.
+
+//INSTRUMENT_OPS lists every instrumented operation.
+#define INSTRUMENT_OPS(X) \
+  X(matrix_create) X(matrix_create_zero) X(quick_matrix_input) \
+  X(matrix_size) X(matrix_add_row) \
+  X(matrix_del_row) X(matrix_replace_row) X(matrix_dupe_row) \
+  X(matrix_swap_row) X(matrix_sum_row) X(matrix_mult_row) \
+  X(matrix_add_mult_row) X(matrix_add_col) X(matrix_del_col) \
+  X(matrix_replace_col) X(matrix_dupe_col) X(matrix_dupe) X(matrix_elem) \
+  X(matrix_elem_checked) \
+  X(matrix_format) X(matrix_format_summary) X(matrix_fprint) \
+  X(matrix_print) X(matrix_print_summary) X(matrix_destroy) \
+  X(matrix_add) X(matrix_mult_scalar) X(matrix_mult_vector) \
+  X(matrix_mult_matrix) X(rotation_matrix) X(is_RREF) X(RREF) \
+  X(matrix_transpose) X(matrix_rank) X(matrix_power) X(matrix_norm_1) \
+  X(matrix_is_symmetric) X(matrix_add_consume) \
+  X(matrix_mult_scalar_consume) X(matrix_mult_matrix_consume) \
+  X(RREF_consume) X(matrix_expr_eval) \
+  X(matrix_cof) X(cof_matrix) X(adj_matrix) X(matrix_inverse) X(matrix_det) \
+  X(matrix_det_scaled) X(matrix_logdet) \
+  X(lu_factor) X(matrix_lu) X(lu_solve) X(lu_inverse) X(lu_update) \
+  X(lu_adjugate) X(lu_inverse_norm_1) X(matrix_cond_1) \
+  X(matrix_inverse_update) X(matrix_det_update) X(matrix_structure) \
+  X(matrix_is_integral) X(matrix_det_exact) X(matrix_rank_exact) X(RREF_exact) \
+  X(matrix_rank_modular) \
+  X(sparse_create) X(sparse_from_matrix) X(sparse_mult_vector) \
+  X(precond_ilu0) X(krylov_cg) X(krylov_gmres) X(krylov_bicgstab) \
+  X(eigs_power) X(eigs_lanczos) X(eigs_arnoldi) \
+  X(sketch_range) X(sketch_svd) X(sketch_rank) \
+  X(basis_prepare) X(basis_in_span) X(basis_coord) X(basis_project) \
+  X(basis_coord_batch) X(orthonormal_basis) \
+  X(tsqr_factor) X(tsqr_basis) X(tsqr_least_squares) \
+  X(disk_matrix_mult) X(disk_matrix_lu) X(disk_matrix_lu_solve) \
+  X(gram_add_row) X(gram_add_rows) X(gram_merge) X(gram_solve) \
+  X(refine_solve) \
+  X(B_matrix) X(eigenvalue_2x2) X(eigenvalue_3x3) X(eigenvectors_2x2) \
+  X(eigenvectors_3x3) X(diagonalize_2x2) X(diagonalize_3x3)
+
+#define INSTRUMENT_ENUM_ENTRY(name) INSTR_##name,
+enum instrument_op {
+  INSTRUMENT_OPS(INSTRUMENT_ENUM_ENTRY)
+  INSTR_COUNT
+};
+#undef INSTRUMENT_ENUM_ENTRY
+
+//A struct instrument_counters holds the totals for one operation.
+struct instrument_counters {
+  const char *name;
+  long long calls;
+  long long flops;
+  long long bytes_allocated;
+  long long bytes_freed;
+  long long nanoseconds;
+};
+
+//instrument_enabled() returns true if instrumentation was compiled in.
+bool instrument_enabled(void);
+
+//instrument_snapshot(out, max) copies the counters of the first max
+//   operations (in the order of INSTRUMENT_OPS) into out and returns the
+//   number copied, which is at most INSTR_COUNT.
+//requires: out is not NULL
+//          max >= 0
+//effects: modifies out
+int instrument_snapshot(struct instrument_counters * const out, const int max);
+
+//instrument_reset() sets every counter back to zero.
+//effects: modifies the counters
+void instrument_reset(void);
+
+//instrument_op_name(op) returns the function name of operation op, or NULL if
+//   op is not a valid operation.
+const char *instrument_op_name(const int op);
+
+
+//The rest of this file is used by the toolbox itself.
+
+#if defined(LINALG_INSTRUMENT) || defined(LINALG_TRACE)
+
+//A struct instrument_frame tracks one active call of an operation. Frames
+//   live on the C stack and are linked per thread.
+struct instrument_frame {
+  int op;
+  bool timed;
+  long long start;
+  long long flops;
+  long long bytes_allocated;
+  long long bytes_freed;
+  int rows;
+  int cols;
+  struct instrument_frame *parent;
+};
+
+void instrument_enter(struct instrument_frame * const frame, const int op,
+                      const bool timed);
+void instrument_leave(struct instrument_frame * const frame);
+void instrument_flops(const long long n);
+void instrument_alloc(const long long bytes);
+void instrument_free(const long long bytes);
+
+//INSTRUMENT_SCOPE(name) charges the rest of the enclosing block to operation
+//   name. It must appear at most once per block, before any return.
+#define INSTRUMENT_SCOPE(name) \
+  struct instrument_frame instrument_frame_ \
+    __attribute__((cleanup(instrument_leave))); \
+  instrument_enter(&instrument_frame_, INSTR_##name, true)
+
+//INSTRUMENT_COUNT(name) is like INSTRUMENT_SCOPE, but does not time the call.
+#define INSTRUMENT_COUNT(name) \
+  struct instrument_frame instrument_frame_ \
+    __attribute__((cleanup(instrument_leave))); \
+  instrument_enter(&instrument_frame_, INSTR_##name, false)
+
+//INSTRUMENT_DIMS(m, n) records that the operation in the current block works
+//   on an m by n matrix (shown as arguments of its trace span).
+#define INSTRUMENT_DIMS(m, n) \
+  (instrument_frame_.rows = (m), instrument_frame_.cols = (n))
+
+//INSTRUMENT_MATRIX_DIMS(A) is INSTRUMENT_DIMS with the size of matrix *A.
+#define INSTRUMENT_MATRIX_DIMS(A) \
+  matrix_size(A, &instrument_frame_.rows, &instrument_frame_.cols)
+
+#define INSTRUMENT_FLOPS(n) instrument_flops(n)
+#define INSTRUMENT_ALLOC(bytes) instrument_alloc(bytes)
+#define INSTRUMENT_FREE(bytes) instrument_free(bytes)
+
+#else
+
+#define INSTRUMENT_SCOPE(name) ((void) 0)
+#define INSTRUMENT_COUNT(name) ((void) 0)
+#define INSTRUMENT_DIMS(m, n) ((void) 0)
+#define INSTRUMENT_MATRIX_DIMS(A) ((void) 0)
+#define INSTRUMENT_FLOPS(n) ((void) 0)
+#define INSTRUMENT_ALLOC(bytes) ((void) 0)
+#define INSTRUMENT_FREE(bytes) ((void) 0)
+
+#endif
+
+#endif
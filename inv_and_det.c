@@ -2,49 +2,228 @@
 #include "matrix_core.h"
 #include "matrix_operations.h"
 #include <assert.h>
+#include <float.h>
 #include <limits.h>
+#include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "inv_and_det.h"
+#include "lu.h"
+#include "exact.h"
+#include "matrix_cache.h"
+#include "structure.h"
+#include "instrument.h"
+#include "status.h"
 #include "settings.h"
 
 
 //See header file for documentation
 
 long double matrix_det(const struct matrix * const A) {
+  long double det = INT_MIN;
+  matrix_det_checked(A, &det);
+  return det;
+}
+
+//small_det(A, n) returns the determinant of the n x n matrix A by cofactor
+//   expansion along the first column, which is exact for small integer
+//   entries.
+//requires: A is not NULL, A is n x n, 1 <= n <= 3
+static long double small_det(const struct matrix * const A, const int n) {
+  const long double *r1 = matrix_row_cdata(A, 1);
+  if (n == 1) {
+    return r1[0];
+  }
+  const long double *r2 = matrix_row_cdata(A, 2);
+  if (n == 2) {
+    INSTRUMENT_FLOPS(3);
+    return r1[0] * r2[1] - r2[0] * r1[1];
+  }
+  const long double *r3 = matrix_row_cdata(A, 3);
+  INSTRUMENT_FLOPS(14);
+  return r1[0] * (r2[1] * r3[2] - r3[1] * r2[2]) -
+         r2[0] * (r1[1] * r3[2] - r3[1] * r1[2]) +
+         r3[0] * (r1[1] * r2[2] - r2[1] * r1[2]);
+}
+
+//structured_det(A, n, structure) returns the determinant of the n x n matrix
+//   A, whose structure flags are structure, if one of them allows a shortcut:
+//   the product of the diagonal of a triangular matrix, or the sign of a
+//   permutation. Otherwise it returns false and leaves *det unchanged.
+//requires: A, det are not NULL, A is n x n, n >= 1
+//effects: may modify *det
+//         may allocate heap memory
+static bool structured_det(const struct matrix * const A, const int n,
+                           const unsigned structure, long double * const det) {
+  if (structure & (MATRIX_UPPER_TRIANGULAR | MATRIX_LOWER_TRIANGULAR)) {
+    long double product = 1;
+    for (int i = 1; i <= n; i++) {
+      product *= matrix_row_cdata(A, i)[i - 1];
+    }
+    INSTRUMENT_FLOPS(n);
+    *det = product;
+    return true;
+  } else if (structure & MATRIX_PERMUTATION) {
+    //the sign is -1 to the power of n minus the number of cycles
+    int *p = malloc(n * sizeof(int));
+    INSTRUMENT_ALLOC(n * sizeof(int));
+    permutation_columns(A, n, p);
+    int sign = 1;
+    for (int i = 0; i < n; i++) {
+      while (p[i] != i) {
+        const int next = p[p[i]];
+        p[p[i]] = p[i];
+        p[i] = next;
+        sign = -sign;
+      }
+    }
+    INSTRUMENT_FREE(n * sizeof(int));
+    free(p);
+    *det = sign;
+    return true;
+  }
+  return false;
+}
+
+enum linalg_status matrix_det_checked(const struct matrix * const A,
+                                      long double * const det) {
+  INSTRUMENT_SCOPE(matrix_det);
   assert(A);
+  assert(det);
   int m, n = 0;
   matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
   if ((m != n) || (m < 1)) {
-    printf("Invalid input. Matrix must be n x n where n is positive.\n");
-  } else if (m == 1) {
-    return matrix_elem(A, 1, 1);
-  } else {
-    long double det_total = 0;
-    for (int i = 1; i <= m; i++) {
-      struct matrix *submatrix = matrix_dupe(A);
-      matrix_del_col(submatrix, 1);
-      matrix_del_row(submatrix, i);
-      if (i % 2 == 1) {
-        det_total += matrix_elem(A, i, 1) * matrix_det(submatrix);
-      } else {
-        det_total -= matrix_elem(A, i, 1) * matrix_det(submatrix);
+    return linalg_report(LINALG_ERR_NOT_SQUARE, "matrix_det",
+                         "Invalid input. Matrix must be n x n where n is "
+                         "positive.");
+  }
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!(cache->valid & CACHE_DET)) {
+    if (!structured_det(A, n, matrix_structure(A), &cache->det)) {
+      if (n <= 3) {
+        cache->det = small_det(A, n);
+      } else if ((n > EXACT_DET_MAX) || !matrix_is_integral(A) ||
+                 (matrix_det_exact(A, &cache->det) != LINALG_OK)) {
+        cache->det = lu_det(matrix_lu(A));
       }
-      matrix_destroy(submatrix);
     }
-    return det_total;
+    //a zero determinant may come out as -0; report it as 0
+    if (cache->det == 0) {
+      cache->det = 0;
+    }
+    cache->valid |= CACHE_DET;
   }
-  return INT_MIN;
+  *det = cache->det;
+  return LINALG_OK;
+}
+
+
+enum linalg_status matrix_det_scaled(const struct matrix * const A,
+                                     long double * const mantissa,
+                                     long * const exponent) {
+  INSTRUMENT_SCOPE(matrix_det_scaled);
+  assert(A);
+  assert(mantissa);
+  assert(exponent);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m != n) || (m < 1)) {
+    return linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                         "Invalid input. Matrix must be n x n where n is "
+                         "positive.");
+  }
+  const unsigned structure = matrix_structure(A);
+  if (structure & (MATRIX_UPPER_TRIANGULAR | MATRIX_LOWER_TRIANGULAR)) {
+    long double fraction = 1;
+    long e = 0;
+    int shift = 0;
+    for (int i = 1; i <= n; i++) {
+      fraction *= frexpl(matrix_row_cdata(A, i)[i - 1], &shift);
+      e += shift;
+      fraction = frexpl(fraction, &shift);
+      e += shift;
+    }
+    INSTRUMENT_FLOPS(n);
+    *mantissa = fraction;
+    *exponent = fraction == 0 ? 0 : e;
+  } else if (structure & MATRIX_PERMUTATION) {
+    long double det = 0;
+    structured_det(A, n, structure, &det);
+    *mantissa = det / 2;
+    *exponent = 1;
+  } else {
+    lu_det_scaled(matrix_lu(A), mantissa, exponent);
+  }
+  return LINALG_OK;
+}
+
+enum linalg_status matrix_logdet(const struct matrix * const A,
+                                 int * const sign,
+                                 long double * const logdet) {
+  INSTRUMENT_SCOPE(matrix_logdet);
+  assert(A);
+  assert(sign);
+  assert(logdet);
+  long double mantissa = 0;
+  long exponent = 0;
+  const enum linalg_status status =
+    matrix_det_scaled(A, &mantissa, &exponent);
+  if (status != LINALG_OK) {
+    return status;
+  }
+  if (mantissa == 0) {
+    *sign = 0;
+    *logdet = -INFINITY;
+  } else {
+    *sign = mantissa < 0 ? -1 : 1;
+    *logdet = logl(fabsl(mantissa)) + exponent * logl(2);
+  }
+  return LINALG_OK;
 }
 
 
+enum linalg_status matrix_cond_1(const struct matrix * const A,
+                                 long double * const cond) {
+  INSTRUMENT_SCOPE(matrix_cond_1);
+  assert(A);
+  assert(cond);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m != n) || (m < 1)) {
+    return linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                         "Invalid input. Matrix must be n x n where n is "
+                         "positive.");
+  }
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!(cache->valid & CACHE_COND_1)) {
+    const long double inverse = lu_inverse_norm_1(matrix_lu(A));
+    //a zero pivot makes the estimate infinite, even for the zero matrix
+    cache->cond_1 = isinf(inverse) ? inverse : matrix_norm_1(A) * inverse;
+    cache->valid |= CACHE_COND_1;
+  }
+  *cond = cache->cond_1;
+  return LINALG_OK;
+}
+
 long double matrix_cof(const struct matrix * const A, const int i, 
                        const int j) {
+  INSTRUMENT_SCOPE(matrix_cof);
   assert(A);
   int m, n = 0;
   matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
   if ((m != n) || (m < 2)) {
-    printf("Invalid input. Matrix must be n x n where n >= 2.\n");
-  } else if (matrix_elem(A, i, j) != INT_MIN) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. Matrix must be n x n where n >= 2.");
+  } else if ((i < 1) || (i > m) || (j < 1) || (j > n)) {
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Invalid input. Index is out of bound.");
+  } else {
     struct matrix *submatrix = matrix_dupe(A);
     matrix_del_row(submatrix, i);
     matrix_del_col(submatrix, j);
@@ -59,51 +238,332 @@ long double matrix_cof(const struct matrix * const A, const int i,
   return INT_MIN;
 }
 
+//exact_cofactors(A, n) returns the cofactor matrix of the n x n integer
+//   matrix A, one minor at a time, so every entry is an exact determinant
+//   (see matrix_det).
+//requires: A is not NULL, A is n x n, 2 <= n <= EXACT_DET_MAX
+//effects: allocates heap memory
+static struct matrix *exact_cofactors(const struct matrix * const A,
+                                      const int n) {
+  struct matrix *cof = matrix_create_zero(n, n);
+  for (int i = 1; i <= n; i++) {
+    long double *row = matrix_row_data(cof, i);
+    for (int j = 1; j <= n; j++) {
+      const long double c = matrix_cof(A, i, j);
+      //a zero cofactor may come out as -0; store it as 0
+      row[j - 1] = c == 0 ? 0 : c;
+    }
+  }
+  return cof;
+}
+
+//exact_range(A, n) returns true if the cofactors of the n x n matrix A are
+//   found exactly, that is, if A is an integer matrix with n at most
+//   EXACT_DET_MAX.
+//requires: A is not NULL, A is n x n
+static bool exact_range(const struct matrix * const A, const int n) {
+  return (n <= EXACT_DET_MAX) && matrix_is_integral(A);
+}
+
 struct matrix *cof_matrix(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(cof_matrix);
   assert(A);
   int m, n = -1;
   matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
   if ((m < 2) || (m != n)) {
-    printf("Invalid input. Matrix must be n by n where n >= 2. \n");
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. Matrix must be n by n where n >= 2.");
+  } else if (exact_range(A, n)) {
+    return exact_cofactors(A, n);
   } else {
-    struct matrix *cof = matrix_create();
-    for (int i = 1; i <= n; i++) {
-      struct vector *temp = vector_create();
-      for (int j = 1; j <= n; j++) {
-        vector_add_elem(temp, matrix_cof(A, i, j));
-      }
-      matrix_add_row(cof, temp);
-      vector_destroy(temp);
-    }
+    //the cofactor matrix is the transpose of the adjugate
+    struct matrix *adj = lu_adjugate(matrix_lu(A));
+    struct matrix *cof = matrix_transpose(adj);
+    matrix_destroy(adj);
     return cof;
   }
   return NULL;
 }
 
 struct matrix *adj_matrix(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(adj_matrix);
   assert(A);
-  struct matrix *temp = cof_matrix(A);
-  if (temp) {
-    struct matrix *adj = matrix_transpose(temp);
-    matrix_destroy(temp);
-    return adj;
-  } else {
+  int m, n = -1;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m < 2) || (m != n)) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. Matrix must be n by n where n >= 2.");
     return NULL;
+  } else if (exact_range(A, n)) {
+    struct matrix *cof = exact_cofactors(A, n);
+    struct matrix *adj = matrix_transpose(cof);
+    matrix_destroy(cof);
+    return adj;
+  }
+  return lu_adjugate(matrix_lu(A));
+}
+
+//triangular_inverse(A, n, upper) returns the inverse of the invertible n x n
+//   triangular matrix A by back substitution, column by column. A is upper
+//   triangular if upper is true and lower triangular otherwise.
+//requires: A is not NULL, A is n x n and triangular, no diagonal entry is 0
+//effects: allocates heap memory
+static struct matrix *triangular_inverse(const struct matrix * const A,
+                                         const int n, const bool upper) {
+  struct matrix *inv = matrix_create_zero(n, n);
+  for (int j = 1; j <= n; j++) {
+    matrix_row_data(inv, j)[j - 1] = 1 / matrix_row_cdata(A, j)[j - 1];
+    const int step = upper ? -1 : 1;
+    for (int i = j + step; (i >= 1) && (i <= n); i += step) {
+      const long double *a = matrix_row_cdata(A, i);
+      long double sum = 0;
+      const int from = upper ? i + 1 : j;
+      const int to = upper ? j : i - 1;
+      for (int k = from; k <= to; k++) {
+        sum += a[k - 1] * matrix_row_cdata(inv, k)[j - 1];
+      }
+      matrix_row_data(inv, i)[j - 1] = -sum / a[i - 1];
+    }
   }
+  INSTRUMENT_FLOPS((long long) n * n * n / 3);
+  return inv;
+}
+
+//structured_inverse(A, n, structure) returns the inverse of the invertible
+//   n x n matrix A, whose structure flags are structure, if one of them
+//   allows a shortcut. Otherwise it returns NULL.
+//requires: A is not NULL, A is n x n, n >= 1, det(A) is not 0
+//effects: may allocate heap memory
+static struct matrix *structured_inverse(const struct matrix * const A,
+                                         const int n,
+                                         const unsigned structure) {
+  if (structure & MATRIX_DIAGONAL) {
+    struct matrix *inv = matrix_create_zero(n, n);
+    for (int i = 1; i <= n; i++) {
+      matrix_row_data(inv, i)[i - 1] = 1 / matrix_row_cdata(A, i)[i - 1];
+    }
+    INSTRUMENT_FLOPS(n);
+    return inv;
+  } else if (structure & MATRIX_PERMUTATION) {
+    return matrix_transpose(A);
+  } else if (structure & MATRIX_UPPER_TRIANGULAR) {
+    return triangular_inverse(A, n, true);
+  } else if (structure & MATRIX_LOWER_TRIANGULAR) {
+    return triangular_inverse(A, n, false);
+  }
+  return NULL;
+}
+
+//nearly_singular(A, n, structure) returns true if the n x n matrix A, whose
+//   structure flags are structure, is within rounding of a singular matrix:
+//   by the test of lu_singular (see lu.h), applied to the diagonal of a
+//   triangular A and to the LU factorization of any other A but a
+//   permutation matrix.
+//requires: A is not NULL, A is n x n, n >= 1
+//effects: may allocate heap memory
+static bool nearly_singular(const struct matrix * const A, const int n,
+                            const unsigned structure) {
+  if (structure & MATRIX_PERMUTATION) {
+    return false;
+  } else if (structure & (MATRIX_UPPER_TRIANGULAR | MATRIX_LOWER_TRIANGULAR)) {
+    long double largest = 0;
+    for (int i = 1; i <= n; i++) {
+      const long double *row = matrix_row_cdata(A, i);
+      for (int j = 0; j < n; j++) {
+        largest = fmaxl(largest, fabsl(row[j]));
+      }
+    }
+    for (int i = 1; i <= n; i++) {
+      const long double pivot = fabsl(matrix_row_cdata(A, i)[i - 1]);
+      if ((pivot == 0) || (pivot <= n * LDBL_EPSILON * largest)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return lu_singular(matrix_lu(A));
 }
 
 struct matrix *matrix_inverse(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_inverse);
+  INSTRUMENT_MATRIX_DIMS(A);
   assert(A);
-  if (matrix_det(A) != INT_MIN) {
-    if ((-PRECISION < matrix_det(A)) && (matrix_det(A) < PRECISION)) {
-      printf("The matrix is not invertible.\n");
-    } else {
-      struct matrix *adj = adj_matrix(A);
-      struct matrix *inv = matrix_mult_scalar(adj, 1/matrix_det(A));
-      matrix_destroy(adj);
-      return inv;
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  if ((m != n) || (m < 1)) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. Matrix must be n x n where n is positive.");
+  } else if (nearly_singular(A, n, matrix_structure(A))) {
+    linalg_report(LINALG_ERR_SINGULAR, __func__,
+                  "The matrix is not invertible.");
+  } else {
+    struct matrix_cache * const cache = matrix_cache(A);
+    if (!cache->inverse) {
+      cache->inverse = structured_inverse(A, n, matrix_structure(A));
+    }
+    if (!cache->inverse) {
+      cache->inverse = lu_inverse(matrix_lu(A));
+    }
+    if (cache->inverse) {
+      return matrix_dupe(cache->inverse);
     }
   }
   return NULL;
 }
 
+
+//capacitance(Ainv, U, V, function, z) checks that Ainv is n x n and U and V
+//   are n x k, and returns the k x k matrix C = I + V^T Ainv U, storing Ainv
+//   U (n x k, by rows) in *z if z is not NULL. Otherwise it reports on behalf
+//   of function and returns NULL.
+//requires: Ainv, U, V, function are not NULL
+//effects: may modify *z
+//         may print output
+//         may allocate heap memory
+static struct matrix *capacitance(const struct matrix * const Ainv,
+                                  const struct matrix * const U,
+                                  const struct matrix * const V,
+                                  const char * const function,
+                                  long double ** const z) {
+  int m, n, um, k, vm, vk = 0;
+  matrix_size(Ainv, &m, &n);
+  matrix_size(U, &um, &k);
+  matrix_size(V, &vm, &vk);
+  if ((m != n) || (n < 1)) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, function,
+                  "Invalid input. Ainv must be n x n where n is positive.");
+    return NULL;
+  } else if ((um != n) || (vm != n) || (k != vk) || (k < 1)) {
+    linalg_report(LINALG_ERR_DIMENSION, function,
+                  "Invalid input. U and V must both be %d x k for some "
+                  "positive k.", n);
+    return NULL;
+  }
+  //Z = Ainv U, a row of Ainv at a time
+  long double *Z = calloc((size_t) n * k, sizeof(long double));
+  INSTRUMENT_ALLOC((size_t) n * k * sizeof(long double));
+  for (int i = 0; i < n; i++) {
+    const long double *a = matrix_row_cdata(Ainv, i + 1);
+    long double *zi = Z + (size_t) i * k;
+    for (int l = 0; l < n; l++) {
+      const long double *ul = matrix_row_cdata(U, l + 1);
+      for (int j = 0; j < k; j++) {
+        zi[j] += a[l] * ul[j];
+      }
+    }
+  }
+  struct matrix *C = matrix_create_zero(k, k);
+  for (int i = 0; i < k; i++) {
+    matrix_row_data(C, i + 1)[i] = 1;
+  }
+  for (int l = 0; l < n; l++) {
+    const long double *vl = matrix_row_cdata(V, l + 1);
+    const long double *zl = Z + (size_t) l * k;
+    for (int i = 0; i < k; i++) {
+      long double *c = matrix_row_data(C, i + 1);
+      for (int j = 0; j < k; j++) {
+        c[j] += vl[i] * zl[j];
+      }
+    }
+  }
+  INSTRUMENT_FLOPS(2LL * n * n * k + 2LL * n * k * k);
+  if (z) {
+    *z = Z;
+  } else {
+    INSTRUMENT_FREE((size_t) n * k * sizeof(long double));
+    free(Z);
+  }
+  return C;
+}
+
+struct matrix *matrix_inverse_update(const struct matrix * const Ainv,
+                                     const struct matrix * const U,
+                                     const struct matrix * const V) {
+  INSTRUMENT_SCOPE(matrix_inverse_update);
+  INSTRUMENT_MATRIX_DIMS(Ainv);
+  assert(Ainv);
+  assert(U);
+  assert(V);
+  long double *Z = NULL;
+  struct matrix *C = capacitance(Ainv, U, V, __func__, &Z);
+  if (!C) {
+    return NULL;
+  }
+  int n, k = 0;
+  matrix_size(U, &n, &k);
+  struct lu_factorization *f = lu_factor(C);
+  matrix_destroy(C);
+  struct matrix *inv = NULL;
+  if (lu_singular(f)) {
+    linalg_report(LINALG_ERR_SINGULAR, __func__,
+                  "The updated matrix is not invertible.");
+  } else {
+    //Woodbury: (A + U V^T)^-1 = Ainv - Z C^-1 V^T Ainv, with Y = C^-1 V^T
+    //   Ainv found a column at a time (by rows, k x n)
+    const size_t bytes = ((size_t) k * n + 2 * k) * sizeof(long double);
+    long double *Y = malloc(bytes);
+    INSTRUMENT_ALLOC(bytes);
+    long double *w = Y + (size_t) k * n;
+    long double *y = w + k;
+    for (int c = 0; c < n; c++) {
+      for (int j = 0; j < k; j++) {
+        w[j] = 0;
+      }
+      for (int l = 0; l < n; l++) {
+        const long double a = matrix_row_cdata(Ainv, l + 1)[c];
+        const long double *vl = matrix_row_cdata(V, l + 1);
+        for (int j = 0; j < k; j++) {
+          w[j] += vl[j] * a;
+        }
+      }
+      lu_solve_into(f, w, y);
+      for (int j = 0; j < k; j++) {
+        Y[(size_t) j * n + c] = y[j];
+      }
+    }
+    inv = matrix_create_zero(n, n);
+    for (int i = 0; i < n; i++) {
+      long double *row = matrix_row_data(inv, i + 1);
+      memcpy(row, matrix_row_cdata(Ainv, i + 1), n * sizeof(long double));
+      for (int j = 0; j < k; j++) {
+        const long double z = Z[(size_t) i * k + j];
+        const long double *yj = Y + (size_t) j * n;
+        for (int c = 0; c < n; c++) {
+          row[c] -= z * yj[c];
+        }
+      }
+    }
+    INSTRUMENT_FLOPS(4LL * n * n * k);
+    INSTRUMENT_FREE(bytes);
+    free(Y);
+  }
+  lu_destroy(f);
+  INSTRUMENT_FREE((size_t) n * k * sizeof(long double));
+  free(Z);
+  return inv;
+}
+
+enum linalg_status matrix_det_update(const long double det,
+                                     const struct matrix * const Ainv,
+                                     const struct matrix * const U,
+                                     const struct matrix * const V,
+                                     long double * const result) {
+  INSTRUMENT_SCOPE(matrix_det_update);
+  INSTRUMENT_MATRIX_DIMS(Ainv);
+  assert(Ainv);
+  assert(U);
+  assert(V);
+  assert(result);
+  struct matrix *C = capacitance(Ainv, U, V, __func__, NULL);
+  if (!C) {
+    return linalg_last_status();
+  }
+  //det(A + U V^T) = det(A) det(I + V^T A^-1 U)
+  struct lu_factorization *f = lu_factor(C);
+  *result = det * lu_det(f);
+  lu_destroy(f);
+  matrix_destroy(C);
+  return LINALG_OK;
+}
@@ -1,3 +1,5 @@
+#include "status.h"
+
 //matrix_cof(A, i ,j) returns the cofactor A[ij] if possible. Otherwise it 
 //   outputs an error message and returns INT_MIN.
 //requires: A is not NULL;
@@ -8,6 +10,7 @@ long double matrix_cof(const struct matrix * const A, const int i,
 //cof_matrix(A) returns the cofactor matrix of A through a heap allocated 
 //   matrix pointer if possible (the client must free the pointer using
 //   matrix_destroy).Otherwise it outputs an error message and returns NULL.
+//   It is the transpose of adj_matrix(A), and is found the same way.
 //requires: A is not NULL;
 //effects: may print message
 struct matrix *cof_matrix(const struct matrix * const A);
@@ -16,6 +19,11 @@ struct matrix *cof_matrix(const struct matrix * const A);
 //adj_matrix(A) returns the adjugate matrix of A through a heap allocated 
 //   matrix pointer if possible (the client must free the pointer using
 //   matrix_destroy).Otherwise it outputs an error message and returns NULL.
+//   The entries of an integer matrix up to EXACT_DET_MAX x EXACT_DET_MAX
+//   (see settings.h) are cofactors, found exactly like matrix_det. For
+//   larger or non-integer matrices, all n^2 entries come in O(n^3) from
+//   the one LU factorization of A (see lu_adjugate), which also serves
+//   singular matrices, and are subject to its rounding errors.
 //requires: A is not NULL;
 //effects: may print message
 struct matrix *adj_matrix(const struct matrix * const A);
@@ -23,15 +31,107 @@ struct matrix *adj_matrix(const struct matrix * const A);
 //matrix_inverse(A) returns the inverse of A through a heap allocated 
 //   matrix pointer if possible (the client must free the pointer using
 //   matrix_destroy).Otherwise it outputs an error message and returns NULL.
+//   The inverse is computed from the LU factorization of A (see lu.h) and
+//   kept with A, so asking again before A changes only copies it. After
+//   that, matrix_cond_1 tells in O(n^2) how many digits it can be trusted to.
 //requires: A is not NULL;
 //effects: may print message
 struct matrix *matrix_inverse(const struct matrix * const A);
 
 //matrix_det(A) returns the determinant of A if possible. Otherwise it 
-//   outputs an error message and returns INT_MIN.
+//   outputs an error message and returns INT_MIN. Matrices larger than 3 x 3
+//   use the LU factorization of A (see lu.h), or exact elimination if every
+//   entry is an integer and A is at most EXACT_DET_MAX x EXACT_DET_MAX (see
+//   exact.h and settings.h). The result is kept with A, so asking again
+//   before A changes takes O(1) time.
 //requires: A is not NULL;
 //effects: may print message
 long double matrix_det(const struct matrix * const A);
 
+//matrix_det_checked(A, det) stores the determinant of A in *det and returns
+//   LINALG_OK if possible. Otherwise it reports the error (see status.h),
+//   leaves *det unchanged and returns its status.
+//requires: A, det are not NULL;
+//effects: may modify *det
+//         may print message
+enum linalg_status matrix_det_checked(const struct matrix * const A,
+                                      long double * const det);
+
+//matrix_det_scaled(A, mantissa, exponent) stores the determinant of A as
+//   *mantissa * 2^*exponent, with 0.5 <= |*mantissa| < 1 (or both 0 if it
+//   is 0), and returns LINALG_OK if possible. The factors come from the
+//   diagonal of a triangular A or of the LU factorization of A (see lu.h),
+//   taken apart into fraction and exponent one at a time, so the result is
+//   right where matrix_det would overflow to inf or underflow to 0, such as
+//   for most 1000 x 1000 matrices. Otherwise it reports the error (see
+//   status.h), leaves *mantissa and *exponent unchanged and returns its
+//   status.
+//requires: A, mantissa, exponent are not NULL;
+//effects: may modify *mantissa and *exponent
+//         may print message
+enum linalg_status matrix_det_scaled(const struct matrix * const A,
+                                     long double * const mantissa,
+                                     long * const exponent);
 
+//matrix_logdet(A, sign, logdet) stores the sign of the determinant of A
+//   (1, -1 or 0) in *sign and the natural logarithm of its absolute value in
+//   *logdet (-INFINITY if it is 0), and returns LINALG_OK if possible. It is
+//   found like matrix_det_scaled. Otherwise it reports the error (see
+//   status.h), leaves *sign and *logdet unchanged and returns its status.
+//requires: A, sign, logdet are not NULL;
+//effects: may modify *sign and *logdet
+//         may print message
+enum linalg_status matrix_logdet(const struct matrix * const A,
+                                 int * const sign,
+                                 long double * const logdet);
+
+//matrix_cond_1(A, cond) stores an estimate of the 1-norm condition number
+//   of A, |A|_1 |A^-1|_1, in *cond and returns LINALG_OK if possible. The
+//   estimate comes from the LU factorization of A (see lu_inverse_norm_1 in
+//   lu.h) without forming A^-1, so once A has been factored, by matrix_det,
+//   matrix_inverse or a solve, it costs O(n^2); it is kept with A like the
+//   determinant. The estimate never exceeds the true condition number and
+//   is rarely far below it. Solving a system with A, or inverting it, may lose about
+//   log10(*cond) of the 19 significant digits of a long double, and *cond
+//   is INFINITY if a pivot is 0. Otherwise it reports the error (see
+//   status.h), leaves *cond unchanged and returns its status.
+//requires: A, cond are not NULL;
+//effects: may modify *cond
+//         may print message
+enum linalg_status matrix_cond_1(const struct matrix * const A,
+                                 long double * const cond);
+
+//matrix_inverse_update(Ainv, U, V) returns the inverse of A + U V^T, where
+//   Ainv is the inverse of the n x n matrix A and U and V are n x k, through a
+//   heap-allocated matrix that the caller must free with matrix_destroy(). It
+//   uses the Sherman-Morrison-Woodbury formula, (A + U V^T)^-1 = Ainv -
+//   Ainv U C^-1 V^T Ainv with C = I + V^T Ainv U, in O(n^2 k) time instead of
+//   inverting again (k = 1 is the Sherman-Morrison formula). Replacing row i
+//   of A by r is the change with U = e_i and V = (r - row i)^T, and replacing
+//   column j by c the one with U = c - column j and V = e_j. If Ainv is not
+//   square or U and V are not both n x k with k positive, it outputs an error
+//   message and returns NULL; if A + U V^T is not invertible (C is singular
+//   by the test of lu_singular in lu.h), it reports LINALG_ERR_SINGULAR and
+//   returns NULL.
+//requires: Ainv, U, V are not NULL;
+//effects: may print message
+//         may allocate heap memory
+struct matrix *matrix_inverse_update(const struct matrix * const Ainv,
+                                     const struct matrix * const U,
+                                     const struct matrix * const V);
 
+//matrix_det_update(det, Ainv, U, V, result) stores in *result the
+//   determinant of A + U V^T, where det is the determinant of the n x n
+//   matrix A, Ainv its inverse and U and V are n x k, found by the matrix
+//   determinant lemma det(A + U V^T) = det(A) det(I + V^T Ainv U) in O(n^2 k)
+//   time, and returns LINALG_OK. If Ainv is not square or U and V are not
+//   both n x k with k positive, it reports the error (see status.h), leaves
+//   *result unchanged and returns its status.
+//requires: Ainv, U, V, result are not NULL;
+//effects: may modify *result
+//         may print message
+enum linalg_status matrix_det_update(const long double det,
+                                     const struct matrix * const Ainv,
+                                     const struct matrix * const U,
+                                     const struct matrix * const V,
+                                     long double * const result);
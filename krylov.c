@@ -0,0 +1,431 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "krylov.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+const struct krylov_options KRYLOV_DEFAULTS = {1e-10L, 1000, 30, NULL};
+
+//matrix_apply(data, x, y) stores Ax in y, where data is A.
+//requires: data, x, y are not NULL, x and y do not overlap
+//          A is n x n, x and y hold n long doubles
+//effects: modifies y
+static void matrix_apply(const void * const data, const long double * const x,
+                         long double * const y) {
+  const struct matrix * const A = data;
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  for (int i = 0; i < m; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    long double sum = 0;
+    for (int j = 0; j < n; j++) {
+      sum += row[j] * x[j];
+    }
+    y[i] = sum;
+  }
+  INSTRUMENT_FLOPS(2LL * m * n);
+}
+
+struct linop linop_matrix(const struct matrix * const A) {
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  assert((m == n) && (n >= 1));
+  const struct linop op = {n, matrix_apply, A};
+  return op;
+}
+
+//A struct solve holds what every method needs during a solve: the operator,
+//   the options, the statistics, the norm of b and the work vectors.
+struct solve {
+  const struct linop *A;
+  const struct linop *M;
+  struct krylov_options options;
+  struct krylov_stats stats;
+  int n;
+  long double b_norm;
+  long double *work;
+  size_t bytes;
+};
+
+//dot(x, y, n) returns the dot product of the n long doubles of x and y.
+//requires: x, y are not NULL
+static long double dot(const long double * const x, const long double * const y,
+                       const int n) {
+  long double sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  INSTRUMENT_FLOPS(2LL * n);
+  return sum;
+}
+
+//axpy(y, a, x, n) adds a times x to y, which hold n long doubles.
+//requires: x, y are not NULL
+//effects: modifies y
+static void axpy(long double * const y, const long double a,
+                 const long double * const x, const int n) {
+  for (int i = 0; i < n; i++) {
+    y[i] += a * x[i];
+  }
+  INSTRUMENT_FLOPS(2LL * n);
+}
+
+//apply(S, x, y) stores Ax in y, where A is the operator of S.
+//requires: S, x, y are not NULL, x and y do not overlap
+//effects: modifies y and S->stats
+static void apply(struct solve * const S, const long double * const x,
+                  long double * const y) {
+  S->A->apply(S->A->data, x, y);
+  S->stats.applications++;
+}
+
+//precondition(S, r, z) stores M^-1 r in z, where M is the preconditioner of
+//   S, or copies r if there is none.
+//requires: S, r, z are not NULL, r and z do not overlap
+//effects: modifies z and S->stats
+static void precondition(struct solve * const S, const long double * const r,
+                         long double * const z) {
+  if (S->M) {
+    S->M->apply(S->M->data, r, z);
+    S->stats.preconditioner_applications++;
+  } else {
+    memcpy(z, r, S->n * sizeof(long double));
+  }
+}
+
+//residual(S, b, x, r) stores b - Ax in r and returns its norm relative to
+//   the norm of b.
+//requires: S, b, x, r are not NULL, r overlaps neither b nor x
+//effects: modifies r and S->stats
+static long double residual(struct solve * const S, const long double * const b,
+                            const long double * const x, long double * const r) {
+  apply(S, x, r);
+  for (int i = 0; i < S->n; i++) {
+    r[i] = b[i] - r[i];
+  }
+  INSTRUMENT_FLOPS(S->n);
+  return sqrtl(dot(r, r, S->n)) / S->b_norm;
+}
+
+//solve_begin(S, A, b, x, options, vectors, extra, function) checks the
+//   sizes of A, b and x, sets up S and allocates vectors work vectors of n
+//   long doubles and extra more long doubles in S->work. It returns
+//   LINALG_OK, or reports the error on behalf of function and returns its
+//   status. If b is zero, x is set to zero and the solve is finished, which
+//   solve_begin reports by leaving S->work NULL.
+//requires: S, A, b, x are not NULL
+//effects: modifies *S
+//         may modify x
+//         may allocate heap memory
+//         may print output
+static enum linalg_status solve_begin(struct solve * const S,
+                                      const struct linop * const A,
+                                      const struct vector * const b,
+                                      struct vector * const x,
+                                      const struct krylov_options * const options,
+                                      const int vectors, const int extra,
+                                      const char * const function) {
+  assert(A);
+  assert(b);
+  assert(x);
+  const int n = A->n;
+  S->A = A;
+  S->options = options ? *options : KRYLOV_DEFAULTS;
+  S->M = S->options.preconditioner;
+  S->n = n;
+  S->work = NULL;
+  S->bytes = 0;
+  S->stats.converged = false;
+  S->stats.iterations = 0;
+  S->stats.applications = 0;
+  S->stats.preconditioner_applications = 0;
+  S->stats.residual = 0;
+  if ((n < 1) || (vector_dim(b) != n) || (vector_dim(x) != n) ||
+      (S->M && (S->M->n != n))) {
+    return linalg_report(LINALG_ERR_DIMENSION, function,
+                         "Invalid input. The operator, b, x and the "
+                         "preconditioner must have the same dimension.");
+  }
+  const long double *rhs = vector_cdata(b);
+  S->b_norm = sqrtl(dot(rhs, rhs, n));
+  if (S->b_norm == 0) {
+    memset(vector_data(x), 0, n * sizeof(long double));
+    S->stats.converged = true;
+    return LINALG_OK;
+  }
+  S->bytes = ((size_t) vectors * n + extra) * sizeof(long double);
+  S->work = malloc(S->bytes);
+  INSTRUMENT_ALLOC(S->bytes);
+  return LINALG_OK;
+}
+
+//solve_end(S, stats, function) frees the work vectors of S, copies the
+//   statistics to stats if it is not NULL and returns LINALG_OK if the solve
+//   converged. Otherwise it reports the failure on behalf of function and
+//   returns its status.
+//requires: S is not NULL
+//effects: frees heap memory
+//         may modify *stats
+//         may print output
+static enum linalg_status solve_end(struct solve * const S,
+                                    struct krylov_stats * const stats,
+                                    const char * const function) {
+  if (S->work) {
+    INSTRUMENT_FREE(S->bytes);
+    free(S->work);
+    S->work = NULL;
+  }
+  if (stats) {
+    *stats = S->stats;
+  }
+  if (!S->stats.converged) {
+    return linalg_report(LINALG_ERR_NO_CONVERGENCE, function,
+                         "The residual is %Lg of b after %d iterations.",
+                         S->stats.residual, S->stats.iterations);
+  }
+  return LINALG_OK;
+}
+
+enum linalg_status krylov_cg(const struct linop * const A,
+                             const struct vector * const b,
+                             struct vector * const x,
+                             const struct krylov_options * const options,
+                             struct krylov_stats * const stats) {
+  INSTRUMENT_SCOPE(krylov_cg);
+  struct solve S;
+  const enum linalg_status status = solve_begin(&S, A, b, x, options, 4, 0,
+                                                __func__);
+  INSTRUMENT_DIMS(S.n, S.n);
+  if ((status != LINALG_OK) || !S.work) {
+    if (stats) {
+      *stats = S.stats;
+    }
+    return status;
+  }
+  const int n = S.n;
+  long double *r = S.work;
+  long double *z = r + n;
+  long double *p = z + n;
+  long double *q = p + n;
+  long double *sol = vector_data(x);
+  S.stats.residual = residual(&S, vector_cdata(b), sol, r);
+  precondition(&S, r, z);
+  memcpy(p, z, n * sizeof(long double));
+  long double rz = dot(r, z, n);
+  while ((S.stats.residual > S.options.tolerance) &&
+         (S.stats.iterations < S.options.max_iterations)) {
+    apply(&S, p, q);
+    const long double pq = dot(p, q, n);
+    if (!(pq > 0)) {
+      break;
+    }
+    const long double alpha = rz / pq;
+    axpy(sol, alpha, p, n);
+    axpy(r, -alpha, q, n);
+    S.stats.iterations++;
+    S.stats.residual = sqrtl(dot(r, r, n)) / S.b_norm;
+    precondition(&S, r, z);
+    const long double rz_next = dot(r, z, n);
+    const long double beta = rz_next / rz;
+    rz = rz_next;
+    for (int i = 0; i < n; i++) {
+      p[i] = z[i] + beta * p[i];
+    }
+    INSTRUMENT_FLOPS(2LL * n);
+  }
+  S.stats.converged = S.stats.residual <= S.options.tolerance;
+  return solve_end(&S, stats, __func__);
+}
+
+enum linalg_status krylov_gmres(const struct linop * const A,
+                                const struct vector * const b,
+                                struct vector * const x,
+                                const struct krylov_options * const options,
+                                struct krylov_stats * const stats) {
+  INSTRUMENT_SCOPE(krylov_gmres);
+  const int m = options ? options->restart : KRYLOV_DEFAULTS.restart;
+  assert(m >= 1);
+  //the basis V (m + 1 vectors), two more vectors, then the Hessenberg
+  //   matrix H ((m + 1) x m, stored by columns) and the rotations and
+  //   right-hand side of the least squares problem (3m + 1 numbers)
+  struct solve S;
+  const enum linalg_status status =
+    solve_begin(&S, A, b, x, options, m + 3, (m + 1) * m + 3 * m + 1,
+                __func__);
+  INSTRUMENT_DIMS(S.n, S.n);
+  if ((status != LINALG_OK) || !S.work) {
+    if (stats) {
+      *stats = S.stats;
+    }
+    return status;
+  }
+  const int n = S.n;
+  long double *V = S.work;
+  long double *w = V + (size_t) (m + 1) * n;
+  long double *t = w + n;
+  long double *H = t + n;
+  long double *cs = H + (m + 1) * m;
+  long double *sn = cs + m;
+  long double *g = sn + m;
+  const long double *rhs = vector_cdata(b);
+  long double *sol = vector_data(x);
+  bool broke_down = false;
+  S.stats.residual = residual(&S, rhs, sol, V);
+  while ((S.stats.residual > S.options.tolerance) &&
+         (S.stats.iterations < S.options.max_iterations) && !broke_down) {
+    const long double beta = S.stats.residual * S.b_norm;
+    for (int i = 0; i < n; i++) {
+      V[i] /= beta;
+    }
+    memset(g, 0, (m + 1) * sizeof(long double));
+    g[0] = beta;
+    int k = 0;
+    while ((k < m) && (S.stats.residual > S.options.tolerance) &&
+           (S.stats.iterations < S.options.max_iterations)) {
+      long double *h = H + (size_t) k * (m + 1);
+      long double *v_next = V + (size_t) (k + 1) * n;
+      //w = A M^-1 v_k, orthogonalized against v_0, ..., v_k
+      precondition(&S, V + (size_t) k * n, t);
+      apply(&S, t, w);
+      for (int i = 0; i <= k; i++) {
+        h[i] = dot(w, V + (size_t) i * n, n);
+        axpy(w, -h[i], V + (size_t) i * n, n);
+      }
+      h[k + 1] = sqrtl(dot(w, w, n));
+      if (h[k + 1] != 0) {
+        for (int i = 0; i < n; i++) {
+          v_next[i] = w[i] / h[k + 1];
+        }
+      }
+      //apply the earlier rotations to the new column, then zero h[k + 1]
+      for (int i = 0; i < k; i++) {
+        const long double hi = cs[i] * h[i] + sn[i] * h[i + 1];
+        h[i + 1] = -sn[i] * h[i] + cs[i] * h[i + 1];
+        h[i] = hi;
+      }
+      const long double radius = hypotl(h[k], h[k + 1]);
+      if (radius == 0) {
+        broke_down = true;
+        break;
+      }
+      cs[k] = h[k] / radius;
+      sn[k] = h[k + 1] / radius;
+      h[k] = radius;
+      h[k + 1] = 0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] *= cs[k];
+      INSTRUMENT_FLOPS(6LL * k + 3LL * n + 10);
+      k++;
+      S.stats.iterations++;
+      S.stats.residual = fabsl(g[k]) / S.b_norm;
+    }
+    //x += M^-1 V y, where Hy = g is solved by back substitution
+    for (int i = k - 1; i >= 0; i--) {
+      long double sum = g[i];
+      for (int j = i + 1; j < k; j++) {
+        sum -= H[(size_t) j * (m + 1) + i] * g[j];
+      }
+      g[i] = sum / H[(size_t) i * (m + 1) + i];
+    }
+    memset(w, 0, n * sizeof(long double));
+    for (int i = 0; i < k; i++) {
+      axpy(w, g[i], V + (size_t) i * n, n);
+    }
+    precondition(&S, w, t);
+    axpy(sol, 1, t, n);
+    INSTRUMENT_FLOPS((long long) k * k);
+    //the true residual starts the next cycle and guards against drift
+    S.stats.residual = residual(&S, rhs, sol, V);
+  }
+  S.stats.converged = S.stats.residual <= S.options.tolerance;
+  return solve_end(&S, stats, __func__);
+}
+
+enum linalg_status krylov_bicgstab(const struct linop * const A,
+                                   const struct vector * const b,
+                                   struct vector * const x,
+                                   const struct krylov_options * const options,
+                                   struct krylov_stats * const stats) {
+  INSTRUMENT_SCOPE(krylov_bicgstab);
+  struct solve S;
+  const enum linalg_status status = solve_begin(&S, A, b, x, options, 7, 0,
+                                                __func__);
+  INSTRUMENT_DIMS(S.n, S.n);
+  if ((status != LINALG_OK) || !S.work) {
+    if (stats) {
+      *stats = S.stats;
+    }
+    return status;
+  }
+  const int n = S.n;
+  long double *r = S.work;
+  long double *r0 = r + n;
+  long double *p = r0 + n;
+  long double *v = p + n;
+  long double *y = v + n;
+  long double *s = y + n;
+  long double *t = s + n;
+  long double *sol = vector_data(x);
+  S.stats.residual = residual(&S, vector_cdata(b), sol, r);
+  memcpy(r0, r, n * sizeof(long double));
+  memset(p, 0, n * sizeof(long double));
+  memset(v, 0, n * sizeof(long double));
+  long double rho = 1;
+  long double alpha = 1;
+  long double omega = 1;
+  while ((S.stats.residual > S.options.tolerance) &&
+         (S.stats.iterations < S.options.max_iterations)) {
+    const long double rho_next = dot(r0, r, n);
+    if (rho_next == 0) {
+      break;
+    }
+    const long double beta = (rho_next / rho) * (alpha / omega);
+    rho = rho_next;
+    for (int i = 0; i < n; i++) {
+      p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    }
+    INSTRUMENT_FLOPS(4LL * n);
+    precondition(&S, p, y);
+    apply(&S, y, v);
+    const long double r0v = dot(r0, v, n);
+    if (r0v == 0) {
+      break;
+    }
+    alpha = rho / r0v;
+    for (int i = 0; i < n; i++) {
+      s[i] = r[i] - alpha * v[i];
+    }
+    INSTRUMENT_FLOPS(2LL * n);
+    axpy(sol, alpha, y, n);
+    S.stats.iterations++;
+    const long double s_norm = sqrtl(dot(s, s, n)) / S.b_norm;
+    if (s_norm <= S.options.tolerance) {
+      memcpy(r, s, n * sizeof(long double));
+      S.stats.residual = s_norm;
+      break;
+    }
+    precondition(&S, s, y);
+    apply(&S, y, t);
+    const long double tt = dot(t, t, n);
+    omega = tt == 0 ? 0 : dot(t, s, n) / tt;
+    axpy(sol, omega, y, n);
+    for (int i = 0; i < n; i++) {
+      r[i] = s[i] - omega * t[i];
+    }
+    INSTRUMENT_FLOPS(2LL * n);
+    S.stats.residual = sqrtl(dot(r, r, n)) / S.b_norm;
+    if (omega == 0) {
+      break;
+    }
+  }
+  S.stats.converged = S.stats.residual <= S.options.tolerance;
+  return solve_end(&S, stats, __func__);
+}
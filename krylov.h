@@ -0,0 +1,111 @@
+#ifndef LINALG_KRYLOV_H
+#define LINALG_KRYLOV_H
+
+#include <stdbool.h>
+#include "status.h"
+
+//Large systems Ax = b are too expensive to solve with RREF or an inverse.
+//   The Krylov methods in this file only need to apply A to vectors, so A
+//   can be a struct matrix, a sparse matrix (see sparse.h) or any function
+//   that computes Ax. They refine a starting guess x until the residual
+//   b - Ax is small:
+//     krylov_cg        conjugate gradient, for symmetric positive definite A
+//     krylov_gmres     restarted GMRES, for any nonsingular A
+//     krylov_bicgstab  BiCGSTAB, for any nonsingular A, with short recurrences
+//   Each can be preconditioned by an operator M that approximates A^-1
+//   (see precond_jacobi and precond_ilu0 in sparse.h), which is applied
+//   once or twice per iteration. All the work vectors of a solve are
+//   allocated together when it starts and freed when it ends.
+
+struct vector;
+struct matrix;
+
+//A struct linop is a linear operator on R[n]: apply(data, x, y) must store
+//   the product of the operator and x in y, where x and y each hold n long
+//   doubles and do not overlap. data is passed through unchanged.
+struct linop {
+  int n;
+  void (*apply)(const void *data, const long double *x, long double *y);
+  const void *data;
+};
+
+//A struct krylov_options controls a solve. The solve stops when the norm of
+//   the residual is at most tolerance times the norm of b, or after
+//   max_iterations iterations. restart is the number of iterations GMRES
+//   runs before it restarts (ignored by the other methods). preconditioner
+//   is applied as an approximation of A^-1, or not at all if it is NULL.
+struct krylov_options {
+  long double tolerance;
+  int max_iterations;
+  int restart;
+  const struct linop *preconditioner;
+};
+
+//KRYLOV_DEFAULTS is used when no options are given: a tolerance of 1e-10,
+//   at most 1000 iterations, restarts every 30 and no preconditioner.
+extern const struct krylov_options KRYLOV_DEFAULTS;
+
+//A struct krylov_stats describes a finished solve. residual is the norm of
+//   the residual the method tracked, relative to the norm of b. A solve that
+//   broke down (a division by zero in its recurrences, which CG also reports
+//   for a matrix that is not positive definite) has not converged.
+struct krylov_stats {
+  bool converged;
+  int iterations;
+  int applications;
+  int preconditioner_applications;
+  long double residual;
+};
+
+//linop_matrix(A) returns the operator x -> Ax. A is not copied: it must
+//   stay alive and keep its size while the operator is used.
+//requires: A is not NULL, A is n x n with n >= 1
+struct linop linop_matrix(const struct matrix * const A);
+
+//krylov_cg(A, b, x, options, stats) solves Ax = b by the conjugate gradient
+//   method, starting from the guess in x and leaving the last iterate there.
+//   It returns LINALG_OK if the solve converged. If the sizes of A, b and x
+//   do not fit, it reports LINALG_ERR_DIMENSION and leaves x unchanged; if
+//   the solve does not converge or breaks down, it reports
+//   LINALG_ERR_NO_CONVERGENCE. options may be NULL (see KRYLOV_DEFAULTS), as
+//   may stats; otherwise *stats describes the solve.
+//requires: A, b, x are not NULL
+//          A is symmetric positive definite, and so is the preconditioner
+//effects: may modify x and *stats
+//         may print output
+//         allocates and frees heap memory
+enum linalg_status krylov_cg(const struct linop * const A,
+                             const struct vector * const b,
+                             struct vector * const x,
+                             const struct krylov_options * const options,
+                             struct krylov_stats * const stats);
+
+//krylov_gmres(A, b, x, options, stats) is like krylov_cg, but uses GMRES
+//   restarted every options->restart iterations, preconditioned on the
+//   right, and works for any nonsingular A. It keeps restart + 1 vectors, so
+//   a larger restart converges in fewer iterations but takes more memory.
+//requires: A, b, x are not NULL
+//          options is NULL or options->restart >= 1
+//effects: may modify x and *stats
+//         may print output
+//         allocates and frees heap memory
+enum linalg_status krylov_gmres(const struct linop * const A,
+                                const struct vector * const b,
+                                struct vector * const x,
+                                const struct krylov_options * const options,
+                                struct krylov_stats * const stats);
+
+//krylov_bicgstab(A, b, x, options, stats) is like krylov_cg, but uses
+//   BiCGSTAB, preconditioned on the right, and works for any nonsingular A.
+//   Each iteration applies A twice.
+//requires: A, b, x are not NULL
+//effects: may modify x and *stats
+//         may print output
+//         allocates and frees heap memory
+enum linalg_status krylov_bicgstab(const struct linop * const A,
+                                   const struct vector * const b,
+                                   struct vector * const x,
+                                   const struct krylov_options * const options,
+                                   struct krylov_stats * const stats);
+
+#endif
@@ -0,0 +1,698 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "matrix_cache.h"
+#include "lu.h"
+#include "krylov.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+struct lu_factorization {
+  int n;
+  //L (below the diagonal, unit diagonal implied) and U (on and above it),
+  //   row-major
+  long double *lu;
+  //row i of PA is row perm[i] of A
+  int *perm;
+  //determinant of P, 1 or -1
+  int sign;
+  bool singular;
+  //after lu_update, the factored matrix is A + U V^T for the A above and a
+  //   rank k change U V^T, kept through z = A^-1 U and v = V (n x k, by
+  //   columns) and the LU factorization of the k x k capacitance matrix
+  //   C = I + V^T A^-1 U (by rows, with its own perm and sign)
+  int k;
+  long double *z;
+  long double *v;
+  long double *cap;
+  int *cap_perm;
+  int cap_sign;
+  //the largest absolute value of an entry of A, the scale of its pivots
+  long double largest;
+  size_t bytes;
+};
+
+//steps of the condition estimator, each of which solves two systems
+static const int MAX_ESTIMATES = 5;
+
+//abs_ld(x) returns the absolute value of x.
+static long double abs_ld(const long double x) {
+  return x < 0 ? -x : x;
+}
+
+//tiny_pivot(a, n, largest) returns true if a pivot on the diagonal of the
+//   n x n factors in a (row-major) is 0 or at most n LDBL_EPSILON times
+//   largest, the largest absolute value of an entry of the factored matrix:
+//   then the matrix is within rounding of a singular one. Unlike a test of
+//   the determinant, this does not depend on the scale of the matrix.
+//requires: a is not NULL
+static bool tiny_pivot(const long double * const a, const int n,
+                       const long double largest) {
+  const long double tolerance = n * LDBL_EPSILON * largest;
+  for (int k = 0; k < n; k++) {
+    const long double pivot = abs_ld(a[k * n + k]);
+    if ((pivot == 0) || (pivot <= tolerance)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+struct lu_factorization *lu_factor(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(lu_factor);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m != n) || (n < 1)) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. Matrix must be n x n where n is positive.");
+    return NULL;
+  }
+  struct lu_factorization *f = malloc(sizeof(struct lu_factorization));
+  f->n = n;
+  f->lu = malloc(n * n * sizeof(long double));
+  f->perm = malloc(n * sizeof(int));
+  f->bytes = sizeof(struct lu_factorization) +
+             n * n * sizeof(long double) + n * sizeof(int);
+  INSTRUMENT_ALLOC(f->bytes);
+  f->sign = 1;
+  f->singular = false;
+  f->k = 0;
+  f->z = NULL;
+  f->v = NULL;
+  f->cap = NULL;
+  f->cap_perm = NULL;
+  f->cap_sign = 1;
+  f->largest = 0;
+  for (int i = 0; i < n; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    memcpy(f->lu + i * n, row, n * sizeof(long double));
+    for (int j = 0; j < n; j++) {
+      if (abs_ld(row[j]) > f->largest) {
+        f->largest = abs_ld(row[j]);
+      }
+    }
+    f->perm[i] = i;
+  }
+  long double * const a = f->lu;
+  for (int k = 0; k < n; k++) {
+    int pivot = k;
+    for (int i = k + 1; i < n; i++) {
+      if (abs_ld(a[i * n + k]) > abs_ld(a[pivot * n + k])) {
+        pivot = i;
+      }
+    }
+    if (pivot != k) {
+      for (int j = 0; j < n; j++) {
+        const long double temp = a[k * n + j];
+        a[k * n + j] = a[pivot * n + j];
+        a[pivot * n + j] = temp;
+      }
+      const int temp = f->perm[k];
+      f->perm[k] = f->perm[pivot];
+      f->perm[pivot] = temp;
+      f->sign = -f->sign;
+    }
+    const long double u_kk = a[k * n + k];
+    if (u_kk == 0) {
+      //the column is already zero below the diagonal
+      continue;
+    }
+    for (int i = k + 1; i < n; i++) {
+      const long double l_ik = a[i * n + k] / u_kk;
+      a[i * n + k] = l_ik;
+      if (l_ik != 0) {
+        for (int j = k + 1; j < n; j++) {
+          a[i * n + j] -= l_ik * a[k * n + j];
+        }
+      }
+    }
+    INSTRUMENT_FLOPS((long long) (n - k - 1) * (2 * (n - k - 1) + 1));
+  }
+  f->singular = tiny_pivot(f->lu, n, f->largest);
+  return f;
+}
+
+const struct lu_factorization *matrix_lu(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_lu);
+  INSTRUMENT_MATRIX_DIMS(A);
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!cache->lu) {
+    cache->lu = lu_factor(A);
+  }
+  return cache->lu;
+}
+
+int lu_dim(const struct lu_factorization * const lu) {
+  assert(lu);
+  return lu->n;
+}
+
+bool lu_singular(const struct lu_factorization * const lu) {
+  assert(lu);
+  return lu->singular;
+}
+
+long double lu_det(const struct lu_factorization * const lu) {
+  assert(lu);
+  const int n = lu->n;
+  long double det = lu->sign;
+  for (int k = 0; k < n; k++) {
+    det *= lu->lu[k * n + k];
+  }
+  //det(A + U V^T) = det(A) det(C), the matrix determinant lemma
+  det *= lu->cap_sign;
+  for (int j = 0; j < lu->k; j++) {
+    det *= lu->cap[j * lu->k + j];
+  }
+  INSTRUMENT_FLOPS(n + lu->k);
+  return det;
+}
+
+void lu_det_scaled(const struct lu_factorization * const lu,
+                   long double * const mantissa, long * const exponent) {
+  assert(lu);
+  assert(mantissa);
+  assert(exponent);
+  const int n = lu->n;
+  //every factor is split into a fraction in [0.5, 1) and a power of 2, so
+  //   the running product of the fractions stays in [0.25, 1)
+  long double m = lu->sign * lu->cap_sign;
+  long e = 0;
+  int shift = 0;
+  for (int k = 0; k < n + lu->k; k++) {
+    const long double x = k < n ? lu->lu[k * n + k]
+                                : lu->cap[(k - n) * lu->k + (k - n)];
+    m *= frexpl(x, &shift);
+    e += shift;
+    m = frexpl(m, &shift);
+    e += shift;
+  }
+  INSTRUMENT_FLOPS(n + lu->k);
+  *mantissa = m;
+  *exponent = m == 0 ? 0 : e;
+}
+
+//base_solve(lu, b, x) solves Ax = b for the matrix A factored before any
+//   update.
+//requires: lu, b, x are not NULL, b and x do not overlap
+//effects: modifies x
+static void base_solve(const struct lu_factorization * const lu,
+                       const long double * const b, long double * const x) {
+  const int n = lu->n;
+  const long double * const a = lu->lu;
+  //Ly = Pb
+  for (int i = 0; i < n; i++) {
+    long double sum = b[lu->perm[i]];
+    for (int j = 0; j < i; j++) {
+      sum -= a[i * n + j] * x[j];
+    }
+    x[i] = sum;
+  }
+  //Ux = y
+  for (int i = n - 1; i >= 0; i--) {
+    long double sum = x[i];
+    for (int j = i + 1; j < n; j++) {
+      sum -= a[i * n + j] * x[j];
+    }
+    x[i] = sum / a[i * n + i];
+  }
+  INSTRUMENT_FLOPS(2LL * n * n);
+}
+
+void lu_solve_into(const struct lu_factorization * const lu,
+                   const long double * const b, long double * const x) {
+  assert(lu);
+  assert(b);
+  assert(x);
+  base_solve(lu, b, x);
+  const int n = lu->n;
+  const int k = lu->k;
+  if (k == 0) {
+    return;
+  }
+  //Woodbury: (A + U V^T)^-1 b = A^-1 b - Z C^-1 V^T A^-1 b
+  long double *w = malloc(2 * k * sizeof(long double));
+  INSTRUMENT_ALLOC(2 * k * sizeof(long double));
+  long double * const y = w + k;
+  for (int j = 0; j < k; j++) {
+    const long double *vj = lu->v + (size_t) j * n;
+    long double sum = 0;
+    for (int i = 0; i < n; i++) {
+      sum += vj[i] * x[i];
+    }
+    w[j] = sum;
+  }
+  for (int i = 0; i < k; i++) {
+    long double sum = w[lu->cap_perm[i]];
+    for (int j = 0; j < i; j++) {
+      sum -= lu->cap[i * k + j] * y[j];
+    }
+    y[i] = sum;
+  }
+  for (int i = k - 1; i >= 0; i--) {
+    long double sum = y[i];
+    for (int j = i + 1; j < k; j++) {
+      sum -= lu->cap[i * k + j] * y[j];
+    }
+    y[i] = sum / lu->cap[i * k + i];
+  }
+  for (int j = 0; j < k; j++) {
+    const long double *zj = lu->z + (size_t) j * n;
+    for (int i = 0; i < n; i++) {
+      x[i] -= zj[i] * y[j];
+    }
+  }
+  INSTRUMENT_FREE(2 * k * sizeof(long double));
+  free(w);
+  INSTRUMENT_FLOPS(4LL * n * k + 2LL * k * k);
+}
+
+struct vector *lu_solve(const struct lu_factorization * const lu,
+                        const struct vector * const b) {
+  INSTRUMENT_SCOPE(lu_solve);
+  assert(lu);
+  assert(b);
+  INSTRUMENT_DIMS(lu->n, lu->n);
+  if (vector_dim(b) != lu->n) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "A vector with %d elements cannot be the right side of a "
+                  "system with %d unknowns.", vector_dim(b), lu->n);
+    return NULL;
+  } else if (lu->singular) {
+    linalg_report(LINALG_ERR_SINGULAR, __func__,
+                  "The matrix is not invertible.");
+    return NULL;
+  }
+  struct vector *x = vector_create_zero(lu->n);
+  lu_solve_into(lu, vector_cdata(b), vector_data(x));
+  return x;
+}
+
+struct matrix *lu_inverse(const struct lu_factorization * const lu) {
+  INSTRUMENT_SCOPE(lu_inverse);
+  assert(lu);
+  const int n = lu->n;
+  INSTRUMENT_DIMS(n, n);
+  if (lu->singular) {
+    linalg_report(LINALG_ERR_SINGULAR, __func__,
+                  "The matrix is not invertible.");
+    return NULL;
+  }
+  struct matrix *inv = matrix_create_zero(n, n);
+  long double *e = calloc(2 * n, sizeof(long double));
+  INSTRUMENT_ALLOC(2 * n * sizeof(long double));
+  long double * const x = e + n;
+  for (int j = 0; j < n; j++) {
+    e[j] = 1;
+    lu_solve_into(lu, e, x);
+    e[j] = 0;
+    for (int i = 0; i < n; i++) {
+      matrix_row_data(inv, i + 1)[j] = x[i];
+    }
+  }
+  INSTRUMENT_FREE(2 * n * sizeof(long double));
+  free(e);
+  return inv;
+}
+
+//transpose_solve(a, perm, n, c, x, w) solves M^T x = c for the n long
+//   doubles of x, where a (row-major) and perm hold PM = LU for an n x n
+//   matrix M as in struct lu_factorization, using the n long doubles of w:
+//   U^T w = c, then L^T w = w, and x = P^T w. c is read before x is
+//   written, so the two may be the same array.
+//requires: a, perm, c, x, w are not NULL, w overlaps neither c nor x
+//effects: modifies x and w
+static void transpose_solve(const long double * const a,
+                            const int * const perm, const int n,
+                            const long double * const c,
+                            long double * const x, long double * const w) {
+  for (int i = 0; i < n; i++) {
+    w[i] = c[i];
+  }
+  for (int k = 0; k < n; k++) {
+    const long double * const rk = a + (size_t) k * n;
+    w[k] /= rk[k];
+    for (int i = k + 1; i < n; i++) {
+      w[i] -= rk[i] * w[k];
+    }
+  }
+  for (int k = n - 1; k >= 0; k--) {
+    const long double * const rk = a + (size_t) k * n;
+    for (int i = 0; i < k; i++) {
+      w[i] -= rk[i] * w[k];
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    x[perm[i]] = w[i];
+  }
+  INSTRUMENT_FLOPS(2LL * n * n);
+}
+
+//solve_transpose_into(lu, c, x) solves A^T x = c for the n long doubles of
+//   x, where A is the factored matrix. After an update,
+//   (A + U V^T)^-T c = A^-T (c - V C^-T Z^T c) with Z = A^-1 U, by the
+//   Sherman-Morrison-Woodbury formula for A^T + V U^T.
+//requires: lu, c, x are not NULL, c and x do not overlap
+//effects: modifies x
+static void solve_transpose_into(const struct lu_factorization * const lu,
+                                 const long double * const c,
+                                 long double * const x) {
+  const int n = lu->n;
+  const int k = lu->k;
+  long double *w = malloc((n + 3 * k) * sizeof(long double));
+  INSTRUMENT_ALLOC((n + 3 * k) * sizeof(long double));
+  if (k <= 0) {
+    transpose_solve(lu->lu, lu->perm, n, c, x, w);
+  } else {
+    long double * const s = w + n;
+    long double * const t = s + k;
+    for (int j = 0; j < k; j++) {
+      const long double *zj = lu->z + (size_t) j * n;
+      long double sum = 0;
+      for (int i = 0; i < n; i++) {
+        sum += zj[i] * c[i];
+      }
+      s[j] = sum;
+    }
+    transpose_solve(lu->cap, lu->cap_perm, k, s, t, t + k);
+    for (int i = 0; i < n; i++) {
+      x[i] = c[i];
+    }
+    for (int j = 0; j < k; j++) {
+      const long double *vj = lu->v + (size_t) j * n;
+      for (int i = 0; i < n; i++) {
+        x[i] -= vj[i] * t[j];
+      }
+    }
+    transpose_solve(lu->lu, lu->perm, n, x, x, w);
+    INSTRUMENT_FLOPS(4LL * n * k);
+  }
+  INSTRUMENT_FREE((n + 3 * k) * sizeof(long double));
+  free(w);
+}
+
+//apply_inverse(data, b, x) and apply_inverse_transpose(data, c, x) solve
+//   Ax = b and A^T x = c for the factorization data, as struct linop
+//   operators (see krylov.h).
+//requires: data, b, c, x are not NULL, x overlaps neither b nor c
+//          lu_singular(data) is false
+//effects: modifies x
+static void apply_inverse(const void *data, const long double *b,
+                          long double *x) {
+  lu_solve_into(data, b, x);
+}
+
+static void apply_inverse_transpose(const void *data, const long double *c,
+                                    long double *x) {
+  solve_transpose_into(data, c, x);
+}
+
+long double lu_inverse_norm_1(const struct lu_factorization * const lu) {
+  INSTRUMENT_SCOPE(lu_inverse_norm_1);
+  assert(lu);
+  const int n = lu->n;
+  INSTRUMENT_DIMS(n, n);
+  for (int i = 0; i < n + lu->k; i++) {
+    const long double pivot = i < n ? lu->lu[i * n + i]
+                                    : lu->cap[(i - n) * lu->k + (i - n)];
+    if (pivot == 0) {
+      return INFINITY;
+    }
+  }
+  const struct linop inverse = {n, apply_inverse, lu};
+  const struct linop inverse_transpose = {n, apply_inverse_transpose, lu};
+  return inverse_norm_1_estimate(&inverse, &inverse_transpose);
+}
+
+long double inverse_norm_1_estimate(const struct linop * const inverse,
+                                    const struct linop * const
+                                      inverse_transpose) {
+  assert(inverse);
+  assert(inverse_transpose);
+  assert(inverse->n == inverse_transpose->n);
+  const int n = inverse->n;
+  const size_t bytes = 3 * (size_t) n * sizeof(long double);
+  long double *x = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  long double * const y = x + n;
+  long double * const sign = y + n;
+  for (int i = 0; i < n; i++) {
+    x[i] = 1.0L / n;
+  }
+  //Hager's method as refined by Higham: |A^-1 x|_1 is convex in x, and
+  //   its maximum over |x|_1 = 1 is |A^-1|_1, reached at some e_j; climb
+  //   along the gradient A^-T sign(A^-1 x) from one e_j to a better one
+  long double estimate = 0;
+  int j = -1;
+  for (int step = 0; step < MAX_ESTIMATES; step++) {
+    inverse->apply(inverse->data, x, y);
+    long double norm = 0;
+    bool same_signs = step > 0;
+    for (int i = 0; i < n; i++) {
+      norm += abs_ld(y[i]);
+      const long double s = y[i] >= 0 ? 1 : -1;
+      same_signs = same_signs && (s == sign[i]);
+      sign[i] = s;
+    }
+    if ((step > 0) && (same_signs || (norm <= estimate))) {
+      estimate = norm > estimate ? norm : estimate;
+      break;
+    }
+    estimate = norm;
+    inverse_transpose->apply(inverse_transpose->data, sign, y);
+    int next = 0;
+    for (int i = 1; i < n; i++) {
+      if (abs_ld(y[i]) > abs_ld(y[next])) {
+        next = i;
+      }
+    }
+    if ((j >= 0) && (abs_ld(y[next]) <= abs_ld(y[j]))) {
+      break;
+    }
+    j = next;
+    for (int i = 0; i < n; i++) {
+      x[i] = i == j ? 1 : 0;
+    }
+  }
+  //a vector of alternating signs catches the matrices on which the climb
+  //   stops early
+  for (int i = 0; i < n; i++) {
+    x[i] = (i % 2 ? -1 : 1) * (1 + (n > 1 ? (long double) i / (n - 1) : 0));
+  }
+  inverse->apply(inverse->data, x, y);
+  long double norm = 0;
+  for (int i = 0; i < n; i++) {
+    norm += abs_ld(y[i]);
+  }
+  norm = 2 * norm / (3 * n);
+  INSTRUMENT_FREE(bytes);
+  free(x);
+  return norm > estimate ? norm : estimate;
+}
+
+struct matrix *lu_adjugate(const struct lu_factorization * const lu) {
+  INSTRUMENT_SCOPE(lu_adjugate);
+  assert(lu);
+  const int n = lu->n;
+  INSTRUMENT_DIMS(n, n);
+  if (lu->k > 0) {
+    //without the factors of the updated matrix, only det(A) A^-1 is at hand
+    if (lu->singular) {
+      linalg_report(LINALG_ERR_SINGULAR, __func__,
+                    "The updated matrix is not invertible.");
+      return NULL;
+    }
+    struct matrix *adj = lu_inverse(lu);
+    const long double det = lu_det(lu);
+    for (int i = 1; i <= n; i++) {
+      long double *row = matrix_row_data(adj, i);
+      for (int j = 0; j < n; j++) {
+        row[j] *= det;
+      }
+    }
+    INSTRUMENT_FLOPS((long long) n * n);
+    return adj;
+  }
+  const long double * const a = lu->lu;
+  //adj(XY) = adj(Y) adj(X) for all square X and Y, so from A = P^T L U,
+  //   adj(A) = adj(U) adj(L) adj(P^T) = sign adj(U) L^-1 P
+  const size_t bytes = (size_t) n * n * sizeof(long double);
+  long double *w = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  memset(w, 0, bytes);
+  //adj(U) grows one leading submatrix at a time without dividing, so a zero
+  //   (or tiny) pivot needs no special case: if U_k is the leading k x k
+  //   submatrix and r the column above u_kk, then
+  //   adj(U_k+1) = [u_kk adj(U_k), -adj(U_k) r; 0, det(U_k)]
+  w[0] = 1;
+  long double minor = a[0];
+  for (int k = 1; k < n; k++) {
+    const long double u_kk = a[k * n + k];
+    for (int i = 0; i < k; i++) {
+      long double * const wi = w + (size_t) i * n;
+      long double sum = 0;
+      for (int j = i; j < k; j++) {
+        sum += wi[j] * a[j * n + k];
+        wi[j] *= u_kk;
+      }
+      wi[k] = -sum;
+    }
+    w[(size_t) k * n + k] = minor;
+    minor *= u_kk;
+  }
+  INSTRUMENT_FLOPS((long long) n * n * n / 2);
+  //each row x of adj(U) L^-1 solves x L = w, from the last entry back
+  struct matrix *adj = matrix_create_zero(n, n);
+  for (int i = 0; i < n; i++) {
+    long double * const x = w + (size_t) i * n;
+    for (int j = n - 1; j >= 0; j--) {
+      long double sum = x[j];
+      for (int t = j + 1; t < n; t++) {
+        sum -= x[t] * a[t * n + j];
+      }
+      x[j] = sum;
+    }
+    long double *row = matrix_row_data(adj, i + 1);
+    for (int j = 0; j < n; j++) {
+      row[lu->perm[j]] = lu->sign * x[j];
+    }
+  }
+  INSTRUMENT_FLOPS((long long) n * n * n);
+  INSTRUMENT_FREE(bytes);
+  free(w);
+  return adj;
+}
+
+struct lu_factorization *lu_update(const struct lu_factorization * const lu,
+                                   const struct matrix * const U,
+                                   const struct matrix * const V) {
+  INSTRUMENT_SCOPE(lu_update);
+  assert(lu);
+  assert(U);
+  assert(V);
+  const int n = lu->n;
+  int um, uk, vm, vk = 0;
+  matrix_size(U, &um, &uk);
+  matrix_size(V, &vm, &vk);
+  INSTRUMENT_DIMS(n, uk);
+  if ((um != n) || (vm != n) || (uk != vk) || (uk < 1)) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. U and V must both be %d x k for some "
+                  "positive k.", n);
+    return NULL;
+  }
+  if (tiny_pivot(lu->lu, n, lu->largest)) {
+    linalg_report(LINALG_ERR_SINGULAR, __func__,
+                  "The matrix before the first update is not invertible.");
+    return NULL;
+  }
+  const int k = lu->k + uk;
+  struct lu_factorization *f = malloc(sizeof(struct lu_factorization));
+  f->n = n;
+  f->lu = malloc(n * n * sizeof(long double));
+  f->perm = malloc(n * sizeof(int));
+  memcpy(f->lu, lu->lu, n * n * sizeof(long double));
+  memcpy(f->perm, lu->perm, n * sizeof(int));
+  f->sign = lu->sign;
+  f->largest = lu->largest;
+  f->k = k;
+  f->z = malloc(((size_t) 2 * n * k + (size_t) k * k) * sizeof(long double));
+  f->v = f->z + (size_t) n * k;
+  f->cap = f->v + (size_t) n * k;
+  f->cap_perm = malloc(k * sizeof(int));
+  f->bytes = sizeof(struct lu_factorization) +
+             ((size_t) n * n + (size_t) 2 * n * k + (size_t) k * k) *
+             sizeof(long double) + ((size_t) n + k) * sizeof(int);
+  INSTRUMENT_ALLOC(f->bytes);
+  //the earlier changes are kept, and each new column adds A^-1 u
+  if (lu->k) {
+    memcpy(f->z, lu->z, (size_t) n * lu->k * sizeof(long double));
+    memcpy(f->v, lu->v, (size_t) n * lu->k * sizeof(long double));
+  }
+  long double *u = malloc(n * sizeof(long double));
+  INSTRUMENT_ALLOC(n * sizeof(long double));
+  for (int j = 0; j < uk; j++) {
+    long double *vj = f->v + (size_t) (lu->k + j) * n;
+    for (int i = 0; i < n; i++) {
+      u[i] = matrix_row_cdata(U, i + 1)[j];
+      vj[i] = matrix_row_cdata(V, i + 1)[j];
+    }
+    base_solve(lu, u, f->z + (size_t) (lu->k + j) * n);
+  }
+  INSTRUMENT_FREE(n * sizeof(long double));
+  free(u);
+  //C = I + V^T Z, factored with partial pivoting
+  long double * const c = f->cap;
+  long double largest = 0;
+  for (int i = 0; i < k; i++) {
+    const long double *vi = f->v + (size_t) i * n;
+    for (int j = 0; j < k; j++) {
+      const long double *zj = f->z + (size_t) j * n;
+      long double sum = i == j;
+      for (int l = 0; l < n; l++) {
+        sum += vi[l] * zj[l];
+      }
+      c[i * k + j] = sum;
+      if (abs_ld(sum) > largest) {
+        largest = abs_ld(sum);
+      }
+    }
+    f->cap_perm[i] = i;
+  }
+  f->cap_sign = 1;
+  for (int j = 0; j < k; j++) {
+    int pivot = j;
+    for (int i = j + 1; i < k; i++) {
+      if (abs_ld(c[i * k + j]) > abs_ld(c[pivot * k + j])) {
+        pivot = i;
+      }
+    }
+    if (pivot != j) {
+      for (int l = 0; l < k; l++) {
+        const long double temp = c[j * k + l];
+        c[j * k + l] = c[pivot * k + l];
+        c[pivot * k + l] = temp;
+      }
+      const int temp = f->cap_perm[j];
+      f->cap_perm[j] = f->cap_perm[pivot];
+      f->cap_perm[pivot] = temp;
+      f->cap_sign = -f->cap_sign;
+    }
+    if (c[j * k + j] == 0) {
+      continue;
+    }
+    for (int i = j + 1; i < k; i++) {
+      const long double l_ij = c[i * k + j] / c[j * k + j];
+      c[i * k + j] = l_ij;
+      for (int l = j + 1; l < k; l++) {
+        c[i * k + l] -= l_ij * c[j * k + l];
+      }
+    }
+  }
+  INSTRUMENT_FLOPS(2LL * n * k * k + 2LL * k * k * k / 3);
+  //A is invertible, so A + U V^T is singular exactly when C is
+  f->singular = tiny_pivot(c, k, largest);
+  return f;
+}
+
+void lu_destroy(struct lu_factorization * const lu) {
+  if (!lu) {
+    return;
+  }
+  INSTRUMENT_FREE(lu->bytes);
+  free(lu->lu);
+  free(lu->perm);
+  free(lu->z);
+  free(lu->cap_perm);
+  free(lu);
+}
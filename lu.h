@@ -0,0 +1,149 @@
+#ifndef LINALG_LU_H
+#define LINALG_LU_H
+
+#include <stdbool.h>
+
+//An LU factorization with partial pivoting of an n x n matrix A stores a
+//   row permutation P, a unit lower triangular L and an upper triangular U
+//   with PA = LU. Once A is factored, its determinant takes O(n) time and
+//   every linear system Ax = b takes O(n^2).
+struct lu_factorization;
+struct vector;
+struct matrix;
+struct linop;
+
+//lu_factor(A) returns the LU factorization of A through a heap-allocated
+//   pointer that the caller must free with lu_destroy(). If A is empty or not
+//   square, it outputs an error message and returns NULL. A singular A is
+//   factored too (see lu_singular).
+//requires: A is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct lu_factorization *lu_factor(const struct matrix * const A);
+
+//matrix_lu(A) is like lu_factor(A), but the factorization belongs to A: it
+//   is computed once, reused until A is modified, and freed together with A.
+//   The caller must not free or keep the pointer after modifying A.
+//requires: A is not NULL
+//effects: may print output
+//         may allocate heap memory
+const struct lu_factorization *matrix_lu(const struct matrix * const A);
+
+//lu_dim(lu) returns n, the dimension of the factored matrix.
+//requires: lu is not NULL
+int lu_dim(const struct lu_factorization * const lu);
+
+//lu_singular(lu) returns true if a pivot of the factorization is 0 or at
+//   most n LDBL_EPSILON times the largest absolute value of an entry of the
+//   factored matrix (for an updated factorization, of its k x k matrix C),
+//   in which case the matrix is treated as not invertible and systems are
+//   not solved. The test does not depend on the scale of the matrix, so
+//   0.5 I is invertible however large n is.
+//requires: lu is not NULL
+bool lu_singular(const struct lu_factorization * const lu);
+
+//lu_det(lu) returns the determinant of the factored matrix.
+//requires: lu is not NULL
+long double lu_det(const struct lu_factorization * const lu);
+
+//lu_det_scaled(lu, mantissa, exponent) stores in *mantissa and *exponent the
+//   determinant of the factored matrix as mantissa * 2^exponent, where
+//   0.5 <= |mantissa| < 1, or both 0 if the determinant is 0. Unlike lu_det,
+//   it neither overflows nor underflows however large n is.
+//requires: lu, mantissa, exponent are not NULL
+//effects: modifies *mantissa and *exponent
+void lu_det_scaled(const struct lu_factorization * const lu,
+                   long double * const mantissa, long * const exponent);
+
+//lu_solve(lu, b) returns the solution x of Ax = b, where A is the factored
+//   matrix, through a heap-allocated pointer that the caller must free with
+//   vector_destroy(). If A is singular or b has the wrong dimension, it
+//   outputs an error message and returns NULL.
+//requires: lu, b are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct vector *lu_solve(const struct lu_factorization * const lu,
+                        const struct vector * const b);
+
+//lu_inverse(lu) returns the inverse of the factored matrix through a
+//   heap-allocated pointer that the caller must free with matrix_destroy().
+//   If the matrix is singular, it outputs an error message and returns NULL.
+//requires: lu is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct matrix *lu_inverse(const struct lu_factorization * const lu);
+
+//lu_inverse_norm_1(lu) returns an estimate of the 1-norm of the inverse of
+//   the factored matrix A, without forming the inverse: Hager's method, as
+//   refined by Higham, solves at most a dozen systems with A or A^T, so it
+//   costs O(n^2) once A is factored. The estimate never exceeds |A^-1|_1
+//   and is rarely less than a third of it. Times the 1-norm of A, it
+//   estimates the condition number of A (see matrix_cond_1 in
+//   inv_and_det.h). It returns INFINITY if a pivot is 0.
+//requires: lu is not NULL
+//effects: allocates and frees heap memory
+long double lu_inverse_norm_1(const struct lu_factorization * const lu);
+
+//lu_adjugate(lu) returns the adjugate of the factored matrix A, the matrix
+//   with A adj(A) = det(A) I, through a heap-allocated pointer that the
+//   caller must free with matrix_destroy(). It takes O(n^3) time and stays
+//   accurate when A is singular or nearly so, where adj(A) is det(A) A^-1
+//   no longer: it is the product adj(U) L^-1 P up to sign, and adj(U) is
+//   built without dividing by the pivots of U. If lu came from lu_update and
+//   the updated matrix is singular, it outputs an error message and returns
+//   NULL.
+//requires: lu is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct matrix *lu_adjugate(const struct lu_factorization * const lu);
+
+//lu_update(lu, U, V) returns the factorization of A + U V^T, where A is the
+//   matrix factored by lu and U and V are n x k, through a heap-allocated
+//   pointer that the caller must free with lu_destroy(); lu is unchanged. It
+//   takes O(n^2 k) time instead of the O(n^3) of lu_factor: the new
+//   factorization keeps the one of A, with A^-1 U and the LU factorization of
+//   the k x k matrix C = I + V^T A^-1 U, and solves systems by the
+//   Sherman-Morrison-Woodbury formula in O(n^2 + nk + k^2). Its determinant
+//   is det(A) det(C) (the matrix determinant lemma). Updating an updated
+//   factorization adds to its k, so after many updates, factoring the
+//   matrix again becomes cheaper. Replacing row i of A by r is the rank one
+//   change with U = e_i and V = (r - row i)^T, and replacing column j by c
+//   the one with U = c - column j and V = e_j. If U and V are not both n x k
+//   with k positive, it outputs an error message and returns NULL; if the
+//   A first factored is singular, it reports LINALG_ERR_SINGULAR and returns
+//   NULL.
+//requires: lu, U, V are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct lu_factorization *lu_update(const struct lu_factorization * const lu,
+                                   const struct matrix * const U,
+                                   const struct matrix * const V);
+
+//lu_destroy(lu) frees all heap memory allocated to lu. Passing NULL does
+//   nothing.
+//effects: frees heap memory
+void lu_destroy(struct lu_factorization * const lu);
+
+
+//The rest of this file is used by the toolbox itself.
+
+//lu_solve_into(lu, b, x) solves Ax = b for the n long doubles of x, where A
+//   is the factored matrix and b holds n long doubles.
+//requires: lu, b, x are not NULL, b and x do not overlap
+//          lu_singular(lu) is false
+//effects: modifies x
+void lu_solve_into(const struct lu_factorization * const lu,
+                   const long double * const b, long double * const x);
+
+//inverse_norm_1_estimate(inverse, inverse_transpose) returns an estimate of
+//   the 1-norm of A^-1 for an invertible n x n matrix A known only through
+//   the operators inverse, x -> A^-1 x, and inverse_transpose, x -> A^-T x,
+//   by Hager's method as refined by Higham (see lu_inverse_norm_1). Any
+//   factorization of A can supply the two operators.
+//requires: inverse, inverse_transpose are not NULL and have the same n >= 1
+//effects: allocates and frees heap memory
+long double inverse_norm_1_estimate(const struct linop * const inverse,
+                                    const struct linop * const
+                                      inverse_transpose);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef LINALG_MATRIX_CACHE_H
+#define LINALG_MATRIX_CACHE_H
+
+#include <stdbool.h>
+
+//Every matrix carries a version number that each modification increases
+//   (see matrix_version in matrix_core.h). Results derived from a matrix, such
+//   as its determinant, RREF or LU factorization, are kept in a cache attached
+//   to the matrix and tagged with the version they were computed from, so
+//   asking the same question twice about an unchanged matrix does not redo
+//   the work. Asking for the cache after the matrix was modified discards the
+//   stale results first.
+//This file is used by the toolbox itself; clients only see the effects
+//   through faster repeated calls.
+//The cache is filled by functions that take const matrices, so two threads
+//   must not query the same matrix at the same time (they may query different
+//   matrices).
+
+struct matrix;
+struct lu_factorization;
+
+//flags in struct matrix_cache's valid field
+enum matrix_cache_entry {
+  CACHE_DET = 1,
+  CACHE_RANK = 2,
+  CACHE_NORM_1 = 4,
+  CACHE_SYMMETRIC = 8,
+  CACHE_STRUCTURE = 16,
+  CACHE_INTEGRAL = 32,
+  CACHE_COND_1 = 64
+};
+
+//A struct matrix_cache holds the results derived from one version of a
+//   matrix. The scalar fields are meaningful only when their flag is set in
+//   valid; the pointer fields are NULL until computed and are owned by the
+//   cache.
+struct matrix_cache {
+  unsigned long version;
+  unsigned valid;
+  long double det;
+  int rank;
+  long double norm_1;
+  long double cond_1;
+  bool symmetric;
+  unsigned structure;
+  bool integral;
+  struct lu_factorization *lu;
+  struct matrix *rref;
+  struct matrix *inverse;
+};
+
+//matrix_cache(A) returns the cache of A, emptied first if A was modified
+//   since the cache was last filled.
+//requires: A is not NULL
+//effects: may allocate heap memory
+//         may free heap memory
+struct matrix_cache *matrix_cache(const struct matrix * const A);
+
+#endif
@@ -1,35 +1,163 @@
 #include <assert.h>
+#include <stdbool.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "vector_core.h"
+#include "matrix_core.h"
+#include "format.h"
+#include "lu.h"
+#include "matrix_cache.h"
 #include "vector_operations.h"
+#include "instrument.h"
+#include "status.h"
 #include "settings.h"
 
 //see header file for documentation
 
 
 
+//A struct row_block holds the rows of one or more matrices. Copies made by
+//   matrix_dupe share the block of the original; a matrix that is about to be
+//   modified first gets a block of its own, whose rows still share their
+//   elements (see vector_dupe) until they are written to.
+struct row_block {
+  //number of matrices sharing the block, updated atomically
+  int refs;
+  int maxheight;
+  struct vector *rows[];
+};
+
 struct matrix {
   int width;
   int height;
-  int maxheight;
-  struct vector **rows;
+  struct row_block *block;
+  unsigned long version;
+  struct matrix_cache *cache;
 };
 
 
+//block_create(maxheight) returns a new block with room for maxheight rows
+//   and a single reference.
+//effects: allocates heap memory
+static struct row_block *block_create(const int maxheight) {
+  const size_t size = sizeof(struct row_block) +
+                      maxheight * sizeof(struct vector *);
+  struct row_block *block = malloc(size);
+  INSTRUMENT_ALLOC(size);
+  block->refs = 1;
+  block->maxheight = maxheight;
+  return block;
+}
+
+//block_release(block, height) drops one reference to block and, when none
+//   are left, destroys its first height rows and frees it.
+//effects: may free heap memory
+static void block_release(struct row_block * const block, const int height) {
+  if (__atomic_sub_fetch(&block->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    for (int i = height - 1; i >= 0; i--) {
+      vector_destroy(block->rows[i]);
+    }
+    INSTRUMENT_FREE(sizeof(struct row_block) +
+                    block->maxheight * sizeof(struct vector *));
+    free(block);
+  }
+}
+
+//own_rows(A) gives A a block of its own if it shares one with a copy, so its
+//   rows can be replaced, reordered or written to. Only the row pointers are
+//   copied: the elements stay shared until a row is written to.
+//effects: modifies *A
+//         may allocate heap memory
+static void own_rows(struct matrix * const A) {
+  struct row_block * const shared = A->block;
+  if (__atomic_load_n(&shared->refs, __ATOMIC_ACQUIRE) > 1) {
+    A->block = block_create(shared->maxheight);
+    for (int i = 0; i < A->height; i++) {
+      A->block->rows[i] = vector_dupe(shared->rows[i]);
+    }
+    block_release(shared, A->height);
+  }
+}
+
+
+//modified(A) records that the entries or the shape of A changed, which
+//   makes every cached result of A stale.
+//effects: modifies *A
+static void modified(struct matrix * const A) {
+  A->version++;
+}
+
+//cache_clear(cache) frees the results held by *cache and marks them all
+//   invalid.
+//effects: modifies *cache
+//         may free heap memory
+static void cache_clear(struct matrix_cache * const cache) {
+  cache->valid = 0;
+  lu_destroy(cache->lu);
+  cache->lu = NULL;
+  matrix_destroy(cache->rref);
+  cache->rref = NULL;
+  matrix_destroy(cache->inverse);
+  cache->inverse = NULL;
+}
+
+struct matrix_cache *matrix_cache(const struct matrix * const A) {
+  assert(A);
+  //the cache is not part of the value of A, so filling it is allowed on a
+  //   const matrix
+  struct matrix * const owner = (struct matrix *) A;
+  if (!owner->cache) {
+    owner->cache = malloc(sizeof(struct matrix_cache));
+    INSTRUMENT_ALLOC(sizeof(struct matrix_cache));
+    owner->cache->lu = NULL;
+    owner->cache->rref = NULL;
+    owner->cache->inverse = NULL;
+    cache_clear(owner->cache);
+    owner->cache->version = A->version;
+  } else if (owner->cache->version != A->version) {
+    cache_clear(owner->cache);
+    owner->cache->version = A->version;
+  }
+  return owner->cache;
+}
+
+
 struct matrix *matrix_create() {
+  INSTRUMENT_SCOPE(matrix_create);
   struct matrix *current = malloc(sizeof(struct matrix));
   current->width = 0;
   //no maxwidth parameter since vector rows dynamically realloc themselves
   current->height = 0;
-  current->maxheight = 1;
-  current->rows = malloc(sizeof(struct vector *));
+  current->block = block_create(1);
+  current->version = 0;
+  current->cache = NULL;
+  INSTRUMENT_ALLOC(sizeof(struct matrix));
+  return current;
+}
+
+struct matrix *matrix_create_zero(const int m, const int n) {
+  INSTRUMENT_SCOPE(matrix_create_zero);
+  INSTRUMENT_DIMS(m, n);
+  assert(m >= 0);
+  assert(n >= 0);
+  struct matrix *current = malloc(sizeof(struct matrix));
+  current->width = m > 0 ? n : 0;
+  current->height = m;
+  current->block = block_create(m > 0 ? m : 1);
+  current->version = 0;
+  current->cache = NULL;
+  INSTRUMENT_ALLOC(sizeof(struct matrix));
+  for (int i = 0; i < m; i++) {
+    current->block->rows[i] = vector_create_zero(n);
+  }
   return current;
 }
 
 
 void matrix_size(const struct matrix * const A, int * const m, int * const n) {
+  INSTRUMENT_COUNT(matrix_size);
   assert(A);
   assert(n);
   assert(m);
@@ -37,47 +165,75 @@ void matrix_size(const struct matrix * const A, int * const m, int * const n) {
   *n = A->width;
 }
 
+unsigned long matrix_version(const struct matrix * const A) {
+  assert(A);
+  return A->version;
+}
+
+void matrix_invalidate(struct matrix * const A) {
+  assert(A);
+  modified(A);
+}
+
 
 void matrix_add_row(struct matrix * const A, const struct vector * const v1) {
+  INSTRUMENT_SCOPE(matrix_add_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   assert(v1);
   if(A->height == 0) {
+    own_rows(A);
     struct vector *temp = vector_dupe(v1);
-    A->rows[0] = temp;
+    A->block->rows[0] = temp;
     A->height ++;
     A->width = vector_dim(v1);
+    modified(A);
     return;
   } else if (A->width != vector_dim(v1)) {
-    printf("A vector with %d elements cannot be added as a ", vector_dim(v1));
-    printf("row of a matrix with %d columns.\n", A->width);
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "A vector with %d elements cannot be added as a row of a "
+                  "matrix with %d columns.", vector_dim(v1), A->width);
     return;
-  } else if (A->height == A->maxheight) {
-    A->maxheight *= 2;
-    A->rows = realloc(A->rows, A->maxheight * sizeof(struct vector *));
+  }
+  own_rows(A);
+  if (A->height == A->block->maxheight) {
+    INSTRUMENT_FREE(A->block->maxheight * sizeof(struct vector *));
+    A->block->maxheight *= 2;
+    A->block = realloc(A->block, sizeof(struct row_block) +
+                       A->block->maxheight * sizeof(struct vector *));
+    INSTRUMENT_ALLOC(A->block->maxheight * sizeof(struct vector *));
   }
   struct vector *temp = vector_dupe(v1);
-  A->rows[A->height] = temp;
+  A->block->rows[A->height] = temp;
   A->height ++;
+  modified(A);
 }
 
 
 
 void matrix_replace_row(struct matrix * const A, const int index, 
                         const struct vector * const v1) {
+  INSTRUMENT_SCOPE(matrix_replace_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   assert(v1);
   if (index <= 0 || index > A->height) {
-    printf("Row %d does not exist in a matrix with %d rows.\n", index,
-           A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Row %d does not exist in a matrix with %d rows.", index,
+                  A->height);
   } else if (A->width != vector_dim(v1)) {
-    printf("A vector with %d elements cannot be a ", vector_dim(v1));
-    printf("replacement of a row in a matrix with %d columns.\n", A->width);
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "A vector with %d elements cannot be a replacement of a "
+                  "row in a matrix with %d columns.", vector_dim(v1),
+                  A->width);
     return;
   } else {
-    struct vector *temp = A->rows[index - 1];
-    struct vector *temp2 = vector_dupe(v1);
-    A->rows[index - 1] = temp2;
+    own_rows(A);
+    //the row shares the elements of v1 until one of them is modified
+    struct vector *temp = A->block->rows[index - 1];
+    A->block->rows[index - 1] = vector_dupe(v1);
     vector_destroy(temp);
+    modified(A);
   }
 }
 
@@ -85,113 +241,142 @@ void matrix_replace_row(struct matrix * const A, const int index,
 
 struct vector *matrix_dupe_row(const struct matrix * const A, 
                                const int index) {
+  INSTRUMENT_SCOPE(matrix_dupe_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (index <= 0 || index > A->height) {
-    printf("Row %d does not exist in a matrix with %d rows.\n", index,
-           A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Row %d does not exist in a matrix with %d rows.", index,
+                  A->height);
     return NULL;
   } else {
-    struct vector *dupe = vector_dupe(A->rows[index - 1]);
+    struct vector *dupe = vector_dupe(A->block->rows[index - 1]);
     return dupe;
   }
 }
 
 void matrix_del_row(struct matrix * const A, const int m) {
+  INSTRUMENT_SCOPE(matrix_del_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (A->height == 0) {
-    printf("The matrix has no rows to remove.\n");
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The matrix has no rows to remove.");
   } else if ((m > A->height) || (m <= 0)) {
-    printf("Row %d cannot be found in a matrix with %d rows.\n", m,
-           A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Row %d cannot be found in a matrix with %d rows.", m,
+                  A->height);
   } else {
-    struct vector *temp = A->rows[m - 1];
+    own_rows(A);
+    struct vector *temp = A->block->rows[m - 1];
     for (int i = m - 1; i < A->height - 1; i++) {
-      A->rows[i] = A->rows[i + 1];
+      A->block->rows[i] = A->block->rows[i + 1];
     }
     A->height --;
     vector_destroy(temp);
+    modified(A);
   }
 }
 
 void matrix_swap_row(struct matrix * const A, const int r1, const int r2) {
+  INSTRUMENT_SCOPE(matrix_swap_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (r1 <= 0 || r1 > A->height || r2 <= 0 || r2 > A->height) {
-    printf("Rows %d and %d cannot both be found in a matrix with %d rows.\n",
-           r1, r2, A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Rows %d and %d cannot both be found in a matrix with %d "
+                  "rows.", r1, r2, A->height);
     return;
   } else {
-    struct vector *temp = A->rows[r1 - 1];
-    A->rows[r1 - 1] = A->rows[r2 - 1];
-    A->rows[r2 - 1] = temp;
+    own_rows(A);
+    struct vector *temp = A->block->rows[r1 - 1];
+    A->block->rows[r1 - 1] = A->block->rows[r2 - 1];
+    A->block->rows[r2 - 1] = temp;
+    modified(A);
   }
 }
 
 
 void matrix_sum_row(struct matrix * const A, const int r1, const int r2) {
+  INSTRUMENT_SCOPE(matrix_sum_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (r1 <= 0 || r1 > A->height || r2 <= 0 || r2 > A->height) {
-    printf("Rows %d and %d cannot both be found in a matrix with %d rows.\n",
-           r1, r2, A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Rows %d and %d cannot both be found in a matrix with %d "
+                  "rows.", r1, r2, A->height);
     return;
   } else {
-    struct vector *sum = vector_add(A->rows[r1 - 1], A->rows[r2 - 1]);
-    struct vector *temp = A->rows[r1 - 1];
-    A->rows[r1 - 1] = sum;
-    vector_destroy(temp);
+    own_rows(A);
+    long double *x = vector_data(A->block->rows[r1 - 1]);
+    const long double *y = vector_cdata(A->block->rows[r2 - 1]);
+    for (int i = 0; i < A->width; i++) {
+      x[i] += y[i];
+    }
+    INSTRUMENT_FLOPS(A->width);
+    modified(A);
   }
 }
 
 
 void matrix_mult_row(struct matrix * const A, const int r1,
                      const long double c) {
+  INSTRUMENT_SCOPE(matrix_mult_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (r1 <= 0 || r1 > A->height) {
-    printf("Rows %d cannot be found in a matrix with %d rows.\n",
-           r1, A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Row %d cannot be found in a matrix with %d rows.", r1,
+                  A->height);
     return;
   } else {
-    struct vector *product = vector_mult(A->rows[r1 - 1], c);
-    struct vector *temp = A->rows[r1 - 1];
-    A->rows[r1 - 1] = product;
-    vector_destroy(temp);
+    own_rows(A);
+    long double *x = vector_data(A->block->rows[r1 - 1]);
+    for (int i = 0; i < A->width; i++) {
+      x[i] *= c;
+    }
+    INSTRUMENT_FLOPS(A->width);
+    modified(A);
   }
 }
 
 void matrix_add_mult_row(struct matrix * const A, const int r1, const int r2, 
                          const long double c) {
+  INSTRUMENT_SCOPE(matrix_add_mult_row);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (r1 <= 0 || r1 > A->height || r2 <= 0 || r2 > A->height) {
-    printf("Rows %d and %d cannot be found in a matrix with %d rows.\n",
-           r1, r2, A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Rows %d and %d cannot both be found in a matrix with %d "
+                  "rows.", r1, r2, A->height);
     return;
   } else {
-    struct vector *product = vector_mult(A->rows[r2 - 1], c);
-    struct vector *sum_product = vector_add(A->rows[r1 - 1], product);
-    struct vector *temp = A->rows[r1 - 1];
-    A->rows[r1 - 1] = sum_product;
-    vector_destroy(temp);
-    vector_destroy(product);
+    own_rows(A);
+    long double *x = vector_data(A->block->rows[r1 - 1]);
+    const long double *y = vector_cdata(A->block->rows[r2 - 1]);
+    for (int i = 0; i < A->width; i++) {
+      x[i] += c * y[i];
+    }
+    INSTRUMENT_FLOPS(2 * A->width);
+    modified(A);
   }
 }
 
 
 struct matrix *quick_matrix_input(const long double values[], const int m,
                                   const int n) {
+  INSTRUMENT_SCOPE(quick_matrix_input);
+  INSTRUMENT_DIMS(m, n);
   assert(values);
   if ((m < 0) || (n < 0)) {
-    printf("A matrix cannot have negative width or height.\n");
+    linalg_report(LINALG_ERR_INVALID, __func__,
+                  "A matrix cannot have negative width or height.");
     return NULL;
   } else {
-    int entry = 0;
-    struct matrix *current = matrix_create();
+    struct matrix *current = matrix_create_zero(m, n);
     for (int i = 0; i < m; i++) {
-      struct vector *temp = vector_create();
-      for (int j = 0; j < n; j++) {
-        vector_add_elem(temp, values[entry]);
-        entry++;
-      }
-      matrix_add_row(current, temp);
-      vector_destroy(temp);
+      memcpy(vector_data(current->block->rows[i]), values + i * n,
+             n * sizeof(long double));
     }
     return current;
   }
@@ -199,25 +384,32 @@ struct matrix *quick_matrix_input(const long double values[], const int m,
 
 
 void matrix_add_col(struct matrix * const A, const struct vector * const v1) {
+  INSTRUMENT_SCOPE(matrix_add_col);
 
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   assert(v1);
+  const long double *x = vector_cdata(v1);
   if(A->width == 0) {
-    for (int i = 1; i <= vector_dim(v1); i++) {
+    for (int i = 0; i < vector_dim(v1); i++) {
       struct vector *temp = vector_create();
-      vector_add_elem(temp, vector_elem(v1, i));
+      vector_add_elem(temp, x[i]);
       matrix_add_row(A, temp);
       vector_destroy(temp);
     }
     A->height = vector_dim(v1);
+    modified(A);
   } else if (A->height != vector_dim(v1)) {
-    printf("A vector with %d elements cannot be added as a ", vector_dim(v1));
-    printf("column of a matrix with %d rows.\n", A->height);
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "A vector with %d elements cannot be added as a column of "
+                  "a matrix with %d rows.", vector_dim(v1), A->height);
   } else {
+    own_rows(A);
     for (int i = 0; i < A->height; i++) {
-      vector_add_elem(A->rows[i], vector_elem(v1,i + 1));
+      vector_add_elem(A->block->rows[i], x[i]);
     }
     A->width ++;
+    modified(A);
   }
 }
 
@@ -225,19 +417,27 @@ void matrix_add_col(struct matrix * const A, const struct vector * const v1) {
 
 void matrix_replace_col(struct matrix * const A, const int index,
                         const struct vector * const v1) { 
+  INSTRUMENT_SCOPE(matrix_replace_col);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   assert(v1);
   if (index <= 0 || index > A->width) {
-    printf("Column %d does not exist in a matrix with %d columns.\n", index,
-           A->width);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Column %d does not exist in a matrix with %d columns.",
+                  index, A->width);
   } else if (A->height != vector_dim(v1)) {
-    printf("A vector with %d elements cannot be a ", vector_dim(v1));
-    printf("replacement of a column in a matrix with %d rows.\n", A->height);
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "A vector with %d elements cannot be a replacement of a "
+                  "column in a matrix with %d rows.", vector_dim(v1),
+                  A->height);
     return;
   } else {
+    const long double *x = vector_cdata(v1);
+    own_rows(A);
     for (int i = 0; i < A->height; i++) {
-      vector_replace(A->rows[i], index, vector_elem(v1,i + 1));
+      vector_data(A->block->rows[i])[index - 1] = x[i];
     }
+    modified(A);
   }
 }
 
@@ -246,88 +446,224 @@ void matrix_replace_col(struct matrix * const A, const int index,
 
 struct vector *matrix_dupe_col(const struct matrix * const A, 
                                const int index) {
+  INSTRUMENT_SCOPE(matrix_dupe_col);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (index <= 0 || index > A->width) {
-    printf("Column %d does not exist in a matrix with %d rows.\n", index,
-           A->height);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Column %d does not exist in a matrix with %d columns.",
+                  index, A->width);
     return NULL;
   } else {
-    struct vector *dupe = vector_create();
+    struct vector *dupe = vector_create_zero(A->height);
+    long double *x = vector_data(dupe);
     for (int i = 0; i < A->height; i++) {
-      vector_add_elem(dupe, vector_elem((A->rows)[i], index));
+      x[i] = vector_cdata(A->block->rows[i])[index - 1];
     }    
     return dupe;
   }
 }
 
 void matrix_del_col(struct matrix * const A, const int n) {
+  INSTRUMENT_SCOPE(matrix_del_col);
   assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
   if (A->width == 0) {
-    printf("The matrix has no columns to remove.\n");
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The matrix has no columns to remove.");
   } else if ((n > A->width) || (n <= 0)) {
-    printf("Columns %d cannot be found in a matrix with %d columns.\n",n,
-           A->width);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Column %d cannot be found in a matrix with %d columns.", n,
+                  A->width);
   } else {
-    for (int i = n; i < A->width; i++) {
-      struct vector *temp = matrix_dupe_col(A, i + 1);
-      matrix_replace_col(A, i, temp);
-      vector_destroy(temp);
-    }
-    A->width --;
+    own_rows(A);
     for (int i = 0; i < A->height; i++) {
-      vector_remove(A->rows[i]);
+      long double *x = vector_data(A->block->rows[i]);
+      memmove(x + n - 1, x + n, (A->width - n) * sizeof(long double));
+      vector_remove(A->block->rows[i]);
     }
+    A->width --;
+    modified(A);
   }
 }
 
 struct matrix *matrix_dupe(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_dupe);
   assert(A);
-  struct matrix *result = matrix_create();
-  for (int i = 0; i < A->height; i++) {
-    struct vector *row = vector_dupe(A->rows[i]);
-    matrix_add_row(result, row);
-    vector_destroy(row);
-  }
+  INSTRUMENT_DIMS(A->height, A->width);
+  struct matrix *result = malloc(sizeof(struct matrix));
+  INSTRUMENT_ALLOC(sizeof(struct matrix));
+  result->width = A->width;
+  result->height = A->height;
+  result->block = A->block;
+  __atomic_add_fetch(&result->block->refs, 1, __ATOMIC_RELAXED);
+  result->version = 0;
+  result->cache = NULL;
   return result;
 }
 
 long double matrix_elem(const struct matrix * const A, const int m, 
                         const int n) {
+  INSTRUMENT_COUNT(matrix_elem);
+  long double x = INT_MIN;
+  matrix_elem_checked(A, m, n, &x);
+  return x;
+}
+
+enum linalg_status matrix_elem_checked(const struct matrix * const A,
+                                       const int m, const int n,
+                                       long double * const x) {
+  INSTRUMENT_COUNT(matrix_elem_checked);
   assert(A);
-  int m1, n1 = 0;
-  matrix_size(A, &m1, &n1);
-  if (m <= 0 || n <= 0 || m > m1 || n > n1) {
-    printf("Entry %d, %d does not exist in a %d by %d matrix.\n",
-           m, n, m1, n1);
-    return INT_MIN;
+  assert(x);
+  if (m <= 0 || n <= 0 || m > A->height || n > A->width) {
+    return linalg_report(LINALG_ERR_INDEX, "matrix_elem",
+                         "Entry %d, %d does not exist in a %d by %d matrix.",
+                         m, n, A->height, A->width);
   } else {
-    return vector_elem(A->rows[m - 1], n);
+    *x = vector_cdata(A->block->rows[m - 1])[n - 1];
+    return LINALG_OK;
   }
 }
 
-void matrix_print(const struct matrix * const A) {
-  if (!A) {
-    return;
+long double matrix_elem_unchecked(const struct matrix * const A, const int m,
+                                  const int n) {
+  assert(A);
+  assert(0 < m && m <= A->height && 0 < n && n <= A->width);
+  return vector_cdata(A->block->rows[m - 1])[n - 1];
+}
+
+const long double *matrix_row_cdata(const struct matrix * const A,
+                                    const int m) {
+  assert(A);
+  assert(0 < m && m <= A->height);
+  return vector_cdata(A->block->rows[m - 1]);
+}
+
+long double *matrix_row_data(struct matrix * const A, const int m) {
+  assert(A);
+  assert(0 < m && m <= A->height);
+  //the caller may write through the pointer
+  own_rows(A);
+  modified(A);
+  return vector_data(A->block->rows[m - 1]);
+}
+
+//format_ellipsis_row(A, edge, tb) appends the row of "..." that stands in
+//   for the omitted rows of a matrix summary to *tb.
+//effects: modifies *tb
+static void format_ellipsis_row(const struct matrix * const A, const int edge,
+                                struct text_buffer * const tb) {
+  const bool summary_cols = A->width > 2 * edge;
+  const int shown = summary_cols ? 2 * edge + 1 : A->width;
+  text_buffer_append_char(tb, MATRIX_BRACKET_LEFT);
+  for (int i = 0; i < shown; i++) {
+    if (summary_cols && i == edge) {
+      text_buffer_append(tb, "...", 3);
+    } else {
+      for (int j = 3; j < PRINT_WIDTH; j++) {
+        text_buffer_append_char(tb, ' ');
+      }
+      text_buffer_append(tb, "...", 3);
+    }
+    if (i != shown - 1) {
+      text_buffer_append_char(tb, ' ');
+    }
   }
+  text_buffer_append_char(tb, MATRIX_BRACKET_RIGHT);
+  text_buffer_append_char(tb, '\n');
+}
+
+//matrix_format_into(A, edge, tb) appends the matrix A points to to *tb. If
+//   edge is positive, only the first and last edge rows and columns are
+//   written.
+//requires: A and tb are not NULL
+//effects: modifies *tb
+static void matrix_format_into(const struct matrix * const A, const int edge,
+                               struct text_buffer * const tb) {
+  assert(A);
   if (A->height == 0) {
-    printf("[Empty]\n");
+    text_buffer_append(tb, "[Empty]\n", 8);
   } else {
+    const bool summary_rows = (edge > 0) && (A->height > 2 * edge);
     for (int i = 0; i < A->height; i++) {
-      vector_print_bracket(A->rows[i], MATRIX_BRACKET_LEFT, 
-                           MATRIX_BRACKET_RIGHT);
+      if (summary_rows && i == edge) {
+        format_ellipsis_row(A, edge, tb);
+        i = A->height - edge;
+      }
+      vector_format_into(A->block->rows[i], MATRIX_BRACKET_LEFT, MATRIX_BRACKET_RIGHT,
+                         edge, tb);
     }
   }
-  printf("\n");
+  text_buffer_append_char(tb, '\n');
+}
+
+int matrix_format_summary(const struct matrix * const A, const int edge,
+                          char * const buf, const int size) {
+  INSTRUMENT_SCOPE(matrix_format_summary);
+  assert(A);
+  INSTRUMENT_DIMS(A->height, A->width);
+  struct text_buffer *tb = text_buffer_wrap(buf, size);
+  matrix_format_into(A, edge, tb);
+  const int length = text_buffer_length(tb);
+  text_buffer_data(tb);
+  text_buffer_destroy(tb);
+  return length;
+}
+
+int matrix_format(const struct matrix * const A, char * const buf,
+                  const int size) {
+  INSTRUMENT_SCOPE(matrix_format);
+  return matrix_format_summary(A, 0, buf, size);
+}
+
+void matrix_fprint(const struct matrix * const A, FILE * const out) {
+  INSTRUMENT_SCOPE(matrix_fprint);
+  assert(out);
+  if (!A) {
+    return;
+  }
+  INSTRUMENT_DIMS(A->height, A->width);
+  int edge = 0;
+  if ((PRINT_SUMMARY_THRESHOLD > 0) &&
+      ((long long) A->height * A->width > PRINT_SUMMARY_THRESHOLD)) {
+    edge = PRINT_SUMMARY_EDGE;
+  }
+  struct text_buffer *tb = text_buffer_create();
+  matrix_format_into(A, edge, tb);
+  text_buffer_write(tb, out);
+  text_buffer_destroy(tb);
+}
+
+void matrix_print(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_print);
+  matrix_fprint(A, stdout);
+}
+
+void matrix_print_summary(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_print_summary);
+  if (!A) {
+    return;
+  }
+  INSTRUMENT_DIMS(A->height, A->width);
+  struct text_buffer *tb = text_buffer_create();
+  matrix_format_into(A, PRINT_SUMMARY_EDGE, tb);
+  text_buffer_write(tb, stdout);
+  text_buffer_destroy(tb);
 }
 
 void matrix_destroy(struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_destroy);
   if (!A) {
     return;
   } else {
-    for (int i = A->height - 1; i >= 0; i--) {
-      vector_destroy(A->rows[i]);
+    block_release(A->block, A->height);
+    if (A->cache) {
+      cache_clear(A->cache);
+      INSTRUMENT_FREE(sizeof(struct matrix_cache));
+      free(A->cache);
     }
-    free(A->rows);
+    INSTRUMENT_FREE(sizeof(struct matrix));
     free(A);
   }
 }
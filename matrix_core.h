@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include "status.h"
+
 //You have all seen a vector before, but now...
 struct vector;
 //Whoa, a matrix.
@@ -8,6 +11,12 @@ struct matrix;
 //effects: allocates heap memory
 struct matrix *matrix_create();
 
+//matrix_create_zero(m, n) returns a heap-allocated m by n zero matrix that 
+//   the caller must free using matrix_destroy().
+//requires: m >= 0, n >= 0
+//effects: allocates heap memory
+struct matrix *matrix_create_zero(const int m, const int n);
+
 //quick_matrix_input(values, m, n) takes an array of long doubles and two 
 //   integers m and n. If possible, it returns a heap-allocated pointer to an
 //   m by n matrix formed with the numbers; the caller must free this pointer
@@ -26,6 +35,22 @@ struct matrix *quick_matrix_input(const long double values[], const int m,
 //effects: may modify *m and *n
 void matrix_size(const struct matrix *const A, int * const m, int * const n);
 
+//matrix_version(A) returns the version of A, a number that increases every
+//   time A is modified. Results derived from A (its determinant, rank, RREF,
+//   inverse, ...) are cached with the matrix and reused until the version
+//   changes. The cache is filled by functions that take the matrix as const,
+//   so a matrix shared between threads must not be queried by two of them
+//   at the same time, even through const pointers; different matrices may
+//   be queried concurrently.
+//requires: A is not NULL
+unsigned long matrix_version(const struct matrix * const A);
+
+//matrix_invalidate(A) marks A as modified, so cached results of A are
+//   computed again on the next request.
+//requires: A is not NULL
+//effects: modifies *A
+void matrix_invalidate(struct matrix * const A);
+
 //matrix_add_row(A, v1) takes in a struct vector pointer and a matrix pointer. 
 //   It then attempts to add the corresponding vector as a row in the matrix.
 //   It outputs an error if the operation cannot be done.
@@ -116,6 +141,8 @@ struct vector *matrix_dupe_col(const struct matrix * const A, const int index);
 
 //matrix_dupe(A) returns a new heap-allocated pointer to a duplicate copy of
 //   the matrix passed in if possible. Otherwise it outputs an error message.
+//   It takes O(1) time: the copy shares the entries of A until either matrix
+//   is modified, and then only the modified rows are copied.
 //requires: A is not NULL;
 //effects: may allocate heap memory
 //         may print message
@@ -128,11 +155,82 @@ struct matrix *matrix_dupe(const struct matrix * const A);
 long double matrix_elem(const struct matrix * const A, const int m,
                         const int n);
 
+//matrix_elem_checked(A, m, n, x) sets *x to A[mn] and returns LINALG_OK if
+//   possible. Otherwise it reports and returns LINALG_ERR_INDEX and leaves *x
+//   unchanged.
+//requires: A and x are not NULL;
+//effects: may modify *x
+//         may print message
+enum linalg_status matrix_elem_checked(const struct matrix * const A,
+                                       const int m, const int n,
+                                       long double * const x);
+
+//matrix_elem_unchecked(A, m, n) returns A[mn] without validating m and n
+//   (beyond an assert), for use in loops whose bounds were checked once.
+//requires: A is not NULL;
+//          1 <= m <= height of A, 1 <= n <= width of A
+long double matrix_elem_unchecked(const struct matrix * const A, const int m,
+                                  const int n);
+
+//matrix_row_cdata(A, m) returns a pointer to the entries of row m of *A,
+//   stored contiguously (column 1 first). The pointer is invalidated by any 
+//   call that changes the matrix.
+//requires: A is not NULL;
+//          1 <= m <= height of A
+const long double *matrix_row_cdata(const struct matrix * const A,
+                                    const int m);
+
+//matrix_row_data(A, m) is like matrix_row_cdata(A, m), but the entries may be
+//   modified through the returned pointer. Asking for the pointer counts as a
+//   modification of A (see matrix_version), and gives row m a private copy of
+//   its entries if it shares them with a copy made by matrix_dupe.
+//requires: A is not NULL;
+//          1 <= m <= height of A
+//effects: modifies *A
+//         may allocate heap memory
+long double *matrix_row_data(struct matrix * const A, const int m);
+
+
+//matrix_format(A, buf, size) writes every entry of the matrix A points to 
+//   into buf as matrix_print would lay it out, writing at most size chars
+//   including the terminating NUL. It returns the number of chars the full 
+//   text needs (like snprintf), so the text was truncated if the result is 
+//   size or more.
+//requires: A is not NULL
+//          buf is not NULL if size > 0
+//effects: modifies buf
+int matrix_format(const struct matrix * const A, char * const buf,
+                  const int size);
+
+//matrix_format_summary(A, edge, buf, size) is like matrix_format, but only
+//   the first and last edge rows and columns are written; the rest are
+//   replaced by "...". 
+//requires: A is not NULL
+//          buf is not NULL if size > 0
+//          edge > 0
+//effects: modifies buf
+int matrix_format_summary(const struct matrix * const A, const int edge,
+                          char * const buf, const int size);
+
+//matrix_fprint(A, out) prints the matrix that A points to into out with a 
+//   single write. If PRINT_SUMMARY_THRESHOLD is positive, matrices with more
+//   entries are printed as a summary (see settings.h).
+//requires: out is not NULL
+//effects: prints output
+void matrix_fprint(const struct matrix * const A, FILE * const out);
 
 //matrix_print(A) takes in a pointer to a matrix and prints the matrix.
+//   If PRINT_SUMMARY_THRESHOLD is positive, matrices with more entries are
+//   printed as a summary (see settings.h).
 //effects: prints output
 void matrix_print(const struct matrix * const A);
 
+//matrix_print_summary(A) prints A as a summary, with only its first and
+//   last PRINT_SUMMARY_EDGE rows and columns (see settings.h), whatever its
+//   size.
+//effects: prints output
+void matrix_print_summary(const struct matrix * const A);
+
 //matrix_destroy(A) frees heap memory allocated to A if it is not NULL
 //requires: A is not NULL
 void matrix_destroy(struct matrix * const A);
@@ -0,0 +1,607 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix_core.h"
+#include "matrix_operations.h"
+#include "matrix_expr.h"
+#include "structure.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+enum expr_op {
+  EXPR_MATRIX,
+  EXPR_TRANSPOSE,
+  EXPR_ADD,
+  EXPR_HADAMARD,
+  EXPR_SCALE,
+  EXPR_MAP,
+  EXPR_MULT
+};
+
+struct expr_node {
+  enum expr_op op;
+  int rows;
+  int cols;
+  //operands (only left for the operations with one)
+  struct expr_node *left;
+  struct expr_node *right;
+  const struct matrix *matrix;
+  long double c;
+  long double (*f)(long double);
+  //the same expression with transposes moved down onto matrices, and its
+  //   transpose (NULL until needed)
+  struct expr_node *plain;
+  struct expr_node *plain_t;
+  //the expression that is evaluated for this one, with products reordered
+  struct expr_node *planned;
+  //number of planned nodes that use this one
+  int uses;
+  //state of one evaluation: the full value if it is needed, and the row
+  //   (counted from 1) held in row
+  bool prepared;
+  struct matrix *value;
+  long double *row;
+  int row_index;
+};
+
+struct matrix_expr {
+  int count;
+  int max;
+  struct expr_node **nodes;
+};
+
+
+struct matrix_expr *matrix_expr_create(void) {
+  struct matrix_expr *E = malloc(sizeof(struct matrix_expr));
+  E->count = 0;
+  E->max = 8;
+  E->nodes = malloc(E->max * sizeof(struct expr_node *));
+  INSTRUMENT_ALLOC(sizeof(struct matrix_expr) +
+                   E->max * sizeof(struct expr_node *));
+  return E;
+}
+
+//new_node(E, op, rows, cols, left, right) returns a new rows x cols node of
+//   E for op applied to left and right.
+//requires: E is not NULL
+//effects: modifies *E
+//         allocates heap memory
+static struct expr_node *new_node(struct matrix_expr * const E,
+                                  const enum expr_op op, const int rows,
+                                  const int cols,
+                                  struct expr_node * const left,
+                                  struct expr_node * const right) {
+  if (E->count == E->max) {
+    INSTRUMENT_FREE(E->max * sizeof(struct expr_node *));
+    E->max *= 2;
+    E->nodes = realloc(E->nodes, E->max * sizeof(struct expr_node *));
+    INSTRUMENT_ALLOC(E->max * sizeof(struct expr_node *));
+  }
+  struct expr_node *x = calloc(1, sizeof(struct expr_node));
+  INSTRUMENT_ALLOC(sizeof(struct expr_node));
+  x->op = op;
+  x->rows = rows;
+  x->cols = cols;
+  x->left = left;
+  x->right = right;
+  E->nodes[E->count] = x;
+  E->count++;
+  return x;
+}
+
+//same_size(x, y, function) returns true if x and y are of the same size.
+//   Otherwise it reports the error on behalf of function and returns false.
+//requires: x, y are not NULL
+//effects: may print output
+static bool same_size(const struct expr_node * const x,
+                      const struct expr_node * const y,
+                      const char * const function) {
+  if ((x->rows != y->rows) || (x->cols != y->cols)) {
+    linalg_report(LINALG_ERR_DIMENSION, function,
+                  "The input matrices must be of the same size.");
+    return false;
+  }
+  return true;
+}
+
+const struct expr_node *expr_matrix(struct matrix_expr * const E,
+                                    const struct matrix * const A) {
+  assert(E);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  if ((m == 0) || (n == 0)) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The input matrix must not be empty.");
+    return NULL;
+  }
+  struct expr_node *x = new_node(E, EXPR_MATRIX, m, n, NULL, NULL);
+  x->matrix = A;
+  return x;
+}
+
+const struct expr_node *expr_add(struct matrix_expr * const E,
+                                 const struct expr_node * const x,
+                                 const struct expr_node * const y) {
+  assert(E);
+  if (!x || !y || !same_size(x, y, __func__)) {
+    return NULL;
+  }
+  return new_node(E, EXPR_ADD, x->rows, x->cols, (struct expr_node *) x,
+                  (struct expr_node *) y);
+}
+
+const struct expr_node *expr_scale(struct matrix_expr * const E,
+                                   const struct expr_node * const x,
+                                   const long double c) {
+  assert(E);
+  if (!x) {
+    return NULL;
+  }
+  struct expr_node *scaled = new_node(E, EXPR_SCALE, x->rows, x->cols,
+                                      (struct expr_node *) x, NULL);
+  scaled->c = c;
+  return scaled;
+}
+
+const struct expr_node *expr_mult(struct matrix_expr * const E,
+                                  const struct expr_node * const x,
+                                  const struct expr_node * const y) {
+  assert(E);
+  if (!x || !y) {
+    return NULL;
+  } else if (x->cols != y->rows) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "The height of the second matrix must match the width "
+                  "of the first matrix.");
+    return NULL;
+  }
+  return new_node(E, EXPR_MULT, x->rows, y->cols, (struct expr_node *) x,
+                  (struct expr_node *) y);
+}
+
+const struct expr_node *expr_transpose(struct matrix_expr * const E,
+                                       const struct expr_node * const x) {
+  assert(E);
+  if (!x) {
+    return NULL;
+  }
+  return new_node(E, EXPR_TRANSPOSE, x->cols, x->rows,
+                  (struct expr_node *) x, NULL);
+}
+
+const struct expr_node *expr_hadamard(struct matrix_expr * const E,
+                                      const struct expr_node * const x,
+                                      const struct expr_node * const y) {
+  assert(E);
+  if (!x || !y || !same_size(x, y, __func__)) {
+    return NULL;
+  }
+  return new_node(E, EXPR_HADAMARD, x->rows, x->cols,
+                  (struct expr_node *) x, (struct expr_node *) y);
+}
+
+const struct expr_node *expr_map(struct matrix_expr * const E,
+                                 const struct expr_node * const x,
+                                 long double (* const f)(long double)) {
+  assert(E);
+  assert(f);
+  if (!x) {
+    return NULL;
+  }
+  struct expr_node *mapped = new_node(E, EXPR_MAP, x->rows, x->cols,
+                                      (struct expr_node *) x, NULL);
+  mapped->f = f;
+  return mapped;
+}
+
+
+//derive(E, x, left, right, rows, cols) returns x if left and right are its
+//   operands already, and otherwise a new rows x cols node for the operation
+//   of x applied to left and right.
+//requires: E, x are not NULL
+//effects: may modify *E
+//         may allocate heap memory
+static struct expr_node *derive(struct matrix_expr * const E,
+                                struct expr_node * const x,
+                                struct expr_node * const left,
+                                struct expr_node * const right,
+                                const int rows, const int cols) {
+  if ((left == x->left) && (right == x->right) && (rows == x->rows)) {
+    return x;
+  }
+  struct expr_node *derived = new_node(E, x->op, rows, cols, left, right);
+  derived->c = x->c;
+  derived->f = x->f;
+  return derived;
+}
+
+static struct expr_node *plain_t(struct matrix_expr * const E,
+                                 struct expr_node * const x);
+
+//plain(E, x) returns x with every transpose moved down onto the matrices,
+//   using (X + Y)^T = X^T + Y^T and (XY)^T = Y^T X^T, so that only
+//   transposes of matrices are left.
+//requires: E, x are not NULL
+//effects: may modify *E
+//         may allocate heap memory
+static struct expr_node *plain(struct matrix_expr * const E,
+                               struct expr_node * const x) {
+  if (!x->plain) {
+    switch (x->op) {
+    case EXPR_MATRIX:
+      x->plain = x;
+      break;
+    case EXPR_TRANSPOSE:
+      x->plain = plain_t(E, x->left);
+      break;
+    case EXPR_ADD:
+    case EXPR_HADAMARD:
+    case EXPR_MULT:
+      x->plain = derive(E, x, plain(E, x->left), plain(E, x->right), x->rows,
+                        x->cols);
+      break;
+    case EXPR_SCALE:
+    case EXPR_MAP:
+      x->plain = derive(E, x, plain(E, x->left), NULL, x->rows, x->cols);
+      break;
+    }
+  }
+  return x->plain;
+}
+
+//plain_t(E, x) returns the transpose of x in the form described at plain.
+//requires: E, x are not NULL
+//effects: may modify *E
+//         may allocate heap memory
+static struct expr_node *plain_t(struct matrix_expr * const E,
+                                 struct expr_node * const x) {
+  if (!x->plain_t) {
+    switch (x->op) {
+    case EXPR_MATRIX:
+      x->plain_t = new_node(E, EXPR_TRANSPOSE, x->cols, x->rows, x, NULL);
+      break;
+    case EXPR_TRANSPOSE:
+      x->plain_t = plain(E, x->left);
+      break;
+    case EXPR_ADD:
+    case EXPR_HADAMARD:
+      x->plain_t = derive(E, x, plain_t(E, x->left), plain_t(E, x->right),
+                          x->cols, x->rows);
+      break;
+    case EXPR_MULT:
+      x->plain_t = derive(E, x, plain_t(E, x->right), plain_t(E, x->left),
+                          x->cols, x->rows);
+      break;
+    case EXPR_SCALE:
+    case EXPR_MAP:
+      x->plain_t = derive(E, x, plain_t(E, x->left), NULL, x->cols,
+                          x->rows);
+      break;
+    }
+  }
+  return x->plain_t;
+}
+
+//count_uses(x) adds one use to x and, if it is the first, one to each of its
+//   operands.
+//requires: x is not NULL
+//effects: modifies the nodes reachable from x
+static void count_uses(struct expr_node * const x) {
+  x->uses++;
+  if (x->uses == 1) {
+    if (x->left) {
+      count_uses(x->left);
+    }
+    if (x->right) {
+      count_uses(x->right);
+    }
+  }
+}
+
+//chain_operands(x, chain, operands, k) appends the factors of the product
+//   chain x to operands and advances *k. A product used more than once is
+//   kept as one factor, so it is still computed only once.
+//requires: x, operands, k are not NULL, operands has room for the factors
+//effects: modifies operands and *k
+static void chain_operands(struct expr_node * const x, const bool chain,
+                           struct expr_node ** const operands, int * const k) {
+  if ((x->op == EXPR_MULT) && (chain || (x->uses <= 1))) {
+    chain_operands(x->left, false, operands, k);
+    chain_operands(x->right, false, operands, k);
+  } else {
+    operands[*k] = x;
+    (*k)++;
+  }
+}
+
+//build_chain(E, operands, split, k, i, j) returns the product of factors i
+//   to j of operands, multiplied in the order recorded in split.
+//requires: E, operands, split are not NULL, 0 <= i <= j < k
+//effects: may modify *E
+//         may allocate heap memory
+static struct expr_node *build_chain(struct matrix_expr * const E,
+                                     struct expr_node ** const operands,
+                                     const int * const split, const int k,
+                                     const int i, const int j) {
+  if (i == j) {
+    return operands[i];
+  }
+  const int s = split[i * k + j];
+  struct expr_node *left = build_chain(E, operands, split, k, i, s);
+  struct expr_node *right = build_chain(E, operands, split, k, s + 1, j);
+  return new_node(E, EXPR_MULT, left->rows, right->cols, left, right);
+}
+
+static struct expr_node *reorder(struct matrix_expr * const E,
+                                 struct expr_node * const x);
+
+//reorder_chain(E, x) returns the product chain x multiplied in the order
+//   with the fewest floating point operations, found with the classic
+//   O(k^3) dynamic program over the k factors.
+//requires: E, x are not NULL, x is a product in plain form
+//effects: may modify *E
+//         may allocate heap memory
+static struct expr_node *reorder_chain(struct matrix_expr * const E,
+                                       struct expr_node * const x) {
+  //a chain has at most one factor per node
+  const int max = E->count;
+  struct expr_node **operands = malloc(max * sizeof(struct expr_node *));
+  INSTRUMENT_ALLOC(max * sizeof(struct expr_node *));
+  int k = 0;
+  chain_operands(x, true, operands, &k);
+  for (int i = 0; i < k; i++) {
+    operands[i] = reorder(E, operands[i]);
+  }
+  struct expr_node *result = NULL;
+  if (k == 2) {
+    result = derive(E, x, operands[0], operands[1], x->rows, x->cols);
+  } else {
+    //cost[i * k + j] is the cheapest way to multiply factors i to j
+    long long *cost = calloc(k * k, sizeof(long long));
+    int *split = calloc(k * k, sizeof(int));
+    INSTRUMENT_ALLOC(k * k * (sizeof(long long) + sizeof(int)));
+    for (int length = 1; length < k; length++) {
+      for (int i = 0; i + length < k; i++) {
+        const int j = i + length;
+        cost[i * k + j] = -1;
+        for (int s = i; s < j; s++) {
+          const long long c = cost[i * k + s] + cost[(s + 1) * k + j] +
+                              (long long) operands[i]->rows *
+                              operands[s]->cols * operands[j]->cols;
+          //on ties the later split wins: it keeps the right factor a
+          //   single matrix, which is read in place instead of computed
+          if ((cost[i * k + j] < 0) || (c <= cost[i * k + j])) {
+            cost[i * k + j] = c;
+            split[i * k + j] = s;
+          }
+        }
+      }
+    }
+    result = build_chain(E, operands, split, k, 0, k - 1);
+    INSTRUMENT_FREE(k * k * (sizeof(long long) + sizeof(int)));
+    free(cost);
+    free(split);
+  }
+  INSTRUMENT_FREE(max * sizeof(struct expr_node *));
+  free(operands);
+  return result;
+}
+
+//reorder(E, x) returns the plain expression x with every chain of products
+//   reordered (see reorder_chain).
+//requires: E, x are not NULL, x is in plain form
+//effects: may modify *E
+//         may allocate heap memory
+static struct expr_node *reorder(struct matrix_expr * const E,
+                                 struct expr_node * const x) {
+  if (!x->planned) {
+    switch (x->op) {
+    case EXPR_MATRIX:
+    case EXPR_TRANSPOSE:
+      x->planned = x;
+      break;
+    case EXPR_ADD:
+    case EXPR_HADAMARD:
+      x->planned = derive(E, x, reorder(E, x->left), reorder(E, x->right),
+                          x->rows, x->cols);
+      break;
+    case EXPR_SCALE:
+    case EXPR_MAP:
+      x->planned = derive(E, x, reorder(E, x->left), NULL, x->rows, x->cols);
+      break;
+    case EXPR_MULT:
+      x->planned = reorder_chain(E, x);
+      break;
+    }
+  }
+  return x->planned;
+}
+
+
+static const long double *eval_row(struct expr_node * const x, const int i);
+
+//materialize(x) returns the value of x through a heap-allocated matrix
+//   pointer, computed one row at a time.
+//requires: x is not NULL, x and its operands are prepared
+//effects: allocates heap memory
+static struct matrix *materialize(struct expr_node * const x) {
+  struct matrix *result = matrix_create_zero(x->rows, x->cols);
+  for (int i = 1; i <= x->rows; i++) {
+    memcpy(matrix_row_data(result, i), eval_row(x, i),
+           x->cols * sizeof(long double));
+  }
+  return result;
+}
+
+//streamable(x) returns true if the rows of x can be read without computing
+//   x, which is the case for a matrix and the transpose of a matrix.
+static bool streamable(const struct expr_node * const x) {
+  return (x->op == EXPR_MATRIX) || (x->op == EXPR_TRANSPOSE);
+}
+
+//prepare(x) readies x and its operands for evaluation: every node gets a
+//   row buffer, and the right side of every product that is neither a matrix
+//   nor a transposed matrix is computed in full, since each row of a product
+//   needs all of its right side.
+//requires: x is not NULL, x is planned
+//effects: modifies the nodes reachable from x
+//         allocates heap memory
+static void prepare(struct expr_node * const x) {
+  if (x->prepared) {
+    return;
+  }
+  x->prepared = true;
+  x->row_index = 0;
+  if (x->left) {
+    prepare(x->left);
+  }
+  if (x->right) {
+    prepare(x->right);
+  }
+  if (x->op != EXPR_MATRIX) {
+    x->row = malloc(x->cols * sizeof(long double));
+    INSTRUMENT_ALLOC(x->cols * sizeof(long double));
+  }
+  if ((x->op == EXPR_MULT) && !streamable(x->right) && !x->right->value) {
+    x->right->value = materialize(x->right);
+  }
+}
+
+//eval_row(x, i) returns row i of the value of x. The row stays valid until
+//   the next row of x is asked for.
+//requires: x is not NULL and prepared, 1 <= i <= rows of x
+//effects: may modify the nodes reachable from x
+static const long double *eval_row(struct expr_node * const x, const int i) {
+  if (x->value) {
+    return matrix_row_cdata(x->value, i);
+  } else if (x->op == EXPR_MATRIX) {
+    return matrix_row_cdata(x->matrix, i);
+  } else if (x->row_index == i) {
+    //x is used more than once in the expression
+    return x->row;
+  }
+  const int n = x->cols;
+  long double * const row = x->row;
+  switch (x->op) {
+  case EXPR_MATRIX:
+    break;
+  case EXPR_TRANSPOSE:
+    for (int j = 0; j < n; j++) {
+      row[j] = matrix_row_cdata(x->left->matrix, j + 1)[i - 1];
+    }
+    break;
+  case EXPR_ADD: {
+    const long double *a = eval_row(x->left, i);
+    const long double *b = eval_row(x->right, i);
+    for (int j = 0; j < n; j++) {
+      row[j] = a[j] + b[j];
+    }
+    INSTRUMENT_FLOPS(n);
+    break;
+  }
+  case EXPR_HADAMARD: {
+    const long double *a = eval_row(x->left, i);
+    const long double *b = eval_row(x->right, i);
+    for (int j = 0; j < n; j++) {
+      row[j] = a[j] * b[j];
+    }
+    INSTRUMENT_FLOPS(n);
+    break;
+  }
+  case EXPR_SCALE: {
+    const long double *a = eval_row(x->left, i);
+    for (int j = 0; j < n; j++) {
+      row[j] = x->c * a[j];
+    }
+    INSTRUMENT_FLOPS(n);
+    break;
+  }
+  case EXPR_MAP: {
+    const long double *a = eval_row(x->left, i);
+    for (int j = 0; j < n; j++) {
+      row[j] = x->f(a[j]);
+    }
+    break;
+  }
+  case EXPR_MULT: {
+    //row i of XY is row i of X times Y, so X is never needed in full
+    const long double *a = eval_row(x->left, i);
+    const int k = x->left->cols;
+    const struct expr_node *y = x->right;
+    if (y->op == EXPR_TRANSPOSE) {
+      //entry j is row i of X dotted with row j of the transposed matrix
+      for (int j = 0; j < n; j++) {
+        const long double *b = matrix_row_cdata(y->left->matrix, j + 1);
+        long double entry = 0;
+        for (int q = 0; q < k; q++) {
+          entry += a[q] * b[q];
+        }
+        row[j] = entry;
+      }
+      INSTRUMENT_FLOPS(2LL * k * n);
+    } else {
+      memset(row, 0, n * sizeof(long double));
+      row_times_matrix(a, y->op == EXPR_MATRIX ? y->matrix : y->value, 1, k,
+                       row);
+    }
+    break;
+  }
+  }
+  x->row_index = i;
+  return row;
+}
+
+struct matrix *matrix_expr_eval(struct matrix_expr * const E,
+                                const struct expr_node * const x) {
+  INSTRUMENT_SCOPE(matrix_expr_eval);
+  assert(E);
+  if (!x) {
+    return NULL;
+  }
+  INSTRUMENT_DIMS(x->rows, x->cols);
+  struct expr_node * const root = plain(E, (struct expr_node *) x);
+  for (int i = 0; i < E->count; i++) {
+    E->nodes[i]->uses = 0;
+  }
+  count_uses(root);
+  struct expr_node * const planned = reorder(E, root);
+  if (planned->op == EXPR_MATRIX) {
+    return matrix_dupe(planned->matrix);
+  }
+  prepare(planned);
+  struct matrix *result = materialize(planned);
+  //the leaves may change before the next evaluation, so nothing computed is
+  //   kept
+  for (int i = 0; i < E->count; i++) {
+    struct expr_node * const node = E->nodes[i];
+    if (node->prepared) {
+      node->prepared = false;
+      matrix_destroy(node->value);
+      node->value = NULL;
+      if (node->row) {
+        INSTRUMENT_FREE(node->cols * sizeof(long double));
+        free(node->row);
+        node->row = NULL;
+      }
+    }
+  }
+  return result;
+}
+
+void matrix_expr_destroy(struct matrix_expr * const E) {
+  if (!E) {
+    return;
+  }
+  for (int i = 0; i < E->count; i++) {
+    INSTRUMENT_FREE(sizeof(struct expr_node));
+    free(E->nodes[i]);
+  }
+  INSTRUMENT_FREE(sizeof(struct matrix_expr) +
+                  E->max * sizeof(struct expr_node *));
+  free(E->nodes);
+  free(E);
+}
@@ -0,0 +1,115 @@
+#ifndef LINALG_MATRIX_EXPR_H
+#define LINALG_MATRIX_EXPR_H
+
+//A struct matrix_expr records a matrix expression instead of computing it
+//   step by step. Expressions such as A + cB or P D P^-1, written with the
+//   functions in matrix_operations.h, allocate and fill a full temporary
+//   matrix for every operation. Recorded as a matrix_expr, the same
+//   expression is evaluated in one pass over the rows of the result:
+//   additions, scaling, elementwise operations and transposes are fused, so
+//   each entry is written once, and a product only needs a full temporary
+//   when its right side is itself a computed expression. Chains of three or
+//   more products are multiplied in the order that takes the fewest
+//   floating point operations, which may round differently from the order
+//   they were written in.
+//An expression is made of nodes. Every node belongs to the struct
+//   matrix_expr it was created in, may be used any number of times in that
+//   expression (the nodes form a DAG), and is freed together with it.
+//   Building a node checks the sizes of its operands: if they do not fit, it
+//   reports the error (see status.h) and returns NULL, and every node built
+//   from NULL is NULL as well, so an invalid expression can be built without
+//   checking each step.
+//Example (P D P^-1):
+//   struct matrix_expr *E = matrix_expr_create();
+//   const struct expr_node *p = expr_matrix(E, P);
+//   const struct expr_node *x =
+//     expr_mult(E, expr_mult(E, p, expr_matrix(E, D)), expr_matrix(E, P_inv));
+//   struct matrix *result = matrix_expr_eval(E, x);
+//   matrix_expr_destroy(E);
+struct matrix_expr;
+struct expr_node;
+struct matrix;
+
+//matrix_expr_create() returns a new, empty expression through a
+//   heap-allocated pointer that the caller must free with
+//   matrix_expr_destroy().
+//effects: allocates heap memory
+struct matrix_expr *matrix_expr_create(void);
+
+//expr_matrix(E, A) returns a node that stands for the matrix A. A is not
+//   copied: it must not be resized or freed before the last evaluation of E,
+//   and changes to its entries are seen by later evaluations. If A is empty,
+//   it outputs an error message and returns NULL.
+//requires: E, A are not NULL
+//effects: may print output
+//         may allocate heap memory
+const struct expr_node *expr_matrix(struct matrix_expr * const E,
+                                    const struct matrix * const A);
+
+//expr_add(E, x, y) returns a node for x + y. If x or y is NULL, it returns
+//   NULL; if they are not of the same size, it outputs an error message and
+//   returns NULL.
+//requires: E is not NULL, x and y belong to E
+//effects: may print output
+//         may allocate heap memory
+const struct expr_node *expr_add(struct matrix_expr * const E,
+                                 const struct expr_node * const x,
+                                 const struct expr_node * const y);
+
+//expr_scale(E, x, c) returns a node for cx, or NULL if x is NULL.
+//requires: E is not NULL, x belongs to E
+//effects: may allocate heap memory
+const struct expr_node *expr_scale(struct matrix_expr * const E,
+                                   const struct expr_node * const x,
+                                   const long double c);
+
+//expr_mult(E, x, y) returns a node for the product xy. If x or y is NULL, it
+//   returns NULL; if the width of x is not the height of y, it outputs an
+//   error message and returns NULL.
+//requires: E is not NULL, x and y belong to E
+//effects: may print output
+//         may allocate heap memory
+const struct expr_node *expr_mult(struct matrix_expr * const E,
+                                  const struct expr_node * const x,
+                                  const struct expr_node * const y);
+
+//expr_transpose(E, x) returns a node for the transpose of x, or NULL if x is
+//   NULL.
+//requires: E is not NULL, x belongs to E
+//effects: may allocate heap memory
+const struct expr_node *expr_transpose(struct matrix_expr * const E,
+                                       const struct expr_node * const x);
+
+//expr_hadamard(E, x, y) returns a node for the elementwise product of x and
+//   y. If x or y is NULL, it returns NULL; if they are not of the same size,
+//   it outputs an error message and returns NULL.
+//requires: E is not NULL, x and y belong to E
+//effects: may print output
+//         may allocate heap memory
+const struct expr_node *expr_hadamard(struct matrix_expr * const E,
+                                      const struct expr_node * const x,
+                                      const struct expr_node * const y);
+
+//expr_map(E, x, f) returns a node for the matrix whose entries are f applied
+//   to the entries of x, or NULL if x is NULL.
+//requires: E, f are not NULL, x belongs to E
+//effects: may allocate heap memory
+const struct expr_node *expr_map(struct matrix_expr * const E,
+                                 const struct expr_node * const x,
+                                 long double (* const f)(long double));
+
+//matrix_expr_eval(E, x) returns the value of x through a heap-allocated
+//   matrix pointer that the caller must free with matrix_destroy(), or NULL
+//   if x is NULL. E may be evaluated any number of times, for the same or
+//   different nodes.
+//requires: E is not NULL, x belongs to E
+//effects: may allocate heap memory
+struct matrix *matrix_expr_eval(struct matrix_expr * const E,
+                                const struct expr_node * const x);
+
+//matrix_expr_destroy(E) frees E and all of its nodes, but not the matrices
+//   given to expr_matrix. Passing NULL does nothing.
+//effects: frees heap memory
+void matrix_expr_destroy(struct matrix_expr * const E);
+
+#endif
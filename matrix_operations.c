@@ -3,95 +3,195 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "vector_operations.h"
 #include "vector_core.h"
 #include "matrix_operations.h"
 #include "matrix_core.h"
+#include "matrix_cache.h"
+#include "structure.h"
+#include "exact.h"
+#include "modular.h"
+#include "instrument.h"
+#include "status.h"
 #include "settings.h"
 
 
 //See header file for documentation
 
-//valid_matrix(A) returns true if A is a valid, non-empty matrix. It returns 
-//   false and prints error pessage if not.
+//valid_matrix(A, function) returns LINALG_OK if A is a valid, non-empty
+//   matrix. Otherwise it reports the error on behalf of function and returns
+//   its status.
 //requires: A is not NULL;
 //effects: may print output.
-static bool valid_matrix(const struct matrix * const A) {
+static enum linalg_status valid_matrix(const struct matrix * const A,
+                                       const char * const function) {
   assert(A);
   int m = 0;
   int n = 0;
   matrix_size(A, &m, &n);
   if ((m == 0) || (n == 0)) {
-    printf("The input matrix must not be empty.\n");
-    return false;
+    return linalg_report(LINALG_ERR_EMPTY, function,
+                         "The input matrix must not be empty.");
   }
-  return true;
+  return LINALG_OK;
 }
 
+//is_zero(x) returns true if x is within PRECISION of zero.
+static bool is_zero(const long double x) {
+  return (-PRECISION < x) && (x < PRECISION);
+}
 
 
 struct matrix *matrix_add(const struct matrix * const A,
                           const struct matrix * const B) {
+  INSTRUMENT_SCOPE(matrix_add);
   assert(A);
   assert(B);
   int m1, n1, m2, n2 = 0;
   matrix_size(A, &m1, &n1);
+  INSTRUMENT_DIMS(m1, n1);
   matrix_size(B, &m2, &n2);
   if ((m1 == 0) || (n1 == 0) || (m2 == 0) || (n2 == 0)) {
-    printf("The input matrix must not be empty.\n");
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The input matrix must not be empty.");
     return NULL;
   } else if ((m1 != m2) || (n1 != n2)) {
-    printf("The input matrices must be of the same size.\n");
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "The input matrices must be of the same size.");
     return NULL;
   } else {
-    struct matrix *dupe = matrix_create();
+    struct matrix *sum = matrix_create_zero(m1, n1);
+    for (int i = 1; i <= m1; i++) {
+      const long double *a = matrix_row_cdata(A, i);
+      const long double *b = matrix_row_cdata(B, i);
+      long double *c = matrix_row_data(sum, i);
+      for (int j = 0; j < n1; j++) {
+        c[j] = a[j] + b[j];
+      }
+    }
+    INSTRUMENT_FLOPS((long long) m1 * n1);
+    return sum;
+  }
+}
+
+struct matrix *matrix_add_consume(struct matrix * const A,
+                                  const struct matrix * const B) {
+  INSTRUMENT_SCOPE(matrix_add_consume);
+  assert(A);
+  assert(B);
+  int m1, n1, m2, n2 = 0;
+  matrix_size(A, &m1, &n1);
+  INSTRUMENT_DIMS(m1, n1);
+  matrix_size(B, &m2, &n2);
+  if ((m1 == 0) || (n1 == 0) || (m2 == 0) || (n2 == 0)) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The input matrix must not be empty.");
+  } else if ((m1 != m2) || (n1 != n2)) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "The input matrices must be of the same size.");
+  } else {
     for (int i = 1; i <= m1; i++) {
-      struct vector *dupe_row_A = matrix_dupe_row(A, i);
-      struct vector *dupe_row_B = matrix_dupe_row(B, i);
-      struct vector *dupe_row_sum = vector_add(dupe_row_A, dupe_row_B);
-      matrix_add_row(dupe, dupe_row_sum);
-      vector_destroy(dupe_row_A);
-      vector_destroy(dupe_row_B);
-      vector_destroy(dupe_row_sum);
+      //A's row first: if it shares its entries with B, it is copied, and b
+      //   keeps pointing at the original
+      long double *a = matrix_row_data(A, i);
+      const long double *b = matrix_row_cdata(B, i);
+      for (int j = 0; j < n1; j++) {
+        a[j] += b[j];
+      }
     }
-    return dupe;
+    INSTRUMENT_FLOPS((long long) m1 * n1);
+    return A;
   }
+  matrix_destroy(A);
+  return NULL;
 }
 
 struct matrix *matrix_mult_scalar(const struct matrix * const A,
                                   const long double c) {
-  if (valid_matrix(A)) {
-    struct matrix *dupe = matrix_create();
+  INSTRUMENT_SCOPE(matrix_mult_scalar);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
     int m, n = 0;
     matrix_size(A, &m, &n);
+    INSTRUMENT_DIMS(m, n);
+    struct matrix *product = matrix_create_zero(m, n);
     for (int i = 1; i <= m; i++) {
-      struct vector *dupe_row = matrix_dupe_row(A, i);
-      struct vector *dupe_row_mult = vector_mult(dupe_row, c);
-      matrix_add_row(dupe, dupe_row_mult);
-      vector_destroy(dupe_row);
-      vector_destroy(dupe_row_mult);
+      const long double *a = matrix_row_cdata(A, i);
+      long double *b = matrix_row_data(product, i);
+      for (int j = 0; j < n; j++) {
+        b[j] = c * a[j];
+      }
+    }
+    INSTRUMENT_FLOPS((long long) m * n);
+    return product;
+  }
+  return NULL;
+}
+
+
+struct matrix *matrix_mult_scalar_consume(struct matrix * const A,
+                                          const long double c) {
+  INSTRUMENT_SCOPE(matrix_mult_scalar_consume);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
+    int m, n = 0;
+    matrix_size(A, &m, &n);
+    INSTRUMENT_DIMS(m, n);
+    for (int i = 1; i <= m; i++) {
+      long double *a = matrix_row_data(A, i);
+      for (int j = 0; j < n; j++) {
+        a[j] *= c;
+      }
     }
-    return dupe;
+    INSTRUMENT_FLOPS((long long) m * n);
+    return A;
   }
+  matrix_destroy(A);
   return NULL;
 }
 
 
-struct vector *matrix_mult_vector(const struct matrix * const A, 
+struct vector *matrix_mult_vector(const struct matrix * const A,
                                   const struct vector * const v1) {
-  if (valid_matrix(A)) {
+  INSTRUMENT_SCOPE(matrix_mult_vector);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
     int m, n = 0;
     matrix_size(A, &m, &n);
+    INSTRUMENT_DIMS(m, n);
     if (vector_dim(v1) != n) {
-      printf("The height of the vector must match the width of the matrix.\n");
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "The height of the vector must match the width of the "
+                    "matrix.");
     } else {
-      struct vector *result = vector_create();
+      struct vector *result = vector_create_zero(m);
+      const long double *x = vector_cdata(v1);
+      long double *y = vector_data(result);
+      const unsigned structure = matrix_structure(A);
+      if (structure & MATRIX_PERMUTATION) {
+        for (int i = 1; i <= m; i++) {
+          const long double *a = matrix_row_cdata(A, i);
+          for (int j = 0; j < n; j++) {
+            if (a[j] != 0) {
+              y[i - 1] = x[j];
+              break;
+            }
+          }
+        }
+        return result;
+      }
+      //the entries outside [first, last] of a triangular row are 0
+      const bool upper = structure & MATRIX_UPPER_TRIANGULAR;
+      const bool lower = structure & MATRIX_LOWER_TRIANGULAR;
       for (int i = 1; i <= m; i++) {
-        struct vector *dupe_row = matrix_dupe_row(A, i);
-        long double entry = vector_dot(v1, dupe_row);
-        vector_add_elem(result, entry);
-        vector_destroy(dupe_row);
+        const long double *a = matrix_row_cdata(A, i);
+        const int first = upper ? i - 1 : 0;
+        const int last = lower ? i - 1 : n - 1;
+        long double entry = 0;
+        for (int j = first; j <= last; j++) {
+          entry += x[j] * a[j];
+        }
+        y[i - 1] = entry;
+        INSTRUMENT_FLOPS(2 * (last - first + 1));
       }
       return result;
     }
@@ -100,26 +200,119 @@ struct vector *matrix_mult_vector(const struct matrix * const A,
 }
 
 
-struct matrix *matrix_mult_matrix(const struct matrix * const A, 
+//structured_mult(A, B) returns AB through a heap-allocated matrix pointer if
+//   A or B is diagonal or a permutation matrix, which turns the product into
+//   scaling or reordering the rows or columns of the other. Otherwise it
+//   returns NULL.
+//requires: A, B are not NULL and not empty, width of A = height of B
+//effects: may allocate heap memory
+static struct matrix *structured_mult(const struct matrix * const A,
+                                      const struct matrix * const B) {
+  int m, k, n = 0;
+  matrix_size(A, &m, &k);
+  matrix_size(B, &k, &n);
+  const unsigned structure_A = matrix_structure(A);
+  const unsigned structure_B = matrix_structure(B);
+  if (structure_A & MATRIX_IDENTITY) {
+    return matrix_dupe(B);
+  } else if (structure_B & MATRIX_IDENTITY) {
+    return matrix_dupe(A);
+  } else if (structure_A & (MATRIX_DIAGONAL | MATRIX_PERMUTATION)) {
+    //row i of AB is row i of B scaled by A[ii], or the row of B that row i
+    //   of A selects
+    struct matrix *result = matrix_create_zero(m, n);
+    for (int i = 1; i <= m; i++) {
+      const long double *a = matrix_row_cdata(A, i);
+      long double *c = matrix_row_data(result, i);
+      if (structure_A & MATRIX_DIAGONAL) {
+        const long double *b = matrix_row_cdata(B, i);
+        for (int j = 0; j < n; j++) {
+          c[j] = a[i - 1] * b[j];
+        }
+        INSTRUMENT_FLOPS(n);
+      } else {
+        int col = 0;
+        while (a[col] == 0) {
+          col++;
+        }
+        memcpy(c, matrix_row_cdata(B, col + 1), n * sizeof(long double));
+      }
+    }
+    return result;
+  } else if (structure_B & (MATRIX_DIAGONAL | MATRIX_PERMUTATION)) {
+    //column j of AB is column j of A scaled by B[jj], or the column of A
+    //   that column j of B selects
+    int *p = malloc(n * sizeof(int));
+    INSTRUMENT_ALLOC(n * sizeof(int));
+    if (structure_B & MATRIX_PERMUTATION) {
+      permutation_columns(B, n, p);
+    }
+    struct matrix *result = matrix_create_zero(m, n);
+    for (int i = 1; i <= m; i++) {
+      const long double *a = matrix_row_cdata(A, i);
+      long double *c = matrix_row_data(result, i);
+      if (structure_B & MATRIX_DIAGONAL) {
+        for (int j = 0; j < n; j++) {
+          c[j] = a[j] * matrix_row_cdata(B, j + 1)[j];
+        }
+        INSTRUMENT_FLOPS(n);
+      } else {
+        for (int q = 0; q < n; q++) {
+          c[p[q]] = a[q];
+        }
+      }
+    }
+    INSTRUMENT_FREE(n * sizeof(int));
+    free(p);
+    return result;
+  }
+  return NULL;
+}
+
+
+void row_times_matrix(const long double * const a,
+                      const struct matrix * const B, const int first,
+                      const int last, long double * const c) {
+  int m, n = 0;
+  matrix_size(B, &m, &n);
+  //row i of AB is the sum of A[ik] times row k of B, which walks every row
+  //   contiguously
+  for (int k = first; k <= last; k++) {
+    const long double *b = matrix_row_cdata(B, k);
+    const long double a_k = a[k - 1];
+    for (int j = 0; j < n; j++) {
+      c[j] += a_k * b[j];
+    }
+  }
+  INSTRUMENT_FLOPS(2LL * (last - first + 1) * n);
+}
+
+struct matrix *matrix_mult_matrix(const struct matrix * const A,
                                   const struct matrix * const B) {
-  if (valid_matrix(A) && valid_matrix(B)) {
+  INSTRUMENT_SCOPE(matrix_mult_matrix);
+  if ((valid_matrix(A, __func__) == LINALG_OK) &&
+      (valid_matrix(B, __func__) == LINALG_OK)) {
     int m1, n1, m2, n2 = 0;
     matrix_size(A, &m1, &n1);
+    INSTRUMENT_DIMS(m1, n1);
     matrix_size(B, &m2, &n2);
     if (m2 != n1) {
-      printf("The height of the second matrix must match the width of the");
-      printf(" first matrix.\n");
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "The height of the second matrix must match the width "
+                    "of the first matrix.");
     } else {
-      struct matrix *result = matrix_create();
-     
-      for (int i = 1; i <= n2; i++) {
-        
-        struct vector *duped_col = matrix_dupe_col(B, i);
-        struct vector *duped_col_mult = matrix_mult_vector(A, duped_col);
-
-        matrix_add_col(result, duped_col_mult);
-        vector_destroy(duped_col);
-        vector_destroy(duped_col_mult);
+      struct matrix *result = structured_mult(A, B);
+      if (result) {
+        return result;
+      }
+      result = matrix_create_zero(m1, n2);
+      //the entries of a triangular row of A outside [first, last] are 0
+      const unsigned structure = matrix_structure(A);
+      const bool upper = structure & MATRIX_UPPER_TRIANGULAR;
+      const bool lower = structure & MATRIX_LOWER_TRIANGULAR;
+      for (int i = 1; i <= m1; i++) {
+        row_times_matrix(matrix_row_cdata(A, i), B, upper ? i : 1,
+                         lower ? i : n1, matrix_row_data(result, i));
       }
       return result;
     }
@@ -128,32 +321,101 @@ struct matrix *matrix_mult_matrix(const struct matrix * const A,
 }
 
 
+struct matrix *matrix_mult_matrix_consume(struct matrix * const A,
+                                          const struct matrix * const B) {
+  INSTRUMENT_SCOPE(matrix_mult_matrix_consume);
+  assert(A);
+  assert(B);
+  int m1, n1, m2, n2 = 0;
+  matrix_size(A, &m1, &n1);
+  INSTRUMENT_DIMS(m1, n1);
+  matrix_size(B, &m2, &n2);
+  if ((A == B) || (m2 != n2) || (m2 != n1) || (n1 == 0)) {
+    //AB has a different shape than A, or writing A would change B: fall back
+    //   to a new result (which also reports any error)
+    struct matrix *result = matrix_mult_matrix(A, B);
+    matrix_destroy(A);
+    return result;
+  }
+  if (valid_matrix(A, __func__) != LINALG_OK) {
+    matrix_destroy(A);
+    return NULL;
+  }
+  const unsigned structure_B = matrix_structure(B);
+  if (structure_B & MATRIX_IDENTITY) {
+    return A;
+  }
+  const unsigned structure_A = matrix_structure(A);
+  const bool upper = structure_A & MATRIX_UPPER_TRIANGULAR;
+  const bool lower = structure_A & MATRIX_LOWER_TRIANGULAR;
+  int *p = NULL;
+  if (structure_B & MATRIX_PERMUTATION) {
+    p = malloc(n2 * sizeof(int));
+    INSTRUMENT_ALLOC(n2 * sizeof(int));
+    permutation_columns(B, n2, p);
+  }
+  //each row of AB only depends on the same row of A, so it is computed in
+  //   one scratch row and copied over it
+  long double *c = malloc(n2 * sizeof(long double));
+  INSTRUMENT_ALLOC(n2 * sizeof(long double));
+  for (int i = 1; i <= m1; i++) {
+    long double *a = matrix_row_data(A, i);
+    if (structure_B & MATRIX_DIAGONAL) {
+      for (int j = 0; j < n2; j++) {
+        a[j] *= matrix_row_cdata(B, j + 1)[j];
+      }
+      INSTRUMENT_FLOPS(n2);
+      continue;
+    } else if (p) {
+      for (int q = 0; q < n2; q++) {
+        c[p[q]] = a[q];
+      }
+    } else {
+      int first = upper ? i : 1;
+      int last = lower ? i : n1;
+      if (structure_A & MATRIX_PERMUTATION) {
+        //the row selects a single row of B
+        while (a[first - 1] == 0) {
+          first++;
+        }
+        last = first;
+      }
+      memset(c, 0, n2 * sizeof(long double));
+      row_times_matrix(a, B, first, last, c);
+    }
+    memcpy(a, c, n2 * sizeof(long double));
+  }
+  INSTRUMENT_FREE(n2 * sizeof(long double));
+  free(c);
+  if (p) {
+    INSTRUMENT_FREE(n2 * sizeof(int));
+    free(p);
+  }
+  return A;
+}
+
+
 struct matrix *rotation_matrix(const long double theta) {
-  struct matrix *result = matrix_create();
-  struct vector *row1 = vector_create();
-  struct vector *row2 = vector_create();
-  long double cosine = cos(theta);
-  long double sine = sin(theta);
-  vector_add_elem(row1, cosine);
-  vector_add_elem(row1, -sine);
-  vector_add_elem(row2, sine);
-  vector_add_elem(row2, cosine);
-  matrix_add_row(result, row1);
-  matrix_add_row(result, row2);
-  vector_destroy(row1);
-  vector_destroy(row2);
-  return result;
+  INSTRUMENT_SCOPE(rotation_matrix);
+  INSTRUMENT_DIMS(2, 2);
+  const long double cosine = cos(theta);
+  const long double sine = sin(theta);
+  const long double entries[] = {cosine, -sine, sine, cosine};
+  return quick_matrix_input(entries, 2, 2);
 }
 
 struct matrix *matrix_transpose(const struct matrix * const A) {
-  if (valid_matrix(A)) {
+  INSTRUMENT_SCOPE(matrix_transpose);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
     int m, n = 0;
     matrix_size(A, &m, &n);
-    struct matrix *result = matrix_create();
+    INSTRUMENT_DIMS(m, n);
+    struct matrix *result = matrix_create_zero(n, m);
     for (int i = 1; i <= m; i++) {
-      struct vector *row = matrix_dupe_row(A, i);
-      matrix_add_col(result, row);
-      vector_destroy(row);
+      const long double *a = matrix_row_cdata(A, i);
+      for (int j = 1; j <= n; j++) {
+        matrix_row_data(result, j)[i - 1] = a[j - 1];
+      }
     }
     return result;
   }
@@ -163,113 +425,284 @@ struct matrix *matrix_transpose(const struct matrix * const A) {
 
 
 
-//is_leading(A, m, n, precision) returns true if A[mn] is a leading number, 
-//   fale otherwise.
+//is_leading(A, m, n) returns true if A[mn] is a leading number, false
+//   otherwise.
 //requires: m and n are in bound of A
-static bool is_leading (struct matrix * const A, const int m, const int n) {
+static bool is_leading(const struct matrix * const A, const int m,
+                       const int n) {
   assert(A);
-  if ((-PRECISION < matrix_elem(A, m, n)) && 
-      (PRECISION > matrix_elem(A, m, n))) {
+  const long double *row = matrix_row_cdata(A, m);
+  if (is_zero(row[n - 1])) {
     return false;
   }
-  bool leading = true;
-  for (int i = 1; i < n; i ++) {
-    if ((-PRECISION > matrix_elem(A, m, i)) || 
-        (PRECISION < matrix_elem(A, m, i))) {
-      leading = false;
+  for (int i = 0; i < n - 1; i ++) {
+    if (!is_zero(row[i])) {
+      return false;
     }
   }
-  return leading;
+  return true;
 }
 
 
-struct matrix *RREF(const struct matrix * const A) {
-  if (valid_matrix(A)) {
-    struct matrix *result = matrix_dupe(A);
-    int rows, cols = 0;
-    matrix_size(result, &rows, &cols);
-    if (rows <= 1) {
-      return result;
+//reduces_to_identity(A) returns true if the RREF of the non-empty matrix A
+//   is known to be the identity from its structure alone.
+//requires: A is not NULL and not empty
+static bool reduces_to_identity(const struct matrix * const A) {
+  int rows, cols = 0;
+  matrix_size(A, &rows, &cols);
+  const unsigned structure = matrix_structure(A);
+  bool invertible = structure & MATRIX_PERMUTATION;
+  if (structure & (MATRIX_UPPER_TRIANGULAR | MATRIX_LOWER_TRIANGULAR)) {
+    //every column of a triangular matrix with a nonzero diagonal leads
+    invertible = true;
+    for (int i = 1; i <= rows; i++) {
+      if (is_zero(matrix_row_cdata(A, i)[i - 1])) {
+        invertible = false;
+        break;
+      }
     }
-    int leading_row = 1;
-    for (int i = 1; i <= cols; i++) {
-      for (int j = leading_row; j <= rows; j++) {
-        if (is_leading(result, j, i)) {
-          matrix_mult_row(result, j, 1 / matrix_elem(result, j, i));
-          for (int k = 1; k <= rows; k++) {
-            if ((-PRECISION > matrix_elem(result, k, i) ||
-                 PRECISION < matrix_elem(result, k, i)) && k != j) {
-              matrix_add_mult_row(result, k, j, -matrix_elem(result, k, i) /
-                                  matrix_elem(result, j, i));
+  }
+  return invertible;
+}
+
+//eliminate(result) turns the non-empty matrix result into its RREF by
+//   Gauss-Jordan elimination.
+//requires: result is not NULL and not empty
+//effects: modifies *result
+static void eliminate(struct matrix * const result) {
+  int rows, cols = 0;
+  matrix_size(result, &rows, &cols);
+  if (rows <= 1) {
+    return;
+  }
+  int leading_row = 1;
+  for (int i = 1; i <= cols; i++) {
+    for (int j = leading_row; j <= rows; j++) {
+      if (is_leading(result, j, i)) {
+        long double *pivot_row = matrix_row_data(result, j);
+        const long double scale = 1 / pivot_row[i - 1];
+        for (int c = 0; c < cols; c++) {
+          pivot_row[c] *= scale;
+        }
+        INSTRUMENT_FLOPS(cols + 1);
+        for (int k = 1; k <= rows; k++) {
+          long double *row = matrix_row_data(result, k);
+          if (!is_zero(row[i - 1]) && k != j) {
+            const long double factor = -row[i - 1] / pivot_row[i - 1];
+            for (int c = 0; c < cols; c++) {
+              row[c] += factor * pivot_row[c];
             }
+            INSTRUMENT_FLOPS(2 * cols + 1);
           }
-          matrix_swap_row(result, leading_row, j);
-          leading_row++;
-          break;
         }
+        matrix_swap_row(result, leading_row, j);
+        leading_row++;
+        break;
       }
     }
-    return result;
   }
+}
+
+//reduce(A) returns the RREF of the non-empty matrix A through a
+//   heap-allocated matrix pointer.
+//requires: A is not NULL and not empty
+//effects: allocates heap memory
+static struct matrix *reduce(const struct matrix * const A) {
+  if (reduces_to_identity(A)) {
+    int rows, cols = 0;
+    matrix_size(A, &rows, &cols);
+    struct matrix *identity = matrix_create_zero(rows, cols);
+    for (int i = 1; i <= rows; i++) {
+      matrix_row_data(identity, i)[i - 1] = 1;
+    }
+    return identity;
+  }
+  struct matrix *result = matrix_dupe(A);
+  eliminate(result);
+  return result;
+}
+
+//cached_rref(A) returns the RREF of the non-empty matrix A, which belongs to
+//   the cache of A.
+//requires: A is not NULL and not empty
+//effects: may allocate heap memory
+static const struct matrix *cached_rref(const struct matrix * const A) {
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!cache->rref) {
+    cache->rref = reduce(A);
+  }
+  return cache->rref;
+}
+
+struct matrix *RREF(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(RREF);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
+    INSTRUMENT_MATRIX_DIMS(A);
+    return matrix_dupe(cached_rref(A));
+  }
+  return NULL;
+}
+
+struct matrix *RREF_consume(struct matrix * const A) {
+  INSTRUMENT_SCOPE(RREF_consume);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
+    INSTRUMENT_MATRIX_DIMS(A);
+    if (reduces_to_identity(A)) {
+      int rows, cols = 0;
+      matrix_size(A, &rows, &cols);
+      for (int i = 1; i <= rows; i++) {
+        long double *row = matrix_row_data(A, i);
+        memset(row, 0, cols * sizeof(long double));
+        row[i - 1] = 1;
+      }
+    } else {
+      eliminate(A);
+    }
+    return A;
+  }
+  matrix_destroy(A);
   return NULL;
 }
 
 bool is_RREF(const struct matrix * const A) {
-  if (valid_matrix(A)) {
+  INSTRUMENT_SCOPE(is_RREF);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
     int m, n = 0;
     matrix_size(A, &m, &n);
-    struct matrix *RREF_A = RREF(A);
+    INSTRUMENT_DIMS(m, n);
+    const struct matrix *RREF_A = cached_rref(A);
     for (int i = 1; i <= m; i++) {
-      for (int j = 1; j <= n; j++) {
-        if ((matrix_elem(A, i, j) + PRECISION < matrix_elem(RREF_A, i, j)) ||
-            (matrix_elem(A, i, j) - PRECISION > matrix_elem(RREF_A, i, j))) {
-          matrix_destroy(RREF_A);
+      const long double *a = matrix_row_cdata(A, i);
+      const long double *r = matrix_row_cdata(RREF_A, i);
+      for (int j = 0; j < n; j++) {
+        if ((a[j] + PRECISION < r[j]) || (a[j] - PRECISION > r[j])) {
           return false;
         }
       }
     }
-    matrix_destroy(RREF_A);
     return true;
   }
   return false;
 }
 
 int matrix_rank(const struct matrix * const A) {
-  if (valid_matrix(A)) {
-    int m, n = 0;
-    matrix_size(A, &m, &n);
-    struct matrix *RREF_A = RREF(A);
-    int rank = 0;
-    for (int i = 1; i <= m; i++) {
-      for (int j = 1; j <= n; j++) {
-        if (is_leading(RREF_A, i, j)) {
-          rank++;
-          break;
+  int rank = INT_MIN;
+  matrix_rank_checked(A, &rank);
+  return rank;
+}
+
+enum linalg_status matrix_rank_checked(const struct matrix * const A,
+                                       int * const rank) {
+  INSTRUMENT_SCOPE(matrix_rank);
+  assert(rank);
+  const enum linalg_status status = valid_matrix(A, "matrix_rank");
+  if (status != LINALG_OK) {
+    return status;
+  }
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!(cache->valid & CACHE_RANK)) {
+    if (matrix_is_integral(A)) {
+      //integer matrices are ranked modulo primes, free of PRECISION
+      cache->rank = modular_rank(A, NULL);
+    } else {
+      const struct matrix *RREF_A = cached_rref(A);
+      int count = 0;
+      for (int i = 1; i <= m; i++) {
+        for (int j = 1; j <= n; j++) {
+          if (is_leading(RREF_A, i, j)) {
+            count++;
+            break;
+          }
         }
       }
+      cache->rank = count;
     }
-    matrix_destroy(RREF_A);
-    return rank;
+    cache->valid |= CACHE_RANK;
   }
-  return INT_MIN;
+  *rank = cache->rank;
+  return LINALG_OK;
 }
 
 struct matrix *matrix_power(const struct matrix * const A, const int n) {
+  INSTRUMENT_SCOPE(matrix_power);
+  INSTRUMENT_MATRIX_DIMS(A);
   struct matrix *result = matrix_dupe(A);
-  for(int i = 1; i < n; i++) {
-    struct matrix *temp = result;
-    result = matrix_mult_matrix(result, A);
-    matrix_destroy(temp);
+  if (matrix_structure(A) & MATRIX_DIAGONAL) {
+    int size, width = 0;
+    matrix_size(A, &size, &width);
+    for (int i = 1; i <= size; i++) {
+      long double *r = matrix_row_data(result, i);
+      const long double a = r[i - 1];
+      for (int j = 1; j < n; j++) {
+        r[i - 1] *= a;
+      }
+    }
+    INSTRUMENT_FLOPS((long long) size * (n > 1 ? n - 1 : 0));
+    return result;
+  }
+  //every step overwrites result instead of allocating the next power
+  for(int i = 1; i < n && result; i++) {
+    result = matrix_mult_matrix_consume(result, A);
   }
   return result;
 }
-    
-
-
-
-
-
-
-
 
+long double matrix_norm_1(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_norm_1);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
+    int m, n = 0;
+    matrix_size(A, &m, &n);
+    INSTRUMENT_DIMS(m, n);
+    struct matrix_cache * const cache = matrix_cache(A);
+    if (!(cache->valid & CACHE_NORM_1)) {
+      long double norm = 0;
+      for (int j = 0; j < n; j++) {
+        long double sum = 0;
+        for (int i = 1; i <= m; i++) {
+          const long double a = matrix_row_cdata(A, i)[j];
+          sum += a < 0 ? -a : a;
+        }
+        if (sum > norm) {
+          norm = sum;
+        }
+      }
+      INSTRUMENT_FLOPS((long long) m * n);
+      cache->norm_1 = norm;
+      cache->valid |= CACHE_NORM_1;
+    }
+    return cache->norm_1;
+  }
+  return INT_MIN;
+}
 
+bool matrix_is_symmetric(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_is_symmetric);
+  if (valid_matrix(A, __func__) == LINALG_OK) {
+    int m, n = 0;
+    matrix_size(A, &m, &n);
+    INSTRUMENT_DIMS(m, n);
+    if (m != n) {
+      return false;
+    }
+    struct matrix_cache * const cache = matrix_cache(A);
+    if (!(cache->valid & CACHE_SYMMETRIC)) {
+      bool symmetric = true;
+      for (int i = 1; i <= n && symmetric; i++) {
+        const long double *row = matrix_row_cdata(A, i);
+        for (int j = i + 1; j <= n; j++) {
+          if (!is_zero(row[j - 1] - matrix_row_cdata(A, j)[i - 1])) {
+            symmetric = false;
+            break;
+          }
+        }
+      }
+      cache->symmetric = symmetric;
+      cache->valid |= CACHE_SYMMETRIC;
+    }
+    return cache->symmetric;
+  }
+  return false;
+}
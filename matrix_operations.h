@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include "status.h"
 
 //matrix_add(A, B) takes in two struct matrix pointers and outputs the 
 //   result of A+B through a matrix pointer if possible (client must free the
@@ -9,6 +10,18 @@
 struct matrix *matrix_add(const struct matrix * const A, 
                           const struct matrix * const B);
 
+//matrix_add_consume(A, B) is like matrix_add(A, B), but takes ownership of
+//   A: the result is written over the entries of A and returned in its place,
+//   so the caller must not use A afterwards. If the result cannot be
+//   computed, A is freed and NULL is returned. Chaining consuming calls keeps
+//   the number of live matrices constant. B may be A.
+//requires: A, B are not NULL.
+//effects: may print output
+//         may allocate heap memory
+//         may free heap memory
+struct matrix *matrix_add_consume(struct matrix * const A,
+                                  const struct matrix * const B);
+
 //matrix_mult_scalar(A, c) takes in a struct matrix pointer and a long double.
 //   It returns c(A) through a matrix pointer if possible (client must free 
 //   the pointer). Otherwise it prints an error message and returns NULL.
@@ -18,6 +31,15 @@ struct matrix *matrix_add(const struct matrix * const A,
 struct matrix *matrix_mult_scalar(const struct matrix * const A,
                                   const long double c);
 
+//matrix_mult_scalar_consume(A, c) is like matrix_mult_scalar(A, c), but takes
+//   ownership of A (see matrix_add_consume).
+//requires: A is not NULL.
+//effects: may print output
+//         may allocate heap memory
+//         may free heap memory
+struct matrix *matrix_mult_scalar_consume(struct matrix * const A,
+                                          const long double c);
+
 
 //matrix_mult_vector(A, v1) takes in a struct matrix pointer and a struct 
 //   vector pointer. It returns A(v1) through a vector pointer if possible 
@@ -38,6 +60,17 @@ struct vector *matrix_mult_vector(const struct matrix * const A,
 struct matrix *matrix_mult_matrix(const struct matrix * const A, 
                                   const struct matrix * const B);
 
+//matrix_mult_matrix_consume(A, B) is like matrix_mult_matrix(A, B), but takes
+//   ownership of A (see matrix_add_consume). AB is written over A when B is
+//   square and not A itself, using one extra row of scratch memory; otherwise
+//   A is freed after AB is computed into a new matrix.
+//requires: A, B are not NULL.
+//effects: may print output
+//         may allocate heap memory
+//         may free heap memory
+struct matrix *matrix_mult_matrix_consume(struct matrix * const A,
+                                          const struct matrix * const B);
+
 //rotation_matrix(theta) takes in a long double as the angle in RADIANS. Then 
 //  it outputs the rotation matrix R[theta] through a matrix pointer if 
 //   possible (client must free the pointer). Otherwise it prints an error 
@@ -53,12 +86,22 @@ bool is_RREF(const struct matrix * const A);
 
 //RREF(A)takes in a struct matrix pointer A, and returns the RREF of A through
 //   a matrix pointer if possible (client must free the pointer). Otherwise
-//   it prints an error message and returns NULL. 
+//   it prints an error message and returns NULL. The RREF is kept with A, so
+//   asking again before A changes only copies it; matrix_rank and is_RREF
+//   reuse it as well.
 //requires: A is not NULL;
 //effects: may print output
 //         may allocate heap memory
 struct matrix *RREF(const struct matrix * const A);
 
+//RREF_consume(A) is like RREF(A), but takes ownership of A (see
+//   matrix_add_consume) and reduces it in place instead of copying it.
+//requires: A is not NULL;
+//effects: may print output
+//         may allocate heap memory
+//         may free heap memory
+struct matrix *RREF_consume(struct matrix * const A);
+
 
 //matrix_transpose(A) takes in a struct matrix pointer A, and returns the 
 //   transposeof A through a matrix pointer if possible (client must free 
@@ -70,11 +113,23 @@ struct matrix *matrix_transpose(const struct matrix * const A);
 
 //matrix_rank(A) takes in a struct matrix pointer A, and returns the 
 //   rank of A if possible, Otherwise it prints an error message and returns 
-//   INT_MIN.
+//   INT_MIN. The rank of a matrix of integers is found modulo primes (see
+//   modular.h). For other square matrices, a large condition number (see
+//   matrix_cond_1 in inv_and_det.h) warns that rounding may have decided
+//   whether a row is dependent.
 //requires: A is not NULL;
 //effects: may print output
 int matrix_rank(const struct matrix * const A);
 
+//matrix_rank_checked(A, rank) stores the rank of A in *rank and returns
+//   LINALG_OK if possible. Otherwise it reports the error (see status.h),
+//   leaves *rank unchanged and returns its status.
+//requires: A, rank are not NULL;
+//effects: may modify *rank
+//         may print output
+enum linalg_status matrix_rank_checked(const struct matrix * const A,
+                                       int * const rank);
+
 //matrix_power(A, n) takes in a struct matrix pointer A and an integer n, and
 //   returns A^n through a heap_allocated struct matrix pointer if possible (
 //   the client must free the pointer with matrix_destroy). Otherwise it 
@@ -84,3 +139,16 @@ int matrix_rank(const struct matrix * const A);
 //         may allocate heap memory
 struct matrix *matrix_power(const struct matrix * const A, const int n);
 
+//matrix_norm_1(A) returns the 1-norm of A, the largest sum of the absolute
+//   values of the entries of a column, if possible. Otherwise it prints an
+//   error message and returns INT_MIN.
+//requires: A is not NULL;
+//effects: may print output
+long double matrix_norm_1(const struct matrix * const A);
+
+//matrix_is_symmetric(A) returns true if A is square and A[ij] is within
+//   PRECISION of A[ji] for every i and j, false otherwise.
+//requires: A is not NULL, *A is not empty.
+//effects: may print output
+bool matrix_is_symmetric(const struct matrix * const A);
+
@@ -0,0 +1,156 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix_core.h"
+#include "exact.h"
+#include "modular.h"
+#include "instrument.h"
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+//The largest primes below 2^26. Residues are kept in doubles: a product of
+//   two of them is below 2^52, so x - fy is exact and one multiplication by
+//   1/p finds its quotient to within one, which keeps the inner loop free of
+//   integer division.
+static const int64_t PRIMES[] = {67108859, 67108837, 67108819, 67108777,
+                                 67108763, 67108757, 67108753, 67108747};
+static const int PRIME_COUNT = sizeof(PRIMES) / sizeof(PRIMES[0]);
+
+//reduce(t, p, inv) returns t mod p in [0, p).
+//requires: |t| < 2^52, p > 0, inv = 1 / p
+static inline double reduce(const double t, const double p, const double inv) {
+  double r = t - (double) (int64_t) (t * inv) * p;
+  r += r < 0 ? p : 0;
+  r -= r >= p ? p : 0;
+  return r;
+}
+
+//inverse_mod(x, p) returns the inverse of x mod the prime p.
+//requires: 0 < x < p
+static int64_t inverse_mod(const int64_t x, const int64_t p) {
+  int64_t a = x;
+  int64_t b = p;
+  int64_t u = 1;
+  int64_t v = 0;
+  while (b != 0) {
+    const int64_t q = a / b;
+    int64_t t = a - q * b;
+    a = b;
+    b = t;
+    t = u - q * v;
+    u = v;
+    v = t;
+  }
+  return u < 0 ? u + p : u;
+}
+
+//rank_mod(a, m, n, p, pivot) reduces the m x n row-major matrix a, whose
+//   entries are in [0, p), to row echelon form mod p, stores its pivot
+//   columns (numbered from 1) in pivot and returns its rank.
+//requires: a, pivot are not NULL, p is one of PRIMES
+//          pivot has room for min(m, n) ints
+//effects: modifies a, pivot
+static int rank_mod(double * const a, const int m, const int n,
+                    const int64_t p, int * const pivot) {
+  const double P = p;
+  const double inv = 1.0 / P;
+  int r = 0;
+  for (int c = 0; (c < n) && (r < m); c++) {
+    int q = r;
+    while ((q < m) && (a[q * n + c] == 0)) {
+      q++;
+    }
+    if (q == m) {
+      continue;
+    }
+    double *top = a + r * n;
+    if (q != r) {
+      //entries left of c are zero in both rows
+      double *other = a + q * n;
+      for (int j = c; j < n; j++) {
+        const double t = top[j];
+        top[j] = other[j];
+        other[j] = t;
+      }
+    }
+    const double h = inverse_mod(top[c], p);
+    top[c] = 1;
+    for (int j = c + 1; j < n; j++) {
+      top[j] = reduce(top[j] * h, P, inv);
+    }
+    for (int i = r + 1; i < m; i++) {
+      double *row = a + i * n;
+      const double f = row[c];
+      if (f != 0) {
+        row[c] = 0;
+        for (int j = c + 1; j < n; j++) {
+          row[j] = reduce(row[j] - f * top[j], P, inv);
+        }
+      }
+    }
+    INSTRUMENT_FLOPS(2LL * (m - r) * (n - c));
+    pivot[r] = c + 1;
+    r++;
+  }
+  return r;
+}
+
+int modular_rank(const struct matrix * const A, int * const pivot) {
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  const int full = m < n ? m : n;
+  const size_t entries = (size_t) m * n;
+  const size_t bytes = entries * sizeof(double) + 2 * full * sizeof(int);
+  double *a = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  int *found = (int *) (a + entries);
+  int *best_pivot = found + full;
+  int best = -1;
+  const int primes = MODULAR_PRIMES < 1 ? 1 :
+                     MODULAR_PRIMES > PRIME_COUNT ? PRIME_COUNT : MODULAR_PRIMES;
+  for (int k = 0; (k < primes) && (best < full); k++) {
+    const int64_t p = PRIMES[k];
+    for (int i = 0; i < m; i++) {
+      const long double *row = matrix_row_cdata(A, i + 1);
+      for (int j = 0; j < n; j++) {
+        const int64_t x = (int64_t) row[j] % p;
+        a[i * n + j] = x < 0 ? x + p : x;
+      }
+    }
+    const int rank = rank_mod(a, m, n, p, found);
+    if (rank > best) {
+      best = rank;
+      memcpy(best_pivot, found, rank * sizeof(int));
+    }
+  }
+  if (pivot) {
+    memcpy(pivot, best_pivot, best * sizeof(int));
+  }
+  INSTRUMENT_FREE(bytes);
+  free(a);
+  return best;
+}
+
+enum linalg_status matrix_rank_modular(const struct matrix * const A,
+                                       int * const rank) {
+  INSTRUMENT_SCOPE(matrix_rank_modular);
+  assert(A);
+  assert(rank);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m == 0) || (n == 0)) {
+    return linalg_report(LINALG_ERR_EMPTY, __func__,
+                         "The input matrix must not be empty.");
+  } else if (!matrix_is_integral(A)) {
+    return linalg_report(LINALG_ERR_INVALID, __func__,
+                         "Every entry must be an integer below 2^63 in "
+                         "magnitude.");
+  }
+  *rank = modular_rank(A, NULL);
+  return LINALG_OK;
+}
@@ -0,0 +1,44 @@
+#ifndef LINALG_MODULAR_H
+#define LINALG_MODULAR_H
+
+#include "status.h"
+
+//The rank of an integer matrix (see exact.h) can also be found modulo a
+//   prime p: the entries are reduced to integers mod p and eliminated there,
+//   so every operation is exact and costs a few machine instructions, without
+//   any growth in size. The rank mod p is never above the true rank, and is
+//   below it only if p divides every minor of that size, which for a prime
+//   near 2^26 happens with a chance of about one in 67 million. If the first
+//   prime gives a rank below min(m, n), further primes are tried, up to
+//   MODULAR_PRIMES of them (see settings.h), and the largest rank is kept.
+//   A full rank answer is always certain; a lower one is exact with high
+//   probability, though a matrix built to have such minors can fool it. Use
+//   matrix_rank_exact when the answer must be certain.
+
+struct matrix;
+
+//matrix_rank_modular(A, rank) stores the rank of the integer matrix A found
+//   modulo primes (see above) in *rank and returns LINALG_OK if possible.
+//   Otherwise (A is empty or has an entry that is not an integer) it reports
+//   the error (see status.h), leaves *rank unchanged and returns its status.
+//requires: A, rank are not NULL
+//effects: may modify *rank
+//         may print output
+//         may allocate heap memory
+enum linalg_status matrix_rank_modular(const struct matrix * const A,
+                                       int * const rank);
+
+
+//The rest of this file is used by the toolbox itself.
+
+//modular_rank(A, pivot) returns the rank of A as matrix_rank_modular finds
+//   it. If pivot is not NULL, the pivot columns of the elimination that found
+//   it (numbered from 1, increasing) are stored in its first rank entries;
+//   the columns of A they name are linearly independent.
+//requires: A is not NULL, non-empty and integral
+//          pivot is NULL or has room for as many ints as A has columns
+//effects: may modify pivot
+//         allocates and frees heap memory
+int modular_rank(const struct matrix * const A, int * const pivot);
+
+#endif
@@ -0,0 +1,203 @@
+#define _POSIX_C_SOURCE 199309L
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "orthonormal.h"
+#include "instrument.h"
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+//columns per block
+static const int BLOCK = 32;
+
+
+//A struct project_task makes the columns first to last - 1 of a block P
+//   (d x b, by columns) orthogonal to the r columns of Q (d x r, by columns),
+//   with coeff as room for r coefficients per column.
+struct project_task {
+  const long double *Q;
+  long double *P;
+  long double *coeff;
+  int d;
+  int r;
+  int first;
+  int last;
+  pthread_t thread;
+  bool started;
+};
+
+//project(task) runs two passes of P = P - Q (Q^T P) on the columns of task.
+//requires: task is a struct project_task pointer
+//effects: modifies the columns of the block in task
+static void *project(void *task) {
+  const struct project_task * const t = task;
+  const int d = t->d;
+  const int r = t->r;
+  const int b = t->last - t->first;
+  long double * const P = t->P + (size_t) t->first * d;
+  for (int pass = 0; pass < 2; pass++) {
+    //C = Q^T P, reading each column of Q once for the whole group
+    for (int i = 0; i < r; i++) {
+      const long double *q = t->Q + (size_t) i * d;
+      for (int j = 0; j < b; j++) {
+        const long double *p = P + (size_t) j * d;
+        long double sum = 0;
+        for (int l = 0; l < d; l++) {
+          sum += q[l] * p[l];
+        }
+        t->coeff[(size_t) j * r + i] = sum;
+      }
+    }
+    //P = P - QC
+    for (int i = 0; i < r; i++) {
+      const long double *q = t->Q + (size_t) i * d;
+      for (int j = 0; j < b; j++) {
+        long double *p = P + (size_t) j * d;
+        const long double c = t->coeff[(size_t) j * r + i];
+        for (int l = 0; l < d; l++) {
+          p[l] -= c * q[l];
+        }
+      }
+    }
+  }
+  return NULL;
+}
+
+//project_block(Q, r, P, b, d, coeff) makes the b columns of P orthogonal to
+//   the r columns of Q, on several threads if the block is large enough.
+//requires: Q, P, coeff are not NULL, coeff has room for b * r numbers
+//effects: modifies P and coeff
+static void project_block(const long double * const Q, const int r,
+                          long double * const P, const int b, const int d,
+                          long double * const coeff) {
+  if (r == 0) {
+    return;
+  }
+  int threads = MAX_THREADS < b ? MAX_THREADS : b;
+  if ((long long) d * r * b < THREAD_WORK || threads < 1) {
+    threads = 1;
+  }
+  struct project_task *task = malloc(threads * sizeof(struct project_task));
+  for (int t = 0; t < threads; t++) {
+    task[t].Q = Q;
+    task[t].P = P;
+    task[t].d = d;
+    task[t].r = r;
+    task[t].first = (int) ((long long) b * t / threads);
+    task[t].last = (int) ((long long) b * (t + 1) / threads);
+    task[t].coeff = coeff + (size_t) task[t].first * r;
+    task[t].started = false;
+  }
+  //the calling thread takes the first share, and any share whose thread
+  //   could not be started
+  for (int t = 1; t < threads; t++) {
+    task[t].started =
+      pthread_create(&task[t].thread, NULL, project, &task[t]) == 0;
+  }
+  project(&task[0]);
+  for (int t = 1; t < threads; t++) {
+    if (task[t].started) {
+      pthread_join(task[t].thread, NULL);
+    } else {
+      project(&task[t]);
+    }
+  }
+  free(task);
+  INSTRUMENT_FLOPS(8LL * d * r * b);
+}
+
+struct matrix *orthonormal_basis(const struct vector * const vector_list[],
+                                 const int n) {
+  INSTRUMENT_SCOPE(orthonormal_basis);
+  assert(vector_list);
+  for (int i = 0; i < n; i++) {
+    assert(vector_list[i]);
+  }
+  if (n < 1) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. n must be greater than 0.");
+    return NULL;
+  }
+  const int d = vector_dim(vector_list[0]);
+  INSTRUMENT_DIMS(d, n);
+  for (int i = 0; i < n; i++) {
+    if ((vector_dim(vector_list[i]) != d) || (d < 1)) {
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "Invalid input. All vectors must have the same positive "
+                    "dimension.");
+      return NULL;
+    }
+  }
+  //at most d vectors are kept, then a block, its lengths and coefficients
+  const int cap = d < n ? d : n;
+  const int b = BLOCK < n ? BLOCK : n;
+  const size_t bytes = ((size_t) d * cap + (size_t) d * b + b +
+                        (size_t) b * cap) * sizeof(long double);
+  long double *Q = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  long double *P = Q + (size_t) d * cap;
+  long double *length = P + (size_t) d * b;
+  long double *coeff = length + b;
+  int r = 0;
+  for (int start = 0; (start < n) && (r < cap); start += b) {
+    const int width = n - start < b ? n - start : b;
+    for (int j = 0; j < width; j++) {
+      long double *p = P + (size_t) j * d;
+      memcpy(p, vector_cdata(vector_list[start + j]), d * sizeof(long double));
+      long double sum = 0;
+      for (int l = 0; l < d; l++) {
+        sum += p[l] * p[l];
+      }
+      length[j] = sqrtl(sum);
+    }
+    const int before = r;
+    project_block(Q, before, P, width, d, coeff);
+    //within the block, each column is projected twice against the columns
+    //   this block has already added
+    for (int j = 0; (j < width) && (r < cap); j++) {
+      long double *p = P + (size_t) j * d;
+      for (int pass = 0; pass < 2; pass++) {
+        for (int i = before; i < r; i++) {
+          const long double *q = Q + (size_t) i * d;
+          long double c = 0;
+          for (int l = 0; l < d; l++) {
+            c += q[l] * p[l];
+          }
+          for (int l = 0; l < d; l++) {
+            p[l] -= c * q[l];
+          }
+        }
+      }
+      INSTRUMENT_FLOPS(8LL * d * (r - before));
+      long double sum = 0;
+      for (int l = 0; l < d; l++) {
+        sum += p[l] * p[l];
+      }
+      const long double rest = sqrtl(sum);
+      if (rest > PRECISION * length[j]) {
+        long double *q = Q + (size_t) r * d;
+        for (int l = 0; l < d; l++) {
+          q[l] = p[l] / rest;
+        }
+        r++;
+      }
+    }
+  }
+  struct matrix *basis = r ? matrix_create_zero(d, r) : matrix_create();
+  for (int l = 0; l < d && r; l++) {
+    long double *row = matrix_row_data(basis, l + 1);
+    for (int i = 0; i < r; i++) {
+      row[i] = Q[(size_t) i * d + l];
+    }
+  }
+  INSTRUMENT_FREE(bytes);
+  free(Q);
+  return basis;
+}
@@ -0,0 +1,34 @@
+#ifndef LINALG_ORTHONORMAL_H
+#define LINALG_ORTHONORMAL_H
+
+//orthonormal_basis turns a list of vectors into an orthonormal basis of its
+//   span in blocks of columns. Each block is first made orthogonal to the
+//   basis found so far with two passes of classical Gram-Schmidt (CGS2), as
+//   two products Q^T P and P - QC with the basis Q, and then orthonormalized
+//   one column at a time. The second pass restores the orthogonality the
+//   first one loses to rounding, so the result is as accurate as modified
+//   Gram-Schmidt, while the products read Q once per block instead of once
+//   per vector. For long lists the columns of a block are split among up to
+//   MAX_THREADS threads (see settings.h).
+
+struct vector;
+struct matrix;
+
+//orthonormal_basis(vector_list, n) returns a heap-allocated d x r matrix
+//   whose columns are an orthonormal basis of the span of the first n vectors
+//   of vector_list, which are in R[d]. The caller must free it with
+//   matrix_destroy(). A vector whose part outside the span of those before it
+//   is at most PRECISION times its length is left out, so the j-th column
+//   spans the same space as the first j vectors that were kept. If the
+//   vectors only span the zero vector, the matrix is empty. If n is not
+//   positive or the vectors do not have the same positive dimension, it
+//   outputs an error message and returns NULL.
+//requires: vector_list is not NULL
+//          there are at least n pointers in vector_list
+//          first n pointers in vector_list are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct matrix *orthonormal_basis(const struct vector * const vector_list[],
+                                 const int n);
+
+#endif
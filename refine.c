@@ -0,0 +1,379 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "matrix_operations.h"
+#include "lu.h"
+#include "krylov.h"
+#include "refine.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+//columns factored together before the rest of the matrix is updated
+static const int BLOCK = 64;
+//columns of the rest of the matrix updated together, so that the rows of U
+//   they need stay in cache
+static const int TILE = 256;
+//refinement steps before the long double factorization takes over
+static const int MAX_STEPS = 30;
+
+//axpy(y, x, alpha, len) adds alpha times the len doubles of x to those of y.
+//requires: x, y are not NULL and do not overlap
+//effects: modifies y
+static void axpy(double * restrict y, const double * restrict x,
+                 const double alpha, const int len) {
+  for (int j = 0; j < len; j++) {
+    y[j] += alpha * x[j];
+  }
+}
+
+//axpy4(y, x, alpha, len, stride) adds alpha[t] times the len doubles at
+//   x + t stride to those of y for t = 0, 1, 2, 3, loading and storing y
+//   once instead of four times.
+//requires: x, y, alpha are not NULL, y does not overlap the four rows of x
+//effects: modifies y
+static void axpy4(double * restrict y, const double * restrict x,
+                  const double * const alpha, const int len,
+                  const size_t stride) {
+  const double * restrict x1 = x + stride;
+  const double * restrict x2 = x + 2 * stride;
+  const double * restrict x3 = x + 3 * stride;
+  const double a0 = alpha[0];
+  const double a1 = alpha[1];
+  const double a2 = alpha[2];
+  const double a3 = alpha[3];
+  for (int j = 0; j < len; j++) {
+    y[j] += a0 * x[j] + a1 * x1[j] + a2 * x2[j] + a3 * x3[j];
+  }
+}
+
+//factor(a, n, perm) replaces the n x n doubles of a (row-major) by their LU
+//   factorization with partial pivoting, PA = LU, with L below the diagonal
+//   and U on and above it, and row i of PA is row perm[i] of A. Each block
+//   of BLOCK columns is factored on its own, the rows of U to its right are
+//   found next, and then the rest of the matrix is updated tile by tile. It
+//   returns false if a pivot is 0, leaving a partly factored.
+//requires: a, perm are not NULL, perm has room for n ints
+//effects: modifies a and perm
+static bool factor(double * const a, const int n, int * const perm) {
+  for (int i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+  for (int kb = 0; kb < n; kb += BLOCK) {
+    const int ke = kb + BLOCK < n ? kb + BLOCK : n;
+    for (int k = kb; k < ke; k++) {
+      int pivot = k;
+      for (int i = k + 1; i < n; i++) {
+        if (fabs(a[(size_t) i * n + k]) > fabs(a[(size_t) pivot * n + k])) {
+          pivot = i;
+        }
+      }
+      if (a[(size_t) pivot * n + k] == 0) {
+        return false;
+      }
+      if (pivot != k) {
+        double * const rk = a + (size_t) k * n;
+        double * const rp = a + (size_t) pivot * n;
+        for (int j = 0; j < n; j++) {
+          const double temp = rk[j];
+          rk[j] = rp[j];
+          rp[j] = temp;
+        }
+        const int temp = perm[k];
+        perm[k] = perm[pivot];
+        perm[pivot] = temp;
+      }
+      const double * const rk = a + (size_t) k * n;
+      for (int i = k + 1; i < n; i++) {
+        double * const ri = a + (size_t) i * n;
+        ri[k] /= rk[k];
+        axpy(ri + k + 1, rk + k + 1, -ri[k], ke - k - 1);
+      }
+    }
+    //the rows of U to the right of the block: L11 U12 = A12
+    for (int k = kb; k < ke; k++) {
+      const double * const rk = a + (size_t) k * n;
+      for (int i = k + 1; i < ke; i++) {
+        double * const ri = a + (size_t) i * n;
+        axpy(ri + ke, rk + ke, -ri[k], n - ke);
+      }
+    }
+    //A22 -= L21 U12
+    for (int jb = ke; jb < n; jb += TILE) {
+      const int width = jb + TILE < n ? TILE : n - jb;
+      for (int i = ke; i < n; i++) {
+        double * const ri = a + (size_t) i * n;
+        int k = kb;
+        for (; k + 4 <= ke; k += 4) {
+          const double l[4] = {-ri[k], -ri[k + 1], -ri[k + 2], -ri[k + 3]};
+          axpy4(ri + jb, a + (size_t) k * n + jb, l, width, n);
+        }
+        for (; k < ke; k++) {
+          axpy(ri + jb, a + (size_t) k * n + jb, -ri[k], width);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+//solve(a, n, perm, b, x) solves Ax = b for the n doubles of x, where a and
+//   perm hold the factorization of A found by factor.
+//requires: a, perm, b, x are not NULL, b and x do not overlap
+//effects: modifies x
+static void solve(const double * const a, const int n, const int * const perm,
+                  const double * const b, double * const x) {
+  for (int i = 0; i < n; i++) {
+    const double * const ri = a + (size_t) i * n;
+    double sum = b[perm[i]];
+    for (int j = 0; j < i; j++) {
+      sum -= ri[j] * x[j];
+    }
+    x[i] = sum;
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    const double * const ri = a + (size_t) i * n;
+    double sum = x[i];
+    for (int j = i + 1; j < n; j++) {
+      sum -= ri[j] * x[j];
+    }
+    x[i] = sum / ri[i];
+  }
+}
+
+//solve_transpose(a, n, perm, c, y, w) solves A^T y = c for the n doubles of
+//   y, where a and perm hold the factorization of A found by factor, using
+//   the n doubles of w: U^T w = c, then L^T w = w, and y = P^T w.
+//requires: a, perm, c, y, w are not NULL and do not overlap
+//effects: modifies y and w
+static void solve_transpose(const double * const a, const int n,
+                            const int * const perm, const double * const c,
+                            double * const y, double * const w) {
+  for (int i = 0; i < n; i++) {
+    w[i] = c[i];
+  }
+  for (int k = 0; k < n; k++) {
+    const double * const rk = a + (size_t) k * n;
+    w[k] /= rk[k];
+    axpy(w + k + 1, rk + k + 1, -w[k], n - k - 1);
+  }
+  for (int k = n - 1; k >= 0; k--) {
+    const double * const rk = a + (size_t) k * n;
+    axpy(w, rk, -w[k], k);
+  }
+  for (int i = 0; i < n; i++) {
+    y[perm[i]] = w[i];
+  }
+}
+
+//A struct double_factors holds the factorization of A found by factor, with
+//   3n doubles of work for solving systems with it as a struct linop (see
+//   krylov.h).
+struct double_factors {
+  const double *a;
+  int n;
+  const int *perm;
+  double *work;
+};
+
+//apply_inverse(data, b, x) solves Ax = b and apply_inverse_transpose(data,
+//   c, x) solves A^T x = c in double, for the struct double_factors data,
+//   so that the condition number is estimated with the factors that the
+//   refinement uses.
+//requires: data, b, c, x are not NULL, x overlaps neither b nor c
+//effects: modifies x and the work of data
+static void apply_inverse(const void *data, const long double *b,
+                          long double *x) {
+  const struct double_factors * const f = data;
+  double * const bd = f->work;
+  double * const xd = f->work + f->n;
+  for (int i = 0; i < f->n; i++) {
+    bd[i] = (double) b[i];
+  }
+  solve(f->a, f->n, f->perm, bd, xd);
+  for (int i = 0; i < f->n; i++) {
+    x[i] = xd[i];
+  }
+}
+
+static void apply_inverse_transpose(const void *data, const long double *c,
+                                    long double *x) {
+  const struct double_factors * const f = data;
+  double * const cd = f->work;
+  double * const xd = f->work + f->n;
+  for (int i = 0; i < f->n; i++) {
+    cd[i] = (double) c[i];
+  }
+  solve_transpose(f->a, f->n, f->perm, cd, xd, f->work + 2 * f->n);
+  for (int i = 0; i < f->n; i++) {
+    x[i] = xd[i];
+  }
+}
+
+//residual(A, b, x, r, n) stores b - Ax in r, in long double, and returns its
+//   infinity norm.
+//requires: A, b, x, r are not NULL, A is n x n, b, x and r hold n long
+//          doubles, r does not overlap b or x
+//effects: modifies r
+static long double residual(const struct matrix * const A,
+                            const long double * const b,
+                            const long double * const x,
+                            long double * const r, const int n) {
+  long double norm = 0;
+  for (int i = 0; i < n; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    long double sum = b[i];
+    for (int j = 0; j < n; j++) {
+      sum -= row[j] * x[j];
+    }
+    r[i] = sum;
+    norm = fmaxl(norm, fabsl(sum));
+  }
+  return norm;
+}
+
+//max_abs(x, n) returns the infinity norm of the n long doubles of x.
+//requires: x is not NULL
+static long double max_abs(const long double * const x, const int n) {
+  long double norm = 0;
+  for (int i = 0; i < n; i++) {
+    norm = fmaxl(norm, fabsl(x[i]));
+  }
+  return norm;
+}
+
+struct vector *refine_solve(const struct matrix * const A,
+                            const struct vector * const b,
+                            struct refine_stats * const stats) {
+  INSTRUMENT_SCOPE(refine_solve);
+  assert(A);
+  assert(b);
+  //a solve that fails leaves these
+  if (stats) {
+    stats->converged = false;
+    stats->iterations = 0;
+    stats->condition = INFINITY;
+    stats->backward_error = INFINITY;
+  }
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m != n) || (n < 1)) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, __func__,
+                  "Invalid input. Matrix must be n x n where n is positive.");
+    return NULL;
+  } else if (vector_dim(b) != n) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "A vector with %d elements cannot be the right side of a "
+                  "system with %d unknowns.", vector_dim(b), n);
+    return NULL;
+  }
+  //A in double, then the 3n doubles of work for the solves
+  const size_t bytes = ((size_t) n * n + 3 * (size_t) n) * sizeof(double);
+  double *a = malloc(bytes);
+  double * const work = a + (size_t) n * n;
+  long double *r = malloc(n * sizeof(long double));
+  int *perm = malloc(n * sizeof(int));
+  INSTRUMENT_ALLOC(bytes + n * (sizeof(long double) + sizeof(int)));
+  //|A| and |b| in the infinity norm, for the backward error
+  long double norm_a = 0;
+  bool finite = true;
+  for (int i = 0; i < n; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    double * const ai = a + (size_t) i * n;
+    long double sum = 0;
+    for (int j = 0; j < n; j++) {
+      ai[j] = (double) row[j];
+      finite = finite && isfinite(ai[j]);
+      sum += fabsl(row[j]);
+    }
+    norm_a = fmaxl(norm_a, sum);
+  }
+  const long double * const bb = vector_cdata(b);
+  const long double norm_b = max_abs(bb, n);
+  struct vector *x = vector_create_zero(n);
+  long double * const xx = vector_data(x);
+  //entries beyond the range of a double, or a zero pivot, leave the work to
+  //   the long double factorization
+  const bool factored = finite && factor(a, n, perm);
+  INSTRUMENT_FLOPS(2LL * n * n * n / 3);
+  long double condition = INFINITY;
+  long double backward_error = INFINITY;
+  bool converged = false;
+  int steps = 0;
+  if (factored) {
+    const struct double_factors factors = {a, n, perm, work};
+    const struct linop inverse = {n, apply_inverse, &factors};
+    const struct linop inverse_transpose = {n, apply_inverse_transpose,
+                                            &factors};
+    condition = matrix_norm_1(A) *
+                inverse_norm_1_estimate(&inverse, &inverse_transpose);
+    const long double tolerance = sqrtl(n) * LDBL_EPSILON;
+    double * const rd = work;
+    double * const d = work + n;
+    //x starts at 0, so the first step solves Ax = b
+    long double norm_r = norm_b;
+    for (int i = 0; i < n; i++) {
+      r[i] = bb[i];
+    }
+    while (true) {
+      const long double denominator = norm_a * max_abs(xx, n) + norm_b;
+      const long double previous = backward_error;
+      backward_error = denominator > 0 ? norm_r / denominator : 0;
+      if (backward_error <= tolerance) {
+        converged = true;
+        break;
+      } else if ((steps >= MAX_STEPS) || (backward_error > previous / 2)) {
+        break;
+      }
+      //the residual is scaled to 1 before it is rounded to double, so that
+      //   it neither underflows nor loses digits
+      for (int i = 0; i < n; i++) {
+        rd[i] = (double) (r[i] / norm_r);
+      }
+      solve(a, n, perm, rd, d);
+      for (int i = 0; i < n; i++) {
+        xx[i] += norm_r * d[i];
+      }
+      steps++;
+      norm_r = residual(A, bb, xx, r, n);
+      INSTRUMENT_FLOPS(4LL * n * n);
+    }
+  }
+  struct vector *result = x;
+  if (!converged) {
+    const struct lu_factorization *lu = matrix_lu(A);
+    if (lu_singular(lu)) {
+      linalg_report(LINALG_ERR_SINGULAR, __func__,
+                    "The matrix is not invertible.");
+      result = NULL;
+    } else {
+      lu_solve_into(lu, bb, xx);
+      const long double denominator = norm_a * max_abs(xx, n) + norm_b;
+      backward_error = denominator > 0 ? residual(A, bb, xx, r, n) /
+                                         denominator : 0;
+    }
+  }
+  INSTRUMENT_FREE(bytes + n * (sizeof(long double) + sizeof(int)));
+  free(a);
+  free(r);
+  free(perm);
+  if (!result) {
+    vector_destroy(x);
+    //A is singular: no x solves the system
+    condition = INFINITY;
+    backward_error = INFINITY;
+  }
+  if (stats) {
+    stats->converged = converged;
+    stats->iterations = steps;
+    stats->condition = condition;
+    stats->backward_error = backward_error;
+  }
+  return result;
+}
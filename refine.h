@@ -0,0 +1,51 @@
+#ifndef LINALG_REFINE_H
+#define LINALG_REFINE_H
+
+#include <stdbool.h>
+
+//Mixed-precision iterative refinement solves a dense system Ax = b to long
+//   double accuracy while doing its O(n^3) work in double: A is rounded to
+//   double and factored there (PA = LU, by a blocked right-looking algorithm
+//   whose inner loops run over contiguous rows that the compiler can
+//   vectorize), and each step of the refinement computes the residual
+//   r = b - Ax in long double from the original entries of A and corrects x
+//   by the solution of Ad = r with the double factors, in O(n^2). Every step
+//   gains about 16 - log10(cond(A)) digits, so for a condition number well
+//   below 10^16 a few steps reach long double accuracy. When the refinement
+//   stalls, the system is solved again with the long double LU factorization
+//   of A (see lu.h), so the result is never worse than that of lu_solve.
+
+struct matrix;
+struct vector;
+
+//A struct refine_stats describes a finished solve. converged is true if the
+//   refinement reached long double accuracy on its own and false if the
+//   long double factorization had to take over. condition estimates the
+//   1-norm condition number of A, |A| |A^-1|, by Hager's method with the
+//   double factors, or is INFINITY if A did not fit in a double or had a
+//   zero pivot there. backward_error is the normwise backward error of the
+//   returned x, |b - Ax| / (|A| |x| + |b|) in the infinity norm, the
+//   smallest relative change to A and b for which x is exact.
+struct refine_stats {
+  bool converged;
+  int iterations;
+  long double condition;
+  long double backward_error;
+};
+
+//refine_solve(A, b, stats) returns the solution x of Ax = b through a
+//   heap-allocated vector that the caller must free with vector_destroy(),
+//   found by mixed-precision iterative refinement. If stats is not NULL,
+//   *stats describes the solve; when NULL is returned, converged is false
+//   and condition and backward_error are INFINITY. If A is not square or b
+//   is not in R[n], it outputs an error message and returns NULL; if A is
+//   singular, it reports LINALG_ERR_SINGULAR and returns NULL.
+//requires: A, b are not NULL
+//effects: may modify *stats
+//         may print output
+//         may allocate heap memory
+struct vector *refine_solve(const struct matrix * const A,
+                            const struct vector * const b,
+                            struct refine_stats * const stats);
+
+#endif
@@ -4,8 +4,23 @@
 
 const long double PRECISION = 0.000001;
 
+const int MODULAR_PRIMES = 3;
+
+const int EXACT_DET_MAX = 16;
+
+const int MAX_THREADS = 4;
+const long long THREAD_WORK = 1LL << 18;
+
 const char VECTOR_BRACKET_LEFT = '(';
 const char VECTOR_BRACKET_RIGHT = ')';
 const char MATRIX_BRACKET_LEFT = '|';
 const char MATRIX_BRACKET_RIGHT = '|';
 
+
+const int PRINT_WIDTH = 14;
+const int PRINT_DECIMALS = 5;
+
+const int PRINT_SUMMARY_THRESHOLD = 0;
+const int PRINT_SUMMARY_EDGE = 3;
+
+const bool PRINT_ERRORS = true;
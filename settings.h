@@ -1,9 +1,32 @@
+#include <stdbool.h>
+
 //Long doubles are very precise, but calculation errors still build up over
 //   time. When checking critical values (such as leading ones for rank), 
 //   functions use a given precision. For example, a number within 
 //   (1-PRECISION, 1+PRECISION) will be treated as 1 when calculating rank.
 extern const long double PRECISION;
 
+//Integer matrices that are not of full rank mod the first prime are checked
+//   mod up to MODULAR_PRIMES primes (between 1 and 8) before their rank is
+//   trusted (see modular.h). Each prime makes a wrong answer less likely by a
+//   factor of about 67 million, and costs one more elimination.
+extern const int MODULAR_PRIMES;
+
+//matrix_det finds the determinant of an integer matrix exactly (see
+//   exact.h) only up to EXACT_DET_MAX x EXACT_DET_MAX, where that costs well
+//   under a millisecond; the integers grow with n, so larger matrices use the
+//   LU factorization like any other. Set it to 3 to never use exact
+//   elimination; call matrix_det_exact for an exact answer at any size.
+//   adj_matrix and cof_matrix use the same bound for their cofactors.
+extern const int EXACT_DET_MAX;
+
+//Long computations (see orthonormal.h) split their work among up to
+//   MAX_THREADS threads. Set it to 1 to keep all work on the calling thread.
+//   A piece of work is split only when it takes at least THREAD_WORK
+//   multiply-adds, since starting a thread costs about as much.
+extern const int MAX_THREADS;
+extern const long long THREAD_WORK;
+
 
 //The following parameters control the brackets of vectors and matrices. For
 //   example, you may want to print a vector with different side brackets as 
@@ -14,3 +37,23 @@ extern const char MATRIX_BRACKET_LEFT;
 extern const char MATRIX_BRACKET_RIGHT;
 
 
+
+
+//The following parameters control how entries are printed. Each entry is
+//   right-aligned in a field of PRINT_WIDTH characters with PRINT_DECIMALS 
+//   digits after the decimal point (PRINT_DECIMALS must be between 0 and 9).
+extern const int PRINT_WIDTH;
+extern const int PRINT_DECIMALS;
+
+
+//If PRINT_SUMMARY_THRESHOLD is positive, matrices with more entries than it
+//   are printed as a summary: only the first and last PRINT_SUMMARY_EDGE
+//   rows and columns are shown, and the rest are replaced by "...". It is 0,
+//   so every entry is printed unless matrix_print_summary is called.
+extern const int PRINT_SUMMARY_THRESHOLD;
+extern const int PRINT_SUMMARY_EDGE;
+
+
+//If PRINT_ERRORS is true, functions print a message explaining why their 
+//   input is invalid (unless an error handler is installed, see status.h).
+extern const bool PRINT_ERRORS;
@@ -0,0 +1,517 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix_core.h"
+#include "sketch.h"
+#include "instrument.h"
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+const struct sketch_options SKETCH_DEFAULTS = {SKETCH_SPARSE_SIGN, 10, 0, 1};
+
+//Each row of a sparse sign test matrix has min(l, SPARSE_SIGNS) entries.
+static const int SPARSE_SIGNS = 8;
+
+//The rank estimate starts with sketches for this rank.
+static const int FIRST_RANK = 8;
+
+//A struct sketch holds the work of one sketch of an m x n matrix with l
+//   columns. Q (m x l) and Z (n x l) are stored by rows, with room for l
+//   entries per row; the first r columns of Q are orthonormal once the
+//   sketch is made. J (r x r, by rows), sigma and order hold the singular
+//   value decomposition of the sketch, and signs the positions (from 1,
+//   negated for -1) of the entries of a sparse sign test matrix.
+struct sketch {
+  int m;
+  int n;
+  int l;
+  int r;
+  long double *Q;
+  long double *Z;
+  long double *J;
+  long double *sigma;
+  int *order;
+  int *signs;
+  size_t bytes;
+};
+
+//next_random(state) returns the next number of the splitmix64 generator.
+//requires: state is not NULL
+//effects: modifies *state
+static uint64_t next_random(uint64_t * const state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//uniform(state) returns a random number in (0, 1).
+//requires: state is not NULL
+//effects: modifies *state
+static long double uniform(uint64_t * const state) {
+  return ((next_random(state) >> 11) + 0.5L) * 0x1p-53L;
+}
+
+//sketch_begin(S, m, n, l) sets up S for a sketch of an m x n matrix with l
+//   columns.
+//requires: S is not NULL, 1 <= l <= min(m, n)
+//effects: modifies *S
+//         allocates heap memory
+static void sketch_begin(struct sketch * const S, const int m, const int n,
+                         const int l) {
+  S->m = m;
+  S->n = n;
+  S->l = l;
+  S->r = 0;
+  const int signs = l < SPARSE_SIGNS ? l : SPARSE_SIGNS;
+  const size_t numbers = (size_t) (m + n + l + 1) * l + l;
+  S->bytes = numbers * sizeof(long double) +
+             ((size_t) n * signs + l) * sizeof(int);
+  S->Q = malloc(S->bytes);
+  INSTRUMENT_ALLOC(S->bytes);
+  S->Z = S->Q + (size_t) m * l;
+  S->J = S->Z + (size_t) n * l;
+  S->sigma = S->J + (size_t) l * l;
+  S->order = (int *) (S->sigma + 2 * l);
+  S->signs = S->order + l;
+}
+
+//sketch_end(S) frees the work of S.
+//requires: S is not NULL
+//effects: frees heap memory
+static void sketch_end(struct sketch * const S) {
+  INSTRUMENT_FREE(S->bytes);
+  free(S->Q);
+}
+
+//times_test(S, A, options) stores A Omega in Q, for a test matrix Omega
+//   drawn as options says. A Gaussian Omega is drawn into Z first.
+//requires: S, A, options are not NULL, A is S->m x S->n
+//effects: modifies *S
+static void times_test(struct sketch * const S, const struct matrix * const A,
+                       const struct sketch_options * const options) {
+  const int l = S->l;
+  const int n = S->n;
+  uint64_t state = options->seed;
+  long double *sum = S->sigma + l;
+  if (options->kind == SKETCH_GAUSSIAN) {
+    const long double two_pi = 6.283185307179586476925286766559L;
+    for (size_t t = 0; t < (size_t) n * l; t++) {
+      S->Z[t] = sqrtl(-2 * logl(uniform(&state))) *
+                cosl(two_pi * uniform(&state));
+    }
+    for (int i = 0; i < S->m; i++) {
+      const long double *row = matrix_row_cdata(A, i + 1);
+      memset(sum, 0, l * sizeof(long double));
+      for (int j = 0; j < n; j++) {
+        if (row[j] != 0) {
+          const long double *omega = S->Z + (size_t) j * l;
+          for (int c = 0; c < l; c++) {
+            sum[c] += row[j] * omega[c];
+          }
+        }
+      }
+      memcpy(S->Q + (size_t) i * l, sum, l * sizeof(long double));
+    }
+    INSTRUMENT_FLOPS(2LL * S->m * n * l);
+    return;
+  }
+  //each row of Omega gets its entries in distinct columns, by a partial
+  //   shuffle of the column numbers kept in order
+  const int signs = l < SPARSE_SIGNS ? l : SPARSE_SIGNS;
+  int *pick = S->order;
+  for (int c = 0; c < l; c++) {
+    pick[c] = c;
+  }
+  for (int j = 0; j < n; j++) {
+    for (int t = 0; t < signs; t++) {
+      const uint64_t random = next_random(&state);
+      const int u = t + (int) ((random >> 1) % (uint64_t) (l - t));
+      const int swap = pick[t];
+      pick[t] = pick[u];
+      pick[u] = swap;
+      S->signs[(size_t) j * signs + t] = random & 1 ? pick[t] + 1 :
+                                         -(pick[t] + 1);
+    }
+  }
+  for (int i = 0; i < S->m; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    memset(sum, 0, l * sizeof(long double));
+    for (int j = 0; j < n; j++) {
+      if (row[j] != 0) {
+        const int *position = S->signs + (size_t) j * signs;
+        for (int t = 0; t < signs; t++) {
+          if (position[t] > 0) {
+            sum[position[t] - 1] += row[j];
+          } else {
+            sum[-position[t] - 1] -= row[j];
+          }
+        }
+      }
+    }
+    memcpy(S->Q + (size_t) i * l, sum, l * sizeof(long double));
+  }
+  INSTRUMENT_FLOPS((long long) S->m * n * signs);
+}
+
+//times_transpose(S, A) stores A^T Q in Z, for the first S->r columns.
+//requires: S, A are not NULL, A is S->m x S->n
+//effects: modifies *S
+static void times_transpose(struct sketch * const S,
+                            const struct matrix * const A) {
+  const int l = S->l;
+  const int r = S->r;
+  for (int j = 0; j < S->n; j++) {
+    memset(S->Z + (size_t) j * l, 0, r * sizeof(long double));
+  }
+  for (int i = 0; i < S->m; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    const long double *q = S->Q + (size_t) i * l;
+    for (int j = 0; j < S->n; j++) {
+      if (row[j] != 0) {
+        long double *z = S->Z + (size_t) j * l;
+        for (int c = 0; c < r; c++) {
+          z[c] += row[j] * q[c];
+        }
+      }
+    }
+  }
+  INSTRUMENT_FLOPS(2LL * S->m * S->n * r);
+}
+
+//times(S, A) stores A Z in Q, for the first S->r columns.
+//requires: S, A are not NULL, A is S->m x S->n
+//effects: modifies *S
+static void times(struct sketch * const S, const struct matrix * const A) {
+  const int l = S->l;
+  const int r = S->r;
+  long double *sum = S->sigma + l;
+  for (int i = 0; i < S->m; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    memset(sum, 0, r * sizeof(long double));
+    for (int j = 0; j < S->n; j++) {
+      if (row[j] != 0) {
+        const long double *z = S->Z + (size_t) j * l;
+        for (int c = 0; c < r; c++) {
+          sum[c] += row[j] * z[c];
+        }
+      }
+    }
+    memcpy(S->Q + (size_t) i * l, sum, r * sizeof(long double));
+  }
+  INSTRUMENT_FLOPS(2LL * S->m * S->n * r);
+}
+
+//orthonormalize(X, rows, l, count) makes the first count columns of the
+//   rows x l matrix X (stored by rows) orthonormal by two passes of modified
+//   Gram-Schmidt, dropping the columns that are (numerically) in the span
+//   of those before them, and returns how many are left, which then come
+//   first.
+//requires: X is not NULL, count <= l
+//effects: modifies X
+static int orthonormalize(long double * const X, const int rows, const int l,
+                          const int count) {
+  long double largest = 0;
+  for (int c = 0; c < count; c++) {
+    long double sum = 0;
+    for (int i = 0; i < rows; i++) {
+      sum += X[(size_t) i * l + c] * X[(size_t) i * l + c];
+    }
+    largest = fmaxl(largest, sqrtl(sum));
+  }
+  int kept = 0;
+  for (int c = 0; c < count; c++) {
+    long double before = 0;
+    for (int i = 0; i < rows; i++) {
+      const long double x = X[(size_t) i * l + c];
+      X[(size_t) i * l + kept] = x;
+      before += x * x;
+    }
+    before = sqrtl(before);
+    for (int pass = 0; pass < 2; pass++) {
+      for (int d = 0; d < kept; d++) {
+        long double h = 0;
+        for (int i = 0; i < rows; i++) {
+          h += X[(size_t) i * l + d] * X[(size_t) i * l + kept];
+        }
+        for (int i = 0; i < rows; i++) {
+          X[(size_t) i * l + kept] -= h * X[(size_t) i * l + d];
+        }
+      }
+    }
+    long double after = 0;
+    for (int i = 0; i < rows; i++) {
+      after += X[(size_t) i * l + kept] * X[(size_t) i * l + kept];
+    }
+    after = sqrtl(after);
+    if ((after > 1e-8L * before) && (after > 64 * LDBL_EPSILON * largest)) {
+      for (int i = 0; i < rows; i++) {
+        X[(size_t) i * l + kept] /= after;
+      }
+      kept++;
+    }
+  }
+  INSTRUMENT_FLOPS(8LL * rows * count * count);
+  return kept;
+}
+
+//sketch_make(S, A, options) makes the first S->r columns of Q an
+//   orthonormal basis of the sketch of A, after the power iterations.
+//requires: S, A, options are not NULL, A is S->m x S->n
+//effects: modifies *S
+static void sketch_make(struct sketch * const S, const struct matrix * const A,
+                        const struct sketch_options * const options) {
+  times_test(S, A, options);
+  S->r = orthonormalize(S->Q, S->m, S->l, S->l);
+  for (int q = 0; (q < options->power_iterations) && (S->r > 0); q++) {
+    times_transpose(S, A);
+    S->r = orthonormalize(S->Z, S->n, S->l, S->r);
+    times(S, A);
+    S->r = orthonormalize(S->Q, S->m, S->l, S->r);
+  }
+}
+
+//sketch_decompose(S, A) finds the singular value decomposition of
+//   B = Q^T A (the first S->r columns of Q), A projected on the sketch: the
+//   columns of Z = B^T are rotated until they are orthogonal (one-sided
+//   Jacobi), so that B^T J = Z has columns of length sigma. S->order lists
+//   the columns by decreasing sigma.
+//requires: S, A are not NULL, sketch_make(S, A, options) was called
+//effects: modifies *S
+static void sketch_decompose(struct sketch * const S,
+                             const struct matrix * const A) {
+  const int l = S->l;
+  const int r = S->r;
+  const int n = S->n;
+  long double *Z = S->Z;
+  times_transpose(S, A);
+  for (int p = 0; p < r; p++) {
+    for (int q = 0; q < r; q++) {
+      S->J[p * r + q] = p == q;
+    }
+  }
+  for (int sweep = 0; sweep < 64; sweep++) {
+    bool rotated = false;
+    for (int p = 0; p < r; p++) {
+      for (int q = p + 1; q < r; q++) {
+        long double alpha = 0;
+        long double beta = 0;
+        long double gamma = 0;
+        for (int j = 0; j < n; j++) {
+          const long double zp = Z[(size_t) j * l + p];
+          const long double zq = Z[(size_t) j * l + q];
+          alpha += zp * zp;
+          beta += zq * zq;
+          gamma += zp * zq;
+        }
+        if (fabsl(gamma) <= LDBL_EPSILON * sqrtl(alpha * beta)) {
+          continue;
+        }
+        rotated = true;
+        //the rotation that makes columns p and q orthogonal
+        const long double zeta = (beta - alpha) / (2 * gamma);
+        const long double t = (zeta < 0 ? -1 : 1) /
+                              (fabsl(zeta) + sqrtl(1 + zeta * zeta));
+        const long double cs = 1 / sqrtl(1 + t * t);
+        const long double sn = cs * t;
+        for (int j = 0; j < n; j++) {
+          const long double zp = Z[(size_t) j * l + p];
+          const long double zq = Z[(size_t) j * l + q];
+          Z[(size_t) j * l + p] = cs * zp - sn * zq;
+          Z[(size_t) j * l + q] = sn * zp + cs * zq;
+        }
+        for (int a = 0; a < r; a++) {
+          const long double jp = S->J[a * r + p];
+          const long double jq = S->J[a * r + q];
+          S->J[a * r + p] = cs * jp - sn * jq;
+          S->J[a * r + q] = sn * jp + cs * jq;
+        }
+        INSTRUMENT_FLOPS(12LL * n + 6LL * r);
+      }
+    }
+    if (!rotated) {
+      break;
+    }
+  }
+  for (int c = 0; c < r; c++) {
+    long double sum = 0;
+    for (int j = 0; j < n; j++) {
+      sum += Z[(size_t) j * l + c] * Z[(size_t) j * l + c];
+    }
+    S->sigma[c] = sqrtl(sum);
+  }
+  for (int p = 0; p < r; p++) {
+    int q = p;
+    while ((q > 0) && (S->sigma[S->order[q - 1]] < S->sigma[p])) {
+      S->order[q] = S->order[q - 1];
+      q--;
+    }
+    S->order[q] = p;
+  }
+}
+
+//sketch_check(A, options, function) reports (on behalf of function) why A
+//   or options cannot be sketched, or returns LINALG_OK.
+//requires: A, options are not NULL
+//effects: may print output
+static enum linalg_status sketch_check(const struct matrix * const A,
+                                       const struct sketch_options * const options,
+                                       const char * const function) {
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  if ((m == 0) || (n == 0)) {
+    return linalg_report(LINALG_ERR_EMPTY, function,
+                         "The input matrix must not be empty.");
+  } else if ((options->oversampling < 0) || (options->power_iterations < 0)) {
+    return linalg_report(LINALG_ERR_INVALID, function,
+                         "The oversampling and the number of power "
+                         "iterations must not be negative.");
+  }
+  return LINALG_OK;
+}
+
+//sketch_columns(k, oversampling, m, n) returns k + oversampling, but at
+//   most min(m, n).
+static int sketch_columns(const int k, const int oversampling, const int m,
+                          const int n) {
+  const int most = m < n ? m : n;
+  return k > most - oversampling ? most : k + oversampling;
+}
+
+struct matrix *sketch_range(const struct matrix * const A, const int k,
+                            const struct sketch_options * const options) {
+  INSTRUMENT_SCOPE(sketch_range);
+  assert(A);
+  const struct sketch_options *opt = options ? options : &SKETCH_DEFAULTS;
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if (sketch_check(A, opt, __func__) != LINALG_OK) {
+    return NULL;
+  } else if (k < 1) {
+    linalg_report(LINALG_ERR_INVALID, __func__, "k must be positive.");
+    return NULL;
+  }
+  struct sketch S;
+  sketch_begin(&S, m, n, sketch_columns(k, opt->oversampling, m, n));
+  sketch_make(&S, A, opt);
+  //a zero matrix keeps one (arbitrary) basis vector
+  struct matrix *Q = matrix_create_zero(m, S.r > 0 ? S.r : 1);
+  if (S.r == 0) {
+    matrix_row_data(Q, 1)[0] = 1;
+  }
+  for (int i = 0; i < m; i++) {
+    memcpy(matrix_row_data(Q, i + 1), S.Q + (size_t) i * S.l,
+           S.r * sizeof(long double));
+  }
+  sketch_end(&S);
+  return Q;
+}
+
+enum linalg_status sketch_svd(const struct matrix * const A, const int k,
+                              const struct sketch_options * const options,
+                              struct matrix ** const U, long double sigma[],
+                              struct matrix ** const V) {
+  INSTRUMENT_SCOPE(sketch_svd);
+  assert(A);
+  assert(sigma);
+  const struct sketch_options *opt = options ? options : &SKETCH_DEFAULTS;
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if (U) {
+    *U = NULL;
+  }
+  if (V) {
+    *V = NULL;
+  }
+  const enum linalg_status status = sketch_check(A, opt, __func__);
+  if (status != LINALG_OK) {
+    return status;
+  } else if ((k < 1) || (k > m) || (k > n)) {
+    return linalg_report(LINALG_ERR_INVALID, __func__,
+                         "k must be between 1 and %d.", m < n ? m : n);
+  }
+  struct sketch S;
+  sketch_begin(&S, m, n, sketch_columns(k, opt->oversampling, m, n));
+  sketch_make(&S, A, opt);
+  sketch_decompose(&S, A);
+  const int found = S.r < k ? S.r : k;
+  for (int c = 0; c < k; c++) {
+    sigma[c] = c < found ? S.sigma[S.order[c]] : 0;
+  }
+  if (U) {
+    //U = QJ
+    *U = matrix_create_zero(m, k);
+    for (int i = 0; i < m; i++) {
+      const long double *q = S.Q + (size_t) i * S.l;
+      long double *u = matrix_row_data(*U, i + 1);
+      for (int c = 0; c < found; c++) {
+        long double sum = 0;
+        for (int a = 0; a < S.r; a++) {
+          sum += q[a] * S.J[a * S.r + S.order[c]];
+        }
+        u[c] = sum;
+      }
+    }
+    INSTRUMENT_FLOPS(2LL * m * S.r * found);
+  }
+  if (V) {
+    *V = matrix_create_zero(n, k);
+    for (int j = 0; j < n; j++) {
+      const long double *z = S.Z + (size_t) j * S.l;
+      long double *v = matrix_row_data(*V, j + 1);
+      for (int c = 0; c < found; c++) {
+        const int index = S.order[c];
+        v[c] = S.sigma[index] > 0 ? z[index] / S.sigma[index] : 0;
+      }
+    }
+  }
+  sketch_end(&S);
+  return LINALG_OK;
+}
+
+enum linalg_status sketch_rank(const struct matrix * const A,
+                               const long double tolerance,
+                               const struct sketch_options * const options,
+                               int * const rank) {
+  INSTRUMENT_SCOPE(sketch_rank);
+  assert(A);
+  assert(rank);
+  const struct sketch_options *opt = options ? options : &SKETCH_DEFAULTS;
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  const enum linalg_status status = sketch_check(A, opt, __func__);
+  if (status != LINALG_OK) {
+    return status;
+  } else if (tolerance < 0) {
+    return linalg_report(LINALG_ERR_INVALID, __func__,
+                         "The tolerance must not be negative.");
+  }
+  const long double relative = tolerance == 0 ? PRECISION : tolerance;
+  const int most = m < n ? m : n;
+  for (int k = FIRST_RANK; ; k *= 2) {
+    struct sketch S;
+    sketch_begin(&S, m, n, sketch_columns(k, opt->oversampling, m, n));
+    sketch_make(&S, A, opt);
+    sketch_decompose(&S, A);
+    int count = 0;
+    while ((count < S.r) &&
+           (S.sigma[S.order[count]] > relative * S.sigma[S.order[0]])) {
+      count++;
+    }
+    const int l = S.l;
+    sketch_end(&S);
+    if ((count < l) || (l == most)) {
+      *rank = count;
+      return LINALG_OK;
+    }
+  }
+}
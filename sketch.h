@@ -0,0 +1,89 @@
+#ifndef LINALG_SKETCH_H
+#define LINALG_SKETCH_H
+
+#include <stdint.h>
+#include "status.h"
+
+//The functions in this file look at a large m x n matrix A through a sketch
+//   Y = A Omega, where Omega is a random n x l test matrix with l = k +
+//   options->oversampling columns, a little more than the rank k of
+//   interest. The columns of Y almost surely span the dominant part of the
+//   range of A, so one pass over A answers rank and low-rank questions that
+//   RREF or an eigendecomposition would answer in O(mn min(m, n)):
+//     sketch_range  an orthonormal basis of the sketched range
+//     sketch_svd    the k largest singular values and vectors
+//     sketch_rank   the numerical rank
+//   A sparse sign test matrix has a few entries of +1 or -1 in each row, so
+//   the sketch costs O(mn log l); a Gaussian one costs O(mnl), but its
+//   error bounds are the sharpest. Each power iteration multiplies the
+//   sketch by A A^T once more, which sharpens the result for singular values
+//   that decay slowly at a cost of O(mnl). Sketches are reproducible: the
+//   same seed gives the same test matrix.
+
+struct matrix;
+
+//An enum sketch_kind selects the random test matrix.
+enum sketch_kind {
+  SKETCH_SPARSE_SIGN,
+  SKETCH_GAUSSIAN
+};
+
+//A struct sketch_options controls a sketch: the kind of test matrix, how
+//   many columns it has beyond the rank of interest, how many power
+//   iterations refine it and the seed of its random numbers.
+struct sketch_options {
+  enum sketch_kind kind;
+  int oversampling;
+  int power_iterations;
+  uint64_t seed;
+};
+
+//SKETCH_DEFAULTS is used when no options are given: a sparse sign test
+//   matrix, 10 extra columns, no power iterations and a seed of 1.
+extern const struct sketch_options SKETCH_DEFAULTS;
+
+//sketch_range(A, k, options) returns an m x r matrix with orthonormal
+//   columns whose span contains most of the range of A, where r is at most k
+//   plus the oversampling (less if the sketch has lower rank). The caller
+//   must free it with matrix_destroy(). If A is empty, k is not positive or
+//   the options are negative, it outputs an error message and returns NULL.
+//requires: A is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct matrix *sketch_range(const struct matrix * const A, const int k,
+                            const struct sketch_options * const options);
+
+//sketch_svd(A, k, options, U, sigma, V) approximates the k largest singular
+//   values of A, stored in decreasing order in sigma, and if U and V are not
+//   NULL, sets *U (m x k) and *V (n x k) to heap-allocated matrices of the
+//   matching left and right singular vectors, so A is close to U S V^T with
+//   S the diagonal matrix of sigma. The caller must free them with
+//   matrix_destroy(). Singular values beyond the rank of the sketch are 0.
+//   It returns LINALG_OK, or reports LINALG_ERR_EMPTY for an empty A and
+//   LINALG_ERR_INVALID if k is not between 1 and min(m, n) or the options
+//   are negative, and sets *U and *V to NULL.
+//requires: A, sigma are not NULL, sigma has room for k numbers
+//effects: modifies sigma, *U and *V
+//         may print output
+//         may allocate heap memory
+enum linalg_status sketch_svd(const struct matrix * const A, const int k,
+                              const struct sketch_options * const options,
+                              struct matrix ** const U, long double sigma[],
+                              struct matrix ** const V);
+
+//sketch_rank(A, tolerance, options, rank) stores in *rank the number of
+//   singular values of A above tolerance times the largest (PRECISION times
+//   the largest if tolerance is 0), estimated from sketches of 8 +
+//   oversampling columns, then twice as many until the rank is below the
+//   size of the sketch. It returns LINALG_OK, or reports LINALG_ERR_EMPTY for
+//   an empty A and LINALG_ERR_INVALID for a negative tolerance or option.
+//requires: A, rank are not NULL
+//effects: modifies *rank
+//         may print output
+//         allocates and frees heap memory
+enum linalg_status sketch_rank(const struct matrix * const A,
+                               const long double tolerance,
+                               const struct sketch_options * const options,
+                               int * const rank);
+
+#endif
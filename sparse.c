@@ -0,0 +1,412 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "krylov.h"
+#include "sparse.h"
+#include "instrument.h"
+#include "status.h"
+
+//See header file for documentation
+
+//The entries of row i are value[start[i]] to value[start[i + 1] - 1], in
+//   increasing order of their columns col[] (numbered from 0), with no column
+//   repeated.
+struct sparse_matrix {
+  int m;
+  int n;
+  int *start;
+  int *col;
+  long double *value;
+};
+
+//A Jacobi preconditioner only has value, the inverse of the diagonal. An
+//   ILU(0) preconditioner has the pattern of its matrix, with L below the
+//   diagonal (its unit diagonal is not stored) and U on and above it, and
+//   diag[i], the index of the diagonal entry of row i. bytes is the heap
+//   memory it holds.
+struct preconditioner {
+  int n;
+  long long bytes;
+  int *start;
+  int *col;
+  int *diag;
+  long double *value;
+};
+
+//sparse_alloc(m, n, nnz) returns an m by n sparse matrix with room for nnz
+//   entries and an uninitialized pattern.
+//requires: m, n >= 1, nnz >= 0
+//effects: allocates heap memory
+static struct sparse_matrix *sparse_alloc(const int m, const int n,
+                                          const int nnz) {
+  struct sparse_matrix *S = malloc(sizeof(struct sparse_matrix));
+  S->m = m;
+  S->n = n;
+  S->start = malloc((m + 1) * sizeof(int));
+  S->col = malloc(nnz * sizeof(int));
+  S->value = malloc(nnz * sizeof(long double));
+  INSTRUMENT_ALLOC(sizeof(struct sparse_matrix) + (m + 1) * sizeof(int) +
+                   nnz * (sizeof(int) + sizeof(long double)));
+  return S;
+}
+
+struct sparse_matrix *sparse_create(const int m, const int n, const int count,
+                                    const int rows[], const int cols[],
+                                    const long double values[]) {
+  INSTRUMENT_SCOPE(sparse_create);
+  INSTRUMENT_DIMS(m, n);
+  assert(count >= 0);
+  if ((m < 1) || (n < 1)) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. m and n must be positive.");
+    return NULL;
+  }
+  for (int k = 0; k < count; k++) {
+    if ((rows[k] < 1) || (rows[k] > m) || (cols[k] < 1) || (cols[k] > n)) {
+      linalg_report(LINALG_ERR_INDEX, __func__,
+                    "Invalid input. Entry %d is out of bound.", k + 1);
+      return NULL;
+    }
+  }
+  //bucket the triplets by row, then sort each row and merge its repeats
+  const size_t bytes = (m + 1) * sizeof(int) +
+                       count * (sizeof(int) + sizeof(long double));
+  long double *value = malloc(bytes);
+  INSTRUMENT_ALLOC(bytes);
+  int *col = (int *) (value + count);
+  int *next = col + count;
+  memset(next, 0, (m + 1) * sizeof(int));
+  for (int k = 0; k < count; k++) {
+    next[rows[k]]++;
+  }
+  for (int i = 1; i <= m; i++) {
+    next[i] += next[i - 1];
+  }
+  for (int k = 0; k < count; k++) {
+    const int slot = next[rows[k] - 1]++;
+    col[slot] = cols[k] - 1;
+    value[slot] = values[k];
+  }
+  //next[i] is now the end of row i, which is the start of row i + 1
+  int nnz = 0;
+  int begin = 0;
+  for (int i = 0; i < m; i++) {
+    const int end = next[i];
+    for (int k = begin + 1; k < end; k++) {
+      const int c = col[k];
+      const long double x = value[k];
+      int j = k;
+      while ((j > begin) && (col[j - 1] > c)) {
+        col[j] = col[j - 1];
+        value[j] = value[j - 1];
+        j--;
+      }
+      col[j] = c;
+      value[j] = x;
+    }
+    const int row_start = nnz;
+    for (int k = begin; k < end; k++) {
+      if ((nnz > row_start) && (col[nnz - 1] == col[k])) {
+        value[nnz - 1] += value[k];
+      } else {
+        col[nnz] = col[k];
+        value[nnz] = value[k];
+        nnz++;
+      }
+    }
+    next[i] = row_start;
+    begin = end;
+  }
+  struct sparse_matrix *S = sparse_alloc(m, n, nnz);
+  memcpy(S->start, next, m * sizeof(int));
+  S->start[m] = nnz;
+  memcpy(S->col, col, nnz * sizeof(int));
+  memcpy(S->value, value, nnz * sizeof(long double));
+  INSTRUMENT_FREE(bytes);
+  free(value);
+  return S;
+}
+
+struct sparse_matrix *sparse_from_matrix(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(sparse_from_matrix);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m == 0) || (n == 0)) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The input matrix must not be empty.");
+    return NULL;
+  }
+  int nnz = 0;
+  for (int i = 1; i <= m; i++) {
+    const long double *row = matrix_row_cdata(A, i);
+    for (int j = 0; j < n; j++) {
+      nnz += row[j] != 0;
+    }
+  }
+  struct sparse_matrix *S = sparse_alloc(m, n, nnz);
+  int k = 0;
+  for (int i = 0; i < m; i++) {
+    S->start[i] = k;
+    const long double *row = matrix_row_cdata(A, i + 1);
+    for (int j = 0; j < n; j++) {
+      if (row[j] != 0) {
+        S->col[k] = j;
+        S->value[k] = row[j];
+        k++;
+      }
+    }
+  }
+  S->start[m] = k;
+  return S;
+}
+
+struct matrix *sparse_to_matrix(const struct sparse_matrix * const S) {
+  assert(S);
+  struct matrix *A = matrix_create_zero(S->m, S->n);
+  for (int i = 0; i < S->m; i++) {
+    long double *row = matrix_row_data(A, i + 1);
+    for (int k = S->start[i]; k < S->start[i + 1]; k++) {
+      row[S->col[k]] = S->value[k];
+    }
+  }
+  return A;
+}
+
+void sparse_size(const struct sparse_matrix * const S, int * const m,
+                 int * const n) {
+  assert(S);
+  assert(m);
+  assert(n);
+  *m = S->m;
+  *n = S->n;
+}
+
+int sparse_nnz(const struct sparse_matrix * const S) {
+  assert(S);
+  return S->start[S->m];
+}
+
+//sparse_apply(data, x, y) stores Sx in y, where data is S.
+//requires: data, x, y are not NULL, x and y do not overlap
+//          x holds n and y holds m long doubles, where S is m x n
+//effects: modifies y
+static void sparse_apply(const void * const data, const long double * const x,
+                         long double * const y) {
+  const struct sparse_matrix * const S = data;
+  for (int i = 0; i < S->m; i++) {
+    long double sum = 0;
+    for (int k = S->start[i]; k < S->start[i + 1]; k++) {
+      sum += S->value[k] * x[S->col[k]];
+    }
+    y[i] = sum;
+  }
+  INSTRUMENT_FLOPS(2LL * S->start[S->m]);
+}
+
+struct vector *sparse_mult_vector(const struct sparse_matrix * const S,
+                                  const struct vector * const v1) {
+  INSTRUMENT_SCOPE(sparse_mult_vector);
+  assert(S);
+  assert(v1);
+  INSTRUMENT_DIMS(S->m, S->n);
+  if (vector_dim(v1) != S->n) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. The width of the matrix must be the "
+                  "dimension of the vector.");
+    return NULL;
+  }
+  struct vector *result = vector_create_zero(S->m);
+  sparse_apply(S, vector_cdata(v1), vector_data(result));
+  return result;
+}
+
+struct linop linop_sparse(const struct sparse_matrix * const S) {
+  assert(S);
+  assert(S->m == S->n);
+  const struct linop op = {S->n, sparse_apply, S};
+  return op;
+}
+
+void sparse_destroy(struct sparse_matrix * const S) {
+  if (S) {
+    INSTRUMENT_FREE(sizeof(struct sparse_matrix) + (S->m + 1) * sizeof(int) +
+                    S->start[S->m] * (sizeof(int) + sizeof(long double)));
+    free(S->start);
+    free(S->col);
+    free(S->value);
+    free(S);
+  }
+}
+
+
+//square_input(S, function) returns true if S is square. Otherwise it reports
+//   the error on behalf of function and returns false.
+//requires: S is not NULL
+//effects: may print output
+static bool square_input(const struct sparse_matrix * const S,
+                         const char * const function) {
+  if (S->m != S->n) {
+    linalg_report(LINALG_ERR_NOT_SQUARE, function,
+                  "Invalid input. Matrix must be n x n.");
+    return false;
+  }
+  return true;
+}
+
+struct preconditioner *precond_jacobi(const struct sparse_matrix * const S) {
+  assert(S);
+  if (!square_input(S, __func__)) {
+    return NULL;
+  }
+  const int n = S->n;
+  struct preconditioner *M = malloc(sizeof(struct preconditioner));
+  M->n = n;
+  M->start = NULL;
+  M->col = NULL;
+  M->diag = NULL;
+  M->value = calloc(n, sizeof(long double));
+  M->bytes = sizeof(struct preconditioner) + n * sizeof(long double);
+  INSTRUMENT_ALLOC(M->bytes);
+  for (int i = 0; i < n; i++) {
+    for (int k = S->start[i]; k < S->start[i + 1]; k++) {
+      if (S->col[k] == i) {
+        M->value[i] = S->value[k];
+      }
+    }
+    if (M->value[i] == 0) {
+      precond_destroy(M);
+      linalg_report(LINALG_ERR_SINGULAR, __func__,
+                    "Diagonal entry %d is zero.", i + 1);
+      return NULL;
+    }
+    M->value[i] = 1 / M->value[i];
+  }
+  INSTRUMENT_FLOPS(n);
+  return M;
+}
+
+struct preconditioner *precond_ilu0(const struct sparse_matrix * const S) {
+  INSTRUMENT_SCOPE(precond_ilu0);
+  assert(S);
+  INSTRUMENT_DIMS(S->m, S->n);
+  if (!square_input(S, __func__)) {
+    return NULL;
+  }
+  const int n = S->n;
+  const int nnz = S->start[n];
+  struct preconditioner *M = malloc(sizeof(struct preconditioner));
+  M->n = n;
+  M->start = malloc((n + 1) * sizeof(int));
+  M->col = malloc(nnz * sizeof(int));
+  M->diag = malloc(n * sizeof(int));
+  M->value = malloc(nnz * sizeof(long double));
+  M->bytes = sizeof(struct preconditioner) + (2 * n + 1) * sizeof(int) +
+             nnz * (sizeof(int) + sizeof(long double));
+  INSTRUMENT_ALLOC(M->bytes);
+  memcpy(M->start, S->start, (n + 1) * sizeof(int));
+  memcpy(M->col, S->col, nnz * sizeof(int));
+  memcpy(M->value, S->value, nnz * sizeof(long double));
+  //pos[j] is the index of the entry in column j of the current row, or -1
+  int *pos = malloc(n * sizeof(int));
+  INSTRUMENT_ALLOC(n * sizeof(int));
+  for (int j = 0; j < n; j++) {
+    pos[j] = -1;
+  }
+  long long flops = 0;
+  bool singular = false;
+  for (int i = 0; (i < n) && !singular; i++) {
+    M->diag[i] = -1;
+    for (int k = M->start[i]; k < M->start[i + 1]; k++) {
+      pos[M->col[k]] = k;
+      if (M->col[k] == i) {
+        M->diag[i] = k;
+      }
+    }
+    if (M->diag[i] >= 0) {
+      //eliminate the entries left of the diagonal with the rows above,
+      //   dropping any update outside the pattern of row i
+      for (int k = M->start[i]; k < M->diag[i]; k++) {
+        const int c = M->col[k];
+        M->value[k] /= M->value[M->diag[c]];
+        for (int kk = M->diag[c] + 1; kk < M->start[c + 1]; kk++) {
+          if (pos[M->col[kk]] >= 0) {
+            M->value[pos[M->col[kk]]] -= M->value[k] * M->value[kk];
+            flops += 2;
+          }
+        }
+        flops++;
+      }
+    }
+    singular = (M->diag[i] < 0) || (M->value[M->diag[i]] == 0);
+    for (int k = M->start[i]; k < M->start[i + 1]; k++) {
+      pos[M->col[k]] = -1;
+    }
+    if (singular) {
+      linalg_report(LINALG_ERR_SINGULAR, __func__,
+                    "Pivot %d is zero.", i + 1);
+    }
+  }
+  INSTRUMENT_FLOPS(flops);
+  INSTRUMENT_FREE(n * sizeof(int));
+  free(pos);
+  if (singular) {
+    precond_destroy(M);
+    return NULL;
+  }
+  return M;
+}
+
+//precond_apply(data, r, z) stores M^-1 r in z, where data is M.
+//requires: data, r, z are not NULL, r and z do not overlap
+//          r and z hold n long doubles, where M is n x n
+//effects: modifies z
+static void precond_apply(const void * const data, const long double * const r,
+                          long double * const z) {
+  const struct preconditioner * const M = data;
+  const int n = M->n;
+  if (!M->start) {
+    for (int i = 0; i < n; i++) {
+      z[i] = r[i] * M->value[i];
+    }
+    INSTRUMENT_FLOPS(n);
+    return;
+  }
+  //solve Ly = r, then Uz = y, both in z
+  for (int i = 0; i < n; i++) {
+    long double sum = r[i];
+    for (int k = M->start[i]; k < M->diag[i]; k++) {
+      sum -= M->value[k] * z[M->col[k]];
+    }
+    z[i] = sum;
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    long double sum = z[i];
+    for (int k = M->diag[i] + 1; k < M->start[i + 1]; k++) {
+      sum -= M->value[k] * z[M->col[k]];
+    }
+    z[i] = sum / M->value[M->diag[i]];
+  }
+  INSTRUMENT_FLOPS(2LL * M->start[n] + n);
+}
+
+struct linop precond_linop(const struct preconditioner * const M) {
+  assert(M);
+  const struct linop op = {M->n, precond_apply, M};
+  return op;
+}
+
+void precond_destroy(struct preconditioner * const M) {
+  if (M) {
+    INSTRUMENT_FREE(M->bytes);
+    free(M->start);
+    free(M->col);
+    free(M->diag);
+    free(M->value);
+    free(M);
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef LINALG_SPARSE_H
+#define LINALG_SPARSE_H
+
+#include "krylov.h"
+
+//A struct sparse_matrix stores only the nonzero entries of a matrix, row by
+//   row (compressed sparse row form), so a product with a vector costs one
+//   multiplication per stored entry. It is built once and not modified;
+//   use it with the solvers in krylov.h through linop_sparse.
+struct sparse_matrix;
+//A struct preconditioner approximates the inverse of a sparse matrix.
+struct preconditioner;
+struct vector;
+struct matrix;
+
+//sparse_create(m, n, count, rows, cols, values) returns the m by n sparse
+//   matrix whose entry (rows[k], cols[k]) is values[k] for the first count
+//   triplets, through a heap-allocated pointer that the caller must free
+//   with sparse_destroy(). Indices start at 1, values given for the same
+//   entry are added, and zeros are stored like other values. If m or n is
+//   not positive or an index is out of range, it outputs an error message
+//   and returns NULL.
+//requires: rows, cols, values are not NULL if count > 0, count >= 0
+//effects: may print output
+//         may allocate heap memory
+struct sparse_matrix *sparse_create(const int m, const int n, const int count,
+                                    const int rows[], const int cols[],
+                                    const long double values[]);
+
+//sparse_from_matrix(A) returns the nonzero entries of A as a sparse matrix
+//   that the caller must free with sparse_destroy(). If A is empty, it
+//   outputs an error message and returns NULL.
+//requires: A is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct sparse_matrix *sparse_from_matrix(const struct matrix * const A);
+
+//sparse_to_matrix(S) returns S as a heap-allocated matrix that the caller
+//   must free with matrix_destroy().
+//requires: S is not NULL
+//effects: allocates heap memory
+struct matrix *sparse_to_matrix(const struct sparse_matrix * const S);
+
+//sparse_size(S, m, n) stores the number of rows and columns of S in *m and
+//   *n.
+//requires: S, m, n are not NULL
+//effects: modifies *m and *n
+void sparse_size(const struct sparse_matrix * const S, int * const m,
+                 int * const n);
+
+//sparse_nnz(S) returns the number of entries stored in S.
+//requires: S is not NULL
+int sparse_nnz(const struct sparse_matrix * const S);
+
+//sparse_mult_vector(S, v1) returns Sv1 through a heap-allocated vector
+//   pointer that the caller must free with vector_destroy(). If the width of
+//   S is not the dimension of v1, it outputs an error message and returns
+//   NULL.
+//requires: S, v1 are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct vector *sparse_mult_vector(const struct sparse_matrix * const S,
+                                  const struct vector * const v1);
+
+//linop_sparse(S) returns the operator x -> Sx for the solvers in krylov.h.
+//   S must stay alive while the operator is used.
+//requires: S is not NULL, S is n x n
+struct linop linop_sparse(const struct sparse_matrix * const S);
+
+//sparse_destroy(S) frees S. Passing NULL does nothing.
+//effects: frees heap memory
+void sparse_destroy(struct sparse_matrix * const S);
+
+
+//precond_jacobi(S) returns the Jacobi preconditioner of the square matrix
+//   S, which divides by the diagonal of S, through a heap-allocated pointer
+//   that the caller must free with precond_destroy(). If S is not square, or
+//   an entry of its diagonal is zero, it outputs an error message and
+//   returns NULL.
+//requires: S is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct preconditioner *precond_jacobi(const struct sparse_matrix * const S);
+
+//precond_ilu0(S) returns the incomplete LU factorization of the square
+//   matrix S with no fill-in: L and U are computed like the LU factors of S,
+//   but only keep the entries that S stores. Applying it takes two triangular
+//   solves over those entries. The caller must free the pointer with
+//   precond_destroy(). If S is not square, or a pivot is zero (which
+//   includes a missing diagonal entry), it outputs an error message and
+//   returns NULL.
+//requires: S is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct preconditioner *precond_ilu0(const struct sparse_matrix * const S);
+
+//precond_linop(M) returns the operator that applies M, for the
+//   preconditioner field of struct krylov_options. M must stay alive while
+//   the operator is used.
+//requires: M is not NULL
+struct linop precond_linop(const struct preconditioner * const M);
+
+//precond_destroy(M) frees M. Passing NULL does nothing.
+//effects: frees heap memory
+void precond_destroy(struct preconditioner * const M);
+
+#endif
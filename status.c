@@ -0,0 +1,86 @@
+#include <assert.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+static __thread struct linalg_error last_error = {LINALG_OK, NULL, ""};
+
+static linalg_error_handler handler = NULL;
+static void *handler_context = NULL;
+
+
+enum linalg_status linalg_last_status(void) {
+  return last_error.status;
+}
+
+const struct linalg_error *linalg_last_error(void) {
+  return &last_error;
+}
+
+void linalg_clear_error(void) {
+  last_error.status = LINALG_OK;
+  last_error.function = NULL;
+  last_error.message[0] = '\0';
+}
+
+const char *linalg_status_string(const enum linalg_status status) {
+  switch (status) {
+  case LINALG_OK:
+    return "success";
+  case LINALG_ERR_EMPTY:
+    return "empty input";
+  case LINALG_ERR_DIMENSION:
+    return "dimension mismatch";
+  case LINALG_ERR_INDEX:
+    return "index out of range";
+  case LINALG_ERR_NOT_SQUARE:
+    return "matrix is not square";
+  case LINALG_ERR_SINGULAR:
+    return "matrix is not invertible";
+  case LINALG_ERR_NOT_REAL:
+    return "eigenvalues are not real";
+  case LINALG_ERR_NOT_DIAGONALIZABLE:
+    return "matrix is not diagonalizable";
+  case LINALG_ERR_NOT_BASIS:
+    return "vectors do not form a basis";
+  case LINALG_ERR_INVALID:
+    return "invalid input";
+  case LINALG_ERR_NO_CONVERGENCE:
+    return "did not converge";
+  case LINALG_ERR_IO:
+    return "input/output error";
+  }
+  return "unknown status";
+}
+
+void linalg_set_error_handler(const linalg_error_handler h,
+                              void * const context) {
+  __atomic_store_n(&handler_context, context, __ATOMIC_RELAXED);
+  __atomic_store_n(&handler, h, __ATOMIC_RELEASE);
+}
+
+enum linalg_status linalg_report(const enum linalg_status status,
+                                 const char * const function,
+                                 const char * const format, ...) {
+  assert(function);
+  assert(format);
+  assert(status != LINALG_OK);
+  last_error.status = status;
+  last_error.function = function;
+  va_list args;
+  va_start(args, format);
+  vsnprintf(last_error.message, sizeof(last_error.message), format, args);
+  va_end(args);
+  const linalg_error_handler h = __atomic_load_n(&handler, __ATOMIC_ACQUIRE);
+  if (h) {
+    h(&last_error, __atomic_load_n(&handler_context, __ATOMIC_RELAXED));
+  } else if (PRINT_ERRORS) {
+    printf("%s\n", last_error.message);
+  }
+  return status;
+}
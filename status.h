@@ -0,0 +1,92 @@
+#ifndef LINALG_STATUS_H
+#define LINALG_STATUS_H
+
+#include <stdbool.h>
+
+//Functions in the toolbox report invalid input through a status code instead
+//   of printing from deep inside a calculation. Every error is recorded as
+//   the calling thread's last error, passed to the error handler if one is
+//   installed, and otherwise printed to stdout if PRINT_ERRORS is true (see
+//   settings.h). Functions keep returning their documented sentinel values
+//   (NULL or INT_MIN) as well, and the *_checked variants of the functions
+//   whose sentinels can be legitimate results return the status directly.
+
+//An enum linalg_status describes the outcome of an operation.
+enum linalg_status {
+  LINALG_OK = 0,
+  //a vector or matrix is empty, or a count is not positive
+  LINALG_ERR_EMPTY,
+  //the sizes of the inputs do not fit together
+  LINALG_ERR_DIMENSION,
+  //a row, column or element index is out of range
+  LINALG_ERR_INDEX,
+  //the matrix must be square (n x n)
+  LINALG_ERR_NOT_SQUARE,
+  //the matrix is not invertible
+  LINALG_ERR_SINGULAR,
+  //the eigenvalues are not all real
+  LINALG_ERR_NOT_REAL,
+  //the matrix is not diagonalizable
+  LINALG_ERR_NOT_DIAGONALIZABLE,
+  //the vectors are not linearly independent, do not span, or are not a basis
+  LINALG_ERR_NOT_BASIS,
+  //any other invalid input
+  LINALG_ERR_INVALID,
+  //an iterative method did not reach its tolerance
+  LINALG_ERR_NO_CONVERGENCE,
+  //a file could not be opened, read or written
+  LINALG_ERR_IO
+};
+
+//A struct linalg_error describes the most recent error of a thread.
+struct linalg_error {
+  enum linalg_status status;
+  //name of the public function the client called (a *_checked variant
+  //reports under the name of its unchecked function)
+  const char *function;
+  char message[160];
+};
+
+//A linalg_error_handler is called with every error as it is reported, along
+//   with the context pointer given to linalg_set_error_handler().
+typedef void (*linalg_error_handler)(const struct linalg_error *error,
+                                     void *context);
+
+//linalg_last_status() returns the status of the calling thread's most 
+//   recent error, or LINALG_OK if there has been none since the last call to
+//   linalg_clear_error().
+enum linalg_status linalg_last_status(void);
+
+//linalg_last_error() returns the calling thread's most recent error record.
+//   Its status is LINALG_OK if there has been no error since the last call to
+//   linalg_clear_error(). The record is overwritten by the next error.
+const struct linalg_error *linalg_last_error(void);
+
+//linalg_clear_error() resets the calling thread's last error to LINALG_OK.
+//effects: modifies the last error record
+void linalg_clear_error(void);
+
+//linalg_status_string(status) returns a short description of status.
+const char *linalg_status_string(const enum linalg_status status);
+
+//linalg_set_error_handler(handler, context) installs handler to be called
+//   with every error reported by any thread, instead of printing it. Passing
+//   NULL restores the default behaviour. 
+//effects: modifies the error handler
+void linalg_set_error_handler(const linalg_error_handler handler,
+                              void * const context);
+
+
+//The rest of this file is used by the toolbox itself.
+
+//linalg_report(status, function, format, ...) records an error with the
+//   printf-style message given by format and returns status.
+//requires: function and format are not NULL
+//          status is not LINALG_OK
+//effects: modifies the last error record
+//         may print output
+enum linalg_status linalg_report(const enum linalg_status status,
+                                 const char * const function,
+                                 const char * const format, ...);
+
+#endif
@@ -0,0 +1,90 @@
+#include <assert.h>
+#include <stdbool.h>
+#include "matrix_core.h"
+#include "matrix_cache.h"
+#include "structure.h"
+#include "instrument.h"
+
+//See header file for documentation
+
+//classify(A, n) returns the structure flags of the n x n matrix A.
+//requires: A is not NULL, A is n x n, n >= 1
+static unsigned classify(const struct matrix * const A, const int n) {
+  unsigned flags = MATRIX_DIAGONAL | MATRIX_UPPER_TRIANGULAR |
+                   MATRIX_LOWER_TRIANGULAR | MATRIX_SYMMETRIC |
+                   MATRIX_PERMUTATION | MATRIX_IDENTITY;
+  for (int i = 0; i < n && flags; i++) {
+    const long double *row = matrix_row_cdata(A, i + 1);
+    int ones = 0;
+    for (int j = 0; j < n; j++) {
+      const long double x = row[j];
+      if (x != 0) {
+        if (j > i) {
+          flags &= ~(MATRIX_DIAGONAL | MATRIX_LOWER_TRIANGULAR |
+                     MATRIX_IDENTITY);
+        } else if (j < i) {
+          flags &= ~(MATRIX_DIAGONAL | MATRIX_UPPER_TRIANGULAR |
+                     MATRIX_IDENTITY);
+        }
+        if (x == 1) {
+          ones++;
+        } else {
+          flags &= ~MATRIX_PERMUTATION;
+        }
+      }
+      if ((j == i) && (x != 1)) {
+        flags &= ~MATRIX_IDENTITY;
+      }
+      if ((j > i) && (flags & MATRIX_SYMMETRIC) &&
+          (x != matrix_row_cdata(A, j + 1)[i])) {
+        flags &= ~MATRIX_SYMMETRIC;
+      }
+    }
+    if (ones != 1) {
+      flags &= ~MATRIX_PERMUTATION;
+    }
+  }
+  //every row holds a single 1, so the columns must each hold one as well
+  for (int j = 0; j < n && (flags & MATRIX_PERMUTATION); j++) {
+    int ones = 0;
+    for (int i = 1; i <= n; i++) {
+      ones += matrix_row_cdata(A, i)[j] == 1;
+    }
+    if (ones != 1) {
+      flags &= ~MATRIX_PERMUTATION;
+    }
+  }
+  return flags;
+}
+
+unsigned matrix_structure(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(matrix_structure);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if ((m != n) || (n < 1)) {
+    return 0;
+  }
+  struct matrix_cache * const cache = matrix_cache(A);
+  if (!(cache->valid & CACHE_STRUCTURE)) {
+    cache->structure = classify(A, n);
+    cache->valid |= CACHE_STRUCTURE;
+  }
+  return cache->structure;
+}
+
+void permutation_columns(const struct matrix * const P, const int n,
+                         int * const p) {
+  assert(P);
+  assert(p);
+  for (int i = 0; i < n; i++) {
+    const long double *row = matrix_row_cdata(P, i + 1);
+    for (int j = 0; j < n; j++) {
+      if (row[j] != 0) {
+        p[i] = j;
+        break;
+      }
+    }
+  }
+}
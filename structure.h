@@ -0,0 +1,64 @@
+#ifndef LINALG_STRUCTURE_H
+#define LINALG_STRUCTURE_H
+
+//Many matrices met in practice have a special shape: the identity, diagonal
+//   and triangular matrices, symmetric matrices and permutation matrices. The
+//   toolbox classifies a square matrix once, keeps the result with the matrix
+//   (see matrix_cache.h), and uses it to pick cheaper algorithms: for example
+//   the determinant of a triangular matrix is the product of its diagonal,
+//   the inverse of a diagonal matrix holds the reciprocals of its diagonal,
+//   and multiplying by a permutation matrix only reorders rows or columns.
+//Structure is exact: an entry counts as zero only if it is exactly 0 (not
+//   within PRECISION), so the fast paths give the same results as the
+//   general algorithms.
+
+struct matrix;
+
+//Flags describing the structure of a square matrix. A matrix may have
+//   several (the identity has all of them).
+enum matrix_structure {
+  //every entry off the diagonal is 0
+  MATRIX_DIAGONAL = 1,
+  //every entry below the diagonal is 0
+  MATRIX_UPPER_TRIANGULAR = 2,
+  //every entry above the diagonal is 0
+  MATRIX_LOWER_TRIANGULAR = 4,
+  //A[ij] equals A[ji] for all i and j
+  MATRIX_SYMMETRIC = 8,
+  //every row and every column holds exactly one 1 and 0 elsewhere
+  MATRIX_PERMUTATION = 16,
+  //the identity matrix
+  MATRIX_IDENTITY = 32
+};
+
+//matrix_structure(A) returns the bitwise or of the enum matrix_structure
+//   flags that apply to A, or 0 if A is empty, not square or has none of
+//   them. The first call takes O(n^2) time; later calls on an unchanged A
+//   take O(1).
+//requires: A is not NULL
+//effects: may allocate heap memory
+unsigned matrix_structure(const struct matrix * const A);
+
+
+//The rest of this file is used by the toolbox itself.
+
+//permutation_columns(P, n, p) sets p[i] to the column (counted from 0) of the
+//   1 in row i + 1 of the n x n permutation matrix P.
+//requires: P is not NULL, matrix_structure(P) has MATRIX_PERMUTATION
+//          p holds n ints
+//effects: modifies p
+void permutation_columns(const struct matrix * const P, const int n,
+                         int * const p);
+
+//row_times_matrix(a, B, first, last, c) adds the product of the row a and B
+//   to the row c, where only the entries first to last (counted from 1) of a
+//   may be nonzero, as they are in a row of a triangular or permutation
+//   matrix.
+//requires: a, B, c are not NULL, a holds the height of B entries and c the
+//          width of B, a and c do not overlap
+//effects: modifies c
+void row_times_matrix(const long double * const a,
+                      const struct matrix * const B, const int first,
+                      const int last, long double * const c);
+
+#endif
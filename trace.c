@@ -0,0 +1,246 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trace.h"
+#include "instrument.h"
+
+//See header file for documentation
+
+#ifdef LINALG_TRACE
+
+//A struct trace_event is one begin ('B') or end ('E') event.
+struct trace_event {
+  long long ns;
+  short op;
+  char phase;
+  int rows;
+  int cols;
+};
+
+//A struct trace_ring holds the events of one thread. Only the owning thread
+//   writes events and advances head; readers copy events and then check head
+//   again to find out which ones were overwritten meanwhile.
+struct trace_ring {
+  int tid;
+  //true while a thread records into the ring; the ring of a thread that
+  //   exited is reused by the next thread that starts recording
+  bool owned;
+  unsigned long long head;
+  unsigned long long start;
+  struct trace_event events[TRACE_RING_EVENTS];
+  struct trace_ring *next;
+};
+
+//all rings ever created, pushed lock-free; rings are never freed since a
+//   dump may be reading them, but they are reused once their thread exits
+static struct trace_ring *rings = NULL;
+static int next_tid = 1;
+static bool recording = true;
+
+static __thread struct trace_ring *own_ring = NULL;
+//releases the ring of a thread when it exits
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+//now_ns() returns a monotonic time stamp in nanoseconds.
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//release_ring(ring) hands the ring of an exiting thread back for reuse.
+//effects: modifies *ring
+static void release_ring(void *ring) {
+  __atomic_store_n(&((struct trace_ring *) ring)->owned, false,
+                   __ATOMIC_RELEASE);
+}
+
+//create_ring_key() creates ring_key, once per process.
+static void create_ring_key(void) {
+  pthread_key_create(&ring_key, release_ring);
+}
+
+//ring_for_thread() returns the calling thread's ring on first use, taking
+//   over the ring of a thread that exited if there is one (its events are
+//   discarded) and creating and registering a new one otherwise.
+//effects: may allocate heap memory
+static struct trace_ring *ring_for_thread(void) {
+  if (!own_ring) {
+    pthread_once(&ring_key_once, create_ring_key);
+    const int tid = __atomic_fetch_add(&next_tid, 1, __ATOMIC_RELAXED);
+    struct trace_ring *ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+    for (; ring; ring = ring->next) {
+      bool owned = false;
+      if (__atomic_compare_exchange_n(&ring->owned, &owned, true, false,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        break;
+      }
+    }
+    if (ring) {
+      __atomic_store_n(&ring->start, ring->head, __ATOMIC_RELAXED);
+      __atomic_store_n(&ring->tid, tid, __ATOMIC_RELAXED);
+    } else {
+      ring = malloc(sizeof(struct trace_ring));
+      ring->tid = tid;
+      ring->owned = true;
+      ring->head = 0;
+      ring->start = 0;
+      ring->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+      while (!__atomic_compare_exchange_n(&rings, &ring->next, ring, true,
+                                          __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED)) {
+      }
+    }
+    pthread_setspecific(ring_key, ring);
+    own_ring = ring;
+  }
+  return own_ring;
+}
+
+//record(phase, op, rows, cols) appends one event to the calling thread's
+//   ring.
+//effects: may allocate heap memory
+static void record(const char phase, const int op, const int rows,
+                   const int cols) {
+  if (!__atomic_load_n(&recording, __ATOMIC_RELAXED)) {
+    return;
+  }
+  struct trace_ring * const ring = ring_for_thread();
+  const unsigned long long head = ring->head;
+  struct trace_event * const e = &ring->events[head % TRACE_RING_EVENTS];
+  e->ns = now_ns();
+  e->op = op;
+  e->phase = phase;
+  e->rows = rows;
+  e->cols = cols;
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void trace_begin(const int op) {
+  record('B', op, -1, -1);
+}
+
+void trace_end(const int op, const int rows, const int cols) {
+  record('E', op, rows, cols);
+}
+
+bool trace_enabled(void) {
+  return true;
+}
+
+void trace_set_recording(const bool on) {
+  __atomic_store_n(&recording, on, __ATOMIC_RELAXED);
+}
+
+void trace_clear(void) {
+  struct trace_ring *ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+  for (; ring; ring = ring->next) {
+    __atomic_store_n(&ring->start, __atomic_load_n(&ring->head,
+                                                   __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELAXED);
+  }
+}
+
+//dump_ring(ring, out, first) writes the events of *ring that are still
+//   intact to out and returns how many were written. End events whose begin
+//   event was overwritten are skipped. A comma precedes every event unless
+//   *first is true, which is then cleared.
+//effects: prints output
+//         may modify *first
+static int dump_ring(struct trace_ring * const ring, FILE * const out,
+                     bool * const first) {
+  const int tid = __atomic_load_n(&ring->tid, __ATOMIC_RELAXED);
+  const unsigned long long head = __atomic_load_n(&ring->head,
+                                                  __ATOMIC_ACQUIRE);
+  unsigned long long from = __atomic_load_n(&ring->start, __ATOMIC_RELAXED);
+  //the owner may be writing event head, whose slot is that of event
+  //   head - TRACE_RING_EVENTS
+  if (head - from >= TRACE_RING_EVENTS) {
+    from = head - TRACE_RING_EVENTS + 1;
+  }
+  const int count = head - from;
+  struct trace_event *copy = malloc((count + 1) * sizeof(struct trace_event));
+  for (int i = 0; i < count; i++) {
+    copy[i] = ring->events[(from + i) % TRACE_RING_EVENTS];
+  }
+  //events up to now - TRACE_RING_EVENTS were overwritten by the owner while
+  //   we were copying, or are being overwritten with event now
+  const unsigned long long now = __atomic_load_n(&ring->head,
+                                                 __ATOMIC_ACQUIRE);
+  int skip = 0;
+  if (now - from >= TRACE_RING_EVENTS) {
+    skip = now - from - TRACE_RING_EVENTS + 1;
+    if (skip > count) {
+      skip = count;
+    }
+  }
+  int written = 0;
+  int depth = 0;
+  for (int i = skip; i < count; i++) {
+    const struct trace_event * const e = &copy[i];
+    if (e->phase == 'E' && depth == 0) {
+      continue;
+    }
+    depth += e->phase == 'B' ? 1 : -1;
+    fprintf(out, "%s\n  {\"name\": \"%s\", \"cat\": \"linalg\", ",
+            *first ? "" : ",", instrument_op_name(e->op));
+    fprintf(out, "\"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %d",
+            e->phase, e->ns / 1000.0, tid);
+    if (e->phase == 'E' && e->rows >= 0) {
+      fprintf(out, ", \"args\": {\"rows\": %d, \"cols\": %d}", e->rows,
+              e->cols);
+    }
+    fprintf(out, "}");
+    *first = false;
+    written++;
+  }
+  free(copy);
+  return written;
+}
+
+int trace_dump(FILE * const out) {
+  assert(out);
+  fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+  bool first = true;
+  int written = 0;
+  struct trace_ring *ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+  for (; ring; ring = ring->next) {
+    const int tid = __atomic_load_n(&ring->tid, __ATOMIC_RELAXED);
+    fprintf(out, "%s\n  {\"name\": \"thread_name\", \"ph\": \"M\", ",
+            first ? "" : ",");
+    fprintf(out, "\"pid\": 1, \"tid\": %d, ", tid);
+    fprintf(out, "\"args\": {\"name\": \"linalg thread %d\"}}", tid);
+    first = false;
+    written += dump_ring(ring, out, &first);
+  }
+  fprintf(out, "\n]}\n");
+  return written;
+}
+
+#else
+
+bool trace_enabled(void) {
+  return false;
+}
+
+void trace_set_recording(const bool on) {
+  (void) on;
+}
+
+void trace_clear(void) {
+}
+
+int trace_dump(FILE * const out) {
+  assert(out);
+  fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": []}\n");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LINALG_TRACE_H
+#define LINALG_TRACE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+//The toolbox can record a timeline of its operations: every instrumented
+//   function (see instrument.h) records a begin event when it is called and
+//   an end event, carrying the dimensions of the matrix it worked on, when it
+//   returns. The timeline can be written out in the Chrome trace event format
+//   and loaded into chrome://tracing or Perfetto to see how operations nest.
+//Tracing is compiled in only when LINALG_TRACE is defined (for example with
+//   "make TRACE=1"). Otherwise nothing is recorded and trace_dump() writes an
+//   empty trace.
+//Each thread records into its own fixed-size ring buffer without locks. When
+//   a ring is full the oldest events are overwritten, so a dump shows the most
+//   recent TRACE_RING_EVENTS - 1 events of every thread (the slot of the
+//   oldest may be in the middle of being overwritten).
+//A ring takes about 1.5 MB. It is created when a thread records its first
+//   event and is handed to the next thread that starts recording after that
+//   thread exits, which discards the events left in it. Memory therefore
+//   grows with the most threads recording at the same time, not with the
+//   number of threads ever started.
+
+//number of events each thread's ring buffer holds
+#define TRACE_RING_EVENTS 65536
+
+//trace_enabled() returns true if tracing was compiled in.
+bool trace_enabled(void);
+
+//trace_set_recording(on) turns recording on or off for all threads.
+//   Recording is on by default.
+//effects: modifies the recording state
+void trace_set_recording(const bool on);
+
+//trace_clear() discards every event recorded so far.
+//effects: modifies the ring buffers
+void trace_clear(void);
+
+//trace_dump(out) writes every recorded event to out as a Chrome trace event
+//   JSON document and returns the number of events written. It may be called
+//   while other threads are recording; events they overwrite during the dump
+//   are left out.
+//requires: out is not NULL
+//effects: prints output
+int trace_dump(FILE * const out);
+
+
+//The rest of this file is used by the toolbox itself.
+
+#ifdef LINALG_TRACE
+
+//trace_begin(op) records the start of instrumented operation op on the
+//   calling thread.
+void trace_begin(const int op);
+
+//trace_end(op, rows, cols) records the end of operation op, which worked on a
+//   rows by cols matrix (negative if unknown).
+void trace_end(const int op, const int rows, const int cols);
+
+#endif
+
+#endif
@@ -0,0 +1,427 @@
+#define _POSIX_C_SOURCE 199309L
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vector_core.h"
+#include "matrix_core.h"
+#include "tsqr.h"
+#include "instrument.h"
+#include "status.h"
+#include "settings.h"
+
+//See header file for documentation
+
+//rows reduced by one set of reflections
+static const int PANEL = 64;
+
+struct tsqr {
+  int n;
+  int rank;
+  //R by rows
+  long double *r;
+  //column j holds R P above row j and the Householder vector of step j of
+  //   the pivoted factorization R P = Q2 R2 from row j down
+  long double *qr;
+  //2 / v^T v for each Householder vector v
+  long double *beta;
+  //the diagonal of R2
+  long double *rdiag;
+  //column j of R2 is column perm[j] of R
+  int *perm;
+  size_t bytes;
+};
+
+
+//absorb(R, c, panel, p) replaces the c x c upper triangular R (by rows) by
+//   the triangle of the QR factorization of R stacked on the p x c panel (by
+//   rows), using one Householder reflection per column.
+//requires: R, panel are not NULL
+//effects: modifies R and panel
+static void absorb(long double * const R, const int c,
+                   long double * const panel, const int p) {
+  for (int j = 0; j < c; j++) {
+    const long double x = R[(size_t) j * c + j];
+    long double tail = 0;
+    for (int i = 0; i < p; i++) {
+      const long double y = panel[(size_t) i * c + j];
+      tail += y * y;
+    }
+    if (tail == 0) {
+      continue;
+    }
+    const long double size = sqrtl(x * x + tail);
+    const long double alpha = x < 0 ? size : -size;
+    //the reflector is (x - alpha, panel column j)
+    const long double v0 = x - alpha;
+    const long double beta = 2 / (tail + v0 * v0);
+    for (int k = j + 1; k < c; k++) {
+      long double s = v0 * R[(size_t) j * c + k];
+      for (int i = 0; i < p; i++) {
+        s += panel[(size_t) i * c + j] * panel[(size_t) i * c + k];
+      }
+      s *= beta;
+      R[(size_t) j * c + k] -= s * v0;
+      for (int i = 0; i < p; i++) {
+        panel[(size_t) i * c + k] -= s * panel[(size_t) i * c + j];
+      }
+    }
+    R[(size_t) j * c + j] = alpha;
+  }
+}
+
+
+//A struct chunk is the share of one thread: rows first to last - 1 of A,
+//   with b as an extra column if it is not NULL. A pass that factors leaves
+//   the triangle of the share in R (c x c by rows); a pass that forms a
+//   basis writes those rows of Q through out.
+struct chunk {
+  const struct matrix *A;
+  const long double *b;
+  const struct tsqr *T;
+  long double **out;
+  long double *R;
+  int c;
+  int first;
+  int last;
+  pthread_t thread;
+  bool started;
+};
+
+//leaf(chunk) reduces the rows of chunk to a triangle a panel at a time.
+//requires: chunk is a struct chunk pointer
+//effects: modifies the triangle of chunk
+static void *leaf(void *chunk) {
+  struct chunk * const t = chunk;
+  const int c = t->c;
+  long double *panel = malloc((size_t) PANEL * c * sizeof(long double));
+  memset(t->R, 0, (size_t) c * c * sizeof(long double));
+  for (int start = t->first; start < t->last; start += PANEL) {
+    const int p = t->last - start < PANEL ? t->last - start : PANEL;
+    for (int i = 0; i < p; i++) {
+      long double *row = panel + (size_t) i * c;
+      const int n = t->b ? c - 1 : c;
+      memcpy(row, matrix_row_cdata(t->A, start + i + 1),
+             n * sizeof(long double));
+      if (t->b) {
+        row[n] = t->b[start + i];
+      }
+    }
+    absorb(t->R, c, panel, p);
+  }
+  free(panel);
+  return NULL;
+}
+
+//orthonormalize(chunk) solves q R2 = (a P) restricted to the first rank
+//   columns for each row a of chunk, and writes q through out.
+//requires: chunk is a struct chunk pointer
+//effects: modifies the rows of out in chunk
+static void *orthonormalize(void *chunk) {
+  const struct chunk * const t = chunk;
+  const struct tsqr * const T = t->T;
+  const int n = T->n;
+  for (int l = t->first; l < t->last; l++) {
+    const long double *a = matrix_row_cdata(t->A, l + 1);
+    long double *q = t->out[l];
+    for (int j = 0; j < T->rank; j++) {
+      long double sum = a[T->perm[j]];
+      for (int i = 0; i < j; i++) {
+        sum -= q[i] * T->qr[(size_t) j * n + i];
+      }
+      q[j] = sum / T->rdiag[j];
+    }
+  }
+  return NULL;
+}
+
+//share(m, work) returns how many threads a pass over m rows that takes work
+//   multiply-adds is split among.
+static int share(const int m, const long long work) {
+  int threads = MAX_THREADS < m / PANEL ? MAX_THREADS : m / PANEL;
+  if ((work < THREAD_WORK) || (threads < 1)) {
+    threads = 1;
+  }
+  return threads;
+}
+
+//run(task, threads, pass) runs pass on each of the threads tasks, the first
+//   and any whose thread could not be started on the calling thread.
+//requires: task is not NULL and holds threads chunks
+//effects: modifies the chunks of task
+static void run(struct chunk * const task, const int threads,
+                void *(*pass)(void *)) {
+  for (int t = 1; t < threads; t++) {
+    task[t].started =
+      pthread_create(&task[t].thread, NULL, pass, &task[t]) == 0;
+  }
+  pass(&task[0]);
+  for (int t = 1; t < threads; t++) {
+    if (task[t].started) {
+      pthread_join(task[t].thread, NULL);
+    } else {
+      pass(&task[t]);
+    }
+  }
+}
+
+//reduce(A, b) returns the heap-allocated c x c triangle (by rows) of [A b],
+//   where c is the number of columns of A, plus 1 if b is not NULL.
+//requires: A is not NULL and not empty, b is NULL or has a number per row
+//effects: allocates heap memory
+static long double *reduce(const struct matrix * const A,
+                           const long double * const b) {
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  const int c = b ? n + 1 : n;
+  const int threads = share(m, (long long) m * c * c);
+  struct chunk *task = malloc(threads * sizeof(struct chunk));
+  long double *R = malloc((size_t) threads * c * c * sizeof(long double));
+  for (int t = 0; t < threads; t++) {
+    task[t].A = A;
+    task[t].b = b;
+    task[t].R = R + (size_t) t * c * c;
+    task[t].c = c;
+    task[t].first = (int) ((long long) m * t / threads);
+    task[t].last = (int) ((long long) m * (t + 1) / threads);
+    task[t].started = false;
+  }
+  run(task, threads, leaf);
+  //the triangles are combined pairwise, so rounding errors grow with the
+  //   depth of the tree rather than the number of threads
+  for (int step = 1; step < threads; step *= 2) {
+    for (int t = 0; t + step < threads; t += 2 * step) {
+      absorb(task[t].R, c, task[t + step].R, c);
+    }
+  }
+  INSTRUMENT_FLOPS(2LL * m * c * c + 2LL * threads * c * c * c);
+  free(task);
+  //the first triangle holds the result
+  return R;
+}
+
+//make(R, c, n) returns the factorization of the top left n x n part of the
+//   c x c triangle R (by rows).
+//requires: R is not NULL, 0 < n <= c
+//effects: allocates heap memory
+static struct tsqr *make(const long double * const R, const int c,
+                         const int n) {
+  struct tsqr *T = malloc(sizeof(struct tsqr));
+  T->n = n;
+  T->bytes = sizeof(struct tsqr) +
+             ((size_t) 2 * n * n + 2 * n) * sizeof(long double) +
+             n * sizeof(int);
+  T->r = malloc(((size_t) 2 * n * n + 2 * n) * sizeof(long double));
+  T->perm = malloc(n * sizeof(int));
+  INSTRUMENT_ALLOC(T->bytes);
+  T->qr = T->r + (size_t) n * n;
+  T->beta = T->qr + (size_t) n * n;
+  T->rdiag = T->beta + n;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      T->r[(size_t) i * n + j] = R[(size_t) i * c + j];
+      T->qr[(size_t) j * n + i] = R[(size_t) i * c + j];
+    }
+    T->perm[i] = i;
+  }
+  //Householder QR with column pivoting, largest remaining column first
+  T->rank = n;
+  for (int j = 0; j < n; j++) {
+    int best = j;
+    long double most = -1;
+    for (int k = j; k < n; k++) {
+      const long double *a = T->qr + (size_t) k * n;
+      long double sum = 0;
+      for (int i = j; i < n; i++) {
+        sum += a[i] * a[i];
+      }
+      if (sum > most) {
+        most = sum;
+        best = k;
+      }
+    }
+    if (best != j) {
+      for (int i = 0; i < n; i++) {
+        const long double temp = T->qr[(size_t) j * n + i];
+        T->qr[(size_t) j * n + i] = T->qr[(size_t) best * n + i];
+        T->qr[(size_t) best * n + i] = temp;
+      }
+      const int temp = T->perm[j];
+      T->perm[j] = T->perm[best];
+      T->perm[best] = temp;
+    }
+    long double *v = T->qr + (size_t) j * n;
+    const long double size = sqrtl(most);
+    if ((T->rank == n) &&
+        !(size > PRECISION * (j ? fabsl(T->rdiag[0]) : 0))) {
+      T->rank = j;
+    }
+    if (size == 0) {
+      T->beta[j] = 0;
+      T->rdiag[j] = 0;
+      continue;
+    }
+    const long double alpha = v[j] < 0 ? size : -size;
+    v[j] -= alpha;
+    T->beta[j] = 1 / (size * (size + fabsl(v[j] + alpha)));
+    T->rdiag[j] = alpha;
+    for (int k = j + 1; k < n; k++) {
+      long double *a = T->qr + (size_t) k * n;
+      long double s = 0;
+      for (int i = j; i < n; i++) {
+        s += v[i] * a[i];
+      }
+      s *= T->beta[j];
+      for (int i = j; i < n; i++) {
+        a[i] -= s * v[i];
+      }
+    }
+  }
+  INSTRUMENT_FLOPS(2LL * n * n * n);
+  return T;
+}
+
+struct tsqr *tsqr_factor(const struct matrix * const A) {
+  INSTRUMENT_SCOPE(tsqr_factor);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if (m == 0 || n == 0) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. Matrix is empty.");
+    return NULL;
+  }
+  long double *R = reduce(A, NULL);
+  struct tsqr *T = make(R, n, n);
+  free(R);
+  return T;
+}
+
+struct matrix *tsqr_r(const struct tsqr * const T) {
+  assert(T);
+  const int n = T->n;
+  struct matrix *R = matrix_create_zero(n, n);
+  for (int i = 0; i < n; i++) {
+    memcpy(matrix_row_data(R, i + 1), T->r + (size_t) i * n,
+           n * sizeof(long double));
+  }
+  return R;
+}
+
+int tsqr_rank(const struct tsqr * const T) {
+  assert(T);
+  return T->rank;
+}
+
+struct matrix *tsqr_basis(const struct tsqr * const T,
+                          const struct matrix * const A) {
+  INSTRUMENT_SCOPE(tsqr_basis);
+  assert(T);
+  assert(A);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if (n != T->n) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. A must have %d columns.", T->n);
+    return NULL;
+  }
+  if (T->rank == 0) {
+    return matrix_create();
+  }
+  struct matrix *Q = matrix_create_zero(m, T->rank);
+  //the rows are fetched here, since matrix_row_data marks Q as modified
+  long double **out = malloc(m * sizeof(long double *));
+  for (int l = 0; l < m; l++) {
+    out[l] = matrix_row_data(Q, l + 1);
+  }
+  const int threads = share(m, (long long) m * T->rank * T->rank);
+  struct chunk *task = malloc(threads * sizeof(struct chunk));
+  for (int t = 0; t < threads; t++) {
+    task[t].A = A;
+    task[t].T = T;
+    task[t].out = out;
+    task[t].first = (int) ((long long) m * t / threads);
+    task[t].last = (int) ((long long) m * (t + 1) / threads);
+    task[t].started = false;
+  }
+  run(task, threads, orthonormalize);
+  INSTRUMENT_FLOPS((long long) m * T->rank * T->rank);
+  free(task);
+  free(out);
+  return Q;
+}
+
+struct vector *tsqr_least_squares(const struct matrix * const A,
+                                  const struct vector * const b,
+                                  long double * const residual) {
+  INSTRUMENT_SCOPE(tsqr_least_squares);
+  assert(A);
+  assert(b);
+  int m, n = 0;
+  matrix_size(A, &m, &n);
+  INSTRUMENT_DIMS(m, n);
+  if (m == 0 || n == 0) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. Matrix is empty.");
+    return NULL;
+  }
+  if (vector_dim(b) != m) {
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. b must be in R[%d].", m);
+    return NULL;
+  }
+  //the triangle of [A b] is [R c; 0 rho], and Ax - b has length
+  //   sqrt(|Rx - c|^2 + rho^2)
+  long double *R = reduce(A, vector_cdata(b));
+  struct tsqr *T = make(R, n + 1, n);
+  long double *z = malloc(n * sizeof(long double));
+  for (int i = 0; i < n; i++) {
+    z[i] = R[(size_t) i * (n + 1) + n];
+  }
+  const long double rho = R[(size_t) n * (n + 1) + n];
+  free(R);
+  //z = Q2^T c, then R2 y = z on the independent columns
+  for (int j = 0; j < n; j++) {
+    const long double *v = T->qr + (size_t) j * n;
+    long double s = 0;
+    for (int i = j; i < n; i++) {
+      s += v[i] * z[i];
+    }
+    s *= T->beta[j];
+    for (int i = j; i < n; i++) {
+      z[i] -= s * v[i];
+    }
+  }
+  struct vector *x = vector_create_zero(n);
+  long double *y = vector_data(x);
+  for (int j = T->rank - 1; j >= 0; j--) {
+    long double sum = z[j];
+    for (int k = j + 1; k < T->rank; k++) {
+      sum -= T->qr[(size_t) k * n + j] * y[T->perm[k]];
+    }
+    y[T->perm[j]] = sum / T->rdiag[j];
+  }
+  if (residual) {
+    long double sum = rho * rho;
+    for (int j = T->rank; j < n; j++) {
+      sum += z[j] * z[j];
+    }
+    *residual = sqrtl(sum);
+  }
+  free(z);
+  tsqr_destroy(T);
+  return x;
+}
+
+void tsqr_destroy(struct tsqr * const T) {
+  if (T) {
+    INSTRUMENT_FREE(T->bytes);
+    free(T->r);
+    free(T->perm);
+    free(T);
+  }
+}
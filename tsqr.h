@@ -0,0 +1,70 @@
+#ifndef LINALG_TSQR_H
+#define LINALG_TSQR_H
+
+//A struct tsqr is the R factor of a tall m x n matrix A = QR, found by
+//   tall-skinny QR (TSQR): the rows of A are split among up to MAX_THREADS
+//   threads (see settings.h), each thread reduces its rows to an n x n
+//   triangle by Householder reflections on panels of 64 rows, and the
+//   triangles are combined pairwise in a binary tree. A is read once, Q is
+//   never formed, and each thread needs O(n^2) memory, so m can be in the
+//   millions. The rank is found from a QR factorization with column
+//   pivoting of R, which costs O(n^3), and a column is dependent when its
+//   pivot is at most PRECISION times the first.
+
+struct tsqr;
+struct matrix;
+struct vector;
+
+//tsqr_factor(A) returns the TSQR factorization of A through a heap-allocated
+//   pointer that the caller must free with tsqr_destroy(). If A is empty, it
+//   outputs an error message and returns NULL.
+//requires: A is not NULL
+//effects: may print output
+//         may allocate heap memory
+struct tsqr *tsqr_factor(const struct matrix * const A);
+
+//tsqr_r(T) returns the n x n upper triangular factor R of T, with A^T A =
+//   R^T R, through a heap-allocated matrix that the caller must free with
+//   matrix_destroy().
+//requires: T is not NULL
+//effects: allocates heap memory
+struct matrix *tsqr_r(const struct tsqr * const T);
+
+//tsqr_rank(T) returns the numerical rank of the matrix factored by T.
+//requires: T is not NULL
+int tsqr_rank(const struct tsqr * const T);
+
+//tsqr_basis(T, A) returns an m x r matrix, where r is the rank of T, whose
+//   columns are an orthonormal basis of the column space of A, through a
+//   heap-allocated pointer that the caller must free with matrix_destroy().
+//   It reads A once more and needs the same A that T was factored from. The
+//   columns lose orthogonality in proportion to the condition number of the
+//   independent columns of A. If the rank is 0 the matrix is empty. If A does
+//   not have n columns, it outputs an error message and returns NULL.
+//requires: T, A are not NULL
+//effects: may print output
+//         may allocate heap memory
+struct matrix *tsqr_basis(const struct tsqr * const T,
+                          const struct matrix * const A);
+
+//tsqr_least_squares(A, b, residual) returns the x in R[n] that minimizes the
+//   length of Ax - b, through a heap-allocated vector that the caller must
+//   free with vector_destroy(), and stores that length in *residual if
+//   residual is not NULL. It factors A and b together in one pass. If A has
+//   rank r < n, x is the basic solution with n - r entries equal to 0. If A
+//   is empty or b is not in R[m], it outputs an error message and returns
+//   NULL.
+//requires: A, b are not NULL
+//effects: may modify *residual
+//         may print output
+//         may allocate heap memory
+struct vector *tsqr_least_squares(const struct matrix * const A,
+                                  const struct vector * const b,
+                                  long double * const residual);
+
+//tsqr_destroy(T) frees all heap memory allocated to T. Passing NULL does
+//   nothing.
+//effects: frees heap memory
+void tsqr_destroy(struct tsqr * const T);
+
+#endif
@@ -1,37 +1,97 @@
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
 #include <limits.h>
+#include <string.h>
 #include "vector_core.h"
+#include "format.h"
+#include "instrument.h"
+#include "status.h"
 #include "settings.h"
 
 
 //see header file for documentation
 
+//A struct vector_storage holds the elements of one or more vectors. Copies
+//   made by vector_dupe share the storage of the original until one of them
+//   is modified, which then gets a private copy first (copy-on-write).
+struct vector_storage {
+  //number of vectors sharing the storage, updated atomically
+  int refs;
+  int maxdim;
+  long double value[];
+};
+
 struct vector {
   int dim;
-  int maxdim;
-  long double *value;
+  struct vector_storage *storage;
 };
 
+//storage_create(maxdim, zero) returns a new storage for maxdim elements with
+//   a single reference. The elements are zero if zero is true.
+//effects: allocates heap memory
+static struct vector_storage *storage_create(const int maxdim,
+                                             const bool zero) {
+  const size_t size = sizeof(struct vector_storage) +
+                      maxdim * sizeof(long double);
+  struct vector_storage *storage = zero ? calloc(1, size) : malloc(size);
+  INSTRUMENT_ALLOC(size);
+  storage->refs = 1;
+  storage->maxdim = maxdim;
+  return storage;
+}
+
+//storage_release(storage) drops one reference to storage and frees it when
+//   none are left.
+//effects: may free heap memory
+static void storage_release(struct vector_storage * const storage) {
+  if (__atomic_sub_fetch(&storage->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    INSTRUMENT_FREE(sizeof(struct vector_storage) +
+                    storage->maxdim * sizeof(long double));
+    free(storage);
+  }
+}
+
+//own(v1) gives v1 a private copy of its elements if the storage is shared,
+//   so they can be modified.
+//effects: modifies *v1
+//         may allocate heap memory
+static void own(struct vector * const v1) {
+  if (__atomic_load_n(&v1->storage->refs, __ATOMIC_ACQUIRE) > 1) {
+    struct vector_storage *copy = storage_create(v1->storage->maxdim, false);
+    memcpy(copy->value, v1->storage->value, v1->dim * sizeof(long double));
+    storage_release(v1->storage);
+    v1->storage = copy;
+  }
+}
+
 struct vector *vector_create() {
   struct vector *current = malloc(sizeof(struct vector));
+  INSTRUMENT_ALLOC(sizeof(struct vector));
   current->dim = 0;
-  current->maxdim = 1;
-  current->value = malloc(sizeof(long double));
+  current->storage = storage_create(1, false);
+  return current;
+}
+
+struct vector *vector_create_zero(const int n) {
+  assert(n >= 0);
+  struct vector *current = malloc(sizeof(struct vector));
+  INSTRUMENT_ALLOC(sizeof(struct vector));
+  current->dim = n;
+  current->storage = storage_create(n > 0 ? n : 1, true);
   return current;
 }
 
 struct vector *quick_vector_input(const long double values[], const int n) {
   assert(values);
   if (n < 0) {
-    printf("A vector cannot have negative number of elements.\n");
+    linalg_report(LINALG_ERR_INVALID, __func__, 
+                  "A vector cannot have negative number of elements.");
     return NULL;
   } else {
-    struct vector *current = vector_create();
-    for (int i = 0; i < n; i++) {
-      vector_add_elem(current, values[i]);
-    }
+    struct vector *current = vector_create_zero(n);
+    memcpy(current->storage->value, values, n * sizeof(long double));
     return current;
   }
 }
@@ -45,85 +105,162 @@ int vector_dim(const struct vector * const v1) {
 
 void vector_add_elem(struct vector * const v1, const long double x) {
   assert(v1);
-  if (v1->dim == v1->maxdim) {
-    v1->maxdim *= 2;
-    v1->value = realloc(v1->value, v1->maxdim * sizeof(long double));
+  own(v1);
+  struct vector_storage *storage = v1->storage;
+  if (v1->dim == storage->maxdim) {
+    INSTRUMENT_FREE(storage->maxdim * sizeof(long double));
+    storage->maxdim *= 2;
+    storage = realloc(storage, sizeof(struct vector_storage) +
+                      storage->maxdim * sizeof(long double));
+    INSTRUMENT_ALLOC(storage->maxdim * sizeof(long double));
+    v1->storage = storage;
   }
-  v1->value[v1->dim] = x;
+  storage->value[v1->dim] = x;
   v1->dim ++;
 }
 
 
 struct vector *vector_dupe(const struct vector * const v1) {
-  struct vector *duped = vector_create();
-  for (int i = 0; i < v1->dim; i++) {
-    vector_add_elem(duped, v1->value[i]);
-  }
+  assert(v1);
+  struct vector *duped = malloc(sizeof(struct vector));
+  INSTRUMENT_ALLOC(sizeof(struct vector));
+  duped->dim = v1->dim;
+  duped->storage = v1->storage;
+  __atomic_add_fetch(&duped->storage->refs, 1, __ATOMIC_RELAXED);
   return duped;
 }
 
 void vector_remove(struct vector * const v1) {
   assert(v1);
   if (v1->dim == 0) {
-    printf("The vector has no coordinates to remove.\n");
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "The vector has no coordinates to remove.");
   } else {
     v1->dim --;
   }
 }
 
 long double vector_elem(const struct vector * const v1, const int index) {
+  long double x = INT_MIN;
+  vector_elem_checked(v1, index, &x);
+  return x;
+}
+
+enum linalg_status vector_elem_checked(const struct vector * const v1,
+                                       const int index, long double * const x) {
   assert(v1);
+  assert(x);
   if ((index <= 0) || (index > v1->dim)) {
-    printf("Element %d does not exist in a vector with %d elements\n",
-           index, v1->dim);
-    return INT_MIN;
+    return linalg_report(LINALG_ERR_INDEX, "vector_elem", 
+                         "Element %d does not exist in a vector with %d "
+                         "elements", index, v1->dim);
   } else {
-    return v1->value[index - 1];
+    *x = v1->storage->value[index - 1];
+    return LINALG_OK;
   }
 }
 
+long double vector_elem_unchecked(const struct vector * const v1,
+                                  const int index) {
+  assert(v1);
+  assert(0 < index && index <= v1->dim);
+  return v1->storage->value[index - 1];
+}
+
+const long double *vector_cdata(const struct vector * const v1) {
+  assert(v1);
+  return v1->storage->value;
+}
+
+long double *vector_data(struct vector * const v1) {
+  assert(v1);
+  own(v1);
+  return v1->storage->value;
+}
+
 void vector_replace(const struct vector * const v1, const int index, 
                     const long double x) {
   assert(v1);
   if (index <= 0 || index > v1->dim) {
-    printf("Element %d does not exist in a vector with %d elements\n",
-           index, v1->dim);
+    linalg_report(LINALG_ERR_INDEX, __func__,
+                  "Element %d does not exist in a vector with %d elements",
+                  index, v1->dim);
   } else {
-    v1->value[index - 1] = x;
+    vector_data((struct vector *) v1)[index - 1] = x;
   }
 }
 
-void vector_print_bracket(const struct vector * const v1, const char left, 
-                          const char right) {
-  if (!v1) {
-    printf("The vector is currently null (uninitialized).\n");
-    return;
-  }
-  printf("%c", left);
+void vector_format_into(const struct vector * const v1, const char left,
+                        const char right, const int edge,
+                        struct text_buffer * const tb) {
+  assert(v1);
+  assert(tb);
+  const bool summary = (edge > 0) && (v1->dim > 2 * edge);
+  text_buffer_append_char(tb, left);
   for (int i = 0; i < v1->dim; i++) {
-    if ((-PRECISION < v1->value[i]) && (PRECISION > v1->value[i])) {
-      const long double x = 0;
-      printf("%14.5Lf", x);
-    } else {
-      printf("%14.5Lf", v1->value[i]);
+    if (summary && i == edge) {
+      text_buffer_append(tb, "...", 3);
+      i = v1->dim - edge;
+      text_buffer_append_char(tb, ' ');
     }
+    text_buffer_append_number(tb, v1->storage->value[i]);
     if (i != v1->dim - 1) {
-      printf(" ");
+      text_buffer_append_char(tb, ' ');
     }
   }
-  printf("%c\n", right);
+  text_buffer_append_char(tb, right);
+  text_buffer_append_char(tb, '\n');
+}
+
+int vector_format(const struct vector * const v1, char * const buf,
+                  const int size) {
+  assert(v1);
+  struct text_buffer *tb = text_buffer_wrap(buf, size);
+  vector_format_into(v1, VECTOR_BRACKET_LEFT, VECTOR_BRACKET_RIGHT, 0, tb);
+  const int length = text_buffer_length(tb);
+  text_buffer_data(tb);
+  text_buffer_destroy(tb);
+  return length;
+}
+
+//vector_fprint_bracket(v1, left, right, out) prints the vector that v1 
+//   points to into out with the given brackets using a single write.
+//requires: out is not NULL
+//effects: prints output
+static void vector_fprint_bracket(const struct vector * const v1, 
+                                  const char left, const char right,
+                                  FILE * const out) {
+  assert(out);
+  if (!v1) {
+    fprintf(out, "The vector is currently null (uninitialized).\n");
+    return;
+  }
+  struct text_buffer *tb = text_buffer_create();
+  vector_format_into(v1, left, right, 0, tb);
+  text_buffer_write(tb, out);
+  text_buffer_destroy(tb);
+}
+
+void vector_print_bracket(const struct vector * const v1, const char left, 
+                          const char right) {
+  vector_fprint_bracket(v1, left, right, stdout);
 }
 
 void vector_print(const struct vector * const v1) {
   vector_print_bracket(v1, VECTOR_BRACKET_LEFT, VECTOR_BRACKET_RIGHT);
 }
 
+void vector_fprint(const struct vector * const v1, FILE * const out) {
+  vector_fprint_bracket(v1, VECTOR_BRACKET_LEFT, VECTOR_BRACKET_RIGHT, out);
+}
+
 
 void vector_destroy(struct vector * const v1) {
   if (!v1) {
     return;
   } else {
-    free(v1->value);
+    INSTRUMENT_FREE(sizeof(struct vector));
+    storage_release(v1->storage);
     free(v1);
   }
 }
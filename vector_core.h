@@ -1,11 +1,21 @@
+#include <stdio.h>
+#include "status.h"
+
 //A struct vector represents a vector in Euclidean space.
 struct vector;
+struct text_buffer;
 
 //vector_create() returns a heap allocated struct vector pointer that caller 
 //   must free using vector_destroy().
 //effects: allocates heap memory
 struct vector *vector_create();
 
+//vector_create_zero(n) returns a heap-allocated zero vector in R[n] that the
+//   caller must free using vector_destroy().
+//requires: n >= 0
+//effects: allocates heap memory
+struct vector *vector_create_zero(const int n);
+
 //quick_vector_input(values, n) takes an array of long doubles and an
 //   integer n. If possible, it returns a heap-allocated pointer to a
 //   vector in R[n] formed with the array of numbers; the caller must free 
@@ -43,6 +53,36 @@ void vector_remove(struct vector * const v1);
 //   that v1 points to. It will return INT_MIN if the index is out of range.
 long double vector_elem(const struct vector * const v1, const int index);
 
+//vector_elem_checked(v1, index, x) sets *x to the index-th element of the
+//   struct vector that v1 points to and returns LINALG_OK. If the index is 
+//   out of range it returns LINALG_ERR_INDEX and leaves *x unchanged.
+//requires: v1 and x are not NULL
+//effects: may modify *x
+//         may print message
+enum linalg_status vector_elem_checked(const struct vector * const v1,
+                                       const int index, long double * const x);
+
+//vector_elem_unchecked(v1, index) returns the index-th element of *v1
+//   without validating index (beyond an assert), for use in loops whose 
+//   bounds were checked once.
+//requires: v1 is not NULL
+//          1 <= index <= vector_dim(v1)
+long double vector_elem_unchecked(const struct vector * const v1,
+                                  const int index);
+
+//vector_cdata(v1) returns a pointer to the vector_dim(v1) elements of *v1,
+//   stored contiguously (element 1 first). The pointer is invalidated by any
+//   call that changes the vector, including vector_data(v1).
+//requires: v1 is not NULL
+const long double *vector_cdata(const struct vector * const v1);
+
+//vector_data(v1) is like vector_cdata(v1), but the elements may be modified
+//   through the returned pointer. If v1 shares its elements with a copy made
+//   by vector_dupe, v1 gets a private copy first.
+//requires: v1 is not NULL
+//effects: may allocate heap memory
+long double *vector_data(struct vector * const v1);
+
 //vector_replace(v1, index, x) takes in a struct vector pointer, an integer
 //   index, and a long double x. If possible, it replaces the index-th 
 //   coordinate  in the vector with x. Otherwise it displays an error message.
@@ -53,7 +93,9 @@ void vector_replace(const struct vector * const v1, const int index,
                     const long double x);
 
 //vector_dupe(v1) returns a new struct vector pointer with identical vector as
-//   the one passed in.
+//   the one passed in. It takes O(1) time: the copy shares the elements of v1
+//   until either vector is modified, and only the modified one is copied
+//   then.
 //effects: may allocate heap memory
 struct vector *vector_dupe(const struct vector * const v1);
 
@@ -67,6 +109,33 @@ void vector_print(const struct vector * const v1);
 void vector_print_bracket(const struct vector * const v1, const char left, 
                           const char right);
 
+//vector_format_into(v1, left, right, edge, tb) appends the vector that v1
+//   points to, with the given characters left and right as brackets and a 
+//   trailing newline, to the text buffer *tb. If edge is positive and the
+//   vector has more than 2 * edge elements, only the first and last edge 
+//   elements are written, separated by "...".
+//requires: v1 and tb are not NULL
+//effects: modifies *tb
+void vector_format_into(const struct vector * const v1, const char left,
+                        const char right, const int edge,
+                        struct text_buffer * const tb);
+
+//vector_format(v1, buf, size) writes the text vector_print(v1) would print
+//   into buf, writing at most size chars including the terminating NUL. It
+//   returns the number of chars the full text needs (like snprintf), so the
+//   text was truncated if the result is size or more.
+//requires: v1 is not NULL
+//          buf is not NULL if size > 0
+//effects: modifies buf
+int vector_format(const struct vector * const v1, char * const buf,
+                  const int size);
+
+//vector_fprint(v1, out) prints the vector that v1 points to into out with a
+//   single write.
+//requires: out is not NULL
+//effects: prints output
+void vector_fprint(const struct vector * const v1, FILE * const out);
+
 //vector_destroy(v1) frees heap memory allocated to v1 if it is not NULL.
 //effects: may free heap memory
 void vector_destroy(struct vector * const v1);
@@ -6,160 +6,258 @@
 #include <math.h>
 #include "vector_operations.h"
 #include "vector_core.h"
+#include "instrument.h"
+#include "status.h"
 
 //see header file for documentation
 
 
-//valid_vectors(v1, v2) returns true if v1 and v2 are non-empty and of the
-//   same length. It returns false and prints error pessage if not.
+//valid_vectors(v1, v2, function) returns LINALG_OK if v1 and v2 are
+//   non-empty and of the same length. Otherwise it reports the error on
+//   behalf of function and returns its status.
 //requires: v1, v2 are not NULL;
 //effects: may print output.
-static bool valid_vectors(const struct vector * const v1,
-                          const struct vector * const v2) {
+static enum linalg_status valid_vectors(const struct vector * const v1,
+                                        const struct vector * const v2,
+                                        const char * const function) {
   assert(v1);
   assert(v2);
   if ((vector_dim(v1) == 0) || (vector_dim(v2) == 0)) {
-    printf("Invalid input. A vector is empty.\n");
-    return false;
+    return linalg_report(LINALG_ERR_EMPTY, function,
+                         "Invalid input. A vector is empty.");
   } else if (vector_dim(v1) != vector_dim(v2)) {
-    printf("Invalid input. The vectors are not of the same dimension.\n");
-    return false;
+    return linalg_report(LINALG_ERR_DIMENSION, function,
+                         "Invalid input. The vectors are not of the same "
+                         "dimension.");
   }
-  return true;
+  return LINALG_OK;
+}
+
+//dot(x, y, n) returns the dot product of the n long doubles in x and y.
+static long double dot(const long double * const x,
+                       const long double * const y, const int n) {
+  long double total = 0;
+  for (int i = 0; i < n; i++) {
+    total += x[i] * y[i];
+  }
+  INSTRUMENT_FLOPS(2 * n);
+  return total;
 }
 
 struct vector *vector_mult(const struct vector * const v1,
                            const long double c) {
   assert(v1);
-  if (vector_dim(v1) == 0) {
-    printf("Invalid input. The vector is empty.\n");
+  const int n = vector_dim(v1);
+  if (n == 0) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. The vector is empty.");
     return NULL;
   } else {
-    struct vector *new = vector_create();
-    for (int i = 1; i <= vector_dim(v1); i++) {
-      vector_add_elem(new, c * vector_elem(v1, i));
+    struct vector *new = vector_create_zero(n);
+    const long double *x = vector_cdata(v1);
+    long double *y = vector_data(new);
+    for (int i = 0; i < n; i++) {
+      y[i] = c * x[i];
     }
+    INSTRUMENT_FLOPS(n);
     return new;
   }
 }
 
 struct vector *vector_add(const struct vector * const v1,
                           const struct vector * const v2) {
-  if (!valid_vectors(v1,v2)) {
+  if (valid_vectors(v1, v2, __func__) != LINALG_OK) {
     return NULL;
   } else {
-    struct vector *new = vector_create();
-    for (int i = 1; i <= vector_dim(v1); i++) {
-      vector_add_elem(new, vector_elem(v1, i) + vector_elem(v2, i));
+    const int n = vector_dim(v1);
+    struct vector *new = vector_create_zero(n);
+    const long double *x = vector_cdata(v1);
+    const long double *y = vector_cdata(v2);
+    long double *z = vector_data(new);
+    for (int i = 0; i < n; i++) {
+      z[i] = x[i] + y[i];
     }
+    INSTRUMENT_FLOPS(n);
     return new;
   }
 }
 
+struct vector *vector_mult_consume(struct vector * const v1,
+                                   const long double c) {
+  assert(v1);
+  const int n = vector_dim(v1);
+  if (n == 0) {
+    linalg_report(LINALG_ERR_EMPTY, __func__,
+                  "Invalid input. The vector is empty.");
+    vector_destroy(v1);
+    return NULL;
+  } else {
+    long double *x = vector_data(v1);
+    for (int i = 0; i < n; i++) {
+      x[i] *= c;
+    }
+    INSTRUMENT_FLOPS(n);
+    return v1;
+  }
+}
+
+struct vector *vector_add_consume(struct vector * const v1,
+                                  const struct vector * const v2) {
+  if (valid_vectors(v1, v2, __func__) != LINALG_OK) {
+    vector_destroy(v1);
+    return NULL;
+  } else {
+    const int n = vector_dim(v1);
+    long double *x = vector_data(v1);
+    const long double *y = vector_cdata(v2);
+    for (int i = 0; i < n; i++) {
+      x[i] += y[i];
+    }
+    INSTRUMENT_FLOPS(n);
+    return v1;
+  }
+}
+
 struct vector *vector_cross(const struct vector * const v1,
                             const struct vector * const v2) {
   assert(v1);
   assert(v2);
   if ((vector_dim(v1) != 3) || (vector_dim(v2) != 3)) {
-    printf("Invalid input. Cross product in this course is defined for");
-    printf("vectors in R(3) only.");
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "Invalid input. Cross product in this course is defined "
+                  "for vectors in R(3) only.");
     return NULL;
   } else {
-    struct vector *new = vector_create();
-    long double x1 = ((vector_elem(v1, 2) * vector_elem(v2, 3)) -
-                      (vector_elem(v1, 3) * vector_elem(v2, 2)));
-    long double x2 = ((vector_elem(v1, 3) * vector_elem(v2, 1)) -
-                      (vector_elem(v1, 1) * vector_elem(v2, 3)));
-    long double x3 = ((vector_elem(v1, 1) * vector_elem(v2, 2)) -
-                      (vector_elem(v1, 2) * vector_elem(v2, 1)));
-    vector_add_elem(new, x1);
-    vector_add_elem(new, x2);
-    vector_add_elem(new, x3);
+    const long double *a = vector_cdata(v1);
+    const long double *b = vector_cdata(v2);
+    struct vector *new = vector_create_zero(3);
+    long double *c = vector_data(new);
+    c[0] = (a[1] * b[2]) - (a[2] * b[1]);
+    c[1] = (a[2] * b[0]) - (a[0] * b[2]);
+    c[2] = (a[0] * b[1]) - (a[1] * b[0]);
+    INSTRUMENT_FLOPS(9);
     return new;
   }
 }
 
 long double vector_dot(const struct vector * const v1,
                        const struct vector * const v2) {
-  if (!valid_vectors(v1,v2)) {
-    return INT_MIN;
-  } else {
-    long double total = 0;
-    for (int i = 1; i <= vector_dim(v1); i++) {
-      total += vector_elem(v1, i) * vector_elem(v2, i);
-    }
-    return total;
+  long double total = INT_MIN;
+  vector_dot_checked(v1, v2, &total);
+  return total;
+}
+
+enum linalg_status vector_dot_checked(const struct vector * const v1,
+                                      const struct vector * const v2,
+                                      long double * const result) {
+  assert(result);
+  const enum linalg_status status = valid_vectors(v1, v2, "vector_dot");
+  if (status == LINALG_OK) {
+    *result = dot(vector_cdata(v1), vector_cdata(v2), vector_dim(v1));
   }
+  return status;
 }
 
 struct vector *vector_proj(const struct vector * const v1,
                            const struct vector * const v2) {
-  if (!valid_vectors(v1,v2)) {
+  if (valid_vectors(v1, v2, __func__) != LINALG_OK) {
     return NULL;
   } else {
-    const long double factor = vector_dot(v1,v2) / vector_dot(v1,v1);
+    const long double *x = vector_cdata(v1);
+    const int n = vector_dim(v1);
+    const long double factor = dot(x, vector_cdata(v2), n) / dot(x, x, n);
+    INSTRUMENT_FLOPS(1);
     return vector_mult(v1, factor);
   }
 }
 
 
-struct vector *vector_perp(const struct vector * const v1, 
+struct vector *vector_perp(const struct vector * const v1,
                            const struct vector * const v2) {
-  if (!valid_vectors(v1,v2)) {
+  if (valid_vectors(v1, v2, __func__) != LINALG_OK) {
     return NULL;
   } else {
-    struct vector *temp1 = vector_proj(v1, v2);
-    struct vector *temp2 = vector_mult(temp1, -1);
-    struct vector *new = vector_add(v2, temp2);
-    vector_destroy(temp1);
-    vector_destroy(temp2);
+    const long double *x = vector_cdata(v1);
+    const long double *y = vector_cdata(v2);
+    const int n = vector_dim(v1);
+    const long double factor = dot(x, y, n) / dot(x, x, n);
+    struct vector *new = vector_create_zero(n);
+    long double *z = vector_data(new);
+    for (int i = 0; i < n; i++) {
+      z[i] = y[i] - factor * x[i];
+    }
+    INSTRUMENT_FLOPS(2 * n + 1);
     return new;
   }
 }
 
 
 long double vector_norm(const struct vector * const v1) {
+  long double norm = INT_MIN;
+  vector_norm_checked(v1, &norm);
+  return norm;
+}
+
+enum linalg_status vector_norm_checked(const struct vector * const v1,
+                                       long double * const result) {
   assert(v1);
-  if (vector_dim(v1) == 0) {
-    printf("Invalid input. The vector is empty.\n");
-    return INT_MIN;
+  assert(result);
+  const int n = vector_dim(v1);
+  if (n == 0) {
+    return linalg_report(LINALG_ERR_EMPTY, "vector_norm",
+                         "Invalid input. The vector is empty.");
   }
-  return pow(vector_dot(v1,v1), 0.5);
+  const long double *x = vector_cdata(v1);
+  INSTRUMENT_FLOPS(1);
+  *result = sqrtl(dot(x, x, n));
+  return LINALG_OK;
 }
 
 long double vector_angle(const struct vector * const v1,
                          const struct vector * const v2) {
-  if (!valid_vectors(v1,v2)) {
-    return INT_MIN;
-  } else if (vector_norm(v1) * vector_norm(v2) == 0) {
-    printf("At least one of the vectors is the zero vector.");
-    printf("The angle is not defined.\n");
-    return INT_MIN;
-  } else {
-    return acos(vector_dot(v1, v2) / (vector_norm(v1) * vector_norm(v2)));
+  long double angle = INT_MIN;
+  vector_angle_checked(v1, v2, &angle);
+  return angle;
+}
+
+enum linalg_status vector_angle_checked(const struct vector * const v1,
+                                        const struct vector * const v2,
+                                        long double * const result) {
+  assert(result);
+  const enum linalg_status status = valid_vectors(v1, v2, "vector_angle");
+  if (status != LINALG_OK) {
+    return status;
+  }
+  const long double *x = vector_cdata(v1);
+  const long double *y = vector_cdata(v2);
+  const int n = vector_dim(v1);
+  const long double norms = sqrtl(dot(x, x, n)) * sqrtl(dot(y, y, n));
+  if (norms == 0) {
+    return linalg_report(LINALG_ERR_INVALID, "vector_angle",
+                         "At least one of the vectors is the zero vector. "
+                         "The angle is not defined.");
   }
+  INSTRUMENT_FLOPS(4);
+  *result = acosl(dot(x, y, n) / norms);
+  return LINALG_OK;
 }
 
-void scalar_equation(const struct vector * const v1, 
+void scalar_equation(const struct vector * const v1,
                      const struct vector * const v2, const long double x1,
                      const long double x2, const long double x3) {
   assert(v1);
   assert(v2);
   if ((vector_dim(v1) != 3) || (vector_dim(v2) != 3)) {
-    printf("The current version only supports scalar equations in R(3)n\n");
+    linalg_report(LINALG_ERR_DIMENSION, __func__,
+                  "The current version only supports scalar equations in "
+                  "R(3)");
     return;
   } else {
     struct vector *n = vector_cross(v1,v2);
-    long double c = (vector_elem(n, 1) * x1) + (vector_elem(n, 2) * x2) +
-      (vector_elem(n, 3) * x3);
-    printf("The scalar equation is:\n%Lf X1 + ", vector_elem(n, 1));
-    printf("%Lf X2 + %Lf X3 = %Lf\n", vector_elem(n, 2), vector_elem(n, 3), c);
+    const long double *normal = vector_cdata(n);
+    long double c = (normal[0] * x1) + (normal[1] * x2) + (normal[2] * x3);
+    printf("The scalar equation is:\n%Lf X1 + ", normal[0]);
+    printf("%Lf X2 + %Lf X3 = %Lf\n", normal[1], normal[2], c);
     vector_destroy(n);
   }
 }
-
-
-
-
-
-
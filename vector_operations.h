@@ -1,3 +1,5 @@
+#include "status.h"
+
 //vector_mult(v1, c) takes in a struct vector pointer and a long double c, and 
 //   returns the result of c(v1) through a vector pointer if possible (the 
 //   caller must free the pointer). If not, it will output an error message 
@@ -17,6 +19,26 @@ struct vector *vector_mult(const struct vector * const v1,
 struct vector *vector_add(const struct vector * const v1, 
                           const struct vector * const v2);
 
+//vector_mult_consume(v1, c) is like vector_mult(v1, c), but takes ownership
+//   of v1: the result is written over the elements of v1 and returned in its
+//   place, so the caller must not use v1 afterwards. If the result cannot be
+//   computed, v1 is freed and NULL is returned.
+//requires: v1 is not NULL.
+//effects: may print output
+//         may allocate heap memory
+//         may free heap memory
+struct vector *vector_mult_consume(struct vector * const v1,
+                                   const long double c);
+
+//vector_add_consume(v1, v2) is like vector_add(v1, v2), but takes ownership
+//   of v1 (see vector_mult_consume). v2 may be v1.
+//requires: v1 and v2 are not NULL.
+//effects: may print output
+//         may allocate heap memory
+//         may free heap memory
+struct vector *vector_add_consume(struct vector * const v1,
+                                  const struct vector * const v2);
+
 //vector_cross(v1, v2) takes in two struct vector pointers, and returns the 
 //   result of v1 x v2 through a vector pointer if possible (the caller must
 //   free the pointer). If not, it will output an error message and return
@@ -35,6 +57,16 @@ struct vector *vector_cross(const struct vector * const v1,
 long double vector_dot(const struct vector * const v1,
                        const struct vector * const v2);
 
+//vector_dot_checked(v1, v2, result) sets *result to v1 dot v2 and returns
+//   LINALG_OK if possible. Otherwise it reports and returns the error status
+//   and leaves *result unchanged.
+//requires: v1, v2 and result are not NULL.
+//effects: may modify *result
+//         may print output
+enum linalg_status vector_dot_checked(const struct vector * const v1,
+                                      const struct vector * const v2,
+                                      long double * const result);
+
 //vector_proj(v1, v2) takes in two struct vector pointers, and returns the 
 //   result of projecting v2 onto v1 through a vector pointer if possible (the
 //   caller must free the pointer). If not, it will output an error message 
@@ -61,6 +93,15 @@ struct vector *vector_perp(const struct vector * const v1,
 //effects: may print output
 long double vector_norm(const struct vector * const v1);
 
+//vector_norm_checked(v1, result) sets *result to the norm of *v1 and returns
+//   LINALG_OK if possible. Otherwise it reports and returns the error status
+//   and leaves *result unchanged.
+//requires: v1 and result are not NULL.
+//effects: may modify *result
+//         may print output
+enum linalg_status vector_norm_checked(const struct vector * const v1,
+                                       long double * const result);
+
 //vector_angle(v1, v2) takes in two struct vector pointers, and returns the
 //   angle (in radians) between the two vectors if possible. If not, it will 
 //   output an error message and return INT_MIN.
@@ -69,6 +110,16 @@ long double vector_norm(const struct vector * const v1);
 long double vector_angle(const struct vector * const v1, 
                          const struct vector * const v2);
 
+//vector_angle_checked(v1, v2, result) sets *result to the angle (in radians)
+//   between the two vectors and returns LINALG_OK if possible. Otherwise it
+//   reports and returns the error status and leaves *result unchanged.
+//requires: v1, v2 and result are not NULL.
+//effects: may modify *result
+//         may print output
+enum linalg_status vector_angle_checked(const struct vector * const v1,
+                                        const struct vector * const v2,
+                                        long double * const result);
+
 //scalar_equation(v1, v2, x1, x2, x3) takes in two struct vector pointers and 
 //   three long doubles representing a point on the plane. It will print the
 //   scalar equation of the plane if possible, or output an error message.
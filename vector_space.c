@@ -2,8 +2,14 @@
 #include "matrix_core.h"
 #include "matrix_operations.h"
 #include "vector_space.h"
+#include "exact.h"
+#include "modular.h"
+#include "basis.h"
+#include "status.h"
 #include <assert.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 //See header file for documentation
 
@@ -23,31 +29,34 @@ void vector_list_print(const struct vector * const vector_list[],
   }
 }
 
-//vector_list_valid(vector_list, n) returns true if vector_list contains
-//   pointers to n vectors with same dimesion. Otherwise it outputs an error
-//   message and returns false.
+//vector_list_valid(vector_list, n, function) returns true if vector_list
+//   contains pointers to n vectors with same dimesion. Otherwise it reports
+//   the error on behalf of function and returns false.
 //requires: vector_list is not NULL
 //          first n pointers in vector_list is not NULL
 //effects: prints message
 static bool vector_list_valid(const struct vector * const vector_list[], 
-                              const int n) {
+                              const int n, const char * const function) {
   assert(vector_list);
   for (int i = 0; i < n; i++) {
     assert(vector_list[i]);
   }
   if (n <= 0) {
-    printf("Invalid input. n must be greater than 0.\n");
+    linalg_report(LINALG_ERR_EMPTY, function,
+                  "Invalid input. n must be greater than 0.");
     return false;
   } else {
     const int dim = vector_dim(vector_list[0]);
     if (dim < 1) {
-      printf("Invalid input. At least one vector has a dimension of less ");
-      printf("than 1.\n");
+      linalg_report(LINALG_ERR_EMPTY, function,
+                    "Invalid input. At least one vector has a dimension of "
+                    "less than 1.");
       return false;
     }
     for (int i = 1; i < n; i++) {
       if (vector_dim(vector_list[i]) != dim) {
-        printf("Invalid input. All vectors must have same dimension.\n");
+        linalg_report(LINALG_ERR_DIMENSION, function,
+                      "Invalid input. All vectors must have same dimension.");
         return false;
       }
     }
@@ -55,10 +64,9 @@ static bool vector_list_valid(const struct vector * const vector_list[],
   }
 }
 
-
 bool linearly_independent(const struct vector * const vector_list[], 
                           const int n) {
-  if (vector_list_valid(vector_list, n)) {
+  if (vector_list_valid(vector_list, n, __func__)) {
     struct matrix *vectors = matrix_create();
     for (int i = 0; i < n; i++) {
       matrix_add_col(vectors, vector_list[i]);
@@ -85,10 +93,11 @@ bool is_basis(const struct vector * const vector_list[], const int dim,
 bool in_span(const struct vector * const vector_list[], const int n, 
              const struct vector * const v1) {
   assert(v1);
-  if (vector_list_valid(vector_list, n)) {
+  if (vector_list_valid(vector_list, n, __func__)) {
     if (vector_dim(v1) != vector_dim(vector_list[0])) {
-      printf("Invalid input. v1 must have same dimension has vectors in");
-      printf("the list of vectors.\n");
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "Invalid input. v1 must have same dimension has vectors "
+                    "in the list of vectors.");
       return false;
     }
     struct matrix *vectors = matrix_create();
@@ -108,8 +117,26 @@ bool in_span(const struct vector * const vector_list[], const int n,
 
 struct matrix *find_basis(const struct vector * const vector_list[], 
                           const int n) {
-  if (vector_list_valid(vector_list, n)) {
+  if (vector_list_valid(vector_list, n, __func__)) {
+    struct matrix *vectors = matrix_create();
+    for (int i = 0; i < n; i++) {
+      matrix_add_col(vectors, vector_list[i]);
+    }
+    const bool integral = matrix_is_integral(vectors);
     struct matrix *basis = matrix_create();
+    if (integral) {
+      //one elimination names the independent vectors
+      int *pivot = malloc(n * sizeof(int));
+      const int rank = modular_rank(vectors, pivot);
+      for (int k = 0; k < rank; k++) {
+        matrix_add_col(basis, vector_list[pivot[k] - 1]);
+      }
+      free(pivot);
+    }
+    matrix_destroy(vectors);
+    if (integral) {
+      return basis;
+    }
     int basis_dim = 0;
     for (int i = 0; i < n; i++) {
       matrix_add_col(basis, vector_list[i]);
@@ -128,10 +155,12 @@ struct vector *B_coord(const struct vector * const basis[], const int n,
                        const struct vector * const v1) {
   assert(v1);
   if (!linearly_independent(basis, n)) {
-    printf("Invalid input. the first n vectors in basis are not linearly");
-    printf("independent.\n");
+    linalg_report(LINALG_ERR_NOT_BASIS, __func__,
+                  "Invalid input. the first n vectors in basis are not "
+                  "linearly independent.");
   } else if (!in_span(basis, n, v1)) {
-    printf("Invalid input. Vector is not in span.\n");
+    linalg_report(LINALG_ERR_INVALID, __func__,
+                  "Invalid input. Vector is not in span.");
   } else {
     struct matrix *vectors = matrix_create();
     for (int i = 0; i < n; i++) {
@@ -156,25 +185,42 @@ struct vector *B_coord(const struct vector * const basis[], const int n,
 struct matrix *change_of_coord_matrix(const struct vector * const B1[], 
                                       const struct vector * const B2[],
                                       const int n) {
-  if (vector_list_valid(B1,n) && vector_list_valid(B2, n)) {
+  if (vector_list_valid(B1, n, __func__) &&
+      vector_list_valid(B2, n, __func__)) {
     if (!(linearly_independent(B1, n) && linearly_independent(B2, n))) {
-      printf("Invalid input. At least one of the vector sets is not a");
-      printf("basis.\n");
+      linalg_report(LINALG_ERR_NOT_BASIS, __func__,
+                    "Invalid input. At least one of the vector sets is not "
+                    "a basis.");
     } else if (vector_dim(B1[0]) != vector_dim(B2[0])) {
-      printf("Invalid input. The vector sets must be of same dimension.\n");
+      linalg_report(LINALG_ERR_DIMENSION, __func__,
+                    "Invalid input. The vector sets must be of same "
+                    "dimension.");
     } else {
+      //one factorization of B1 answers every query
+      struct prepared_basis *prepared = basis_prepare(B1, n);
+      if (!prepared) {
+        return NULL;
+      }
+      struct matrix *vectors = matrix_create();
       for (int i = 0; i < n; i++) {
-        if (!in_span(B1, n, B2[i])) {
-          printf("Invalid input. The vector sets are not basis of the same");
-          printf("vector space.\n");
-          return NULL;
-        } 
+        matrix_add_col(vectors, B2[i]);
       }
-      struct matrix *result = matrix_create();
+      assert(n > 0);
+      bool *spanned = calloc(n, sizeof(bool));
+      struct matrix *result = basis_coord_batch(prepared, vectors, spanned);
+      bool same_space = true;
       for (int i = 0; i < n; i++) {
-        struct vector *temp = B_coord(B1, n, B2[i]);
-        matrix_add_col(result, temp);
-        vector_destroy(temp);
+        same_space = same_space && spanned[i];
+      }
+      free(spanned);
+      matrix_destroy(vectors);
+      basis_destroy(prepared);
+      if (!same_space) {
+        matrix_destroy(result);
+        linalg_report(LINALG_ERR_NOT_BASIS, __func__,
+                      "Invalid input. The vector sets are not basis of "
+                      "the same vector space.");
+        return NULL;
       }
       return result;
     }
@@ -1,5 +1,9 @@
 #include <stdbool.h>
 
+//The functions below decide independence and spans from ranks. When every
+//   entry is an integer, the ranks are found exactly modulo primes (see
+//   modular.h) instead of with PRECISION.
+
 //vector_list_print(vector_list, n) takes in an array of struct vector pointers
 //   and prints the first n vectors in the array if possible. Otherwise it 
 //   outputs an error message.
@@ -60,7 +64,10 @@ struct matrix *find_basis(const struct vector * const vector_list[],
 //   B-coordinate of v1 where the basis is the first n vectors in basis,
 //   through a heap allocated struct vector pointer that the client must free 
 //   using vector_destroy(). If B-coordinate cannot be found, it prints an
-//   error message and returns NULL.
+//   error message and returns NULL. When the basis spans all of R[n], the
+//   relative error of the coordinates is at most about the condition number
+//   of the matrix whose columns are the basis (see matrix_cond_1 in
+//   inv_and_det.h) times the rounding error of a long double.
 //requires: basis and v1 are not NULL
 //          there are at least n pointers in basis
 //          first n pointers in basis are not NULL